@@ -0,0 +1,121 @@
+#include "SubsystemNull.hpp"
+#include "TournamentFactory.hpp"
+#include "Tournament.hpp"
+#include "CheckMatch.hpp"
+#include "AllocationTracker.hpp"
+#include "JobSystem.hpp"
+#include "Timing.hpp"
+
+#include <iostream>
+#include <sstream>
+#include <cstdio>
+
+/* the steady state heap allocations of a match with frogs and projectiles
+   in flight have to stay in budget. the first ticks fill the pools and
+   are not counted. only builds configured with --enable-allocation-tracking
+   count, everywhere else the check is skipped */
+
+static const int PlayerCount = 6;
+static const int NPCCount = 6;
+static const int ProjectileCount = 16;
+static const int WarmupTicks = 60;
+static const int Ticks = 300;
+static const size_t ReportSites = 8;
+static const int SkipExitCode = 77;
+
+/* firing and picking up still allocate a little, a pool or a response
+   that allocates per entity again lands far above */
+static const double AllocationBudget = 4.0;
+
+struct Mode {
+    const char *name;
+    GamePlayType type;
+};
+
+static const Mode Modes[] = {
+    { "dm", GamePlayTypeDM },
+    { "tdm", GamePlayTypeTDM },
+    { "ctf", GamePlayTypeCTF },
+    { "ctc", GamePlayTypeCTC }
+};
+
+static const int ModeCount = sizeof(Modes) / sizeof(Mode);
+
+static int failures = 0;
+
+static void check(bool condition, const std::string& test, const std::string& what) {
+    if (!condition) {
+        std::cout << test << ": FAILED: " << what << std::endl;
+        failures++;
+    }
+}
+
+static void check_mode(Resources& resources, TournamentFactory& factory, const Mode& mode) throw (Exception) {
+    std::string test(mode.name);
+    CheckMatch match(resources, factory, mode.type, PlayerCount, NPCCount, ProjectileCount);
+    match.run(WarmupTicks);
+
+    AllocationTracker::reset();
+    for (int i = 0; i < Ticks; i++) {
+        match.run(1);
+        AllocationTracker::tick();
+    }
+
+    uint64_t ticks = AllocationTracker::get_ticks();
+    double per_tick = static_cast<double>(AllocationTracker::get_allocations()) / (ticks ? ticks : 1);
+    char text[64];
+    sprintf(text, "%.1f allocations per tick, the budget is %.1f", per_tick, AllocationBudget);
+    std::cout << test << ": " << text << std::endl;
+    if (per_tick > AllocationBudget) {
+        check(false, test, text);
+        AllocationTracker::Report report;
+        AllocationTracker::report(report, ReportSites);
+        for (AllocationTracker::Report::iterator it = report.begin(); it != report.end(); it++) {
+            std::cout << test << ": " << *it << std::endl;
+        }
+    }
+}
+
+int main(int argc, char *argv[]) {
+    std::ostream& stream = std::cout;
+    int rv = 1;
+
+    if (!AllocationTracker::is_available()) {
+        stream << "allocation tracking is not built in, check skipped" << std::endl;
+        return SkipExitCode;
+    }
+
+    init_hpet();
+    try {
+        CheckData::TemporaryDirectory dir;
+        CheckMatch::create_data(dir);
+
+        std::ostringstream log;
+        SubsystemNull subsystem(log, "Goat Attack Allocation Check");
+        Resources resources(subsystem, dir.get_path(), Resources::LoadProfileServer);
+
+        /* with workers like a server, the jobs of the tracked thread stay on it */
+        JobSystem jobs(JobSystem::get_default_worker_count());
+        TournamentFactory factory(resources, subsystem, 0);
+        factory.set_job_system(&jobs);
+
+        if (!AllocationTracker::attach()) {
+            throw Exception("Allocations are tracked in another thread");
+        }
+        for (int i = 0; i < ModeCount; i++) {
+            try {
+                check_mode(resources, factory, Modes[i]);
+            } catch (const Exception& e) {
+                check(false, Modes[i].name, e.what());
+            }
+        }
+        AllocationTracker::detach();
+
+        stream << (failures ? "allocation check failed" : "allocation check passed") << std::endl;
+        rv = (failures ? 1 : 0);
+    } catch (const Exception& e) {
+        stream << e.what() << std::endl;
+    }
+
+    return rv;
+}
@@ -0,0 +1,220 @@
+#include "ClientServer.hpp"
+#include "Timing.hpp"
+
+#include <iostream>
+#include <sstream>
+#include <cstring>
+
+/* known messages from a server to a client and back over loopback,
+   the bandwidth counters of both sides have to match what was sent */
+
+static const hostaddr_t Loopback = 0x7f000001;
+static const hostport_t FirstPort = 25212;
+static const int Ports = 16;
+static const ms_t TimeoutMS = 5000;
+
+static const data_len_t TextLen = 10;
+static const data_len_t ChatLen = 5;
+static const data_len_t StateLen = 20;
+static const data_len_t ShotLen = 4;
+static const int Shots = 3;
+
+static int failures = 0;
+
+static void check(bool condition, const std::string& test, const std::string& what) {
+    if (!condition) {
+        std::cout << test << ": FAILED: " << what << std::endl;
+        failures++;
+    }
+}
+
+class CheckEndpoint : public ClientServer {
+private:
+    CheckEndpoint(const CheckEndpoint&);
+    CheckEndpoint& operator=(const CheckEndpoint&);
+
+public:
+    CheckEndpoint(hostport_t port)
+        : ClientServer(port, 1, "Goat Attack Bandwidth Check", ""), conn(0), datagrams(0) { }
+
+    CheckEndpoint(hostaddr_t host, hostport_t port)
+        : ClientServer(host, port), conn(0), datagrams(0) { }
+
+    virtual ~CheckEndpoint() { }
+
+    const Connection *conn;
+    int datagrams;
+
+    virtual void event_login(const Connection *c, data_len_t len, void *data) throw (Exception) {
+        conn = c;
+    }
+
+    virtual void event_data(const Connection *c, data_len_t len, void *data) throw (Exception) {
+        if (len) {
+            count_received(0, data, len);
+            datagrams++;
+        }
+    }
+};
+
+/* keeps both ends going until the condition is met */
+class Pump {
+public:
+    virtual ~Pump() { }
+    virtual bool done() const = 0;
+};
+
+class LoginPump : public Pump {
+public:
+    LoginPump(const CheckEndpoint& server, const CheckEndpoint& client) : server(server), client(client) { }
+
+    virtual bool done() const {
+        return (server.conn && client.conn);
+    }
+
+private:
+    const CheckEndpoint& server;
+    const CheckEndpoint& client;
+};
+
+class DataPump : public Pump {
+public:
+    DataPump(const CheckEndpoint& endpoint, int datagrams) : endpoint(endpoint), datagrams(datagrams) { }
+
+    virtual bool done() const {
+        return (endpoint.datagrams >= datagrams);
+    }
+
+private:
+    const CheckEndpoint& endpoint;
+    int datagrams;
+};
+
+static bool pump(CheckEndpoint& server, CheckEndpoint& client, const Pump& until) {
+    gametime_t start;
+    gametime_t now;
+
+    get_now(start);
+    while (!until.done()) {
+        while (server.cycle());
+        while (client.cycle());
+        get_now(now);
+        if (diff_ms(start, now) > TimeoutMS) {
+            return false;
+        }
+        wait_ns(1000000);
+    }
+
+    return true;
+}
+
+static std::string describe(const char *what, uint64_t value, uint64_t expected) {
+    std::ostringstream text;
+    text << what << " " << value << ", expected " << expected;
+
+    return text.str();
+}
+
+static void check_counter(const std::string& test, const Bandwidth& bandwidth, Bandwidth::Direction direction,
+    Bandwidth::Class cls, command_t cmd, uint64_t messages, data_len_t len, uint64_t datagrams)
+{
+    const Bandwidth::Counter& counter = bandwidth.get(direction, cls, cmd);
+    check(counter.messages == messages, test, describe("messages", counter.messages, messages));
+    check(counter.bytes == messages * (GTransportLen + len), test,
+        describe("bytes", counter.bytes, messages * (GTransportLen + len)));
+    check(counter.datagrams == datagrams, test, describe("datagrams", counter.datagrams, datagrams));
+}
+
+static CheckEndpoint *create_server() throw (Exception) {
+    for (int i = 0; i < Ports; i++) {
+        try {
+            return new CheckEndpoint(FirstPort + i);
+        } catch (const UDPSocketException&) {
+            /* in use, try the next one */
+        }
+    }
+
+    throw Exception("No free port for the server");
+}
+
+/* the server sends two text messages and a chat message stacked in one
+   reliable datagram and a game state on its own, the client a reliable
+   chat message and three shots stacked in one unreliable datagram */
+static void check_messages(CheckEndpoint& server, CheckEndpoint& client) throw (Exception) {
+    char data[64];
+    memset(data, 'x', sizeof data);
+
+    server.stacked_send_data(server.conn, 0, GPCTextMessage, NetFlagsReliable, TextLen, data);
+    server.stacked_send_data(server.conn, 0, GPCTextMessage, NetFlagsReliable, TextLen, data);
+    server.stacked_send_data(server.conn, 0, GPCChatMessage, NetFlagsReliable, ChatLen, data);
+    server.flush_stacked_send_data(server.conn, NetFlagsReliable);
+    server.send_data(server.conn, 0, GPCUpdateGameState, 0, StateLen, data);
+
+    client.send_data(client.conn, 0, GPSChatMessage, NetFlagsReliable, ChatLen, data);
+    for (int i = 0; i < Shots; i++) {
+        client.stacked_send_data(client.conn, 0, GPSShot, 0, ShotLen, data);
+    }
+    client.flush_stacked_send_data(client.conn, 0);
+
+    check(pump(server, client, DataPump(client, 2)), "client", "server data not received");
+    check(pump(server, client, DataPump(server, 2)), "server", "client data not received");
+
+    const Bandwidth& sb = server.get_bandwidth();
+    const Bandwidth& cb = client.get_bandwidth();
+    Bandwidth::Direction sent = Bandwidth::DirectionSent;
+    Bandwidth::Direction received = Bandwidth::DirectionReceived;
+    Bandwidth::Class rel = Bandwidth::ClassReliable;
+    Bandwidth::Class unrel = Bandwidth::ClassUnreliable;
+
+    check_counter("server_sent_text", sb, sent, rel, GPCTextMessage, 2, TextLen, 1);
+    check_counter("server_sent_chat", sb, sent, rel, GPCChatMessage, 1, ChatLen, 1);
+    check_counter("server_sent_state", sb, sent, unrel, GPCUpdateGameState, 1, StateLen, 1);
+    check_counter("client_received_text", cb, received, rel, GPCTextMessage, 2, TextLen, 1);
+    check_counter("client_received_chat", cb, received, rel, GPCChatMessage, 1, ChatLen, 1);
+    check_counter("client_received_state", cb, received, unrel, GPCUpdateGameState, 1, StateLen, 1);
+
+    check_counter("client_sent_chat", cb, sent, rel, GPSChatMessage, 1, ChatLen, 1);
+    check_counter("client_sent_shot", cb, sent, unrel, GPSShot, Shots, ShotLen, 1);
+    check_counter("server_received_chat", sb, received, rel, GPSChatMessage, 1, ChatLen, 1);
+    check_counter("server_received_shot", sb, received, unrel, GPSShot, Shots, ShotLen, 1);
+
+    uint64_t server_bytes = 2 * (GTransportLen + TextLen) + (GTransportLen + ChatLen) + (GTransportLen + StateLen);
+    uint64_t client_bytes = (GTransportLen + ChatLen) + Shots * (GTransportLen + ShotLen);
+    check(sb.get_total_bytes(sent) == server_bytes, "server_sent_total",
+        describe("bytes", sb.get_total_bytes(sent), server_bytes));
+    check(cb.get_total_bytes(received) == server_bytes, "client_received_total",
+        describe("bytes", cb.get_total_bytes(received), server_bytes));
+    check(cb.get_total_bytes(sent) == client_bytes, "client_sent_total",
+        describe("bytes", cb.get_total_bytes(sent), client_bytes));
+    check(sb.get_total_bytes(received) == client_bytes, "server_received_total",
+        describe("bytes", sb.get_total_bytes(received), client_bytes));
+}
+
+int main(int argc, char *argv[]) {
+    std::ostream& stream = std::cout;
+    int rv = 1;
+
+    init_hpet();
+    try {
+        CheckEndpoint *server = create_server();
+        try {
+            CheckEndpoint client(Loopback, server->get_port());
+            client.login(0, 0);
+            if (!pump(*server, client, LoginPump(*server, client))) {
+                throw Exception("Login over loopback failed");
+            }
+            check_messages(*server, client);
+        } catch (...) {
+            delete server;
+            throw;
+        }
+        delete server;
+
+        stream << (failures ? "bandwidth check failed" : "bandwidth check passed") << std::endl;
+        rv = (failures ? 1 : 0);
+    } catch (const Exception& e) {
+        stream << e.what() << std::endl;
+    }
+
+    return rv;
+}
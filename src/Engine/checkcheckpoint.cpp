@@ -0,0 +1,137 @@
+#include "SubsystemNull.hpp"
+#include "TournamentFactory.hpp"
+#include "Tournament.hpp"
+#include "CheckMatch.hpp"
+#include "Timing.hpp"
+
+#include <iostream>
+#include <sstream>
+
+/* a match with frogs, projectiles and carried flags or coins is written
+   to a checkpoint and restored into a fresh tournament, both have to
+   hash the same. players do not survive a restart, carried items are
+   restored where they would have dropped */
+
+static const int PlayerCount = 6;
+static const int NPCCount = 6;
+static const int ProjectileCount = 16;
+static const int Ticks = 300;
+
+struct Mode {
+    const char *name;
+    GamePlayType type;
+    Object::ObjectType carried;
+};
+
+static const Mode Modes[] = {
+    { "dm", GamePlayTypeDM, Object::ObjectTypeNothing },
+    { "ctf", GamePlayTypeCTF, Object::ObjectTypeBlueFlag },
+    { "ctc", GamePlayTypeCTC, Object::ObjectTypeCoin }
+};
+
+static const int ModeCount = sizeof(Modes) / sizeof(Mode);
+
+static int failures = 0;
+
+static void check(bool condition, const std::string& test, const std::string& what) {
+    if (!condition) {
+        std::cout << test << ": FAILED: " << what << std::endl;
+        failures++;
+    }
+}
+
+static std::string describe(const char *what, size_t value) {
+    std::ostringstream text;
+    text << what << " " << value;
+
+    return text.str();
+}
+
+static GameObject *find_object(Tournament *tournament, Object::ObjectType type) {
+    Tournament::GameObjects& objects = tournament->get_game_objects();
+    for (Tournament::GameObjects::iterator it = objects.begin(); it != objects.end(); it++) {
+        if (it->object->get_type() == type) {
+            return &*it;
+        }
+    }
+
+    return 0;
+}
+
+static void check_mode(Resources& resources, TournamentFactory& factory, const Mode& mode) throw (Exception) {
+    std::string test(mode.name);
+    CheckMatch match(resources, factory, mode.type, PlayerCount, NPCCount, ProjectileCount);
+    match.run(Ticks);
+
+    /* the first goat is red and carries the blue flag or the coin */
+    Tournament *tournament = match.get_tournament();
+    if (mode.carried != Object::ObjectTypeNothing) {
+        check(match.pick(match.get_players()[0], mode.carried), test, "item not picked up");
+    }
+    size_t npcs = tournament->get_spawnable_npcs().size();
+    size_t animations = tournament->get_game_animations().size();
+    check(npcs > 0, test, describe("npcs", npcs));
+    check(animations > 0, test, describe("animations", animations));
+
+    Checkpoint written;
+    tournament->write_checkpoint(written);
+    uint64_t live_hash = tournament->get_state_hash();
+
+    Players no_players;
+    Tournament *restored = factory.create_tournament(match.get_config(), true, false, no_players, 0);
+    try {
+        written.rewind();
+        restored->read_checkpoint(written);
+        check(restored->get_state_hash() == live_hash, test, "restored match hashes differently");
+        check(restored->get_spawnable_npcs().size() == npcs, test,
+            describe("restored npcs", restored->get_spawnable_npcs().size()));
+        check(restored->get_game_animations().size() == animations, test,
+            describe("restored animations", restored->get_game_animations().size()));
+        if (mode.carried != Object::ObjectTypeNothing) {
+            GameObject *item = find_object(restored, mode.carried);
+            check(item && !item->picked, test, "restored item is still carried");
+        }
+
+        /* the match goes on, the hash has to follow */
+        restored->update_states(CheckMatch::TickNS);
+        restored->delete_responses();
+        check(restored->get_state_hash() != live_hash, test, "hash does not change with the match");
+    } catch (...) {
+        delete restored;
+        throw;
+    }
+    delete restored;
+
+    std::cout << test << ": npcs=" << npcs << " animations=" << animations << std::endl;
+}
+
+int main(int argc, char *argv[]) {
+    std::ostream& stream = std::cout;
+    int rv = 1;
+
+    init_hpet();
+    try {
+        CheckData::TemporaryDirectory dir;
+        CheckMatch::create_data(dir);
+
+        std::ostringstream log;
+        SubsystemNull subsystem(log, "Goat Attack Checkpoint Check");
+        Resources resources(subsystem, dir.get_path(), Resources::LoadProfileServer);
+        TournamentFactory factory(resources, subsystem, 0);
+
+        for (int i = 0; i < ModeCount; i++) {
+            try {
+                check_mode(resources, factory, Modes[i]);
+            } catch (const Exception& e) {
+                check(false, Modes[i].name, e.what());
+            }
+        }
+
+        stream << (failures ? "checkpoint check failed" : "checkpoint check passed") << std::endl;
+        rv = (failures ? 1 : 0);
+    } catch (const Exception& e) {
+        stream << e.what() << std::endl;
+    }
+
+    return rv;
+}
@@ -0,0 +1,234 @@
+#include "SubsystemNull.hpp"
+#include "Map.hpp"
+#include "MapCache.hpp"
+#include "ZipReader.hpp"
+#include "CheckData.hpp"
+
+#include <iostream>
+#include <sstream>
+#include <cstdio>
+#include <sys/stat.h>
+#include <utime.h>
+
+/* a packaged map is written to the cache and made again from its cached
+   header, both have to be the same map, its tiles are read from the pak
+   on load and its preview comes from the cached thumbnail. a replaced
+   pak is refused. the cache lives in the temporary directory */
+
+static const char *MapName = "maps/check";
+static const int MapWidth = 5;
+static const int MapHeight = 4;
+
+struct Image {
+    const char *name;
+    int width;
+    int height;
+    CheckData::ColorType color_type;
+    int bytes_per_pixel;
+};
+
+static const Image Images[] = {
+    { "wide_rgb", 80, 40, CheckData::ColorTypeRGB, 3 },
+    { "small_rgba", 32, 24, CheckData::ColorTypeRGBA, 4 }
+};
+
+static const int ImageCount = sizeof(Images) / sizeof(Image);
+
+static int failures = 0;
+
+static void check(bool condition, const std::string& test, const std::string& what) {
+    if (!condition) {
+        std::cout << test << ": FAILED: " << what << std::endl;
+        failures++;
+    }
+}
+
+static std::string describe(const char *what, size_t value, size_t expected) {
+    std::ostringstream text;
+    text << what << " " << value << ", expected " << expected;
+
+    return text.str();
+}
+
+static std::string create_map_text(int seed) {
+    std::ostringstream map;
+    map << "name=check\ndescription=map cache check\ntileset=check\nbackground=check\n";
+    map << "width=" << MapWidth << "\nheight=" << MapHeight << "\ngame_play_type=2\n";
+    for (int y = 0; y < MapHeight; y++) {
+        map << "tiles" << y << "=";
+        for (int x = 0; x < MapWidth; x++) {
+            map << (x ? "," : "") << (x + y + seed) % 3 - 1;
+        }
+        map << "\ndecoration" << y << "=";
+        for (int x = 0; x < MapWidth; x++) {
+            map << (x ? "," : "") << -1;
+        }
+        map << "\n";
+    }
+
+    return map.str();
+}
+
+static CheckData::PakEntries create_entries(int seed) {
+    std::string text = create_map_text(seed);
+    CheckData::Bytes png;
+    CheckData::create_png(png, Images[0].width, Images[0].height, Images[0].color_type, false);
+
+    CheckData::PakEntries entries;
+    entries.push_back(CheckData::PakEntry(std::string(MapName) + ".map",
+        CheckData::Bytes(text.begin(), text.end()), true));
+    entries.push_back(CheckData::PakEntry(std::string(MapName) + ".png", png, false));
+
+    return entries;
+}
+
+/* a pak replaced within the same second is told apart by its time */
+static void replace_pak(const std::string& filename, const CheckData::PakEntries& entries) throw (Exception) {
+    struct stat st;
+    if (stat(filename.c_str(), &st)) {
+        throw Exception("Cannot stat " + filename);
+    }
+    CheckData::write_pak(filename, entries);
+    struct utimbuf times;
+    times.actime = st.st_mtime + 10;
+    times.modtime = st.st_mtime + 10;
+    if (utime(filename.c_str(), &times)) {
+        throw Exception("Cannot touch " + filename);
+    }
+}
+
+/* the entry is registered with the directory, so whatever the cache
+   writes there is removed with it */
+static std::string create_cache_filename(CheckData::TemporaryDirectory& dir, const std::string& name) throw (Exception) {
+    std::string cache_filename = dir.get_path() + "/cache/" + name;
+    dir.add_file("cache/" + name + ".map", "");
+    dir.add_file("cache/" + name + ".thumb", "");
+    remove((cache_filename + ".map").c_str());
+    remove((cache_filename + ".thumb").c_str());
+
+    return cache_filename;
+}
+
+static bool same_pixels(const MapCache::Thumbnail& a, const MapCache::Thumbnail& b) {
+    return (a.width == b.width && a.height == b.height &&
+        a.bytes_per_pixel == b.bytes_per_pixel && a.pixels == b.pixels);
+}
+
+static void check_thumbnails(CheckData::TemporaryDirectory& dir) throw (Exception) {
+    for (int i = 0; i < ImageCount; i++) {
+        const Image& image = Images[i];
+        std::string test = std::string("thumbnail_") + image.name;
+        CheckData::Bytes data;
+        CheckData::create_png(data, image.width, image.height, image.color_type, false);
+        dir.add_file(std::string("images/") + image.name + ".png", data);
+        PNG png(dir.get_path() + "/images/" + image.name + ".png");
+
+        MapCache::Thumbnail created;
+        MapCache::create_thumbnail(png, created);
+        int width = (image.width < MapCache::ThumbnailSize ? image.width : MapCache::ThumbnailSize);
+        int height = (image.height < MapCache::ThumbnailSize ? image.height : MapCache::ThumbnailSize);
+        check(created.width == width, test, describe("width", created.width, width));
+        check(created.height == height, test, describe("height", created.height, height));
+        check(created.bytes_per_pixel == image.bytes_per_pixel, test,
+            describe("bytes per pixel", created.bytes_per_pixel, image.bytes_per_pixel));
+
+        std::string cache_filename = create_cache_filename(dir, image.name);
+        MapCache::write_thumbnail(cache_filename, created);
+        MapCache::Thumbnail read;
+        check(MapCache::read_thumbnail(cache_filename, read), test, "thumbnail not read back");
+        check(same_pixels(created, read), test, "thumbnail differs");
+
+        /* whatever is not a thumbnail is not taken */
+        CheckData::write_file(cache_filename + ".thumb", std::string("GTN1 but not a thumbnail"));
+        check(!MapCache::read_thumbnail(cache_filename, read), test, "broken thumbnail read");
+    }
+}
+
+static void check_map(CheckData::TemporaryDirectory& dir) throw (Exception) {
+    std::string test("map");
+    std::ostringstream log;
+    SubsystemNull subsystem(log, "Goat Attack Map Cache Check");
+    std::string pak_filename = dir.get_path() + "/check.pak";
+    std::string cache_filename = create_cache_filename(dir, "check");
+    dir.add_pak("check.pak", create_entries(0));
+
+    std::string hash;
+    Map *full = 0;
+    {
+        SharedZipReader zip(pak_filename);
+        hash = zip.get()->get_hash();
+        full = new Map(subsystem, MapName, zip.get());
+    }
+    Map *cached = 0;
+    try {
+        check(!MapCache::has_header(cache_filename), test, "header before it was written");
+        MapCache::write_header(cache_filename, *full);
+        check(MapCache::has_header(cache_filename), test, "no header written");
+        cached = new Map(subsystem, MapName, pak_filename, hash, cache_filename);
+
+        check(cached->get_entries() == full->get_entries(), test, "cached header differs");
+        check(cached->get_name() == full->get_name(), test, "names differ");
+        check(cached->get_game_play_type() == full->get_game_play_type(), test, "game play types differ");
+
+        /* the tiles come from the pak */
+        cached->load();
+        check(cached->get_width() == MapWidth && cached->get_height() == MapHeight, test, "size differs");
+        int differences = 0;
+        for (int y = 0; y < MapHeight; y++) {
+            for (int x = 0; x < MapWidth; x++) {
+                differences += (cached->get_map_tile(y, x) != full->get_map_tile(y, x) ? 1 : 0);
+            }
+        }
+        check(!differences, test, describe("different tiles", differences, 0));
+
+        /* the preview is cut from the pak once and then read from the cache */
+        check(cached->get_preview() != 0, test, "no preview");
+        MapCache::Thumbnail read;
+        check(MapCache::read_thumbnail(cache_filename, read), test, "no thumbnail cached");
+        MapCache::Thumbnail expected;
+        {
+            SharedZipReader zip(pak_filename);
+            PNG png(std::string(MapName) + ".png", zip.get());
+            MapCache::create_thumbnail(png, expected);
+        }
+        check(same_pixels(read, expected), test, "cached thumbnail differs");
+        delete cached;
+        cached = 0;
+
+        /* a header of another pak does not load */
+        replace_pak(pak_filename, create_entries(1));
+        cached = new Map(subsystem, MapName, pak_filename, hash, cache_filename);
+        bool refused = false;
+        try {
+            cached->load();
+        } catch (const MapException&) {
+            refused = true;
+        }
+        check(refused, test, "tiles of a replaced pak loaded");
+    } catch (...) {
+        delete cached;
+        delete full;
+        throw;
+    }
+    delete cached;
+    delete full;
+}
+
+int main(int argc, char *argv[]) {
+    std::ostream& stream = std::cout;
+    int rv = 1;
+
+    try {
+        CheckData::TemporaryDirectory dir;
+        check_thumbnails(dir);
+        check_map(dir);
+        ZipReader::close_unused();
+
+        stream << (failures ? "map cache check failed" : "map cache check passed") << std::endl;
+        rv = (failures ? 1 : 0);
+    } catch (const Exception& e) {
+        stream << e.what() << std::endl;
+    }
+
+    return rv;
+}
@@ -0,0 +1,158 @@
+#include "ZipReader.hpp"
+#include "CheckData.hpp"
+
+#include <iostream>
+#include <sstream>
+#include <cstring>
+#include <sys/stat.h>
+#include <utime.h>
+
+/* paks are opened once per process and shared, a pak that is replaced
+   on disk, with another size or another modification time, gets a new
+   reader while the users of the old one keep theirs until they let go */
+
+/* the end of the central directory is searched in the last 256 bytes,
+   the entries are long enough for that */
+static const int ContentRepeats = 100;
+
+static int failures = 0;
+
+static void check(bool condition, const std::string& test, const std::string& what) {
+    if (!condition) {
+        std::cout << test << ": FAILED: " << what << std::endl;
+        failures++;
+    }
+}
+
+static std::string create_content(const char *word) {
+    std::string text;
+    for (int i = 0; i < ContentRepeats; i++) {
+        text += word;
+    }
+
+    return text;
+}
+
+static CheckData::PakEntries create_entries(const char *word, bool extra) {
+    CheckData::PakEntries entries;
+    std::string text = create_content(word);
+    entries.push_back(CheckData::PakEntry("maps/check.map",
+        CheckData::Bytes(text.begin(), text.end()), false));
+    if (extra) {
+        entries.push_back(CheckData::PakEntry("maps/extra.map",
+            CheckData::Bytes(text.begin(), text.end()), false));
+    }
+
+    return entries;
+}
+
+static std::string extract(ZipReader *zip, const std::string& filename) {
+    size_t sz = 0;
+    const char *data = zip->extract(filename, &sz);
+    std::string text(data, sz);
+    ZipReader::destroy(data);
+
+    return text;
+}
+
+static time_t get_mtime(const std::string& filename) throw (Exception) {
+    struct stat st;
+    if (stat(filename.c_str(), &st)) {
+        throw Exception("Cannot stat " + filename);
+    }
+
+    return st.st_mtime;
+}
+
+static void set_mtime(const std::string& filename, time_t mtime) throw (Exception) {
+    struct utimbuf times;
+    times.actime = mtime;
+    times.modtime = mtime;
+    if (utime(filename.c_str(), &times)) {
+        throw Exception("Cannot touch " + filename);
+    }
+}
+
+static void check_shared(const std::string& filename) throw (Exception) {
+    std::string test("shared");
+    ZipReader *first = ZipReader::open(filename);
+    ZipReader *second = ZipReader::open(filename);
+    check(first == second, test, "two readers for the same pak");
+    {
+        SharedZipReader shared(filename);
+        check(shared.get() == first, test, "scoped reader is not shared");
+    }
+    std::string hash = first->get_hash();
+    ZipReader::release(second);
+    ZipReader::release(first);
+
+    /* unused readers stay open for the next user */
+    ZipReader *again = ZipReader::open(filename);
+    check(again == first, test, "released reader was closed");
+    ZipReader::release(again);
+
+    /* a reopened pak knows its hash without reading it again */
+    ZipReader::close_unused();
+    SharedZipReader reopened(filename);
+    check(reopened.get()->get_hash() == hash, test, "hash of the reopened pak differs");
+    check(extract(reopened.get(), "maps/check.map") == create_content("goat"), test, "entry differs");
+}
+
+static void check_size_change(const std::string& filename) throw (Exception) {
+    std::string test("size");
+    CheckData::write_pak(filename, create_entries("goat", false));
+    time_t mtime = get_mtime(filename);
+
+    SharedZipReader old_zip(filename);
+    std::string old_hash = old_zip.get()->get_hash();
+
+    /* same modification time, another size */
+    CheckData::write_pak(filename, create_entries("goat", true));
+    set_mtime(filename, mtime);
+    SharedZipReader new_zip(filename);
+    check(new_zip.get() != old_zip.get(), test, "replaced pak is still shared");
+    check(new_zip.get()->file_exists("maps/extra.map"), test, "new entry missing");
+    check(!old_zip.get()->file_exists("maps/extra.map"), test, "old reader sees the new entry");
+    check(new_zip.get()->get_hash() != old_hash, test, "hash of the replaced pak did not change");
+}
+
+static void check_mtime_change(const std::string& filename) throw (Exception) {
+    std::string test("mtime");
+    CheckData::write_pak(filename, create_entries("goat", false));
+    time_t mtime = get_mtime(filename);
+
+    SharedZipReader old_zip(filename);
+    std::string old_hash = old_zip.get()->get_hash();
+
+    /* same size, another modification time */
+    CheckData::write_pak(filename, create_entries("kids", false));
+    set_mtime(filename, mtime + 10);
+    SharedZipReader new_zip(filename);
+    check(new_zip.get() != old_zip.get(), test, "replaced pak is still shared");
+    check(new_zip.get()->get_size() == old_zip.get()->get_size(), test, "sizes differ");
+    check(extract(new_zip.get(), "maps/check.map") == create_content("kids"), test, "new reader reads the old content");
+    check(new_zip.get()->get_hash() != old_hash, test, "hash of the replaced pak did not change");
+}
+
+int main(int argc, char *argv[]) {
+    std::ostream& stream = std::cout;
+    int rv = 1;
+
+    try {
+        CheckData::TemporaryDirectory dir;
+        dir.add_pak("check.pak", create_entries("goat", false));
+        std::string filename = dir.get_path() + "/check.pak";
+
+        check_shared(filename);
+        check_size_change(filename);
+        check_mtime_change(filename);
+        ZipReader::close_unused();
+
+        stream << (failures ? "pak check failed" : "pak check passed") << std::endl;
+        rv = (failures ? 1 : 0);
+    } catch (const Exception& e) {
+        stream << e.what() << std::endl;
+    }
+
+    return rv;
+}
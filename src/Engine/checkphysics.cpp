@@ -0,0 +1,488 @@
+#include "SubsystemNull.hpp"
+#include "TournamentFactory.hpp"
+#include "Tournament.hpp"
+#include "CheckData.hpp"
+#include "Timing.hpp"
+
+#include <iostream>
+#include <sstream>
+#include <cmath>
+#include <cstdio>
+
+/* tunnelling, corner and jump arc checks of the swept tile collisions,
+   on synthetic maps with 16 and 32 pixel tiles */
+
+static const int MapWidth = 24;
+static const int MapHeight = 16;
+static const int CrateSize = 16;
+static const double Epsilon2 = 0.001f;
+
+static const ns_t SecondNS = 1000000000;
+static const ns_t ReferenceTickNS = 10000000;
+static const ns_t TickNS[] = { 16666667, 20000000, 33333333 };
+static const int TickRates = sizeof(TickNS) / sizeof(ns_t);
+
+/* tile rectangles of each map, every map has a floor in its last row */
+static const char *OpenMap[] = { 0 };
+static const char *WallMap[] = { "16,10,16,14", 0 };
+static const char *CornerMap[] = { "12,6,12,6", 0 };
+static const char *PlatformMap[] = { "-4,11,19,11", 0 };
+static const char *CeilingMap[] = { "4,12,19,12", 0 };
+
+struct MapLayout {
+    const char *name;
+    const char **blocks;
+};
+
+static const MapLayout MapLayouts[] = {
+    { "open", OpenMap },
+    { "wall", WallMap },
+    { "corner", CornerMap },
+    { "platform", PlatformMap },
+    { "ceiling", CeilingMap }
+};
+
+static const int MapLayoutCount = sizeof(MapLayouts) / sizeof(MapLayout);
+
+static int failures = 0;
+
+static std::string map_name(const char *layout, int tile_size) {
+    std::ostringstream name;
+    name << layout << tile_size;
+
+    return name.str();
+}
+
+static void check(bool condition, const std::string& test, const std::string& what) {
+    if (!condition) {
+        std::cout << test << ": FAILED: " << what << std::endl;
+        failures++;
+    }
+}
+
+static void add_map(CheckData::TemporaryDirectory& dir, const MapLayout& layout, int tile_size) {
+    int tiles[MapHeight][MapWidth];
+    for (int y = 0; y < MapHeight; y++) {
+        for (int x = 0; x < MapWidth; x++) {
+            tiles[y][x] = (y == MapHeight - 1 ? 0 : -1);
+        }
+    }
+
+    /* blocks are "x0,y0,x1,y1", a leading '-' for a falling only platform */
+    for (const char **block = layout.blocks; *block; block++) {
+        const char *desc = *block;
+        int index = 0;
+        if (*desc == '-') {
+            index = 1;
+            desc++;
+        }
+        int x0, y0, x1, y1;
+        sscanf(desc, "%d,%d,%d,%d", &x0, &y0, &x1, &y1);
+        for (int y = y0; y <= y1; y++) {
+            for (int x = x0; x <= x1; x++) {
+                tiles[y][x] = index;
+            }
+        }
+    }
+
+    std::string name = map_name(layout.name, tile_size);
+    std::ostringstream map;
+    map << "name=" << name << "\ntileset=check" << tile_size << "\nbackground=check\n";
+    map << "width=" << MapWidth << "\nheight=" << MapHeight << "\ngame_play_type=0\n";
+    map << "objects=1\nobject_name0=spawn\nobject_x0=1\nobject_y0=1\n";
+    for (int y = 0; y < MapHeight; y++) {
+        map << "tiles" << y << "=";
+        for (int x = 0; x < MapWidth; x++) {
+            map << (x ? "," : "") << tiles[y][x];
+        }
+        map << "\ndecoration" << y << "=";
+        for (int x = 0; x < MapWidth; x++) {
+            map << (x ? "," : "") << -1;
+        }
+        map << "\n";
+    }
+    dir.add_file("maps/" + name + ".map", map.str());
+}
+
+static void create_data(CheckData::TemporaryDirectory& dir) {
+    CheckData::create_game_data(dir);
+
+    /* a blocking and a falling only tile in every tileset */
+    for (int tile_size = 16; tile_size <= 32; tile_size *= 2) {
+        std::ostringstream tileset;
+        tileset << "name=check" << tile_size << "\nwidth=" << tile_size << "\nheight=" << tile_size
+            << "\ntiletype0=" << Tile::TileTypeBlocking << "\ntiletype1=" << Tile::TileTypeFallingOnlyBlocking << "\n";
+        std::ostringstream name;
+        name << "tilesets/check" << tile_size;
+        dir.add_file(name.str() + ".tileset", tileset.str());
+        dir.add_png(name.str() + ".png", tile_size, tile_size * 2);
+
+        for (int i = 0; i < MapLayoutCount; i++) {
+            add_map(dir, MapLayouts[i], tile_size);
+        }
+    }
+
+    std::ostringstream crate;
+    crate << "name=crate\ntype=" << Object::ObjectTypeNothing << "\nwidth=" << CrateSize << "\nheight="
+        << CrateSize << "\nphysics=1\ncolbox_x=0\ncolbox_y=0\ncolbox_width=" << CrateSize
+        << "\ncolbox_height=" << CrateSize << "\n";
+    dir.add_file("objects/crate.object", crate.str());
+    dir.add_png("objects/crate.png", CrateSize, CrateSize);
+}
+
+/* one tournament on a synthetic map with a player and a crate */
+class Scene {
+private:
+    Scene(const Scene&);
+    Scene& operator=(const Scene&);
+
+public:
+    Scene(Resources& resources, TournamentFactory& factory, const char *layout, int tile_size)
+        : tile_size(tile_size), tournament(0), player(0)
+    {
+        player = new Player(resources, 0, 1, "goat", "goat");
+        players.push_back(player);
+        try {
+            MapConfiguration config(GamePlayTypeDM, map_name(layout, tile_size), 10, 0);
+            tournament = factory.create_tournament(config, true, false, players, 0);
+            tournament->player_added(player);
+            player->client_synced = true;
+            tournament->player_joins(player, 0);
+            tournament->delete_responses();
+        } catch (...) {
+            delete player;
+            throw;
+        }
+
+        /* kept out of the way until a test places it */
+        player->state.server_state.flags = PlayerServerFlagDead;
+        player->bot = true;
+        GameObject *obj = tournament->get_game_objects().create();
+        obj->object = resources.get_object("crate");
+        obj->picked = true;
+        crate = tournament->get_game_objects().get_handle(obj);
+    }
+
+    ~Scene() {
+        delete tournament;
+        delete player;
+    }
+
+    /* x in pixels, y at the feet */
+    void place_player(double x, double y) {
+        player->state.server_state.flags = 0;
+        player->zero();
+        player->spawn(static_cast<int>(x), static_cast<int>(y));
+        player->state.client_server_state.x = x;
+        player->state.client_server_state.y = y;
+    }
+
+    void place_crate(double left, double bottom, double accel_x, double accel_y) {
+        GameObject *crate = get_crate();
+        crate->picked = false;
+        crate->state.x = left;
+        crate->state.y = bottom - CrateSize;
+        crate->state.accel_x = accel_x;
+        crate->state.accel_y = accel_y;
+    }
+
+    void run(ns_t tick_ns, keystates_t keys) {
+        player->state.client_server_state.key_states = keys;
+        tournament->update_states(tick_ns);
+        tournament->delete_responses();
+    }
+
+    void run_for(ns_t tick_ns, keystates_t keys, ns_t duration) {
+        for (ns_t t = 0; t < duration; t += tick_ns) {
+            run(tick_ns, keys);
+        }
+    }
+
+    /* the collision box edges */
+    double player_left() const { return player->state.client_server_state.x + colbox().x; }
+    double player_right() const { return player_left() + colbox().width; }
+    double player_top() const { return player_bottom() - colbox().height; }
+    double player_bottom() const { return player->state.client_server_state.y - colbox().y; }
+    double crate_left() const { return get_crate()->state.x; }
+    double crate_right() const { return get_crate()->state.x + CrateSize; }
+    double crate_top() const { return get_crate()->state.y; }
+    double crate_bottom() const { return get_crate()->state.y + CrateSize; }
+
+    bool player_falling() const {
+        return ((player->state.client_state.flags & PlayerClientFlagFalling) != 0);
+    }
+
+    double floor_top() const { return (MapHeight - 1) * tile_size; }
+
+    int tile_size;
+    Tournament *tournament;
+    Player *player;
+    Tournament::GameObjects::Handle crate;
+
+private:
+    Players players;
+
+    const CollisionBox& colbox() const { return player->get_characterset()->get_colbox(); }
+    GameObject *get_crate() const { return tournament->get_game_objects().get(crate); }
+};
+
+struct JumpArc {
+    JumpArc() : apex(0.0f), distance(0.0f) { }
+
+    double apex;
+    double distance;
+};
+
+static std::string describe(const std::string& what, double value) {
+    std::ostringstream s;
+    s << what << " (" << value << ")";
+
+    return s.str();
+}
+
+static std::string test_name(const char *name, int tile_size) {
+    std::ostringstream s;
+    s << name << tile_size;
+
+    return s.str();
+}
+
+/* a crate shoved faster than a tile per step stops at a one tile wall */
+static void check_crate_wall(Resources& resources, TournamentFactory& factory, int tile_size) {
+    std::string test = test_name("crate_wall", tile_size);
+    Scene scene(resources, factory, "wall", tile_size);
+    double wall = 16 * tile_size;
+
+    scene.place_crate(2 * tile_size, scene.floor_top(), 3.0f * tile_size, 0.0f);
+    bool passed = false;
+    for (int i = 0; i < 50; i++) {
+        scene.run(20000000, 0);
+        if (scene.crate_right() > wall + Epsilon2) {
+            passed = true;
+        }
+    }
+    check(!passed, test, describe("crate went through the wall", scene.crate_left()));
+    check(std::fabs(scene.crate_right() - wall) < Epsilon2, test, describe("crate not flush at the wall", scene.crate_right()));
+}
+
+/* a crate grazing the corner of a single tile within one step does not pass it */
+static void check_crate_corner(Resources& resources, TournamentFactory& factory, int tile_size) {
+    std::string test = test_name("crate_corner", tile_size);
+    double cell_left = 12 * tile_size;
+    double cell_top = 6 * tile_size;
+    double cell_right = cell_left + tile_size;
+    double cell_bottom = cell_top + tile_size;
+    double speed = tile_size + CrateSize;
+
+    /* falling down right onto the top left corner */
+    {
+        Scene scene(resources, factory, "corner", tile_size);
+        scene.place_crate(cell_left - 4 - CrateSize, cell_top - 2, speed, YMaxAccel);
+        scene.run(20000000, 0);
+        check(scene.crate_bottom() <= cell_top + Epsilon2 || scene.crate_right() <= cell_left + Epsilon2,
+            test, describe("crate passed the top left corner", scene.crate_left()));
+    }
+
+    /* entering the side first stops at the side */
+    {
+        Scene scene(resources, factory, "corner", tile_size);
+        scene.place_crate(cell_left - 1 - CrateSize, cell_top + 6, speed, YMaxAccel);
+        scene.run(20000000, 0);
+        check(scene.crate_right() <= cell_left + Epsilon2, test,
+            describe("crate passed the left side", scene.crate_left()));
+    }
+
+    /* rising up left into the bottom right corner */
+    {
+        Scene scene(resources, factory, "corner", tile_size);
+        scene.place_crate(cell_right + 4, cell_bottom + 2 + CrateSize, -speed, -YMaxAccel);
+        scene.run(20000000, 0);
+        check(scene.crate_top() >= cell_bottom - Epsilon2 || scene.crate_left() >= cell_right - Epsilon2,
+            test, describe("crate passed the bottom right corner", scene.crate_left()));
+    }
+}
+
+/* a crate thrown up passes a falling only platform and lands on it */
+static void check_crate_platform(Resources& resources, TournamentFactory& factory, int tile_size) {
+    std::string test = test_name("crate_platform", tile_size);
+    Scene scene(resources, factory, "platform", tile_size);
+    double platform = 11 * tile_size;
+
+    scene.place_crate(10 * tile_size, scene.floor_top(), 0.0f, -sqrt(2.0f * YAccelGravity * 5 * tile_size));
+    double highest = scene.crate_bottom();
+    for (int i = 0; i < 150; i++) {
+        scene.run(20000000, 0);
+        highest = std::min(highest, scene.crate_bottom());
+    }
+    check(highest < platform, test, describe("crate did not pass the platform", highest));
+    check(std::fabs(scene.crate_bottom() - platform) < Epsilon2, test,
+        describe("crate not resting on the platform", scene.crate_bottom()));
+}
+
+/* walking over a floor of many tiles never snags at their seams */
+static void check_player_walk(Resources& resources, TournamentFactory& factory, int tile_size) {
+    std::string test = test_name("player_walk", tile_size);
+    Scene scene(resources, factory, "open", tile_size);
+
+    scene.place_player(2 * tile_size, scene.floor_top());
+    scene.run_for(TickNS[0], 0, 500000000);
+    double start = scene.player_left();
+    bool snagged = false;
+    bool dropped = false;
+    bool full_speed = false;
+    for (int i = 0; i < 120; i++) {
+        scene.run(TickNS[0], PlayerKeyStateRight);
+        double accel_x = scene.player->state.client_server_state.accel_x;
+        if (accel_x >= XMaxAccel - Epsilon2) {
+            full_speed = true;
+        } else if (full_speed) {
+            snagged = true;
+        }
+        if (std::fabs(scene.player_bottom() - scene.floor_top()) > Epsilon2) {
+            dropped = true;
+        }
+    }
+    check(full_speed && !snagged, test, "player snagged on the floor");
+    check(!dropped, test, "player left the floor");
+    check(scene.player_left() - start > 10 * tile_size, test,
+        describe("player did not get far", scene.player_left() - start));
+}
+
+/* running into a wall stops flush at it */
+static void check_player_wall(Resources& resources, TournamentFactory& factory, int tile_size) {
+    std::string test = test_name("player_wall", tile_size);
+    Scene scene(resources, factory, "wall", tile_size);
+    double wall = 16 * tile_size;
+
+    scene.place_player(12 * tile_size, scene.floor_top());
+    bool passed = false;
+    for (int i = 0; i < 180; i++) {
+        scene.run(TickNS[1], PlayerKeyStateRight);
+        if (scene.player_right() > wall + Epsilon2) {
+            passed = true;
+        }
+    }
+    check(!passed, test, "player went into the wall");
+    check(std::fabs(scene.player_right() - wall) < Epsilon2, test,
+        describe("player not flush at the wall", scene.player_right()));
+}
+
+/* a falling only platform holds, down drops through it */
+static void check_player_platform(Resources& resources, TournamentFactory& factory, int tile_size) {
+    std::string test = test_name("player_platform", tile_size);
+    Scene scene(resources, factory, "platform", tile_size);
+    double platform = 11 * tile_size;
+
+    scene.place_player(10 * tile_size, platform - tile_size);
+    scene.run_for(TickNS[0], 0, 1000000000);
+    check(std::fabs(scene.player_bottom() - platform) < Epsilon2, test,
+        describe("player not standing on the platform", scene.player_bottom()));
+
+    scene.run_for(TickNS[0], PlayerKeyStateDown, 1000000000);
+    check(std::fabs(scene.player_bottom() - scene.floor_top()) < Epsilon2, test,
+        describe("player did not drop to the floor", scene.player_bottom()));
+}
+
+/* jumping under a low ceiling bumps at it */
+static void check_player_ceiling(Resources& resources, TournamentFactory& factory, int tile_size) {
+    std::string test = test_name("player_ceiling", tile_size);
+    Scene scene(resources, factory, "ceiling", tile_size);
+    double ceiling = 13 * tile_size;
+
+    scene.place_player(10 * tile_size, scene.floor_top());
+    scene.run_for(TickNS[1], 0, 500000000);
+    double highest = scene.player_top();
+    for (int i = 0; i < 50; i++) {
+        scene.run(TickNS[1], PlayerKeyStateJump);
+        highest = std::min(highest, scene.player_top());
+    }
+    check(highest < scene.floor_top() - scene.tile_size / 2, test, "player did not jump");
+    check(highest >= ceiling - Epsilon2, test, describe("player went into the ceiling", highest));
+    check(std::fabs(scene.player_bottom() - scene.floor_top()) < Epsilon2, test,
+        describe("player did not land", scene.player_bottom()));
+}
+
+/* a held jump to the right from standing, apex and distance when landing */
+static JumpArc measure_jump(Resources& resources, TournamentFactory& factory, int tile_size,
+    ns_t tick_ns)
+{
+    Scene scene(resources, factory, "open", tile_size);
+    JumpArc arc;
+
+    scene.place_player(2 * tile_size, scene.floor_top());
+    scene.run_for(tick_ns, 0, 500000000);
+    double x = scene.player_left();
+    double y = scene.player_bottom();
+    bool airborne = false;
+    for (ns_t t = 0; t < 3 * SecondNS; t += tick_ns) {
+        scene.run(tick_ns, PlayerKeyStateJump | PlayerKeyStateRight);
+        arc.apex = std::max(arc.apex, y - scene.player_bottom());
+        if (scene.player_falling()) {
+            airborne = true;
+        } else if (airborne) {
+            arc.distance = scene.player_left() - x;
+            break;
+        }
+    }
+
+    return arc;
+}
+
+/* IntegrateMaxTimeStep: the jump arcs with longer steps than the 10 ms
+   reference reach the same tiles, apexes differ by less than 2 pixels
+   and the landings by less than the way a player runs in one tick */
+static void check_jump_arcs(Resources& resources, TournamentFactory& factory, int tile_size) {
+    std::string test = test_name("jump_arc", tile_size);
+    JumpArc reference = measure_jump(resources, factory, tile_size, ReferenceTickNS);
+    std::cout << test << ": " << ((SecondNS + ReferenceTickNS / 2) / ReferenceTickNS) << " Hz apex=" << reference.apex
+        << " distance=" << reference.distance << std::endl;
+    check(reference.apex > tile_size && reference.distance > tile_size, test, "reference jump failed");
+
+    for (int i = 0; i < TickRates; i++) {
+        JumpArc arc = measure_jump(resources, factory, tile_size, TickNS[i]);
+        std::cout << test << ": " << ((SecondNS + TickNS[i] / 2) / TickNS[i]) << " Hz apex=" << arc.apex
+            << " distance=" << arc.distance << std::endl;
+        double tick_way = XMaxAccel * TickNS[i] / ReferenceTickNS;
+        check(std::fabs(arc.apex - reference.apex) < 2.0f, test, describe("apex differs", arc.apex));
+        check(std::fabs(arc.distance - reference.distance) < tick_way, test,
+            describe("distance differs", arc.distance));
+        check(static_cast<int>(arc.apex / tile_size) == static_cast<int>(reference.apex / tile_size),
+            test, "apex reaches other tiles");
+        check(static_cast<int>(arc.distance / tile_size) == static_cast<int>(reference.distance / tile_size),
+            test, "distance reaches other tiles");
+    }
+}
+
+int main(int argc, char *argv[]) {
+    std::ostream& stream = std::cout;
+    int rv = 1;
+
+    init_hpet();
+    try {
+        CheckData::TemporaryDirectory dir;
+        create_data(dir);
+
+        std::ostringstream log;
+        SubsystemNull subsystem(log, "Goat Attack Physics Check");
+        Resources resources(subsystem, dir.get_path(), Resources::LoadProfileServer);
+        TournamentFactory factory(resources, subsystem, 0);
+
+        for (int tile_size = 16; tile_size <= 32; tile_size *= 2) {
+            check_crate_wall(resources, factory, tile_size);
+            check_crate_corner(resources, factory, tile_size);
+            check_crate_platform(resources, factory, tile_size);
+            check_player_walk(resources, factory, tile_size);
+            check_player_wall(resources, factory, tile_size);
+            check_player_platform(resources, factory, tile_size);
+            check_player_ceiling(resources, factory, tile_size);
+            check_jump_arcs(resources, factory, tile_size);
+        }
+
+        stream << (failures ? "physics check failed" : "physics check passed") << std::endl;
+        rv = (failures ? 1 : 0);
+    } catch (const Exception& e) {
+        stream << e.what() << std::endl;
+    }
+
+    return rv;
+}
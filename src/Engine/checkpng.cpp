@@ -0,0 +1,143 @@
+#include "SubsystemNull.hpp"
+#include "Tileset.hpp"
+#include "PNG.hpp"
+#include "ZipReader.hpp"
+#include "CheckData.hpp"
+
+#include <iostream>
+#include <sstream>
+
+/* the header only path of the dedicated server against the full decode,
+   for loose files and for stored and deflated pak entries */
+
+static const int TileSize = 16;
+
+struct Image {
+    const char *name;
+    int width;
+    int height;
+    CheckData::ColorType color_type;
+    bool transparent;
+};
+
+static const Image Images[] = {
+    { "rgb", 64, 32, CheckData::ColorTypeRGB, false },
+    { "rgba", 48, 32, CheckData::ColorTypeRGBA, false },
+    { "palette", 32, 48, CheckData::ColorTypePalette, false },
+    { "palette_trns", 40, 24, CheckData::ColorTypePalette, true }
+};
+
+static const int ImageCount = sizeof(Images) / sizeof(Image);
+
+static int failures = 0;
+
+static void check(bool condition, const std::string& test, const std::string& what) {
+    if (!condition) {
+        std::cout << test << ": FAILED: " << what << std::endl;
+        failures++;
+    }
+}
+
+static std::string describe(const char *what, size_t value, size_t expected) {
+    std::ostringstream text;
+    text << what << " " << value << ", expected " << expected;
+
+    return text.str();
+}
+
+static CheckData::PakEntries create_entries(bool deflated) {
+    CheckData::PakEntries entries;
+    for (int i = 0; i < ImageCount; i++) {
+        const Image& image = Images[i];
+        std::string name = std::string("tilesets/") + image.name;
+        std::ostringstream tileset;
+        tileset << "name=" << image.name << "\nwidth=" << TileSize << "\nheight=" << TileSize << "\n";
+        std::string text = tileset.str();
+        CheckData::Bytes png;
+        CheckData::create_png(png, image.width, image.height, image.color_type, image.transparent);
+        entries.push_back(CheckData::PakEntry(name + ".tileset", CheckData::Bytes(text.begin(), text.end()), deflated));
+        entries.push_back(CheckData::PakEntry(name + ".png", png, deflated));
+    }
+
+    return entries;
+}
+
+static void check_image(const std::string& test, const Image& image, const std::string& filename, ZipReader *zip) {
+    PNG header(filename, zip, true);
+    PNG full(filename, zip, false);
+    PNG::ColorFormat expected = ((image.color_type == CheckData::ColorTypeRGB ||
+        (image.color_type == CheckData::ColorTypePalette && !image.transparent)) ?
+        PNG::ColorFormatRGB : PNG::ColorFormatRGBA);
+
+    check(full.get_color_format() == expected, test, "full decode has another color format");
+    check(header.get_color_format() == full.get_color_format(), test, "color formats differ");
+    check(header.get_width() == full.get_width(), test, describe("width", header.get_width(), full.get_width()));
+    check(header.get_height() == full.get_height(), test, describe("height", header.get_height(), full.get_height()));
+    check(header.get_bit_depth() == full.get_bit_depth(), test,
+        describe("bit depth", header.get_bit_depth(), full.get_bit_depth()));
+    check(!header.get_pic() && full.get_pic(), test, "pictures of the wrong path");
+}
+
+static void check_tiles(const std::string& test, const std::string& filename, ZipReader *zip) {
+    std::ostringstream log;
+    SubsystemNull header_subsystem(log, "Goat Attack PNG Check");
+    SubsystemNull full_subsystem(log, "Goat Attack PNG Check");
+    full_subsystem.set_keep_pictures(true);
+
+    Tileset header(header_subsystem, filename, zip);
+    Tileset full(full_subsystem, filename, zip);
+    check(header.get_tile_count() == full.get_tile_count(), test,
+        describe("tiles", header.get_tile_count(), full.get_tile_count()));
+    check(full.get_tile_count() > 1, test, "no tiles");
+    for (size_t i = 0; i < header.get_tile_count() && i < full.get_tile_count(); i++) {
+        size_t header_pictures = header.get_tile(static_cast<int>(i))->get_tilegraphic()->get_tile_count();
+        size_t full_pictures = full.get_tile(static_cast<int>(i))->get_tilegraphic()->get_tile_count();
+        check(header_pictures == full_pictures, test, describe("pictures", header_pictures, full_pictures));
+    }
+}
+
+static void check_source(const std::string& source, const std::string& prefix, ZipReader *zip) {
+    for (int i = 0; i < ImageCount; i++) {
+        const Image& image = Images[i];
+        std::string test = source + "_" + image.name;
+        std::string filename = prefix + "tilesets/" + image.name;
+        try {
+            check_image(test, image, filename + ".png", zip);
+            check_tiles(test, filename, zip);
+        } catch (const Exception& e) {
+            check(false, test, e.what());
+        }
+    }
+}
+
+int main(int argc, char *argv[]) {
+    std::ostream& stream = std::cout;
+    int rv = 1;
+
+    try {
+        CheckData::TemporaryDirectory dir;
+        dir.add_pak("stored.pak", create_entries(false));
+        dir.add_pak("deflated.pak", create_entries(true));
+        CheckData::PakEntries files = create_entries(false);
+        for (CheckData::PakEntries::iterator it = files.begin(); it != files.end(); it++) {
+            dir.add_file(it->name, it->data);
+        }
+
+        check_source("file", dir.get_path() + "/", 0);
+        {
+            SharedZipReader zip(dir.get_path() + "/stored.pak");
+            check_source("stored", "", zip.get());
+        }
+        {
+            SharedZipReader zip(dir.get_path() + "/deflated.pak");
+            check_source("deflated", "", zip.get());
+        }
+
+        stream << (failures ? "png check failed" : "png check passed") << std::endl;
+        rv = (failures ? 1 : 0);
+    } catch (const Exception& e) {
+        stream << e.what() << std::endl;
+    }
+
+    return rv;
+}
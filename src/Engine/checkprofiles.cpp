@@ -0,0 +1,125 @@
+#include "SubsystemNull.hpp"
+#include "Resources.hpp"
+#include "CheckData.hpp"
+
+#include <iostream>
+#include <sstream>
+
+/* the same data loaded with each load profile: the client loads sounds
+   and music with their audio, the server keeps stubs of the sounds and
+   only the names of the music, the editor only the names of both.
+   animations refer to their sound in every profile that has one */
+
+static const char *SoundName = "jump";
+static const char *MusicName = "theme";
+static const char *AnimationName = "jump_dust";
+
+enum SoundPolicy {
+    SoundPolicyLoad = 0,
+    SoundPolicyStub,
+    SoundPolicyIndex
+};
+
+struct Profile {
+    const char *name;
+    Resources::LoadProfile profile;
+    SoundPolicy sounds;
+    bool music;
+};
+
+static const Profile Profiles[] = {
+    { "client", Resources::LoadProfileClient, SoundPolicyLoad, true },
+    { "server", Resources::LoadProfileServer, SoundPolicyStub, false },
+    { "editor", Resources::LoadProfileEditor, SoundPolicyIndex, false }
+};
+
+static const int ProfileCount = sizeof(Profiles) / sizeof(Profile);
+
+static int failures = 0;
+
+static void check(bool condition, const std::string& test, const std::string& what) {
+    if (!condition) {
+        std::cout << test << ": FAILED: " << what << std::endl;
+        failures++;
+    }
+}
+
+static void create_data(CheckData::TemporaryDirectory& dir) throw (CheckDataException) {
+    CheckData::create_game_data(dir);
+
+    /* the audio is never decoded by the null subsystem */
+    dir.add_file(std::string("sounds/") + SoundName + ".sound", std::string("name=") + SoundName + "\n");
+    dir.add_file(std::string("sounds/") + SoundName + ".ogg", "not audio");
+    dir.add_file(std::string("music/") + MusicName + ".music", std::string("name=") + MusicName + "\n");
+    dir.add_file(std::string("music/") + MusicName + ".ogg", "not audio");
+
+    dir.add_file(std::string("animations/") + AnimationName + ".animation", std::string("name=") + AnimationName +
+        "\nwidth=16\nheight=16\nspeed=10\nsound_name=" + SoundName + "\n");
+    dir.add_png(std::string("animations/") + AnimationName + ".png", 16, 16);
+}
+
+static void check_profile(const std::string& path, const Profile& profile) throw (Exception) {
+    std::string test(profile.name);
+    std::ostringstream log;
+    SubsystemNull subsystem(log, "Goat Attack Profile Check");
+    Resources resources(subsystem, path, profile.profile);
+
+    Sound *sound = 0;
+    try {
+        sound = resources.get_sound(SoundName);
+    } catch (const ResourcesException&) {
+        /* indexed */
+    }
+    switch (profile.sounds) {
+        case SoundPolicyLoad:
+            check(sound && sound->get_audio(), test, "sound without audio");
+            break;
+
+        case SoundPolicyStub:
+            check(sound && !sound->get_audio(), test, "sound is not a stub");
+            break;
+
+        case SoundPolicyIndex:
+            check(!sound && resources.get_sounds().empty(), test, "sound is not indexed");
+            break;
+    }
+
+    bool music = false;
+    try {
+        resources.get_music(MusicName);
+        music = true;
+    } catch (const ResourcesException&) {
+        /* indexed */
+    }
+    check(music == profile.music, test, (music ? "music loaded" : "music not loaded"));
+    check(music || resources.get_musics().empty(), test, "music objects left");
+
+    /* indexed sounds are only checked for their names */
+    Animation *animation = resources.get_animation(AnimationName);
+    check(animation->get_sound() == sound, test, "animation has another sound");
+}
+
+int main(int argc, char *argv[]) {
+    std::ostream& stream = std::cout;
+    int rv = 1;
+
+    try {
+        CheckData::TemporaryDirectory dir;
+        create_data(dir);
+
+        for (int i = 0; i < ProfileCount; i++) {
+            try {
+                check_profile(dir.get_path(), Profiles[i]);
+            } catch (const Exception& e) {
+                check(false, Profiles[i].name, e.what());
+            }
+        }
+
+        stream << (failures ? "profile check failed" : "profile check passed") << std::endl;
+        rv = (failures ? 1 : 0);
+    } catch (const Exception& e) {
+        stream << e.what() << std::endl;
+    }
+
+    return rv;
+}
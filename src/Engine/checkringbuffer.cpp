@@ -0,0 +1,197 @@
+#include "RingBuffer.hpp"
+#include "Thread.hpp"
+
+#include <iostream>
+#include <sstream>
+#include <cstring>
+#include <stdint.h>
+
+/* positions that wrap around the end of the ring, writes that do not
+   fit and are refused as a whole, and one producer against one consumer
+   thread that drops what does not fit, like the server logger does */
+
+static const size_t SmallRing = 16;
+static const size_t ThreadRing = 64;
+static const uint32_t Records = 20000;
+static const int WriteAttempts = 100;
+
+static int failures = 0;
+
+static void check(bool condition, const std::string& test, const std::string& what) {
+    if (!condition) {
+        std::cout << test << ": FAILED: " << what << std::endl;
+        failures++;
+    }
+}
+
+static std::string describe(const char *what, size_t value, size_t expected) {
+    std::ostringstream text;
+    text << what << " " << value << ", expected " << expected;
+
+    return text.str();
+}
+
+static void fill(unsigned char *data, size_t len, unsigned char first) {
+    for (size_t i = 0; i < len; i++) {
+        data[i] = static_cast<unsigned char>(first + i);
+    }
+}
+
+static void check_size() {
+    RingBuffer ring(100);
+    check(ring.get_size() == 128, "size", describe("size", ring.get_size(), 128));
+    check(ring.get_used() == 0, "size", describe("used", ring.get_used(), 0));
+}
+
+static void check_wrap() {
+    std::string test("wrap");
+    RingBuffer ring(SmallRing);
+    unsigned char in[SmallRing];
+    unsigned char out[SmallRing];
+
+    /* moves both positions close to the end */
+    fill(in, 10, 0);
+    check(ring.write(in, 10), test, "first write refused");
+    check(ring.read(out, 10), test, "first read failed");
+
+    /* twelve bytes, six at the end and six at the start */
+    fill(in, 12, 100);
+    check(ring.write(in, 12), test, "wrapping write refused");
+    check(ring.get_used() == 12, test, describe("used", ring.get_used(), 12));
+    memset(out, 0, sizeof out);
+    check(ring.peek(out, 12) && !memcmp(in, out, 12), test, "peek differs");
+    check(ring.get_used() == 12, test, "peek consumed");
+    memset(out, 0, sizeof out);
+    check(ring.read(out, 12) && !memcmp(in, out, 12), test, "read differs");
+    check(ring.get_used() == 0, test, describe("used", ring.get_used(), 0));
+    check(!ring.read(out, 1), test, "read from an empty ring");
+}
+
+static void check_overflow() {
+    std::string test("overflow");
+    RingBuffer ring(SmallRing);
+    unsigned char in[SmallRing];
+    unsigned char out[SmallRing];
+
+    fill(in, SmallRing, 0);
+    check(ring.write(in, 12), test, "write refused");
+    check(!ring.write(in, 8), test, "write over the end accepted");
+    check(ring.get_used() == 12, test, describe("used after a refused write", ring.get_used(), 12));
+    check(ring.write(in + 12, 4), test, "write up to the end refused");
+    check(!ring.write(in, 1), test, "write into a full ring accepted");
+
+    /* an incomplete read leaves everything in place */
+    check(!ring.read(out, SmallRing + 1), test, "read of more than there is");
+    check(ring.get_used() == SmallRing, test, describe("used", ring.get_used(), SmallRing));
+
+    check(ring.read(out, SmallRing) && !memcmp(in, out, SmallRing), test, "refused writes left bytes behind");
+}
+
+struct Record {
+    uint32_t sequence;
+    uint32_t check;
+};
+
+class Producer : public Thread {
+private:
+    Producer(const Producer&);
+    Producer& operator=(const Producer&);
+
+public:
+    Producer(RingBuffer& ring) : ring(ring), written(0), dropped(0), started(false), done(false) { }
+    virtual ~Producer() { }
+
+    bool start() {
+        return thread_start();
+    }
+
+    void join() {
+        thread_join();
+    }
+
+    RingBuffer& ring;
+    uint32_t written;
+    uint32_t dropped;
+    volatile bool started;
+    volatile bool done;
+
+protected:
+    virtual void thread() {
+        while (!started) { }
+        for (uint32_t i = 0; i < Records; i++) {
+            Record record;
+            record.sequence = i;
+            record.check = ~i;
+
+            /* a while for the consumer, then it is dropped */
+            bool ok = false;
+            for (int attempt = 0; !ok && attempt < WriteAttempts; attempt++) {
+                ok = ring.write(&record, sizeof record);
+            }
+            if (ok) {
+                written++;
+            } else {
+                dropped++;
+            }
+        }
+        done = true;
+    }
+};
+
+static void check_threads() {
+    std::string test("threads");
+    RingBuffer ring(ThreadRing);
+    Producer producer(ring);
+    uint32_t received = 0;
+    uint32_t broken = 0;
+    uint32_t unordered = 0;
+    uint32_t last = 0;
+
+    check(producer.start(), test, "producer did not start");
+    producer.started = true;
+    while (true) {
+        bool done = producer.done;
+        Record record;
+        if (ring.read(&record, sizeof record)) {
+            if (record.check != ~record.sequence) {
+                broken++;
+            }
+            if (received && record.sequence <= last) {
+                unordered++;
+            }
+            last = record.sequence;
+            received++;
+        } else if (done) {
+            break;
+        }
+    }
+    producer.join();
+
+    check(producer.written + producer.dropped == Records, test,
+        describe("written and dropped", producer.written + producer.dropped, Records));
+    check(received == producer.written, test, describe("received", received, producer.written));
+    check(!broken, test, describe("broken records", broken, 0));
+    check(!unordered, test, describe("records out of order", unordered, 0));
+    check(!ring.get_used(), test, describe("left in the ring", ring.get_used(), 0));
+
+    std::cout << test << ": written=" << producer.written << " dropped=" << producer.dropped << std::endl;
+}
+
+int main(int argc, char *argv[]) {
+    std::ostream& stream = std::cout;
+    int rv = 1;
+
+    try {
+        check_size();
+        check_wrap();
+        check_overflow();
+        check_threads();
+
+        stream << (failures ? "ring buffer check failed" : "ring buffer check passed") << std::endl;
+        rv = (failures ? 1 : 0);
+    } catch (const Exception& e) {
+        stream << e.what() << std::endl;
+    }
+
+    return rv;
+}
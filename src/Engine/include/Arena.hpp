@@ -0,0 +1,39 @@
+#ifndef ARENA_HPP
+#define ARENA_HPP
+
+#include <vector>
+#include <cstddef>
+
+/* bump pointer allocator, everything is released at once by reset(),
+   the blocks are kept for the next round */
+class Arena {
+private:
+    Arena(const Arena&);
+    Arena& operator=(const Arena&);
+
+    struct Block {
+        Block(char *data, size_t size) : data(data), size(size) { }
+
+        char *data;
+        size_t size;
+    };
+
+    typedef std::vector<Block> Blocks;
+
+public:
+    Arena(size_t block_size = 8192);
+    virtual ~Arena();
+
+    void *alloc(size_t sz);
+    void reset();
+    size_t get_heap_allocations() const;
+
+private:
+    size_t block_size;
+    Blocks blocks;
+    size_t current;
+    size_t used;
+    size_t heap_allocations;
+};
+
+#endif
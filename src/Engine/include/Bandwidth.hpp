@@ -0,0 +1,69 @@
+#ifndef BANDWIDTH_HPP
+#define BANDWIDTH_HPP
+
+#include "Protocol.hpp"
+
+#include <string>
+#include <vector>
+#include <stdint.h>
+
+/* messages, bytes and datagrams per game protocol command, for both
+   directions and for reliable and unreliable datagrams. bytes are the
+   transport header and the payload of a command, a datagram counts once
+   for every command it carries, no matter how often */
+class Bandwidth {
+public:
+    enum Direction {
+        DirectionSent = 0,
+        DirectionReceived,
+        _DirectionMAX
+    };
+
+    enum Class {
+        ClassUnreliable = 0,
+        ClassReliable,
+        _ClassMAX
+    };
+
+    static const size_t MaxCommands = 64;
+
+    struct Counter {
+        Counter() : messages(0), bytes(0), datagrams(0) { }
+
+        uint64_t messages;
+        uint64_t bytes;
+        uint64_t datagrams;
+    };
+
+    struct Message {
+        Message(command_t cmd, size_t bytes) : cmd(cmd), bytes(bytes) { }
+
+        command_t cmd;
+        size_t bytes;
+    };
+
+    typedef std::vector<Message> Datagram;
+    typedef std::vector<std::string> Report;
+
+    Bandwidth();
+    virtual ~Bandwidth();
+
+    static Class get_class(flags_t flags);
+
+    void count(Direction direction, Class cls, const Datagram& datagram);
+    void count(Direction direction, Class cls, command_t cmd, size_t bytes);
+    void count(Direction direction, Class cls, const void *transport, size_t len);
+    const Counter& get(Direction direction, Class cls, command_t cmd) const;
+    uint64_t get_total_bytes(Direction direction) const;
+    void reset();
+    void report(Report& lines, bool server, size_t max_lines) const;
+
+private:
+    Counter counters[_DirectionMAX][_ClassMAX][MaxCommands];
+    uint64_t seen[MaxCommands];
+    uint64_t datagram_no;
+
+    void count_message(Direction direction, Class cls, command_t cmd, size_t bytes);
+};
+
+#endif
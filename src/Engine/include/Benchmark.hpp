@@ -0,0 +1,49 @@
+#ifndef BENCHMARK_HPP
+#define BENCHMARK_HPP
+
+#include "Exception.hpp"
+#include "Subsystem.hpp"
+#include "KeyValue.hpp"
+#include "Timing.hpp"
+
+#include <string>
+#include <vector>
+
+class BenchmarkException : public Exception {
+public:
+    BenchmarkException(const char *msg) : Exception(msg) { }
+    BenchmarkException(const std::string& msg) : Exception(msg) { }
+};
+
+/* what the benchmark drivers share. parameters are key=value pairs or
+   names of files with such pairs, data_directory=<dir> points to the
+   game data. the results are saved as key=value pairs to
+   result_file=<file> if one is given */
+class Benchmark : public KeyValue {
+private:
+    Benchmark(const Benchmark&);
+    Benchmark& operator=(const Benchmark&);
+
+public:
+    typedef std::vector<std::string> Parameters;
+
+    virtual ~Benchmark();
+
+    /* the number of failed runs */
+    virtual int run() throw (Exception) = 0;
+
+protected:
+    Benchmark(Subsystem& subsystem, const Parameters& parms) throw (BenchmarkException);
+
+    Subsystem& subsystem;
+
+    void set_default(const std::string& key, const std::string& value) throw (BenchmarkException);
+    void set_result(const std::string& key, const std::string& value) throw (BenchmarkException);
+    void set_result(const std::string& key, ns_t value) throw (BenchmarkException);
+    void save_results() throw (BenchmarkException);
+
+private:
+    KeyValue results;
+};
+
+#endif
@@ -0,0 +1,49 @@
+#ifndef BOT_HPP
+#define BOT_HPP
+
+#include "Player.hpp"
+#include "Navigation.hpp"
+#include "Timing.hpp"
+
+class Tournament;
+
+/* drives a server side player by its key states. the bot walks the
+   navigation graph towards the objective of the game mode or the nearest
+   enemy, otherwise it roams, and fires whatever it carries at enemies in
+   front of it. all timers count in tournament periods (0.01 s) */
+class Bot {
+private:
+    Bot(const Bot&);
+    Bot& operator=(const Bot&);
+
+public:
+    Bot(Player *p);
+    virtual ~Bot();
+
+    Player *get_player() const;
+    void reset();
+    void think(Tournament& tournament, Navigation& navigation, Players& players, ns_t ns);
+
+private:
+    Player *p;
+    Navigation::Path path;
+    size_t path_index;
+    int roam_node;
+    double replan_counter;
+    double dead_counter;
+    double fire_counter;
+    double stuck_counter;
+    double last_x;
+    double last_y;
+    bool jump_pressed;
+
+    void get_feet(Player *player, double& x, double& y);
+    Player *find_enemy(Tournament& tournament, Players& players, double& distance);
+    void plan(Tournament& tournament, Navigation& navigation, Player *enemy, int from, bool roam);
+    keystates_t steer(Navigation& navigation, double x, int current);
+    void fire(Tournament& tournament, Player *enemy, double x, double y);
+};
+
+typedef std::vector<Bot *> Bots;
+
+#endif
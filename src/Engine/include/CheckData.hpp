@@ -0,0 +1,90 @@
+#ifndef CHECKDATA_HPP
+#define CHECKDATA_HPP
+
+#include "Exception.hpp"
+
+#include <string>
+#include <vector>
+
+class CheckDataException : public Exception {
+public:
+    CheckDataException(const char *msg) : Exception(msg) { }
+    CheckDataException(const std::string& msg) : Exception(msg) { }
+};
+
+/* synthetic files for the check programs: png images, paks with stored
+   or deflated entries and plain files. there is no deflate in the tree,
+   data is compressed with the fixed huffman codes of deflate, literals
+   only, which is enough to go through the whole inflate path */
+class CheckData {
+private:
+    CheckData();
+    CheckData(const CheckData&);
+    CheckData& operator=(const CheckData&);
+
+public:
+    typedef std::vector<unsigned char> Bytes;
+
+    enum ColorType {
+        ColorTypeRGB = 2,
+        ColorTypePalette = 3,
+        ColorTypeRGBA = 6
+    };
+
+    struct PakEntry {
+        PakEntry(const std::string& name, const Bytes& data, bool deflated)
+            : name(name), data(data), deflated(deflated) { }
+
+        std::string name;
+        Bytes data;
+        bool deflated;
+    };
+
+    typedef std::vector<PakEntry> PakEntries;
+
+    /* a data directory below /tmp, removed with everything written into it */
+    class TemporaryDirectory {
+    private:
+        TemporaryDirectory(const TemporaryDirectory&);
+        TemporaryDirectory& operator=(const TemporaryDirectory&);
+
+    public:
+        TemporaryDirectory() throw (CheckDataException);
+        ~TemporaryDirectory();
+
+        const std::string& get_path() const;
+
+        /* the name is relative, its subdirectories are created */
+        void add_file(const std::string& name, const Bytes& data) throw (CheckDataException);
+        void add_file(const std::string& name, const std::string& text) throw (CheckDataException);
+        void add_pak(const std::string& name, const PakEntries& entries) throw (CheckDataException);
+        void add_png(const std::string& name, int width, int height) throw (CheckDataException);
+
+    private:
+        typedef std::vector<std::string> Paths;
+
+        std::string path;
+        Paths files;
+        Paths directories;
+
+        std::string prepare(const std::string& name) throw (CheckDataException);
+    };
+
+    /* a raw deflate stream, without zlib header */
+    static void deflate(const Bytes& data, Bytes& out);
+
+    /* a palette image gets a tRNS chunk with transparent */
+    static void create_png(Bytes& png, int width, int height, ColorType color_type,
+        bool transparent);
+
+    /* what a server side tournament needs besides its tilesets and maps:
+       icons, a font, the game settings with their weapons, the goat, the
+       frog npc and the spawn point, flag and coin objects */
+    static void create_game_data(TemporaryDirectory& dir) throw (CheckDataException);
+
+    static void write_file(const std::string& filename, const Bytes& data) throw (CheckDataException);
+    static void write_file(const std::string& filename, const std::string& text) throw (CheckDataException);
+    static void write_pak(const std::string& filename, const PakEntries& entries) throw (CheckDataException);
+};
+
+#endif
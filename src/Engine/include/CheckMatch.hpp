@@ -0,0 +1,52 @@
+#ifndef CHECKMATCH_HPP
+#define CHECKMATCH_HPP
+
+#include "CheckData.hpp"
+#include "TournamentFactory.hpp"
+#include "Tournament.hpp"
+#include "MapConfiguration.hpp"
+#include "Player.hpp"
+
+/* a server side match on the synthetic arena for the check programs.
+   the goats run back and forth and jump, frogs and projectiles are
+   topped up, so every pool of the tournament is in use. the arena has
+   spawn points of both teams, both flags and the coin */
+class CheckMatch {
+private:
+    CheckMatch(const CheckMatch&);
+    CheckMatch& operator=(const CheckMatch&);
+
+public:
+    static const ns_t TickNS = 1000000000 / 60;
+
+    static void create_data(CheckData::TemporaryDirectory& dir) throw (CheckDataException);
+
+    CheckMatch(Resources& resources, TournamentFactory& factory, GamePlayType type,
+        int player_count, int npc_count, int projectile_count) throw (Exception);
+    ~CheckMatch();
+
+    Tournament *get_tournament() const;
+    const MapConfiguration& get_config() const;
+    Players& get_players();
+    void run(int ticks);
+
+    /* puts the player onto the first object of that type, true if it was picked up */
+    bool pick(Player *p, Object::ObjectType type);
+
+private:
+    MapConfiguration config;
+    Players players;
+    Tournament *tournament;
+    int npc_count;
+    int projectile_count;
+    int tick;
+    size_t next_shooter;
+
+    void cleanup();
+    void respawn_player(Player *p);
+    void script_players();
+    void top_up();
+    Player *next_alive_player();
+};
+
+#endif
@@ -0,0 +1,69 @@
+#ifndef CHECKPOINT_HPP
+#define CHECKPOINT_HPP
+
+#include "Exception.hpp"
+
+#include <string>
+#include <vector>
+#include <stdint.h>
+
+class CheckpointException : public Exception {
+public:
+    CheckpointException(const char *msg) : Exception(msg) { }
+    CheckpointException(const std::string& msg) : Exception(msg) { }
+};
+
+/* binary snapshot of a running match. the server writes one before it
+   goes down and restores the match from it after a restart. values are
+   appended and read back in the same order, integers little endian,
+   doubles as they are in memory, strings with a u16 length. the file
+   carries a magic, the version and a crc of the payload */
+class Checkpoint {
+private:
+    Checkpoint(const Checkpoint&);
+    Checkpoint& operator=(const Checkpoint&);
+
+public:
+    static const uint32_t Version = 2;
+
+    Checkpoint();
+    virtual ~Checkpoint();
+
+    void load(const std::string& filename) throw (CheckpointException);
+    void save(const std::string& filename) throw (CheckpointException);
+    void rewind();
+    void clear();
+    bool at_end() const;
+    uint64_t get_hash() const;
+    size_t get_size() const;
+    const unsigned char *get_data() const;
+    void assign(const void *data, size_t len);
+
+    void write_u8(unsigned char value);
+    void write_u16(uint16_t value);
+    void write_u32(uint32_t value);
+    void write_u64(uint64_t value);
+    void write_bool(bool value);
+    void write_float(float value);
+    void write_double(double value);
+    void write_string(const std::string& value);
+    void write_data(const void *data, size_t len);
+
+    unsigned char read_u8() throw (CheckpointException);
+    uint16_t read_u16() throw (CheckpointException);
+    uint32_t read_u32() throw (CheckpointException);
+    uint64_t read_u64() throw (CheckpointException);
+    bool read_bool() throw (CheckpointException);
+    float read_float() throw (CheckpointException);
+    double read_double() throw (CheckpointException);
+    std::string read_string() throw (CheckpointException);
+    void read_data(void *data, size_t len) throw (CheckpointException);
+
+private:
+    typedef std::vector<unsigned char> Data;
+
+    Data data;
+    size_t pos;
+};
+
+#endif
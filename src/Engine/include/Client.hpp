@@ -13,6 +13,7 @@
 #include "OptionsMenu.hpp"
 #include "KeyBinding.hpp"
 #include "Mutex.hpp"
+#include "Demo.hpp"
 
 #include <string>
 #include <vector>
@@ -37,8 +38,13 @@ public:
     Client(Resources& resources, Subsystem& subsystem, hostaddr_t host,
         hostport_t port, Configuration& config, const std::string& password)
         throw (Exception);
+    Client(Resources& resources, Subsystem& subsystem, Configuration& config,
+        const std::string& demo_filename, bool headless) throw (Exception);
     virtual ~Client();
 
+    size_t get_demo_frames() const;
+    size_t get_demo_messages() const;
+
     virtual void idle() throw (Exception);
     virtual void on_input_event(const InputData& input);
 
@@ -82,6 +88,7 @@ private:
     FILE *fhnd;
     bool running;
     bool reload_resources;
+    MapPreloader *preloader;
 
     gametime_t now;
     gametime_t last;
@@ -103,6 +110,16 @@ private:
     ServerEvents server_events;
     std::string current_download_filename;
 
+    /* demos */
+    DemoRecorder *recorder;
+    DemoPlayer *demo;
+    bool demo_headless;
+    bool demo_paused;
+    double demo_speed;
+    ns_t demo_time;
+    size_t demo_frames;
+    size_t demo_messages;
+
     /* implements MessageSequencer */
     virtual void event_status(hostaddr_t host, hostport_t port, const std::string& name,
         int max_clients, int cur_clients, ms_t ping_time, bool secured,
@@ -123,6 +140,16 @@ private:
     void sevt_login(ServerEvent& evt);
     void sevt_data(ServerEvent& evt);
 
+    /* demo funcs */
+    void start_recording();
+    void record_message(DemoCodec::MessageKind kind, const void *data, size_t len);
+    void play_demo(ns_t diff) throw (Exception);
+    void advance_demo(ns_t ns) throw (Exception);
+    void seek_demo(ns_t ns) throw (Exception);
+    void rewind_demo();
+    void demo_key(MappedKey::Device dev, int param, bool down);
+    void draw_demo_status();
+
     /* gui funcs */
     void set_key(MappedKey::Device dev, int param);
     void set_key(MappedKey::Device dev, int param, MappedKey& key, int flag);
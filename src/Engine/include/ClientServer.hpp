@@ -7,6 +7,7 @@
 #include "GameProtocol.hpp"
 #include "TournamentFactory.hpp"
 #include "MapConfiguration.hpp"
+#include "Bandwidth.hpp"
 
 #include <string>
 
@@ -42,6 +43,9 @@ protected:
 
     Players players;
 
+    /* relays get what synced clients get but are no players */
+    Players relays;
+
 public:
     void stacked_send_data(const Connection *c, unsigned char tournament_id, command_t cmd, flags_t flags,
         data_len_t len, const void *data) throw (Exception);
@@ -68,8 +72,16 @@ public:
     void set_server(Server *server);
     void reload_config(hostport_t port, pico_size_t num_players,
         const std::string& server_name, const std::string& password) throw (Exception);
+    void profile(const Connection *c, const std::string& params) throw (Exception);
+    void checkpoint(const Connection *c) throw (Exception);
+    void bandwidth_report(const Connection *c, const std::string& params) throw (Exception);
+    void allocations(const Connection *c, const std::string& params) throw (Exception);
 
     hostport_t get_port() const;
+    Bandwidth& get_bandwidth();
+
+protected:
+    void count_received(Player *p, const void *data, size_t len);
 
 private:
     char buffer[1024];
@@ -79,8 +91,17 @@ private:
     bool has_temp_map_config;
 
     MapConfiguration temp_map_config;
+    Bandwidth bandwidth;
+    Bandwidth::Datagram stacked_messages;
+    Bandwidth::Datagram single_message;
 
     void stack_data(unsigned char tournament_id, command_t cmd, data_len_t len, const void *data);
+    void count_sent(const Connection *c, Player *p, flags_t flags, const Bandwidth::Datagram& datagram);
+    void count_sent(const Connection *c, Player *p, flags_t flags, command_t cmd, data_len_t len);
+    void count_sent(const Players& to, flags_t flags, const Bandwidth::Datagram& datagram);
+    void push_synced(const Players& to, flags_t flags, data_len_t len,
+        const Bandwidth::Datagram& datagram) throw (Exception);
+    Player *find_player(const Connection *c);
 };
 
 #endif
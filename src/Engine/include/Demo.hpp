@@ -0,0 +1,87 @@
+#ifndef DEMO_HPP
+#define DEMO_HPP
+
+#include "Exception.hpp"
+#include "Timing.hpp"
+
+#include <string>
+#include <vector>
+#include <map>
+#include <fstream>
+#include <stdint.h>
+
+class DemoException : public Exception {
+public:
+    DemoException(const char *msg) : Exception(msg) { }
+    DemoException(const std::string& msg) : Exception(msg) { }
+};
+
+/* a demo is the message stream a client received from the server and
+   the states it sent of its own player, each message with the
+   milliseconds since the recording started. a message
+   is stored as the difference to the last message of the same length,
+   the long runs of zeros of that difference are packed. state updates
+   hardly change from one to the next, they shrink the most */
+class DemoCodec {
+public:
+    enum MessageKind {
+        MessageKindServer = 0,
+        MessageKindOwnState,
+        _MessageKindMAX
+    };
+
+protected:
+    typedef std::vector<unsigned char> Data;
+    typedef std::map<size_t, Data> LastMessages;
+
+    static const char *Magic;
+    static const size_t MagicLength = 4;
+    static const uint32_t Version = 1;
+
+    LastMessages last_messages;
+};
+
+class DemoRecorder : public DemoCodec {
+private:
+    DemoRecorder(const DemoRecorder&);
+    DemoRecorder& operator=(const DemoRecorder&);
+
+public:
+    DemoRecorder(const std::string& filename) throw (DemoException);
+    virtual ~DemoRecorder();
+
+    const std::string& get_filename() const;
+    void record(MessageKind kind, const void *data, size_t len) throw (DemoException);
+
+private:
+    std::string filename;
+    std::ofstream f;
+    gametime_t start;
+    Data packed;
+};
+
+class DemoPlayer : public DemoCodec {
+private:
+    DemoPlayer(const DemoPlayer&);
+    DemoPlayer& operator=(const DemoPlayer&);
+
+public:
+    DemoPlayer(const std::string& filename) throw (DemoException);
+    virtual ~DemoPlayer();
+
+    ms_t get_duration() const;
+    size_t get_message_count() const;
+    void rewind();
+    bool at_end() const;
+    ms_t get_next_time() const;
+    unsigned char *next(MessageKind& kind, size_t& len) throw (DemoException);
+
+private:
+    Data data;
+    size_t pos;
+    size_t message_count;
+    ms_t duration;
+    Data message;
+};
+
+#endif
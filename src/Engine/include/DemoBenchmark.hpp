@@ -0,0 +1,20 @@
+#ifndef DEMOBENCHMARK_HPP
+#define DEMOBENCHMARK_HPP
+
+#include "Benchmark.hpp"
+
+/* plays the recorded client demo demo=<file> headless, as fast as it
+   goes, and reports its nanoseconds per frame */
+class DemoBenchmark : public Benchmark {
+private:
+    DemoBenchmark(const DemoBenchmark&);
+    DemoBenchmark& operator=(const DemoBenchmark&);
+
+public:
+    DemoBenchmark(Subsystem& subsystem, const Parameters& parms) throw (BenchmarkException);
+    virtual ~DemoBenchmark();
+
+    virtual int run() throw (Exception);
+};
+
+#endif
@@ -6,6 +6,9 @@
 #include "Resources.hpp"
 #include "Configuration.hpp"
 
+#include <string>
+#include <vector>
+
 class GameException : public Exception {
 public:
     GameException(const char *msg) : Exception(msg) { }
@@ -18,15 +21,19 @@ private:
     Game& operator=(const Game&);
 
 public:
+    typedef std::vector<std::string> Parameters;
+
     Game(Resources& resources, Subsystem& subsystem);
     virtual ~Game();
 
-    void run(const std::string& parm);
+    void run(const Parameters& parms);
 
 private:
     Resources& resources;
     Subsystem& subsystem;
     Configuration config;
+
+    void run_servers(const Parameters& parms);
 };
 
 #endif
@@ -17,11 +17,14 @@ typedef int16_t sscore_t;
 typedef uint16_t playerflags_t;
 typedef uint32_t sr_milliseconds_t;
 typedef uint32_t datasize_t;
+typedef uint16_t resource_id_t;
 
 const int NameLength = 32;
 const int TextLength = 64;
 const int FilenameLen = 64;
 
+const resource_id_t ResourceIdNone = 0xffff;
+
 const int PlayerKeyStateLeft = 1;
 const int PlayerKeyStateRight = 2;
 const int PlayerKeyStateUp = 4;
@@ -83,7 +86,9 @@ enum GPC {
     GPCXferDataChunk,
     GPCGenericData,
     GPCPakHash,
-    GPCServerQuit
+    GPCServerQuit,
+    GPCResourceId,
+    GPCNextMap
 };
 
 /* game protocol client to server */
@@ -326,12 +331,59 @@ struct GPlayerDescription {
 };
 #pragma pack()
 
+const int LoginFlagRelay = 1;
+
+/* a relay logs in with flags behind its description, it only watches */
+#pragma pack(1)
+struct GPlayerLogin {
+    GPlayerDescription desc;
+    unsigned char flags;
+};
+#pragma pack()
+
 #pragma pack(1)
 struct GGenericName {
     char name[NameLength];
 };
 #pragma pack()
 
+#pragma pack(1)
+struct GResourceId {
+    unsigned char category;
+    resource_id_t id;
+    char name[NameLength];
+
+    inline void from_net() {
+        id = ntohs(id);
+    }
+
+    inline void to_net() {
+        id = htons(id);
+    }
+};
+#pragma pack()
+
+/* hint for clients to preload the map after this round */
+#pragma pack(1)
+struct GNextMap {
+    char map_name[NameLength];
+};
+#pragma pack()
+
+#pragma pack(1)
+struct GPlaySound {
+    resource_id_t sound_id;
+
+    inline void from_net() {
+        sound_id = ntohs(sound_id);
+    }
+
+    inline void to_net() {
+        sound_id = htons(sound_id);
+    }
+};
+#pragma pack()
+
 #pragma pack(1)
 struct GPlayerInfo {
     player_id_t id;
@@ -358,8 +410,8 @@ struct GPlayerInfo {
 
 #pragma pack(1)
 struct GAnimation {
-    char animation_name[NameLength];
-    char sound_name[NameLength];
+    resource_id_t animation_id; // 2
+    resource_id_t sound_id;     // 2
     identifier_t id;            // 2
     scounter_t duration;        // 2
     identifier_t owner;         // 2
@@ -368,6 +420,8 @@ struct GAnimation {
     double accel_x;             // 8
     double accel_y;             // 8
     inline void from_net() {
+        animation_id = ntohs(animation_id);
+        sound_id = ntohs(sound_id);
         id = ntohs(id);
         duration = ntohs(duration);
         owner = ntohs(owner);
@@ -378,6 +432,8 @@ struct GAnimation {
     }
 
     inline void to_net() {
+        animation_id = htons(animation_id);
+        sound_id = htons(sound_id);
         id = htons(id);
         duration = htons(duration);
         owner = htons(owner);
@@ -457,19 +513,21 @@ struct GPlaceObject {
 
 #pragma pack(1)
 struct GSpawnObject {
-    char object_name[NameLength];
+    resource_id_t object_id;
     identifier_t id;
     flags_t flags;
     pos_t x;
     pos_t y;
 
     inline void from_net() {
+        object_id = ntohs(object_id);
         id = ntohs(id);
         x = ntohl(x);
         y = ntohl(y);
     }
 
     inline void to_net() {
+        object_id = htons(object_id);
         id = htons(id);
         x = htonl(x);
         y = htonl(y);
@@ -505,8 +563,8 @@ struct GObjectState {
 
 #pragma pack(1)
 struct GSpawnNPC {
-    char npc_name[NameLength];
-    char sound_name[NameLength];
+    resource_id_t npc_id;
+    resource_id_t sound_id;
     identifier_t id;
     identifier_t owner;
     unsigned char direction;
@@ -517,6 +575,8 @@ struct GSpawnNPC {
     double accel_y;
 
     inline void from_net() {
+        npc_id = ntohs(npc_id);
+        sound_id = ntohs(sound_id);
         id = ntohs(id);
         owner = ntohs(owner);
         byte_swap<double>(x);
@@ -526,6 +586,8 @@ struct GSpawnNPC {
     }
 
     inline void to_net() {
+        npc_id = htons(npc_id);
+        sound_id = htons(sound_id);
         id = htons(id);
         owner = htons(owner);
         byte_swap<double>(x);
@@ -797,6 +859,7 @@ const int GPlayerClientServerStateLen = sizeof(GPlayerClientServerState);
 const int GPlayerServerStateLen = sizeof(GPlayerServerState);
 const int GGameStateLen = sizeof(GGameState);
 const int GPlayerDescriptionLen = sizeof(GPlayerDescription);
+const int GPlayerLoginLen = sizeof(GPlayerLogin);
 const int GPlaceObjectLen = sizeof(GPlaceObject);
 const int GObjectStateLen = sizeof(GObjectState);
 const int GAnimationStateLen = sizeof(GAnimationState);
@@ -810,6 +873,9 @@ const int GRemoveNPCLen = sizeof(GRemoveNPC);
 const int GNPCStateLen = sizeof(GNPCState);
 const int GSpawnObjectLen = sizeof(GSpawnObject);
 const int GGenericNameLen = sizeof(GGenericName);
+const int GResourceIdLen = sizeof(GResourceId);
+const int GNextMapLen = sizeof(GNextMap);
+const int GPlaySoundLen = sizeof(GPlaySound);
 const int GTransportTimeLen = sizeof(GTransportTime);
 const int GTransportTotalAndTimeLen = sizeof(GTransportTotalAndTime);
 const int GClanNamesLen = sizeof(GClanNames);
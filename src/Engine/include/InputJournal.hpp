@@ -0,0 +1,87 @@
+#ifndef INPUTJOURNAL_HPP
+#define INPUTJOURNAL_HPP
+
+#include "Exception.hpp"
+#include "Checkpoint.hpp"
+#include "MapConfiguration.hpp"
+#include "Player.hpp"
+#include "Timing.hpp"
+#include "Random.hpp"
+
+#include <string>
+#include <fstream>
+#include <istream>
+#include <stdint.h>
+
+class Tournament;
+
+class InputJournalException : public Exception {
+public:
+    InputJournalException(const char *msg) : Exception(msg) { }
+    InputJournalException(const std::string& msg) : Exception(msg) { }
+};
+
+/* records what drives the tournaments of a server: the map, players
+   coming and going, their inputs in the order they arrived and the
+   length of every tick. each record reseeds the random generator of the
+   server with a seed stored in the record, so goatattack-replay runs the
+   very same tournament offline. a hash of the game state every
+   HashInterval ticks tells where a replay went another way. the file is
+   flushed with every hash, a crash loses a second at most */
+class InputJournal {
+private:
+    InputJournal(const InputJournal&);
+    InputJournal& operator=(const InputJournal&);
+
+public:
+    enum RecordType {
+        RecordTypeTournament = 0,
+        RecordTypePlayerAdded,
+        RecordTypePlayerRemoved,
+        RecordTypeInput,
+        RecordTypeTick,
+        RecordTypeHash,
+        _RecordTypeMAX
+    };
+
+    struct Record {
+        RecordType type;
+        uint32_t tick;
+        uint32_t seed;
+        Checkpoint payload;
+    };
+
+    static const uint32_t Version = 2;
+    static const size_t HeaderLength = 11;
+    static const uint32_t HashInterval = 60;
+
+    InputJournal(const std::string& filename, Random& random) throw (InputJournalException);
+    virtual ~InputJournal();
+
+    bool is_broken() const;
+
+    void tournament_started(const MapConfiguration& config, bool warmup, bool switch_to_game,
+        bool friendly_fire_alarm, const std::string& team_red, const std::string& team_blue);
+    void player_added(Player *p, Players& players);
+    void player_removed(Player *p);
+    void input(Player *p, unsigned char cmd, const void *data, size_t len);
+    void tick(ns_t ns);
+    void tick_done(Tournament *tournament, Players& players);
+
+    static uint64_t get_state_hash(Tournament *tournament, Players& players);
+    static void read_header(std::istream& f) throw (InputJournalException);
+    static bool read_record(std::istream& f, Record& record) throw (InputJournalException);
+
+private:
+    std::ofstream f;
+    Random& random;
+    Checkpoint payload;
+    uint32_t tick_number;
+    uint32_t seed_state;
+    bool broken;
+
+    void write_record(RecordType type);
+    uint32_t next_seed();
+};
+
+#endif
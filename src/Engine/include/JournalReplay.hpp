@@ -0,0 +1,76 @@
+#ifndef JOURNALREPLAY_HPP
+#define JOURNALREPLAY_HPP
+
+#include "Exception.hpp"
+#include "Subsystem.hpp"
+#include "Resources.hpp"
+#include "KeyValue.hpp"
+#include "Player.hpp"
+#include "Profiler.hpp"
+#include "Bot.hpp"
+#include "InputJournal.hpp"
+#include "Random.hpp"
+
+#include <string>
+#include <vector>
+
+class Tournament;
+class TournamentFactory;
+class Navigation;
+
+class JournalReplayException : public Exception {
+public:
+    JournalReplayException(const char *msg) : Exception(msg) { }
+    JournalReplayException(const std::string& msg) : Exception(msg) { }
+};
+
+/* feeds an input journal of a server into headless tournaments, the
+   way the server did, and compares the state hashes along the way. the
+   first tick where a tournament went another way is reported. the time
+   spent in the tournament is profiled, real traffic as a benchmark.
+   parameters are key=value pairs or names of files with such pairs */
+class JournalReplay : public KeyValue {
+private:
+    JournalReplay(const JournalReplay&);
+    JournalReplay& operator=(const JournalReplay&);
+
+public:
+    typedef std::vector<std::string> Parameters;
+
+    JournalReplay(Subsystem& subsystem, const Parameters& parms) throw (JournalReplayException);
+    virtual ~JournalReplay();
+
+    int run() throw (Exception);
+
+private:
+    Subsystem& subsystem;
+    Profiler profiler;
+    Random random;
+    size_t phase;
+    size_t bots_phase;
+    Tournament *tournament;
+    Navigation *navigation;
+    Players players;
+    Bots bots;
+    std::string map_name;
+    uint32_t tournament_ticks;
+    uint32_t tournament_hashes;
+    uint32_t diverged_tick;
+    int tournaments;
+    int divergences;
+
+    void set_default(const std::string& key, const std::string& value);
+    void replay(Resources& resources, TournamentFactory& factory,
+        InputJournal::Record& record) throw (Exception);
+    void start_tournament(TournamentFactory& factory, Checkpoint& payload) throw (Exception);
+    void finish_tournament();
+    void add_player(Resources& resources, Checkpoint& payload) throw (Exception);
+    void remove_player(Checkpoint& payload) throw (Exception);
+    void apply_input(Checkpoint& payload) throw (Exception);
+    void tick(ns_t ns);
+    void check_hash(uint32_t tick, uint64_t hash);
+    Player *find_player(player_id_t id) throw (JournalReplayException);
+    void cleanup();
+};
+
+#endif
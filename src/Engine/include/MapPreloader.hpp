@@ -0,0 +1,50 @@
+#ifndef MAPPRELOADER_HPP
+#define MAPPRELOADER_HPP
+
+#include "Exception.hpp"
+#include "Resources.hpp"
+#include "Thread.hpp"
+#include "Navigation.hpp"
+
+#include <string>
+
+/* prepares the next map of the rotation on a worker thread while the
+   current round is played. clients decode the lightmap image, servers
+   with bots build the navigation graph. the map and tileset are looked
+   up on the calling thread, the worker also reads the tiles of packaged
+   maps which were only created from their cached header. textures are
+   still created by the tournament, graphics stay on the main thread */
+class MapPreloader : public Thread {
+private:
+    MapPreloader(const MapPreloader&);
+    MapPreloader& operator=(const MapPreloader&);
+
+public:
+    MapPreloader(Resources& resources, const std::string& map_name, bool lightmap,
+        int navigation_player_height) throw (ResourcesException);
+    virtual ~MapPreloader();
+
+    const std::string& get_map_name() const;
+    void wait();
+    bool has_lightmap_image();
+    PNG *get_lightmap_image();
+    Navigation *release_navigation();
+
+private:
+    std::string map_name;
+    Map *map;
+    Tileset *tileset;
+    bool lightmap;
+    int navigation_player_height;
+    bool running;
+    bool lightmap_loaded;
+    PNG *lightmap_image;
+    Navigation *navigation;
+
+    void prepare();
+
+    /* implements Thread */
+    virtual void thread();
+};
+
+#endif
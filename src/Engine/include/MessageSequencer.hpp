@@ -7,6 +7,8 @@
 
 #include <deque>
 #include <vector>
+#include <cstring>
+#include <stdint.h>
 #include <time.h>
 
 class MessageSequencerException : public Exception {
@@ -44,11 +46,35 @@ struct QueueMessage {
 
 struct Connection {
     Connection(hostaddr_t host, hostport_t port)
-        : host(host), port(port), ping_time(0) { }
+        : host(host), port(port), ping_time(0), bytes_sent(0), bytes_received(0),
+          datagrams_sent(0), datagrams_received(0), resends(0), lost(0) { }
 
     hostaddr_t host;
     hostport_t port;
     ms_t ping_time;
+
+    /* lost counts the gaps in the unreliable sequence */
+    uint64_t bytes_sent;
+    uint64_t bytes_received;
+    uint64_t datagrams_sent;
+    uint64_t datagrams_received;
+    uint64_t resends;
+    uint64_t lost;
+};
+
+/* datagrams and bytes of the socket per net command */
+struct NetTraffic {
+    NetTraffic() {
+        memset(datagrams_sent, 0, sizeof(datagrams_sent));
+        memset(bytes_sent, 0, sizeof(bytes_sent));
+        memset(datagrams_received, 0, sizeof(datagrams_received));
+        memset(bytes_received, 0, sizeof(bytes_received));
+    }
+
+    uint64_t datagrams_sent[_NetCommandMAX];
+    uint64_t bytes_sent[_NetCommandMAX];
+    uint64_t datagrams_received[_NetCommandMAX];
+    uint64_t bytes_received[_NetCommandMAX];
 };
 
 struct SequencerHeap : public Connection {
@@ -56,7 +82,7 @@ struct SequencerHeap : public Connection {
 
     SequencerHeap(hostaddr_t host, hostport_t port)
         : Connection(host, port), sent_pings(0), active(true),
-          processing(false), deferred_kill(false),
+          processing(false), deferred_kill(false), relay(false),
           last_send_unrel_seq_no(0), last_send_rel_seq_no(0),
           last_recv_unrel_seq_no(0), last_recv_rel_seq_no(0)
     {
@@ -68,6 +94,7 @@ struct SequencerHeap : public Connection {
     bool active;
     bool processing;
     bool deferred_kill;
+    bool relay;
 
     sequence_no_t last_send_unrel_seq_no;
     sequence_no_t last_send_rel_seq_no;
@@ -125,6 +152,8 @@ public:
     void kill(const Connection *c) throw (Exception);
     void new_settings(hostport_t port, pico_size_t num_heaps, const std::string& name,
         const std::string& password) throw (Exception);
+    const NetTraffic& get_traffic() const;
+    flags_t get_incoming_flags() const;
 
     virtual void event_status(hostaddr_t host, hostport_t port, const std::string& name,
         int max_clients, int cur_clients, ms_t ping_time, bool secured,
@@ -134,9 +163,15 @@ public:
     virtual void event_data(const Connection *c, data_len_t len, void *data) throw (Exception) { }
     virtual void event_logout(const Connection *c, LogoutReason reason) throw (Exception) { }
 
+protected:
+    /* relays are let in beside the clients, they do not take a slot */
+    virtual bool is_relay_login(data_len_t len, const void *data) { return false; }
+
 private:
     typedef std::vector<SequencerHeap *> SequencerHeaps;
 
+    static const pico_size_t MaxRelayHeaps = 4;
+
     pico_size_t max_heaps;
     bool is_client;
     std::string name;
@@ -147,10 +182,13 @@ private:
 
     SequencerHeaps heaps;
     char buffer[1024];
+    NetTraffic traffic;
+    flags_t incoming_flags;
 
     void ack(SequencerHeap *heap, sequence_no_t seq_no) throw (Exception);
     void process_incoming(SequencerHeap *heap, NetMessage *msg) throw (Exception);
     void sorted_insert(SequencerHeap::QueuedMessages& msg_queue, QueueMessage *smsg);
+    pico_size_t count_heaps(bool relays) const;
     SequencerHeap *find_heap(hostaddr_t host, hostport_t port);
     SequencerHeap *find_heap(const Connection *c);
     void delete_heap(SequencerHeap *heap);
@@ -158,6 +196,8 @@ private:
     void flush_queues(SequencerHeap *heap);
     void slack_send(hostaddr_t host, hostport_t port, sequence_no_t seq_no,
         flags_t flags, command_t cmd, data_len_t len, const void *data) throw (Exception);
+    void slack_send(SequencerHeap *heap, sequence_no_t seq_no, flags_t flags,
+        command_t cmd, data_len_t len, const void *data) throw (Exception);
     void delete_all_heaps();
 };
 
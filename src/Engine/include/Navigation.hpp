@@ -0,0 +1,103 @@
+#ifndef NAVIGATION_HPP
+#define NAVIGATION_HPP
+
+#include "Map.hpp"
+#include "Tileset.hpp"
+#include "Random.hpp"
+
+#include <vector>
+#include <cstddef>
+
+/* reachability graph of a map for server side bots. a node is a tile cell
+   a player can stand in, edges walk to the next cell, fall down a ledge,
+   drop through a platform or jump as far as the physics allow. searches
+   reuse scratch buffers, so one graph serves one thread */
+class Navigation {
+private:
+    Navigation(const Navigation&);
+    Navigation& operator=(const Navigation&);
+
+public:
+    enum EdgeType {
+        EdgeTypeWalk = 0,
+        EdgeTypeFall,
+        EdgeTypeDrop,
+        EdgeTypeJump,
+        _EdgeTypeMAX
+    };
+
+    struct Edge {
+        Edge(int to, EdgeType type, double cost) : to(to), type(type), cost(cost) { }
+
+        int to;
+        EdgeType type;
+        double cost;
+    };
+
+    struct Node {
+        Node(int tilex, int tiley) : tilex(tilex), tiley(tiley), first_edge(0), edge_count(0) { }
+
+        int tilex;
+        int tiley;
+        size_t first_edge;
+        size_t edge_count;
+    };
+
+    typedef std::vector<int> Path;
+
+    Navigation(Map& map, Tileset *tileset, int player_height);
+    virtual ~Navigation();
+
+    size_t get_node_count() const;
+    const Node& get_node(int index) const;
+    const Edge *get_edge(int from, int to) const;
+    int get_tile_width() const;
+    int get_tile_height() const;
+
+    int get_standing_node(double x, double y) const;
+    int get_nearest_node(double x, double y) const;
+    int get_random_node(Random& random) const;
+    bool find_path(int from, int to, Path& path);
+
+private:
+    enum Cell {
+        CellFree = 0,
+        CellSolid,
+        CellPlatform,
+        CellPlatformNoDescending,
+        CellKilling
+    };
+
+    typedef std::vector<unsigned char> Cells;
+    typedef std::vector<int> NodeIndices;
+    typedef std::vector<Node> Nodes;
+    typedef std::vector<Edge> Edges;
+
+    int width;
+    int height;
+    int tile_width;
+    int tile_height;
+    int clearance;
+    int jump_tiles;
+    std::vector<int> jump_reach;
+    Cells cells;
+    NodeIndices node_at;
+    Nodes nodes;
+    Edges edges;
+
+    /* search scratch */
+    std::vector<double> cost;
+    std::vector<int> parent;
+    std::vector<unsigned int> visited;
+    unsigned int search_id;
+
+    Cell get_cell(int x, int y) const;
+    bool is_body_free(int x, int y) const;
+    bool is_standable(int x, int y) const;
+    int get_node_at(int x, int y) const;
+    void calculate_jump();
+    void create_edges(int x, int y);
+    int find_landing(int x, int y) const;
+};
+
+#endif
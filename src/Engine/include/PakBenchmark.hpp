@@ -0,0 +1,27 @@
+#ifndef PAKBENCHMARK_HPP
+#define PAKBENCHMARK_HPP
+
+#include "Benchmark.hpp"
+
+/* writes a synthetic pak with entries=<n> small files to file=<name>,
+   reports how fast it opens, how fast its entries are looked up, by
+   name and by walking the central directory, and how fast its
+   directories are listed. the pak is removed afterwards */
+class PakBenchmark : public Benchmark {
+private:
+    PakBenchmark(const PakBenchmark&);
+    PakBenchmark& operator=(const PakBenchmark&);
+
+public:
+    PakBenchmark(Subsystem& subsystem, const Parameters& parms) throw (BenchmarkException);
+    virtual ~PakBenchmark();
+
+    virtual int run() throw (Exception);
+
+private:
+    int entries;
+
+    void write_pak(const std::string& filename, std::vector<std::string>& names) throw (BenchmarkException);
+};
+
+#endif
@@ -4,6 +4,7 @@
 #include "MessageSequencer.hpp"
 #include "GameProtocol.hpp"
 #include "Resources.hpp"
+#include "Bandwidth.hpp"
 
 #include <string>
 #include <vector>
@@ -59,6 +60,9 @@ public:
     bool server_force_quit_client;
     int server_force_quit_client_counter;
     bool server_admin;
+    bool bot;
+    bool relay;
+    Bandwidth bandwidth;
 
     int last_falling_y_pos;
 };
@@ -0,0 +1,174 @@
+#ifndef POOL_HPP
+#define POOL_HPP
+
+#include <vector>
+#include <cstddef>
+
+/* a handle stays valid until its object is removed, after that the
+   slot's generation has moved on and get() returns 0 */
+struct PoolHandle {
+    PoolHandle() : slot(0), generation(0) { }
+    PoolHandle(size_t slot, unsigned int generation)
+        : slot(slot), generation(generation) { }
+
+    bool operator==(const PoolHandle& rhs) const {
+        return (slot == rhs.slot && generation == rhs.generation);
+    }
+
+    size_t slot;
+    unsigned int generation;
+};
+
+/* iterates the live objects in place, it stays valid while objects are
+   created, remove_marked() moves them */
+template <class P, class T> class PoolIterator {
+public:
+    PoolIterator() : pool(0), index(0) { }
+    PoolIterator(P *pool, size_t index) : pool(pool), index(index) { }
+
+    T& operator*() const { return pool->at(index); }
+    T *operator->() const { return &pool->at(index); }
+    PoolIterator& operator++() { index++; return *this; }
+    PoolIterator operator++(int) { PoolIterator tmp(*this); index++; return tmp; }
+    bool operator==(const PoolIterator& rhs) const { return (index == rhs.index); }
+    bool operator!=(const PoolIterator& rhs) const { return (index != rhs.index); }
+
+private:
+    P *pool;
+    size_t index;
+};
+
+/* the live objects are stored densely in spawn order, in blocks that are
+   never reallocated, so creating objects moves nothing. objects are
+   removed by marking them with delete_me, remove_marked() compacts them
+   once per pass and moves the ones behind. pointers are only good until
+   then, whatever is kept longer holds a handle */
+template <class T, size_t BlockSize = 64> class Pool {
+private:
+    Pool(const Pool&);
+    Pool& operator=(const Pool&);
+
+    struct Slot {
+        Slot() : index(0), generation(1) { }
+
+        size_t index;
+        unsigned int generation;
+    };
+
+    typedef std::vector<T *> Blocks;
+    typedef std::vector<Slot> Slots;
+    typedef std::vector<size_t> Indices;
+
+public:
+    typedef PoolHandle Handle;
+    typedef PoolIterator<Pool, T> iterator;
+    typedef PoolIterator<const Pool, const T> const_iterator;
+
+    Pool() : count(0) { }
+
+    ~Pool() {
+        for (typename Blocks::iterator it = blocks.begin(); it != blocks.end(); it++) {
+            delete[] *it;
+        }
+    }
+
+    iterator begin() { return iterator(this, 0); }
+    iterator end() { return iterator(this, count); }
+    const_iterator begin() const { return const_iterator(this, 0); }
+    const_iterator end() const { return const_iterator(this, count); }
+    size_t size() const { return count; }
+    bool empty() const { return !count; }
+    T& operator[](size_t index) { return at(index); }
+    T& at(size_t index) { return blocks[index / BlockSize][index % BlockSize]; }
+    const T& at(size_t index) const { return blocks[index / BlockSize][index % BlockSize]; }
+
+    T *create() {
+        if (count == blocks.size() * BlockSize) {
+            blocks.push_back(new T[BlockSize]);
+        }
+        size_t slot;
+        if (free_slots.empty()) {
+            slot = slots.size();
+            slots.push_back(Slot());
+        } else {
+            slot = free_slots.back();
+            free_slots.pop_back();
+        }
+        slots[slot].index = count;
+        slot_of.push_back(slot);
+
+        T& obj = at(count++);
+        obj = T();
+
+        return &obj;
+    }
+
+    Handle get_handle(const T *obj) const {
+        for (size_t i = 0; i < blocks.size(); i++) {
+            const T *block = blocks[i];
+            if (obj >= block && obj < block + BlockSize) {
+                size_t slot = slot_of[i * BlockSize + (obj - block)];
+                return Handle(slot, slots[slot].generation);
+            }
+        }
+
+        return Handle();
+    }
+
+    T *get(const Handle& handle) {
+        if (handle.slot < slots.size() && slots[handle.slot].generation == handle.generation) {
+            return &at(slots[handle.slot].index);
+        }
+
+        return 0;
+    }
+
+    const T *get(const Handle& handle) const {
+        if (handle.slot < slots.size() && slots[handle.slot].generation == handle.generation) {
+            return &at(slots[handle.slot].index);
+        }
+
+        return 0;
+    }
+
+    void remove_marked() {
+        size_t dst = 0;
+        for (size_t src = 0; src < count; src++) {
+            T& obj = at(src);
+            if (obj.delete_me) {
+                release(slot_of[src]);
+            } else {
+                if (dst != src) {
+                    at(dst) = obj;
+                    slot_of[dst] = slot_of[src];
+                    slots[slot_of[dst]].index = dst;
+                }
+                dst++;
+            }
+        }
+        count = dst;
+        slot_of.resize(count);
+    }
+
+    void clear() {
+        for (size_t i = 0; i < count; i++) {
+            release(slot_of[i]);
+        }
+        count = 0;
+        slot_of.clear();
+    }
+
+private:
+    Blocks blocks;
+    Slots slots;
+    Indices slot_of;
+    Indices free_slots;
+    size_t count;
+
+    void release(size_t slot) {
+        slots[slot].generation++;
+        free_slots.push_back(slot);
+    }
+};
+
+#endif
@@ -15,7 +15,7 @@
 
 
 /* increase, if protocol changes */
-const int ProtocolVersion = 3;
+const int ProtocolVersion = 4;
 
 /* --- */
 typedef uint32_t hostaddr_t;
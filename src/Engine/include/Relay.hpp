@@ -0,0 +1,233 @@
+#ifndef RELAY_HPP
+#define RELAY_HPP
+
+#include "Exception.hpp"
+#include "Subsystem.hpp"
+#include "Resources.hpp"
+#include "KeyValue.hpp"
+#include "MessageSequencer.hpp"
+#include "GameProtocol.hpp"
+#include "Timing.hpp"
+
+#include <string>
+#include <vector>
+#include <deque>
+#include <list>
+#include <map>
+#include <cstdio>
+
+class RelayException : public Exception {
+public:
+    RelayException(const char *msg) : Exception(msg) { }
+    RelayException(const std::string& msg) : Exception(msg) { }
+};
+
+class Relay;
+
+/* a transport chain in net order, stacked the way ClientServer does */
+class RelayChain {
+private:
+    RelayChain(const RelayChain&);
+    RelayChain& operator=(const RelayChain&);
+
+public:
+    RelayChain();
+
+    bool add(command_t cmd, unsigned char tournament_id, data_len_t len, const void *data);
+    bool add(const GTransport *t);
+    void clear();
+    bool is_empty() const;
+    const unsigned char *get_data() const;
+    data_len_t get_size() const;
+
+private:
+    unsigned char buffer[PacketMaxSize];
+    size_t size;
+    GTransport *last;
+};
+
+/* the connection to the game server, events go to the relay */
+class RelayUpstream : public MessageSequencer {
+private:
+    RelayUpstream(const RelayUpstream&);
+    RelayUpstream& operator=(const RelayUpstream&);
+
+public:
+    RelayUpstream(Relay& relay, hostaddr_t host, hostport_t port) throw (Exception);
+    virtual ~RelayUpstream();
+
+    virtual void event_access_denied(RefusalReason reason) throw (Exception);
+    virtual void event_login(const Connection *c, data_len_t len, void *data) throw (Exception);
+    virtual void event_data(const Connection *c, data_len_t len, void *data) throw (Exception);
+    virtual void event_logout(const Connection *c, LogoutReason reason) throw (Exception);
+
+private:
+    Relay& relay;
+};
+
+/* the spectators of the relay, events go to the relay */
+class RelayDownstream : public MessageSequencer {
+private:
+    RelayDownstream(const RelayDownstream&);
+    RelayDownstream& operator=(const RelayDownstream&);
+
+public:
+    RelayDownstream(Relay& relay, hostport_t port, pico_size_t max_spectators,
+        const std::string& name, const std::string& password) throw (Exception);
+    virtual ~RelayDownstream();
+
+    virtual void event_login(const Connection *c, data_len_t len, void *data) throw (Exception);
+    virtual void event_data(const Connection *c, data_len_t len, void *data) throw (Exception);
+    virtual void event_logout(const Connection *c, LogoutReason reason) throw (Exception);
+
+private:
+    Relay& relay;
+};
+
+/* connects to a game server as one spectator and fans its stream out to
+   many spectators over the same protocol. the relay keeps what a
+   joining client needs to see the match: the players, the resource ids
+   and the state messages since the last map change, with repeated ones
+   folded into the latest. everything else is only passed on. with
+   delay=<s> the stream and that state are held back for some seconds.
+   spectators only watch, whatever they send besides the pak handshake
+   is dropped. probe=<n> starts n headless spectators against a relay
+   instead and reports what they receive. parameters are key=value
+   pairs or names of files with such pairs */
+class Relay : public KeyValue {
+private:
+    Relay(const Relay&);
+    Relay& operator=(const Relay&);
+
+public:
+    typedef std::vector<std::string> Parameters;
+
+    Relay(Subsystem& subsystem, const Parameters& parms) throw (RelayException);
+    virtual ~Relay();
+
+    int run() throw (Exception);
+
+    /* upstream */
+    void upstream_access_denied(MessageSequencer::RefusalReason reason);
+    void upstream_login(const Connection *c) throw (Exception);
+    void upstream_data(flags_t flags, data_len_t len, const void *data) throw (Exception);
+    void upstream_logout(MessageSequencer::LogoutReason reason);
+
+    /* downstream */
+    void downstream_login(const Connection *c, data_len_t len, void *data) throw (Exception);
+    void downstream_data(const Connection *c, data_len_t len, void *data) throw (Exception);
+    void downstream_logout(const Connection *c);
+
+private:
+    typedef std::vector<unsigned char> Transport;
+    typedef std::vector<const Resources::LoadedPak *> PakList;
+
+    struct Record {
+        Record(int key, const Transport& transport) : key(key), transport(transport) { }
+
+        int key;
+        Transport transport;
+    };
+
+    typedef std::list<Record> Records;
+    typedef std::map<player_id_t, Transport> PlayerRecords;
+
+    struct Delayed {
+        gametime_t received;
+        flags_t flags;
+        Transport data;
+    };
+
+    typedef std::deque<Delayed *> DelayQueue;
+
+    struct Spectator {
+        Spectator(const Connection *c, const std::string& name)
+            : c(c), name(name), zip(0), size(0), remaining(0), synced(false), quitting(false),
+              quit_counter(0) { }
+
+        const Connection *c;
+        std::string name;
+        PakList paks;
+        ZipReader *zip;
+        datasize_t size;
+        datasize_t remaining;
+        bool synced;
+        bool quitting;
+        ms_t quit_counter;
+    };
+
+    typedef std::vector<Spectator *> Spectators;
+
+    Subsystem& subsystem;
+    Resources *resources;
+    RelayUpstream *upstream;
+    RelayDownstream *downstream;
+    bool running;
+    bool upstream_synced;
+    std::string quit_message;
+    ns_t delay;
+    ms_t report_interval;
+
+    Transport identify;
+    PlayerRecords players;
+    Records resource_ids;
+    Records map_records;
+    Transport server_message;
+    Transport clan_names;
+
+    DelayQueue delayed;
+    Spectators spectators;
+    RelayChain chain;
+    RelayChain forward;
+    unsigned char pak_buffer[PacketMaxSize];
+
+    void set_default(const std::string& key, const std::string& value);
+    int run_relay() throw (Exception);
+    int run_probe() throw (Exception);
+    void deliver_due() throw (Exception);
+    void deliver(flags_t flags, const unsigned char *data, size_t len) throw (Exception);
+    void apply(const GTransport *t);
+    void store_map_record(int key, const Transport& transport);
+    void erase_map_record(int key);
+    void send_join_state(Spectator *s) throw (Exception);
+    void send_transport(Spectator *s, const Transport& transport) throw (Exception);
+    void flush_chain(Spectator *s) throw (Exception);
+    void sync_paks(Spectator *s) throw (Exception);
+    void quit_spectator(Spectator *s, const std::string& message) throw (Exception);
+    void update_spectators(ms_t diff) throw (Exception);
+    Spectator *find_spectator(const Connection *c);
+    void clear_delayed();
+    void report();
+};
+
+/* a headless spectator for testing relays on loopback */
+class RelayProbe : public MessageSequencer {
+private:
+    RelayProbe(const RelayProbe&);
+    RelayProbe& operator=(const RelayProbe&);
+
+public:
+    RelayProbe(Resources& resources, hostaddr_t host, hostport_t port,
+        const std::string& name, const std::string& password) throw (Exception);
+    virtual ~RelayProbe();
+
+    bool is_connected() const;
+    bool is_synced() const;
+    uint64_t get_messages() const;
+    const std::string& get_quit_message() const;
+
+    virtual void event_access_denied(RefusalReason reason) throw (Exception);
+    virtual void event_login(const Connection *c, data_len_t len, void *data) throw (Exception);
+    virtual void event_data(const Connection *c, data_len_t len, void *data) throw (Exception);
+    virtual void event_logout(const Connection *c, LogoutReason reason) throw (Exception);
+
+private:
+    Resources& resources;
+    bool connected;
+    bool synced;
+    uint64_t messages;
+    std::string quit_message;
+    RelayChain chain;
+};
+
+#endif
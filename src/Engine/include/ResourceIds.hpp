@@ -0,0 +1,74 @@
+#ifndef RESOURCEIDS_HPP
+#define RESOURCEIDS_HPP
+
+#include "Resources.hpp"
+#include "GameProtocol.hpp"
+
+#include <string>
+#include <vector>
+#include <map>
+
+/* numeric ids for resources referenced on the wire, the server assigns
+   them from its own resource set and sends the table at join time */
+class ResourceIds {
+private:
+    ResourceIds(const ResourceIds&);
+    ResourceIds& operator=(const ResourceIds&);
+
+public:
+    enum Category {
+        CategoryAnimation = 0,
+        CategorySound,
+        CategoryObject,
+        CategoryNPC,
+        _CategoryMAX
+    };
+
+    struct Entry {
+        Entry() : object(0) { }
+
+        std::string name;
+        void *object;
+    };
+
+    typedef std::vector<Entry> Entries;
+
+    ResourceIds(Resources& resources);
+    virtual ~ResourceIds();
+
+    void assign();
+    void clear();
+    void set(Category category, resource_id_t id, const std::string& name);
+    void resolve();
+
+    const Entries& get_entries(Category category) const;
+    resource_id_t get_id(Category category, const std::string& name) const;
+
+    /* without lookups, by the position of the resource, 0 has no id */
+    resource_id_t get_id(const Animation *animation) const;
+    resource_id_t get_id(const Sound *sound) const;
+    resource_id_t get_id(const Object *object) const;
+    resource_id_t get_id(const NPC *npc) const;
+
+    Animation *get_animation(resource_id_t id) throw (ResourcesException);
+    Sound *get_sound(resource_id_t id) throw (ResourcesException);
+    Object *get_object(resource_id_t id) throw (ResourcesException);
+    NPC *get_npc(resource_id_t id) throw (ResourcesException);
+
+private:
+    typedef std::map<std::string, resource_id_t> Names;
+    typedef std::vector<resource_id_t> Ids;
+
+    Resources& resources;
+    Entries entries[_CategoryMAX];
+    Names names[_CategoryMAX];
+    Ids ids[_CategoryMAX];
+
+    static Properties *get_properties(Category category, void *object);
+    resource_id_t lookup_id(Category category, const Properties *props) const;
+    void map_id(Category category, resource_id_t id, void *object);
+    void *find(Category category, const std::string& name);
+    void *get(Category category, resource_id_t id) throw (ResourcesException);
+};
+
+#endif
@@ -10,6 +10,14 @@
 #include "TournamentFactory.hpp"
 #include "ServerLogger.hpp"
 #include "ServerAdmin.hpp"
+#include "Profiler.hpp"
+#include "Navigation.hpp"
+#include "Bot.hpp"
+#include "MapPreloader.hpp"
+#include "Checkpoint.hpp"
+#include "InputJournal.hpp"
+#include "ServerMetrics.hpp"
+#include "Random.hpp"
 
 #include <vector>
 #include <fstream>
@@ -32,19 +40,38 @@ public:
         throw (Exception);
 
     Server(Resources& resources, Subsystem& subsystem,
-        const std::string& server_config_file) throw (Exception);
+        const std::string& server_config_file, JobSystem *jobs = 0) throw (Exception);
 
     virtual ~Server();
 
     void start() throw (ServerException);
+    void start_thread() throw (ServerException);
     void stop();
     void reload_config() throw (ServerException);
+    void profile(const Connection *c, const std::string& params) throw (Exception);
+    void checkpoint(const Connection *c) throw (Exception);
+    void bandwidth_report(const Connection *c, const std::string& params) throw (Exception);
+    void allocations(const Connection *c, const std::string& params) throw (Exception);
 
 private:
+    enum ProfilePhase {
+        ProfilePhaseTick = 0,
+        ProfilePhaseCycle,
+        ProfilePhaseUpdateStates,
+        ProfilePhaseResponses,
+        ProfilePhaseNewMap,
+        ProfilePhaseBroadcast,
+        ProfilePhaseLogger,
+        ProfilePhaseMasterServer,
+        ProfilePhaseBots,
+        _ProfilePhaseMAX
+    };
+
     struct ClientPak {
-        ClientPak(const Resources::LoadedPak *pak) : pak(pak), remaining(0), synced(0) { }
+        ClientPak(const Resources::LoadedPak *pak) : pak(pak), size(0), remaining(0), synced(0) { }
 
         const Resources::LoadedPak *pak;
+        datasize_t size;
         datasize_t remaining;
         bool synced;
     };
@@ -52,10 +79,10 @@ private:
     typedef std::vector<ClientPak> ClientPaks;
 
     struct PlayerClientPak {
-        PlayerClientPak(Player *p) : p(p), f(0), current_client_pak(0) { }
+        PlayerClientPak(Player *p) : p(p), zip(0), current_client_pak(0) { }
 
         Player *p;
-        FILE *f;
+        ZipReader *zip;
         ClientPak *current_client_pak;
         ClientPaks client_paks;
     };
@@ -69,6 +96,7 @@ private:
         hostaddr_t host;
         std::string player_name;
         gametime_t disconnect_time;
+        bool restored;
     };
 
     typedef std::vector<MapConfiguration> MapConfigurations;
@@ -77,7 +105,10 @@ private:
     /* in ctor */
     Resources& resources;
     Subsystem& subsystem;
+    Random random;
+    Random game_random; /* tournaments and bots, reseeded by the journal */
     TournamentFactory factory;
+    JobSystem *own_jobs;
 
     int nbr_logout_msg;
     bool running;
@@ -97,6 +128,22 @@ private:
     ServerLogger logger;
     ServerAdmin *server_admin;
     bool reload_map_rotation;
+    Profiler profiler;
+    std::string trace_file;
+    int bot_count;
+    Bots bots;
+    Navigation *navigation;
+    MapPreloader *preloader;
+    std::string next_map_name;
+    std::string checkpoint_file;
+    ms_t checkpoint_interval;
+    ms_t checkpoint_counter;
+    MapConfiguration restored_config;
+    InputJournal *journal;
+    ServerMetrics *metrics;
+    ms_t metrics_counter;
+    ms_t bandwidth_log_interval;
+    ms_t bandwidth_log_counter;
 
     MapConfigurations map_configs;
     HeldPlayerStats held_player_stats;
@@ -105,10 +152,16 @@ private:
     char pak_buffer[PacketMaxSize];
 
     bool select_map();
+    void setup_profiler();
     void cleanup_held_players();
     void quit_client(const Connection *c, Player *p, const std::string& message);
 
     void sync_client(const Connection *c, Player *p);
+    void relay_login(const Connection *c, const GPlayerDescription *desc);
+    void relay_data(Player *r, data_len_t len, void *data) throw (Exception);
+    bool relay_logout(const Connection *c);
+    void check_pak_hash(const Connection *c, Player *p, GPakHash *hash);
+    void force_quit_clients(Players& clients);
 
     PlayerClientPak *get_player_client_pak(Player *p);
     void process_sync_pak(const Connection *c, Player *p) throw (ServerException);
@@ -116,6 +169,21 @@ private:
     void destroy_paks(Player *p);
     void check_team_names();
     void load_map_rotation();
+    void preload_next_map();
+    void send_next_map(const Connection *c);
+    player_id_t get_free_player_id();
+    Characterset *get_bot_characterset() throw (ResourcesException);
+    void update_bots() throw (Exception);
+    void add_bot() throw (Exception);
+    void remove_bot();
+    void join_bot(Player *p);
+    void join_bots();
+    void think_bots(ns_t ns);
+    void journal_input(Player *p, GTransport *t);
+    void save_checkpoint() throw (Exception);
+    void restore_checkpoint();
+    void update_metrics(const gametime_t& tick_start, ms_t diff_milliseconds);
+    void log_bandwidth();
 
     std::ostream& create_log_stream();
 
@@ -125,6 +193,7 @@ private:
     virtual void thread();
 
     /* implements MessageSequencer */
+    virtual bool is_relay_login(data_len_t len, const void *data);
     virtual void event_login(const Connection *c, data_len_t len, void *data) throw (Exception);
     virtual void event_data(const Connection *c, data_len_t len, void *data) throw (Exception);
     virtual void event_logout(const Connection *c, LogoutReason reason) throw (Exception);
@@ -58,6 +58,10 @@ private:
     void sc_set(const Connection *c, Player *p, const std::string& params) throw (ServerAdminException);
     void sc_reset(const Connection *c, Player *p, const std::string& params) throw (ServerAdminException);
     void sc_vote(const Connection *c, Player *p, const std::string& params) throw (ServerAdminException);
+    void sc_profile(const Connection *c, Player *p, const std::string& params) throw (ServerAdminException);
+    void sc_checkpoint(const Connection *c, Player *p, const std::string& params) throw (ServerAdminException);
+    void sc_bandwidth(const Connection *c, Player *p, const std::string& params) throw (ServerAdminException);
+    void sc_allocations(const Connection *c, Player *p, const std::string& params) throw (ServerAdminException);
 
     void check_if_authorized(Player *p) throw (ServerAdminException);
     void check_if_params(const std::string& params) throw (ServerAdminException);
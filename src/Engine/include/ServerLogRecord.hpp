@@ -0,0 +1,60 @@
+#ifndef SERVERLOGRECORD_HPP
+#define SERVERLOGRECORD_HPP
+
+#include <string>
+#include <cstddef>
+#include <stdint.h>
+
+/* one logger event in the compact form the server logger queues and the
+   binary log file stores. strings and numbers are positional, what they
+   mean depends on the log type. on disk: length (u16), type (u8), number
+   count (u8), unix time (u32), the strings as u8 length + bytes, then the
+   numbers (u32), all little endian */
+class ServerLogRecord {
+public:
+    enum {
+        HeaderLength = 8,
+        MaxStrings = 5,
+        MaxStringLength = 255,
+        MaxNumbers = 4,
+        MaxRecordLength = HeaderLength + MaxStrings * (MaxStringLength + 1) + MaxNumbers * 4
+    };
+
+    enum StringSlot {
+        StringText = 0,
+        StringPlayer1,
+        StringPlayer2,
+        StringData1,
+        StringData2
+    };
+
+    /* not a log type, carries map name and description for what follows */
+    static const unsigned char TypeMapContext = 255;
+
+    ServerLogRecord();
+
+    uint32_t time;
+    unsigned char type;
+    unsigned char number_count;
+    unsigned char string_length[MaxStrings];
+    char strings[MaxStrings][MaxStringLength + 1];
+    uint32_t numbers[MaxNumbers];
+
+    void clear(unsigned char type, uint32_t time);
+    void set_string(StringSlot slot, const char *s);
+    void set_string(StringSlot slot, const std::string& s);
+    void add_int(int value);
+    void add_float(float value);
+    int get_int(size_t index) const;
+    float get_float(size_t index) const;
+
+    size_t encode(unsigned char *into) const;
+    bool decode(const unsigned char *from, size_t len);
+    bool format(std::string& line, const std::string& map_name,
+        const std::string& map_description) const;
+
+    static size_t get_length(const unsigned char *header);
+    static std::string make_quote(const std::string& s);
+};
+
+#endif
@@ -4,8 +4,16 @@
 #include "Subsystem.hpp"
 #include "Player.hpp"
 #include "Map.hpp"
+#include "Profiler.hpp"
+#include "Thread.hpp"
+#include "RingBuffer.hpp"
+#include "ServerLogRecord.hpp"
 
-class ServerLogger {
+/* log() only packs the event into a compact record. with a writer
+   started, records go through a ring buffer to a thread that formats and
+   writes them, a full ring drops the record and counts it instead of
+   stalling the tick. without, the record is written right away */
+class ServerLogger : public Thread {
 private:
     ServerLogger(const ServerLogger&);
     ServerLogger& operator=(const ServerLogger&);
@@ -51,6 +59,7 @@ public:
         LogTypeStatsGOHTeamBlue,    /* 036 */
         LogTypeJoin,                /* 037 */
         LogTypePlayerNameChange,    /* 038 */
+        LogTypeRecordsDropped,      /* 039 */
         _LogTypeMAX
     };
 
@@ -58,6 +67,10 @@ public:
     virtual ~ServerLogger();
 
     void set_map(Map *map);
+    void set_profiler(Profiler *profiler, size_t phase);
+    bool start_writer(bool binary);
+    void stop_writer();
+    size_t get_dropped_records() const;
     void log(LogType type, const std::string& text, Player *p1 = 0, Player *p2 = 0,
         const void *data1 = 0, const void *data2 = 0,
         const void *data3 = 0, const void *data4 = 0);
@@ -65,18 +78,31 @@ public:
 private:
     std::ostream& stream;
     bool verbose;
-    Map *map;
+    bool binary;
+    Profiler *profiler;
+    size_t profiler_phase;
 
-    char time_buffer[128];
-    char buffer[4096];
-    char subbuffer[256];
+    /* tick thread side */
+    RingBuffer *ring;
+    volatile bool quit;
+    volatile size_t dropped;
+    ServerLogRecord record;
+    unsigned char record_data[ServerLogRecord::MaxRecordLength];
+
+    /* writer side */
+    size_t reported_dropped;
+    ServerLogRecord write_record;
+    unsigned char write_data[ServerLogRecord::MaxRecordLength];
     std::string map_name;
     std::string map_description;
 
-    void prepare();
-    std::string make_quote(const std::string& s);
-    const char *get_map_name();
-    const char *get_map_description();
+    void submit();
+    bool drain();
+    void write(const unsigned char *data, size_t len);
+    void report_dropped();
+
+    /* implements Thread */
+    virtual void thread();
 };
 
-#endif
\ No newline at end of file
+#endif
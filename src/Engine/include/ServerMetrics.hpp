@@ -0,0 +1,94 @@
+#ifndef SERVERMETRICS_HPP
+#define SERVERMETRICS_HPP
+
+#include "Exception.hpp"
+#include "Thread.hpp"
+#include "Mutex.hpp"
+#include "TCPSocket.hpp"
+#include "MessageSequencer.hpp"
+
+#include <string>
+#include <vector>
+#include <stdint.h>
+
+class ServerMetricsException : public Exception {
+public:
+    ServerMetricsException(const char *msg) : Exception(msg) { }
+    ServerMetricsException(const std::string& msg) : Exception(msg) { }
+};
+
+/* serves the numbers of a server as prometheus plain text over tcp. the
+   tick thread fills the sample and publishes a copy of it once in a
+   while, the listener thread renders that copy for each scrape and never
+   looks at the tournament or the players */
+class ServerMetrics : protected Thread {
+private:
+    ServerMetrics(const ServerMetrics&);
+    ServerMetrics& operator=(const ServerMetrics&);
+
+public:
+    static const size_t TickBuckets = 10;
+
+    struct ConnectionSample {
+        ConnectionSample() : connection(0, 0) { }
+
+        std::string player_name;
+        Connection connection;
+    };
+
+    struct PakTransferSample {
+        std::string player_name;
+        std::string pak_name;
+        uint64_t size;
+        uint64_t remaining;
+    };
+
+    typedef std::vector<ConnectionSample> ConnectionSamples;
+    typedef std::vector<PakTransferSample> PakTransferSamples;
+
+    struct Sample {
+        Sample();
+
+        void observe_tick(ns_t ns);
+
+        std::string server_name;
+        size_t players;
+        size_t bots;
+        size_t max_players;
+        uint64_t tick_buckets[TickBuckets];
+        uint64_t tick_count;
+        ns_t tick_sum;
+        uint64_t response_heap_allocations;
+        uint64_t log_records_dropped;
+        NetTraffic traffic;
+        ConnectionSamples connections;
+        PakTransferSamples pak_transfers;
+    };
+
+    ServerMetrics(const std::string& address, hostport_t port) throw (ServerMetricsException);
+    virtual ~ServerMetrics();
+
+    Sample& get_sample();
+    void publish();
+
+private:
+    TCPSocket listener;
+    Mutex mtx;
+    volatile bool quit;
+
+    /* tick thread side */
+    Sample sample;
+
+    /* listener side */
+    Sample published;
+    Sample scraped;
+    std::string page;
+
+    void serve(TCPSocket& client) throw (TCPSocketException);
+    void render(const Sample& s);
+
+    /* implements Thread */
+    virtual void thread();
+};
+
+#endif
@@ -15,9 +15,15 @@
 #include "Gui.hpp"
 #include "Globals.hpp"
 #include "ServerLogger.hpp"
+#include "Pool.hpp"
+#include "Arena.hpp"
+#include "ResourceIds.hpp"
+#include "JobSystem.hpp"
+#include "Checkpoint.hpp"
+#include "Random.hpp"
 
 #include <vector>
-#include <deque>
+#include <new>
 
 /* pointing system:
  *
@@ -41,6 +47,7 @@ const double YMaxAccel = 4.5f;
 const double YVeloLanding = 2.25f;
 const double YDecelJumpNormal = 0.075f;
 const double YDecelJump = 0.005f;
+const double YInitialJumpImpulse = 3.8f;
 
 struct GameAnimation {
     GameAnimation() : animation(0), animation_counter(0.0f),
@@ -135,16 +142,55 @@ struct GenericData {
     GenericData *next;
 };
 
+typedef std::vector<Tile *> TileHits;
+
+/* tile coordinates of the last probe, if hits is set, touched tiles are
+   collected there and applied later instead of right away */
+struct TileProbe {
+    TileProbe() : tilex(0), tiley(0), hits(0) { }
+
+    int tilex;
+    int tiley;
+    TileHits *hits;
+};
+
+struct PlayerStep {
+    PlayerStep() : p(0), move_left(false), move_right(false), move_up(false),
+        move_down(false), newx(0.0f), newy(0.0f), ground_friction(0.0f) { }
+
+    Player *p;
+    bool move_left;
+    bool move_right;
+    bool move_up;
+    bool move_down;
+    double newx;
+    double newy;
+    double ground_friction;
+    TileHits hits;
+};
+
+/* the physics of an npc or an object, run as a job like the player
+   movement, the outcome is applied afterwards in pool order */
+struct BodyStep {
+    BodyStep() : collision(false), killing(false), bumps(0) { }
+
+    bool collision;
+    bool killing;
+    int bumps;
+};
+
+class MapPreloader;
+
 class Tournament {
 private:
     Tournament(const Tournament&);
     Tournament& operator=(const Tournament&);
 
 public:
-    typedef std::deque<StateResponse *> StateResponses;
-    typedef std::vector<GameObject *> GameObjects;
-    typedef std::vector<SpawnableNPC *> SpawnableNPCs;
-    typedef std::vector<GameAnimation *> GameAnimations;
+    typedef std::vector<StateResponse *> StateResponses;
+    typedef Pool<GameObject> GameObjects;
+    typedef Pool<SpawnableNPC> SpawnableNPCs;
+    typedef Pool<GameAnimation> GameAnimations;
 
     Tournament(Resources& resources, Subsystem& subsystem, Gui *gui, ServerLogger *logger,
         const std::string& game_file, bool server,
@@ -155,6 +201,7 @@ public:
     Map& get_map();
     Tileset *get_tileset();
     StateResponses& get_state_responses();
+    size_t get_response_heap_allocations() const;
     GameObjects& get_game_objects();
     SpawnableNPCs& get_spawnable_npcs();
     GameAnimations& get_game_animations();
@@ -166,6 +213,14 @@ public:
     void set_player_configuration(Configuration *config);
     void set_ready();
     void set_team_names(const std::string& team_red, const std::string& team_blue);
+    void set_resource_ids(ResourceIds *ids);
+    void set_job_system(JobSystem *jobs);
+    void set_random(Random *random);
+    Random& get_random();
+    void create_lightmap(MapPreloader *preloaded);
+    void write_checkpoint(Checkpoint& cp);
+    void read_checkpoint(Checkpoint& cp) throw (CheckpointException);
+    uint64_t get_state_hash();
     bool is_ready() const;
     void show_stats(bool state);
     void update_states(ns_t ns);
@@ -187,6 +242,7 @@ public:
     void fire_bomb(Player *p, unsigned char direction);
     void fire_frog(Player *p, unsigned char direction);
     void set_friendly_fire_alarm(bool state);
+    bool is_fire_enabled(Player *p);
 
     void draw();
     void delete_responses();
@@ -214,6 +270,8 @@ public:
     virtual bool play_bomb_error(Player *p);
     virtual bool play_frog_error(Player *p);
     virtual void reopen_join_window(Player *p);
+    virtual bool is_team_game() const;
+    virtual bool get_bot_goal(Player *p, double& x, double& y);
 
     virtual GenericData *create_generic_data();
     virtual void destroy_generic_data(void *data);
@@ -246,8 +304,8 @@ protected:
 
     typedef std::vector<GameTextAnimation *> GameTextAnimations;
     typedef std::vector<GameTextMessage *> GameTextMessages;
-    typedef std::vector<GameObject *> SpawnPoints;
-    typedef std::vector<GameObject *> FrogSpawnPoints;
+    typedef std::vector<GameObjects::Handle> SpawnPoints;
+    typedef std::vector<GameObjects::Handle> FrogSpawnPoints;
 
     int top;
     int left;
@@ -288,12 +346,29 @@ protected:
     Icon *enemy_indicator;
     bool game_over;
     ServerLogger *logger;
+    ResourceIds *resource_ids;
+    JobSystem *jobs;
+    Random own_random;
+    Random *random;
     bool gui_is_destroyed;
     bool do_friendly_fire_alarm;
 
-    int tilex;
-    int tiley;
+    /* sounds of the game settings, resolved once for their resource ids */
+    Sound *die_sound;
+    Sound *shot_start_sound;
+    Sound *grenade_start_sound;
+    Sound *bomb_start_sound;
+    Sound *frog_start_sound;
+
+    typedef std::vector<PlayerStep> PlayerSteps;
+    typedef std::vector<BodyStep> BodySteps;
+    PlayerSteps player_steps;
+    BodySteps npc_steps;
+    BodySteps object_steps;
     StateResponses state_responses;
+    Arena response_arena;
+    size_t response_vector_growths;
+    size_t response_heap_allocations;
     GameAnimations game_animations;
     GameTextAnimations game_text_animations;
     GameObjects game_objects;
@@ -313,14 +388,36 @@ protected:
         TestTypeFallingThrough
     };
 
+    class PlayerJob;
+    class NPCJob;
+    class ObjectJob;
+
+    void run_jobs(JobSystem::Job& job, size_t count);
     void integrate(ns_t ns);
+    void integrate_player(PlayerStep& step, double period_f, Player *me);
+    void integrate_npc(BodyStep& step, double period_f, SpawnableNPC *npc);
+    void integrate_object(BodyStep& step, double period_f, GameObject *obj);
+
+    bool collide_with_tile(TileProbe& probe, TestType type, Player *p,
+        int last_falling_y_pos, double x, double y, double *friction,
+        bool *killing);
 
-    bool collide_with_tile(TestType type, Player *p, int last_falling_y_pos,
-        double x, double y, double *friction, bool *killing);
+    bool sweep_box(TileProbe& probe, TestType falling_type,
+        int last_falling_y_pos, double left, double top, double right,
+        double bottom, double& dx, double& dy, bool *killing);
+
+    bool tile_collision(TestType type, const TileProbe& probe,
+        int last_falling_y_pos, Tile *t, bool *killing);
 
     void add_state_response(int action, data_len_t len, const void *data);
+
+    /* payloads live until delete_responses() */
+    template <class T> T *create_response() {
+        return new (response_arena.alloc(sizeof(T))) T;
+    }
     void add_msg_response(const char *msg);
-    void add_sound_response(const char *name);
+    void add_sound_response(Sound *sound);
+    Sound *lookup_sound(const std::string& name);
     Player *get_following_player();
     Player *get_me();
 
@@ -332,19 +429,19 @@ protected:
         identifier_t owner, double springiness_x, double springiness_y,
         const CollisionBox& colbox, double& x, double& y,
         double& accel_x, double& accel_y, int width, int height,
-        double friction_factor, bool play_bump, bool& falling,
+        double friction_factor, int *bumps, bool& falling,
         int& last_falling_y_pos, bool *killing, const std::string& weapon);
 
-    void play_ground_bump_sound();
+    void play_ground_bump_sound(int bumps);
     void check_attack(Player *p, const CollisionBox& colbox, bool move_up,
         bool move_down, Player *following_player);
 
     void firing_animation(Player *p, int flag, const std::string& animation_name,
-        const std::string& start_sound, int yoffset, unsigned char direction,
+        Sound *start_sound, int yoffset, unsigned char direction,
         unsigned char *mun);
 
     void firing_npc(Player *p, int flag, const std::string& npc_name,
-        const std::string& start_sound, int yoffset, unsigned char direction,
+        Sound *start_sound, int yoffset, unsigned char direction,
         unsigned char *mun);
 
     void check_killing_animation(int x, int y, Animation *ani,
@@ -353,6 +450,8 @@ protected:
     void player_damage(identifier_t owner, Player *p, NPC *npc, int damage, const std::string& weapon);
 
     void spawn_player_base(Player *p, SpawnPoints& spawn_points);
+    void get_object_center(GameObject *obj, double& x, double& y);
+    bool find_tile_center(Tile::TileType type, double& x, double& y);
 
     void control_spectator(Player *me, double period_f);
 
@@ -390,12 +489,14 @@ protected:
     virtual void draw_statistics();
     virtual void draw_enemies_on_hud();
     virtual bool pick_item(Player *p, GameObject *obj);
-    virtual bool tile_collision(TestType type, Player *p,
-        int last_falling_y_pos, Tile *t, bool *killing);
+    virtual void touch_tile(Player *p, Tile *t);
     virtual bool fire_enabled(Player *p);
     virtual void frag_point(Player *pfrag, Player *pkill) = 0;
     virtual void player_join_request(Player *p);
     virtual void check_friendly_fire(identifier_t owner, Player *p);
+    virtual void get_checkpoint_object(GameObject *obj, GameObject& state);
+    virtual void write_mode_checkpoint(Checkpoint& cp);
+    virtual void read_mode_checkpoint(Checkpoint& cp) throw (CheckpointException);
 
     template <class T> static bool erase_element(T *elem) {
         if (elem->delete_me) {
@@ -0,0 +1,59 @@
+#ifndef TOURNAMENTBENCHMARK_HPP
+#define TOURNAMENTBENCHMARK_HPP
+
+#include "Benchmark.hpp"
+#include "Resources.hpp"
+#include "Player.hpp"
+#include "Profiler.hpp"
+#include "Bot.hpp"
+#include "MapConfiguration.hpp"
+#include "Random.hpp"
+
+class Tournament;
+class TournamentFactory;
+class Navigation;
+
+/* runs server side tournaments without any network, scripted players
+   walk, jump and fire, npcs and projectiles are topped up to the wanted
+   count, every mode reports its nanoseconds per tick. with bots=1 the
+   players are driven by server bots instead, their thinking is profiled
+   as a phase of its own. built with allocation tracking every mode also
+   reports its steady state heap allocations per tick and their top call
+   sites */
+class TournamentBenchmark : public Benchmark {
+private:
+    TournamentBenchmark(const TournamentBenchmark&);
+    TournamentBenchmark& operator=(const TournamentBenchmark&);
+
+public:
+    TournamentBenchmark(Subsystem& subsystem, const Parameters& parms) throw (BenchmarkException);
+    virtual ~TournamentBenchmark();
+
+    virtual int run() throw (Exception);
+
+private:
+    Profiler profiler;
+    Random random;
+    int player_count;
+    int npc_count;
+    int projectile_count;
+    int tick_count;
+    bool use_bots;
+    size_t next_shooter;
+
+    void run_mode(Resources& resources, TournamentFactory& factory,
+        const std::string& mode) throw (Exception);
+    void report_allocations(const std::string& mode) throw (BenchmarkException);
+    GamePlayType get_game_play_type(const std::string& mode) throw (BenchmarkException);
+    std::string find_map(Resources& resources, GamePlayType type) throw (BenchmarkException);
+    std::string find_characterset(Resources& resources) throw (BenchmarkException);
+    void join_players(Tournament *tournament, Players& players);
+    void respawn_player(Tournament *tournament, Player *p);
+    void script_players(Tournament *tournament, Players& players, int tick);
+    void think_bots(Tournament *tournament, Navigation *navigation, Bots& bots, Players& players);
+    void cleanup(Tournament *tournament, Navigation *navigation, Bots& bots, Players& players);
+    void top_up(Tournament *tournament, Players& players);
+    Player *next_alive_player(Players& players);
+};
+
+#endif
@@ -14,6 +14,7 @@ public:
     virtual const char *tournament_type();
     virtual void write_stats_in_server_log();
     virtual void update_wearable_remaining(GTimeRemaining *remain);
+    virtual bool get_bot_goal(Player *p, double& x, double& y);
 
 private:
     struct TimesOfPlayer {
@@ -34,10 +35,19 @@ private:
 
     typedef std::vector<TimesOfPlayer> TimesOfPlayers;
 
-    GameObject *coin;
+    /* restored times of players that did not reconnect yet */
+    struct HeldTimes {
+        std::string player_name;
+        float total;
+    };
+
+    typedef std::vector<HeldTimes> HeldTimesOfPlayers;
+
+    GameObjects::Handle coin_handle;
     Icon *enemy_indicator_coin;
 
     TimesOfPlayers times_of_players;
+    HeldTimesOfPlayers held_times;
     char buffer[128];
 
     virtual void frag_point(Player *pfrag, Player *pkill);
@@ -55,10 +65,15 @@ private:
     virtual GenericData *create_generic_data();
     virtual void destroy_generic_data(void *data);
     virtual void generic_data_delivery(void *data);
+    virtual void get_checkpoint_object(GameObject *obj, GameObject& state);
+    virtual void write_mode_checkpoint(Checkpoint& cp);
+    virtual void read_mode_checkpoint(Checkpoint& cp) throw (CheckpointException);
 
+    bool reattach_times(TimesOfPlayer& top);
     void check_coin_validity(double period_f);
     void return_coin(int flags);
     bool coin_not_at_origin();
+    GameObject *get_coin();
     void send_coin_remaining();
     void send_coin_timer(Player *p);
     void send_coin_timer(TimesOfPlayer *top);
@@ -22,24 +22,27 @@ public:
     virtual const char *tournament_type();
     virtual void write_stats_in_server_log();
     virtual void update_wearable_remaining(GTimeRemaining *remain);
+    virtual bool get_bot_goal(Player *p, double& x, double& y);
 
 private:
-    GameObject *red_flag;
-    GameObject *blue_flag;
+    GameObjects::Handle red_flag;
+    GameObjects::Handle blue_flag;
 
     virtual void subintegrate(ns_t ns);
     virtual void draw_object_addons();
     virtual void draw_player_addons();
     virtual bool pick_item(Player *p, GameObject *obj);
 
-    virtual bool tile_collision(TestType type, Player *p, int last_falling_y_pos,
-        Tile *t, bool *killing);
+    virtual void touch_tile(Player *p, Tile *t);
 
     virtual bool fire_enabled(Player *p);
     virtual void player_removed(Player *p);
     virtual void player_died(Player *p);
     virtual bool play_gun_error(Player *p);
+    virtual void get_checkpoint_object(GameObject *obj, GameObject& state);
 
+    GameObject *get_red_flag();
+    GameObject *get_blue_flag();
     bool test_and_drop_flag(Player *p);
     void return_flag(GameObject *flag, int flags);
     void check_flag_validity(double period_f, const std::string& name, GameObject *flag);
@@ -9,6 +9,10 @@
 #include "ServerLogger.hpp"
 #include "Configuration.hpp"
 #include "MapConfiguration.hpp"
+#include "ResourceIds.hpp"
+#include "JobSystem.hpp"
+#include "MapPreloader.hpp"
+#include "Random.hpp"
 
 #include <string>
 
@@ -29,17 +33,24 @@ public:
     virtual ~TournamentFactory();
 
     Tournament *create_tournament(const MapConfiguration& config,
-        bool server, bool warmup, Players& players, ServerLogger *logger) throw (Exception);
+        bool server, bool warmup, Players& players, ServerLogger *logger,
+        MapPreloader *preloaded = 0) throw (Exception);
 
     unsigned char get_tournament_id() const;
     void set_tournament_id(unsigned char id);
     void set_tournament_server_flags(Properties& properties, Tournament *tournament);
+    ResourceIds& get_resource_ids();
+    void set_job_system(JobSystem *jobs);
+    void set_random(Random *random);
 
 private:
     Resources& resources;
     Subsystem& subsystem;
     Gui *gui;
     unsigned char tournament_id;
+    ResourceIds resource_ids;
+    JobSystem *jobs;
+    Random *random;
 };
 
 #endif
@@ -20,16 +20,20 @@ public:
     virtual const char *tournament_type();
     virtual void team_fire_point(Player *penem, Team team, int points);
     virtual void score_transport_raw(void *data);
+    virtual bool get_bot_goal(Player *p, double& x, double& y);
 
 private:
     Player *first_player_on_hill;
     Player *addon_player;
     double hill_counter;
-    std::string crested_sound;
-    std::string scored_sound;
-    std::string leaved_sound;
+    Sound *crested_sound;
+    Sound *scored_sound;
+    Sound *leaved_sound;
 
     GHillCounter draw_hill_counter;
+    bool has_hill;
+    double hill_x;
+    double hill_y;
 
     virtual void subintegrate(ns_t ns);
     virtual void player_removed(Player *p);
@@ -42,7 +46,7 @@ private:
     bool player_is_in_hill_zone(Player *p);
     void test_and_remove_player_from_hill(Player *p);
     void send_hill_counter(pos_t value);
-    GHillCounter *create_hill_counter(pos_t value);
+    void setup_hill_counter(GHillCounter *hc, pos_t value);
 };
 
 #endif
\ No newline at end of file
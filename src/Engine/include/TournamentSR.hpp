@@ -13,6 +13,7 @@ public:
 
     virtual const char *tournament_type();
     virtual void write_stats_in_server_log();
+    virtual bool get_bot_goal(Player *p, double& x, double& y);
 
 private:
     typedef std::vector<float> Times;
@@ -50,15 +51,31 @@ private:
 
     typedef std::vector<TimesOfPlayer> TimesOfPlayers;
 
+    /* restored times of players that did not reconnect yet */
+    struct HeldTimes {
+        std::string player_name;
+        float best;
+        float last;
+        bool finished;
+        Times times;
+    };
+
+    typedef std::vector<HeldTimes> HeldTimesOfPlayers;
+
     TimesOfPlayers times_of_players;
+    HeldTimesOfPlayers held_times;
     PlayersToReturn players_to_return;
+    bool has_finish;
+    double finish_x;
+    double finish_y;
     int max_rounds;
+    Sound *round_complete_sound;
+    Sound *round_complete_best_sound;
     char buffer[128];
     gametime_t now_for_drawing;
 
     virtual void frag_point(Player *pfrag, Player *pkill);
-    virtual bool tile_collision(TestType type, Player *p, int last_falling_y_pos,
-        Tile *t, bool *killing);
+    virtual void touch_tile(Player *p, Tile *t);
 
     virtual void player_added(Player *p);
     virtual void player_removed(Player *p);
@@ -78,6 +95,13 @@ private:
     TimesOfPlayer *get_times_of_player(Player *p);
     TimesOfPlayer *get_times_of_player(player_id_t id);
     void update_stats(TimesOfPlayer *top, float t);
+
+    virtual void write_mode_checkpoint(Checkpoint& cp);
+    virtual void read_mode_checkpoint(Checkpoint& cp) throw (CheckpointException);
+
+    bool reattach_times(TimesOfPlayer& top);
+    void write_times(Checkpoint& cp, const std::string& player_name, float best,
+        float last, bool finished, const Times& times);
 };
 
 #endif
@@ -20,6 +20,8 @@ public:
         throw (TournamentException, ResourcesException);
     virtual ~TournamentTeam();
 
+    virtual bool is_team_game() const;
+
 protected:
     enum Team {
         TeamRed = 0,
@@ -54,6 +56,8 @@ protected:
     virtual bool friendly_fire_alarm(GFriendyFireAlarm *alarm);
     virtual void draw_enemies_on_hud();
     virtual void reopen_join_window(Player *p);
+    virtual void write_mode_checkpoint(Checkpoint& cp);
+    virtual void read_mode_checkpoint(Checkpoint& cp) throw (CheckpointException);
 
     void send_team_score();
     int draw_team_stats(Font* f, int x, int y, playerflags_t flags);
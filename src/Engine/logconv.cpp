@@ -0,0 +1,62 @@
+#include "ServerLogRecord.hpp"
+
+#include <iostream>
+#include <fstream>
+#include <string>
+
+/* turns a binary server log (logfile_format=binary) into the text log */
+int main(int argc, char *argv[]) {
+    if (argc < 2 || argc > 3) {
+        std::cerr << "usage: " << argv[0] << " <binary log> [<text log>]" << std::endl;
+        return 1;
+    }
+
+    std::ifstream in(argv[1], std::ifstream::in | std::ifstream::binary);
+    if (!in.is_open()) {
+        std::cerr << "can't open " << argv[1] << std::endl;
+        return 1;
+    }
+
+    std::ofstream out_file;
+    if (argc == 3) {
+        out_file.open(argv[2], std::ofstream::out | std::ofstream::trunc);
+        if (!out_file.is_open()) {
+            std::cerr << "can't create " << argv[2] << std::endl;
+            return 1;
+        }
+    }
+    std::ostream& out = (argc == 3 ? out_file : std::cout);
+
+    ServerLogRecord record;
+    unsigned char data[ServerLogRecord::MaxRecordLength];
+    std::string map_name(ServerLogRecord::make_quote(""));
+    std::string map_description(ServerLogRecord::make_quote(""));
+    std::string line;
+    size_t offset = 0;
+
+    while (in.read(reinterpret_cast<char *>(data), ServerLogRecord::HeaderLength)) {
+        size_t len = ServerLogRecord::get_length(data);
+        if (len < ServerLogRecord::HeaderLength || len > ServerLogRecord::MaxRecordLength ||
+            !in.read(reinterpret_cast<char *>(data) + ServerLogRecord::HeaderLength,
+                len - ServerLogRecord::HeaderLength) || !record.decode(data, len))
+        {
+            std::cerr << "broken record at offset " << offset << std::endl;
+            return 1;
+        }
+        offset += len;
+
+        if (record.type == ServerLogRecord::TypeMapContext) {
+            map_name = ServerLogRecord::make_quote(record.strings[ServerLogRecord::StringText]);
+            map_description = ServerLogRecord::make_quote(record.strings[ServerLogRecord::StringData1]);
+        } else if (record.format(line, map_name, map_description)) {
+            out << line << '\n';
+        }
+    }
+
+    if (in.gcount()) {
+        std::cerr << "truncated record at offset " << offset << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
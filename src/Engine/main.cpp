@@ -27,8 +27,10 @@ int main(int argc, char *argv[]) {
     try {
         #ifdef DEDICATED_SERVER
             SubsystemNull subsystem(stream, "Goat Attack");
+            Resources::LoadProfile profile = Resources::LoadProfileServer;
         #else
             SubsystemSDL subsystem(stream, "Goat Attack");
+            Resources::LoadProfile profile = Resources::LoadProfileClient;
         #endif
 #ifdef __APPLE__
         CFBundleRef mainBundle = CFBundleGetMainBundle();
@@ -41,12 +43,16 @@ int main(int argc, char *argv[]) {
         CFRelease(resourcesURL);
         std::string data_directory(path);
         data_directory += "/data";
-        Resources resources(subsystem, data_directory);
+        Resources resources(subsystem, data_directory, profile);
 #else
-        Resources resources(subsystem, STRINGIZE_VALUE_OF(DATA_DIRECTORY));
+        Resources resources(subsystem, STRINGIZE_VALUE_OF(DATA_DIRECTORY), profile);
 #endif
+        Game::Parameters parms;
+        for (int i = 1; i < argc; i++) {
+            parms.push_back(argv[i]);
+        }
         Game game(resources, subsystem);
-        game.run(argc > 1 ? argv[1] : "");
+        game.run(parms);
     } catch (const Exception& e) {
         stream << e.what() << std::endl;
     }
@@ -0,0 +1,25 @@
+#include "SubsystemNull.hpp"
+#include "Relay.hpp"
+#include "Timing.hpp"
+
+#include <iostream>
+
+int main(int argc, char *argv[]) {
+    std::ostream& stream = std::cout;
+    int rv = 1;
+
+    init_hpet();
+    try {
+        SubsystemNull subsystem(stream, "Goat Attack Relay");
+        Relay::Parameters parms;
+        for (int i = 1; i < argc; i++) {
+            parms.push_back(argv[i]);
+        }
+        Relay relay(subsystem, parms);
+        rv = (relay.run() ? 1 : 0);
+    } catch (const Exception& e) {
+        stream << e.what() << std::endl;
+    }
+
+    return rv;
+}
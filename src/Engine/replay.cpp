@@ -0,0 +1,25 @@
+#include "SubsystemNull.hpp"
+#include "JournalReplay.hpp"
+#include "Timing.hpp"
+
+#include <iostream>
+
+int main(int argc, char *argv[]) {
+    std::ostream& stream = std::cout;
+    int rv = 1;
+
+    init_hpet();
+    try {
+        SubsystemNull subsystem(stream, "Goat Attack Replay");
+        JournalReplay::Parameters parms;
+        for (int i = 1; i < argc; i++) {
+            parms.push_back(argv[i]);
+        }
+        JournalReplay replay(subsystem, parms);
+        rv = (replay.run() ? 1 : 0);
+    } catch (const Exception& e) {
+        stream << e.what() << std::endl;
+    }
+
+    return rv;
+}
@@ -0,0 +1,47 @@
+#include "Arena.hpp"
+
+static const size_t ArenaAlignment = 8;
+
+Arena::Arena(size_t block_size)
+    : block_size(block_size), current(0), used(0), heap_allocations(0) { }
+
+Arena::~Arena() {
+    for (Blocks::iterator it = blocks.begin(); it != blocks.end(); it++) {
+        delete[] it->data;
+    }
+}
+
+void *Arena::alloc(size_t sz) {
+    sz = (sz ? (sz + ArenaAlignment - 1) & ~(ArenaAlignment - 1) : ArenaAlignment);
+
+    /* find room in the current or one of the following blocks */
+    while (current < blocks.size()) {
+        Block& block = blocks[current];
+        if (used + sz <= block.size) {
+            void *p = block.data + used;
+            used += sz;
+            return p;
+        }
+        current++;
+        used = 0;
+    }
+
+    /* out of blocks, grow */
+    size_t new_size = (sz > block_size ? sz : block_size);
+    blocks.push_back(Block(new char[new_size], new_size));
+    heap_allocations++;
+    current = blocks.size() - 1;
+    used = sz;
+
+    return blocks[current].data;
+}
+
+void Arena::reset() {
+    current = 0;
+    used = 0;
+    heap_allocations = 0;
+}
+
+size_t Arena::get_heap_allocations() const {
+    return heap_allocations;
+}
@@ -0,0 +1,215 @@
+#include "Bandwidth.hpp"
+#include "GameProtocol.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+
+/* in the order of the enums in GameProtocol.hpp */
+static const char *ServerCommandNames[] = {
+    "GPCServerMessage",
+    "GPCMapState",
+    "GPCIdentifyPlayer",
+    "GPCReady",
+    "GPCAddPlayer",
+    "GPCRemovePlayer",
+    "GPCResetPlayer",
+    "GPCSpawnPlayer",
+    "GPCUpdateGameState",
+    "GPCUpdatePlayerState",
+    "GPCUpdateObject",
+    "GPCUpdateAnimation",
+    "GPCUpdateSpawnableNPC",
+    "GPCSpawnNPC",
+    "GPCRemoveNPC",
+    "GPCTextMessage",
+    "GPCChatMessage",
+    "GPCAddAnimation",
+    "GPCAddTextAnimation",
+    "GPCPlayerRecoil",
+    "GPCPlayerHurt",
+    "GPCPickObject",
+    "GPCSpawnObject",
+    "GPCPlaceObject",
+    "GPCJoinAccepted",
+    "GPCJoinRefused",
+    "GPCTeamScore",
+    "GPCFriendlyFire",
+    "GPCGamePlayUnbalanced",
+    "GPCTimeRemaining",
+    "GPCWarmUp",
+    "GPCGameBegins",
+    "GPCGameOver",
+    "GPCPlayerChanged",
+    "GPCPlaySound",
+    "GPCScoreTransportRaw",
+    "GPCClanNames",
+    "GPCXferHeader",
+    "GPCXferDataChunk",
+    "GPCGenericData",
+    "GPCPakHash",
+    "GPCServerQuit",
+    "GPCResourceId",
+    "GPCNextMap",
+    0
+};
+
+static const char *ClientCommandNames[] = {
+    "GPSUpdatePlayerClientServerState",
+    "GPSRespawnRequest",
+    "GPSJoinRequest",
+    "GPSChatMessage",
+    "GPSShot",
+    "GPSGrenade",
+    "GPSBomb",
+    "GPSFrog",
+    "GPSPlayerChanged",
+    "GPSRoundFinished",
+    "GPSPakSyncHash",
+    "GPSPakSyncHashFinished",
+    "GPSPakSyncAck",
+    0
+};
+
+static const char *DirectionNames[] = { "sent", "received" };
+static const char *ClassNames[] = { "unrel", "rel" };
+
+struct BandwidthLine {
+    BandwidthLine(command_t cmd, Bandwidth::Class cls, const Bandwidth::Counter *counter)
+        : cmd(cmd), cls(cls), counter(counter) { }
+
+    command_t cmd;
+    Bandwidth::Class cls;
+    const Bandwidth::Counter *counter;
+};
+
+static bool CompareBandwidthLine(const BandwidthLine& lhs, const BandwidthLine& rhs) {
+    return (lhs.counter->bytes > rhs.counter->bytes);
+}
+
+static const char *get_command_name(const char **names, command_t cmd) {
+    for (command_t i = 0; names[i]; i++) {
+        if (i == cmd) {
+            return names[i];
+        }
+    }
+
+    return "unknown";
+}
+
+Bandwidth::Bandwidth() : datagram_no(0) {
+    memset(seen, 0, sizeof(seen));
+}
+
+Bandwidth::~Bandwidth() { }
+
+Bandwidth::Class Bandwidth::get_class(flags_t flags) {
+    return ((flags & NetFlagsReliable) ? ClassReliable : ClassUnreliable);
+}
+
+void Bandwidth::count(Direction direction, Class cls, const Datagram& datagram) {
+    datagram_no++;
+    for (Datagram::const_iterator it = datagram.begin(); it != datagram.end(); it++) {
+        count_message(direction, cls, it->cmd, it->bytes);
+    }
+}
+
+void Bandwidth::count(Direction direction, Class cls, command_t cmd, size_t bytes) {
+    datagram_no++;
+    count_message(direction, cls, cmd, bytes);
+}
+
+void Bandwidth::count(Direction direction, Class cls, const void *transport, size_t len) {
+    /* a chain still in net order, broken chains count up to the break */
+    datagram_no++;
+    const unsigned char *p = static_cast<const unsigned char *>(transport);
+    size_t pos = 0;
+    while (len - pos >= static_cast<size_t>(GTransportLen)) {
+        const GTransport *t = reinterpret_cast<const GTransport *>(p + pos);
+        size_t sz = GTransportLen + ntohs(t->len);
+        if (sz > len - pos) {
+            break;
+        }
+        count_message(direction, cls, t->cmd, sz);
+        pos += sz;
+        if (!(t->flags & TransportFlagMorePackets)) {
+            break;
+        }
+    }
+}
+
+const Bandwidth::Counter& Bandwidth::get(Direction direction, Class cls, command_t cmd) const {
+    return counters[direction][cls][cmd < MaxCommands ? cmd : 0];
+}
+
+uint64_t Bandwidth::get_total_bytes(Direction direction) const {
+    uint64_t bytes = 0;
+    for (int cls = 0; cls < _ClassMAX; cls++) {
+        for (size_t cmd = 0; cmd < MaxCommands; cmd++) {
+            bytes += counters[direction][cls][cmd].bytes;
+        }
+    }
+
+    return bytes;
+}
+
+void Bandwidth::reset() {
+    for (int direction = 0; direction < _DirectionMAX; direction++) {
+        for (int cls = 0; cls < _ClassMAX; cls++) {
+            for (size_t cmd = 0; cmd < MaxCommands; cmd++) {
+                counters[direction][cls][cmd] = Counter();
+            }
+        }
+    }
+}
+
+void Bandwidth::report(Report& lines, bool server, size_t max_lines) const {
+    char buffer[256];
+
+    for (int direction = 0; direction < _DirectionMAX; direction++) {
+        /* the server sends GPC and receives GPS, the client the other way */
+        const char **names = ((direction == DirectionSent) == server ? ServerCommandNames : ClientCommandNames);
+
+        std::vector<BandwidthLine> used;
+        uint64_t messages = 0;
+        uint64_t bytes = 0;
+        for (int cls = 0; cls < _ClassMAX; cls++) {
+            for (size_t cmd = 0; cmd < MaxCommands; cmd++) {
+                const Counter& counter = counters[direction][cls][cmd];
+                if (counter.messages) {
+                    used.push_back(BandwidthLine(static_cast<command_t>(cmd), static_cast<Class>(cls), &counter));
+                    messages += counter.messages;
+                    bytes += counter.bytes;
+                }
+            }
+        }
+        std::sort(used.begin(), used.end(), CompareBandwidthLine);
+
+        sprintf(buffer, "%s: %llu msgs, %llu bytes", DirectionNames[direction],
+            static_cast<unsigned long long>(messages), static_cast<unsigned long long>(bytes));
+        lines.push_back(buffer);
+        for (size_t i = 0; i < used.size() && i < max_lines; i++) {
+            const BandwidthLine& line = used[i];
+            sprintf(buffer, "  %s (%s): %llu msgs, %llu bytes, %llu datagrams",
+                get_command_name(names, line.cmd), ClassNames[line.cls],
+                static_cast<unsigned long long>(line.counter->messages),
+                static_cast<unsigned long long>(line.counter->bytes),
+                static_cast<unsigned long long>(line.counter->datagrams));
+            lines.push_back(buffer);
+        }
+    }
+}
+
+void Bandwidth::count_message(Direction direction, Class cls, command_t cmd, size_t bytes) {
+    if (cmd >= MaxCommands) {
+        return;
+    }
+
+    Counter& counter = counters[direction][cls][cmd];
+    counter.messages++;
+    counter.bytes += bytes;
+    if (seen[cmd] != datagram_no) {
+        seen[cmd] = datagram_no;
+        counter.datagrams++;
+    }
+}
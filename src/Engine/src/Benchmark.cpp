@@ -0,0 +1,62 @@
+#include "Benchmark.hpp"
+#include "Utils.hpp"
+
+#include <cstdio>
+
+Benchmark::Benchmark(Subsystem& subsystem, const Parameters& parms) throw (BenchmarkException)
+    : subsystem(subsystem)
+{
+    try {
+        for (Parameters::const_iterator it = parms.begin(); it != parms.end(); it++) {
+            StringTokens tokens = tokenize(*it, '=', 2);
+            if (tokens.size() == 2) {
+                set_value(tokens[0], tokens[1]);
+            } else if (it->find('=') == std::string::npos) {
+                read(*it);
+            } else {
+                throw BenchmarkException("Invalid parameter: " + *it);
+            }
+        }
+    } catch (const KeyValueException& e) {
+        throw BenchmarkException(e.what());
+    }
+
+    set_default("data_directory", STRINGIZE_VALUE_OF(DATA_DIRECTORY));
+}
+
+Benchmark::~Benchmark() { }
+
+void Benchmark::set_default(const std::string& key, const std::string& value) throw (BenchmarkException) {
+    if (!get_value(key).length()) {
+        try {
+            set_value(key, value);
+        } catch (const KeyValueException& e) {
+            throw BenchmarkException(e.what());
+        }
+    }
+}
+
+void Benchmark::set_result(const std::string& key, const std::string& value) throw (BenchmarkException) {
+    try {
+        results.set_value(key, value);
+    } catch (const KeyValueException& e) {
+        throw BenchmarkException(e.what());
+    }
+}
+
+void Benchmark::set_result(const std::string& key, ns_t value) throw (BenchmarkException) {
+    char text[32];
+    sprintf(text, "%ld", static_cast<long>(value));
+    set_result(key, std::string(text));
+}
+
+void Benchmark::save_results() throw (BenchmarkException) {
+    const std::string& result_file = get_value("result_file");
+    if (result_file.length()) {
+        try {
+            results.save(result_file);
+        } catch (const KeyValueException& e) {
+            throw BenchmarkException(e.what());
+        }
+    }
+}
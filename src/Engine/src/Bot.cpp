@@ -0,0 +1,246 @@
+#include "Bot.hpp"
+#include "Tournament.hpp"
+
+#include <cstdlib>
+#include <cmath>
+
+static const ns_t BotPeriodNS = 10000000;   /* same 0.01 s as the tournament */
+static const double BotRespawnDelay = 200.0f;
+static const double BotReplanInterval = 50.0f;
+static const int BotReplanJitter = 25;
+static const double BotFireInterval = 40.0f;
+static const double BotFireRange = 320.0f;
+static const double BotFireHeight = 24.0f;
+static const double BotStuckDelay = 100.0f;
+static const double BotStuckDistance = 0.1f;
+
+Bot::Bot(Player *p)
+    : p(p), path_index(0), roam_node(-1), replan_counter(0.0f), dead_counter(0.0f),
+      fire_counter(0.0f), stuck_counter(0.0f), last_x(0.0f), last_y(0.0f),
+      jump_pressed(false) { }
+
+Bot::~Bot() { }
+
+Player *Bot::get_player() const {
+    return p;
+}
+
+void Bot::reset() {
+    path.clear();
+    path_index = 0;
+    roam_node = -1;
+    replan_counter = 0.0f;
+    stuck_counter = 0.0f;
+    jump_pressed = false;
+}
+
+void Bot::think(Tournament& tournament, Navigation& navigation, Players& players, ns_t ns) {
+    double period_f = ns / static_cast<double>(BotPeriodNS);
+    GPlayerClientServerState& state = p->state.client_server_state;
+    playerflags_t flags = p->state.server_state.flags;
+
+    if (flags & PlayerServerFlagSpectating) {
+        state.key_states = 0;
+        return;
+    }
+
+    /* dead -> ask for a respawn after a short break */
+    if (flags & PlayerServerFlagDead) {
+        state.key_states = 0;
+        reset();
+        dead_counter += period_f;
+        if (dead_counter > BotRespawnDelay) {
+            dead_counter = 0.0f;
+            p->respawning = true;
+        }
+        return;
+    }
+    dead_counter = 0.0f;
+
+    double x;
+    double y;
+    get_feet(p, x, y);
+    int current = navigation.get_standing_node(x, y);
+
+    double distance = 0.0f;
+    Player *enemy = find_enemy(tournament, players, distance);
+
+    /* stuck on something? pick another place to go */
+    bool roam = false;
+    if (fabs(x - last_x) + fabs(y - last_y) < BotStuckDistance * period_f) {
+        stuck_counter += period_f;
+        if (stuck_counter > BotStuckDelay) {
+            stuck_counter = 0.0f;
+            roam_node = navigation.get_random_node(tournament.get_random());
+            roam = true;
+        }
+    } else {
+        stuck_counter = 0.0f;
+    }
+    last_x = x;
+    last_y = y;
+
+    /* follow the path, replan on the ground only */
+    replan_counter -= period_f;
+    if (current > -1) {
+        bool on_path = false;
+        size_t sz = path.size();
+        for (size_t i = (path_index ? path_index - 1 : 0); i < sz; i++) {
+            if (path[i] == current) {
+                path_index = i + 1;
+                on_path = true;
+                break;
+            }
+        }
+        if (roam || !on_path || replan_counter < 0.0f) {
+            plan(tournament, navigation, enemy, current, roam);
+        }
+    }
+
+    state.key_states = steer(navigation, x, current);
+
+    fire_counter -= period_f;
+    if (enemy) {
+        fire(tournament, enemy, x, y);
+    }
+}
+
+void Bot::get_feet(Player *player, double& x, double& y) {
+    const CollisionBox& colbox = player->get_characterset()->get_colbox();
+    x = player->state.client_server_state.x + colbox.x + colbox.width / 2;
+    y = player->state.client_server_state.y - colbox.y - 1;
+}
+
+Player *Bot::find_enemy(Tournament& tournament, Players& players, double& distance) {
+    bool team_game = tournament.is_team_game();
+    playerflags_t team = p->state.server_state.flags & PlayerServerFlagTeamRed;
+    double x;
+    double y;
+    get_feet(p, x, y);
+
+    Player *enemy = 0;
+    for (Players::iterator it = players.begin(); it != players.end(); it++) {
+        Player *q = *it;
+        if (q == p || !q->is_alive_and_playing()) {
+            continue;
+        }
+        if (team_game && (q->state.server_state.flags & PlayerServerFlagTeamRed) == team) {
+            continue;
+        }
+        double qx;
+        double qy;
+        get_feet(q, qx, qy);
+        double d = sqrt((qx - x) * (qx - x) + (qy - y) * (qy - y));
+        if (!enemy || d < distance) {
+            enemy = q;
+            distance = d;
+        }
+    }
+
+    return enemy;
+}
+
+void Bot::plan(Tournament& tournament, Navigation& navigation, Player *enemy, int from, bool roam) {
+    int to = -1;
+    bool has_goal = false;
+
+    /* objective of the game mode first, then the nearest enemy */
+    if (!roam) {
+        double gx;
+        double gy;
+        if (tournament.get_bot_goal(p, gx, gy)) {
+            has_goal = true;
+        } else if (enemy) {
+            get_feet(enemy, gx, gy);
+            has_goal = true;
+        }
+        if (has_goal) {
+            to = navigation.get_nearest_node(gx, gy);
+        }
+    }
+
+    if (to < 0) {
+        if (roam_node < 0 || roam_node == from) {
+            roam_node = navigation.get_random_node(tournament.get_random());
+        }
+        to = roam_node;
+    }
+
+    path_index = 1;
+    replan_counter = BotReplanInterval + tournament.get_random().next() % BotReplanJitter;
+    if (!navigation.find_path(from, to, path)) {
+        /* unreachable, try somewhere else next time */
+        roam_node = -1;
+        path.clear();
+        replan_counter = 0.0f;
+    }
+}
+
+keystates_t Bot::steer(Navigation& navigation, double x, int current) {
+    if (path_index >= path.size()) {
+        jump_pressed = false;
+        return 0;
+    }
+
+    keystates_t keys = 0;
+    int next = path[path_index];
+    const Navigation::Node& node = navigation.get_node(next);
+    int tile_width = navigation.get_tile_width();
+    double dx = (node.tilex + 0.5f) * tile_width - x;
+    double slack = tile_width / 4.0f;
+    if (dx < -slack) {
+        keys |= PlayerKeyStateLeft;
+    } else if (dx > slack) {
+        keys |= PlayerKeyStateRight;
+    }
+
+    const Navigation::Edge *edge = navigation.get_edge(path[path_index - 1], next);
+    bool grounded = (!(p->state.client_state.flags & PlayerClientFlagFalling) &&
+        fabs(p->state.client_server_state.jump_accel_y) < Epsilon);
+
+    if (edge && edge->type == Navigation::EdgeTypeJump) {
+        /* a jump needs the key released before, hold it while rising */
+        if (grounded) {
+            if (!jump_pressed) {
+                keys |= PlayerKeyStateJump;
+            }
+            jump_pressed = !jump_pressed;
+        } else if (jump_pressed) {
+            keys |= PlayerKeyStateJump;
+        }
+    } else {
+        jump_pressed = false;
+        if (edge && edge->type == Navigation::EdgeTypeDrop && current > -1) {
+            keys |= PlayerKeyStateDown;
+        }
+    }
+
+    return keys;
+}
+
+void Bot::fire(Tournament& tournament, Player *enemy, double x, double y) {
+    if (fire_counter > 0.0f || !tournament.is_fire_enabled(p)) {
+        return;
+    }
+
+    double ex;
+    double ey;
+    get_feet(enemy, ex, ey);
+    if (fabs(ey - y) > BotFireHeight || fabs(ex - x) > BotFireRange) {
+        return;
+    }
+
+    unsigned char direction = (ex < x ? DirectionLeft : DirectionRight);
+    GPlayerServerState& state = p->state.server_state;
+    if ((state.flags & PlayerServerFlagHasShotgunBelt) && state.ammo) {
+        tournament.fire_shot(p, direction);
+    } else if (state.grenades) {
+        tournament.fire_grenade(p, direction);
+    } else if (state.bombs) {
+        tournament.fire_bomb(p, direction);
+    } else {
+        return;
+    }
+    p->state.client_server_state.direction = direction;
+    fire_counter = BotFireInterval;
+}
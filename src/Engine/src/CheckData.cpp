@@ -0,0 +1,392 @@
+#include "CheckData.hpp"
+#include "Object.hpp"
+#include "Font.hpp"
+
+#include "zlib.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <unistd.h>
+#include <sys/stat.h>
+
+static const unsigned char PNGSignature[] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1a, '\n' };
+static const int PaletteEntries = 4;
+
+static const char *CharactersetAnimations[] = {
+    "standing", "running", "sliding", "jumping", "falling", "landing", "shooting"
+};
+
+static const char *TournamentIcons[] = {
+    "scanlines", "hud_dm", "hud_tdm", "hud_ctf", "hud_sr", "hud_ctc", "hud_goh",
+    "screw1", "screw2", "lives", "lives_half", "lives_empty", "shield", "shield_half",
+    "shield_empty", "ammo", "grenade", "bomb", "frog", "team_badge_red", "team_badge_blue",
+    "enemy_indicator_neutral", "enemy_indicator_red", "enemy_indicator_blue",
+    "enemy_indicator_red_flag", "enemy_indicator_blue_flag", "enemy_indicator_coin"
+};
+
+static const char *GameSettings[] = { "dm", "tdm", "ctf", "sr", "ctc", "goh" };
+
+static const char *NPCAnimations[] = { "standing", "idle1", "idle2", "jumping" };
+
+struct ObjectData {
+    const char *name;
+    Object::ObjectType type;
+};
+
+static const ObjectData Objects[] = {
+    { "spawn", Object::ObjectTypeSpawnPointRed },
+    { "spawn_blue", Object::ObjectTypeSpawnPointBlue },
+    { "red_flag", Object::ObjectTypeRedFlag },
+    { "blue_flag", Object::ObjectTypeBlueFlag },
+    { "coin", Object::ObjectTypeCoin }
+};
+
+/* deflate writes its bits from the lowest one up, huffman codes from the highest */
+class BitWriter {
+public:
+    BitWriter(CheckData::Bytes& out) : out(out), bits(0), count(0) { }
+
+    void put(unsigned int value, int len) {
+        for (int i = 0; i < len; i++) {
+            bits |= ((value >> i) & 1) << count;
+            if (++count == 8) {
+                out.push_back(static_cast<unsigned char>(bits));
+                bits = 0;
+                count = 0;
+            }
+        }
+    }
+
+    void put_code(unsigned int code, int len) {
+        for (int i = len - 1; i >= 0; i--) {
+            put((code >> i) & 1, 1);
+        }
+    }
+
+    void flush() {
+        if (count) {
+            out.push_back(static_cast<unsigned char>(bits));
+            bits = 0;
+            count = 0;
+        }
+    }
+
+private:
+    CheckData::Bytes& out;
+    unsigned int bits;
+    int count;
+};
+
+static void put32be(CheckData::Bytes& data, unsigned int v) {
+    data.push_back((v >> 24) & 0xff);
+    data.push_back((v >> 16) & 0xff);
+    data.push_back((v >> 8) & 0xff);
+    data.push_back(v & 0xff);
+}
+
+static void put16le(CheckData::Bytes& data, unsigned int v) {
+    data.push_back(v & 0xff);
+    data.push_back((v >> 8) & 0xff);
+}
+
+static void put32le(CheckData::Bytes& data, unsigned int v) {
+    put16le(data, v & 0xffff);
+    put16le(data, (v >> 16) & 0xffff);
+}
+
+static void add_chunk(CheckData::Bytes& png, const char *type, const CheckData::Bytes& data) {
+    put32be(png, static_cast<unsigned int>(data.size()));
+    size_t ofs = png.size();
+    png.insert(png.end(), type, type + 4);
+    png.insert(png.end(), data.begin(), data.end());
+    uLong crc = crc32(0, &png[ofs], static_cast<uInt>(png.size() - ofs));
+    put32be(png, static_cast<unsigned int>(crc));
+}
+
+void CheckData::deflate(const Bytes& data, Bytes& out) {
+    BitWriter writer(out);
+
+    /* one final block with the fixed codes */
+    writer.put(1, 1);
+    writer.put(1, 2);
+    for (Bytes::const_iterator it = data.begin(); it != data.end(); it++) {
+        unsigned int v = *it;
+        if (v < 144) {
+            writer.put_code(0x30 + v, 8);
+        } else {
+            writer.put_code(0x190 + v - 144, 9);
+        }
+    }
+    writer.put_code(0, 7);
+    writer.flush();
+}
+
+void CheckData::create_png(Bytes& png, int width, int height, ColorType color_type,
+    bool transparent)
+{
+    int bytes_per_pixel = (color_type == ColorTypeRGBA ? 4 : (color_type == ColorTypeRGB ? 3 : 1));
+
+    png.assign(PNGSignature, PNGSignature + sizeof PNGSignature);
+
+    Bytes ihdr;
+    put32be(ihdr, width);
+    put32be(ihdr, height);
+    ihdr.push_back(8);
+    ihdr.push_back(static_cast<unsigned char>(color_type));
+    ihdr.push_back(0);
+    ihdr.push_back(0);
+    ihdr.push_back(0);
+    add_chunk(png, "IHDR", ihdr);
+
+    if (color_type == ColorTypePalette) {
+        Bytes plte;
+        for (int i = 0; i < PaletteEntries; i++) {
+            plte.push_back(static_cast<unsigned char>(i * 60));
+            plte.push_back(static_cast<unsigned char>(255 - i * 60));
+            plte.push_back(static_cast<unsigned char>(i * 20));
+        }
+        add_chunk(png, "PLTE", plte);
+        if (transparent) {
+            Bytes trns;
+            trns.push_back(0);
+            add_chunk(png, "tRNS", trns);
+        }
+    }
+
+    /* every row starts with filter type none */
+    Bytes raw;
+    for (int y = 0; y < height; y++) {
+        raw.push_back(0);
+        for (int x = 0; x < width; x++) {
+            for (int i = 0; i < bytes_per_pixel; i++) {
+                if (color_type == ColorTypePalette) {
+                    raw.push_back(static_cast<unsigned char>((x / 8 + y / 8) % PaletteEntries));
+                } else {
+                    raw.push_back(static_cast<unsigned char>(x * 7 + y * 3 + i * 50));
+                }
+            }
+        }
+    }
+
+    Bytes idat;
+    idat.push_back(0x78);
+    idat.push_back(0x01);
+    deflate(raw, idat);
+    put32be(idat, static_cast<unsigned int>(adler32(adler32(0, 0, 0), &raw[0], static_cast<uInt>(raw.size()))));
+    add_chunk(png, "IDAT", idat);
+    add_chunk(png, "IEND", Bytes());
+}
+
+void CheckData::write_file(const std::string& filename, const Bytes& data) throw (CheckDataException) {
+    FILE *f = fopen(filename.c_str(), "wb");
+    if (!f) {
+        throw CheckDataException("Cannot write " + filename);
+    }
+    size_t written = (data.size() ? fwrite(&data[0], 1, data.size(), f) : 0);
+    fclose(f);
+    if (written != data.size()) {
+        remove(filename.c_str());
+        throw CheckDataException("Cannot write " + filename);
+    }
+}
+
+void CheckData::write_file(const std::string& filename, const std::string& text) throw (CheckDataException) {
+    write_file(filename, Bytes(text.begin(), text.end()));
+}
+
+void CheckData::write_pak(const std::string& filename, const PakEntries& entries) throw (CheckDataException) {
+    Bytes data;
+    Bytes central;
+    for (PakEntries::const_iterator it = entries.begin(); it != entries.end(); it++) {
+        const PakEntry& entry = *it;
+        Bytes stored;
+        if (entry.deflated) {
+            deflate(entry.data, stored);
+        } else {
+            stored = entry.data;
+        }
+        const Bytes& content = stored;
+        unsigned int len = static_cast<unsigned int>(entry.name.length());
+        unsigned int ofs = static_cast<unsigned int>(data.size());
+        unsigned int method = (entry.deflated ? 8 : 0);
+        unsigned int crc = static_cast<unsigned int>(crc32(0, (entry.data.size() ? &entry.data[0] : 0),
+            static_cast<uInt>(entry.data.size())));
+
+        put32le(data, 0x04034b50);
+        put16le(data, 20);
+        put16le(data, 0);
+        put16le(data, method);
+        put32le(data, 0);
+        put32le(data, crc);
+        put32le(data, static_cast<unsigned int>(content.size()));
+        put32le(data, static_cast<unsigned int>(entry.data.size()));
+        put16le(data, len);
+        put16le(data, 0);
+        data.insert(data.end(), entry.name.begin(), entry.name.end());
+        data.insert(data.end(), content.begin(), content.end());
+
+        put32le(central, 0x02014b50);
+        put16le(central, 20);
+        put16le(central, 20);
+        put16le(central, 0);
+        put16le(central, method);
+        put32le(central, 0);
+        put32le(central, crc);
+        put32le(central, static_cast<unsigned int>(content.size()));
+        put32le(central, static_cast<unsigned int>(entry.data.size()));
+        put16le(central, len);
+        put16le(central, 0);
+        put16le(central, 0);
+        put16le(central, 0);
+        put16le(central, 0);
+        put32le(central, 0);
+        put32le(central, ofs);
+        central.insert(central.end(), entry.name.begin(), entry.name.end());
+    }
+    unsigned int central_ofs = static_cast<unsigned int>(data.size());
+    data.insert(data.end(), central.begin(), central.end());
+    put32le(data, 0x06054b50);
+    put16le(data, 0);
+    put16le(data, 0);
+    put16le(data, static_cast<unsigned int>(entries.size()));
+    put16le(data, static_cast<unsigned int>(entries.size()));
+    put32le(data, static_cast<unsigned int>(central.size()));
+    put32le(data, central_ofs);
+    put16le(data, 0);
+
+    write_file(filename, data);
+}
+
+void CheckData::create_game_data(TemporaryDirectory& dir) throw (CheckDataException) {
+    for (size_t i = 0; i < sizeof(TournamentIcons) / sizeof(const char *); i++) {
+        std::string name(TournamentIcons[i]);
+        dir.add_file("icons/" + name + ".icon", "name=" + name + "\n");
+        dir.add_png("icons/" + name + ".png", 16, 16);
+    }
+
+    dir.add_file("animations/player_afk.animation", "name=player_afk\nwidth=16\nheight=16\nspeed=10\n");
+    dir.add_png("animations/player_afk.png", 16, 16);
+
+    /* font description: magic, height and the rectangle of each glyph */
+    Bytes fds;
+    const char *magic = "FNT1";
+    fds.insert(fds.end(), magic, magic + 4);
+    for (int i = 0; i < 1 + NumOfChars * 4; i++) {
+        int v = (i ? ((i - 1) % 4 < 2 ? 0 : 4) : 4);
+        fds.push_back(0);
+        fds.push_back(0);
+        fds.push_back(0);
+        fds.push_back(static_cast<unsigned char>(v));
+    }
+    dir.add_file("fonts/normal.font", "name=normal\n");
+    dir.add_file("fonts/normal.fds", fds);
+    dir.add_png("fonts/normal.png", 16, 16);
+
+    /* every mode fires the same weapons */
+    for (size_t i = 0; i < sizeof(GameSettings) / sizeof(const char *); i++) {
+        std::string name(GameSettings[i]);
+        dir.add_file("game/" + name + ".game", "name=" + name +
+            "\nshot=shot\ngrenade=grenade\nbomb=bomb\nfrog=frog\n");
+    }
+    dir.add_file("animations/shot.animation", "name=shot\nwidth=16\nheight=16\nspeed=10\n"
+        "duration=60\nprojectile=1\nimpact=8\ndamage=10\nspread=8\nphysics=1\n"
+        "physics_colbox_x=4\nphysics_colbox_y=4\nphysics_colbox_width=8\nphysics_colbox_height=8\n");
+    dir.add_png("animations/shot.png", 16, 16);
+    dir.add_file("animations/grenade.animation", "name=grenade\nwidth=16\nheight=16\nspeed=10\n"
+        "duration=120\nimpact=2\nspringiness=0.5\ndamage=40\nspread=32\nphysics=1\n"
+        "physics_colbox_x=4\nphysics_colbox_y=4\nphysics_colbox_width=8\nphysics_colbox_height=8\n");
+    dir.add_png("animations/grenade.png", 16, 16);
+    dir.add_file("animations/bomb.animation", "name=bomb\nwidth=16\nheight=16\nspeed=10\n"
+        "duration=180\nimpact=1\ndamage=60\nspread=48\nphysics=1\n"
+        "physics_colbox_x=2\nphysics_colbox_y=2\nphysics_colbox_width=12\nphysics_colbox_height=12\n");
+    dir.add_png("animations/bomb.png", 16, 16);
+
+    dir.add_file("npcs/frog.npc", "name=frog\nwidth=16\nheight=16\nimpact=1.5\n"
+        "colbox_x=2\ncolbox_y=0\ncolbox_width=12\ncolbox_height=12\n"
+        "damage_colbox_x=2\ndamage_colbox_y=0\ndamage_colbox_width=12\ndamage_colbox_height=12\n");
+    for (size_t i = 0; i < sizeof(NPCAnimations) / sizeof(const char *); i++) {
+        dir.add_png(std::string("npcs/frog_") + NPCAnimations[i] + ".png", 16, 16);
+    }
+
+    dir.add_file("backgrounds/check.background", "name=check\n");
+    dir.add_png("backgrounds/check.png", 16, 16);
+
+    dir.add_file("charactersets/goat.characterset", "name=goat\nwidth=32\nheight=32\n"
+        "colbox_x=8\ncolbox_y=0\ncolbox_width=16\ncolbox_height=28\n"
+        "damage_colbox_x=8\ndamage_colbox_y=0\ndamage_colbox_width=16\ndamage_colbox_height=28\n");
+    for (size_t i = 0; i < sizeof(CharactersetAnimations) / sizeof(const char *); i++) {
+        std::string name = std::string("charactersets/goat_") + CharactersetAnimations[i];
+        dir.add_png(name + ".png", 32, 32);
+        dir.add_png(name + "_armor_overlay.png", 32, 32);
+        dir.add_png(name + "_overlay.png", 32, 32);
+    }
+
+    for (size_t i = 0; i < sizeof(Objects) / sizeof(ObjectData); i++) {
+        const ObjectData& object = Objects[i];
+        char text[256];
+        sprintf(text, "name=%s\ntype=%d\nwidth=16\nheight=16\n"
+            "colbox_x=0\ncolbox_y=0\ncolbox_width=16\ncolbox_height=16\n",
+            object.name, static_cast<int>(object.type));
+        dir.add_file(std::string("objects/") + object.name + ".object", text);
+        dir.add_png(std::string("objects/") + object.name + ".png", 16, 16);
+    }
+}
+
+CheckData::TemporaryDirectory::TemporaryDirectory() throw (CheckDataException) {
+    char tmpl[] = "/tmp/goatattack-check-XXXXXX";
+    if (!mkdtemp(tmpl)) {
+        throw CheckDataException("Cannot create temporary directory");
+    }
+    path = tmpl;
+}
+
+CheckData::TemporaryDirectory::~TemporaryDirectory() {
+    for (Paths::reverse_iterator it = files.rbegin(); it != files.rend(); it++) {
+        remove(it->c_str());
+    }
+    for (Paths::reverse_iterator it = directories.rbegin(); it != directories.rend(); it++) {
+        rmdir(it->c_str());
+    }
+    rmdir(path.c_str());
+}
+
+const std::string& CheckData::TemporaryDirectory::get_path() const {
+    return path;
+}
+
+void CheckData::TemporaryDirectory::add_file(const std::string& name, const Bytes& data) throw (CheckDataException) {
+    write_file(prepare(name), data);
+}
+
+void CheckData::TemporaryDirectory::add_file(const std::string& name, const std::string& text) throw (CheckDataException) {
+    write_file(prepare(name), text);
+}
+
+void CheckData::TemporaryDirectory::add_pak(const std::string& name, const PakEntries& entries) throw (CheckDataException) {
+    write_pak(prepare(name), entries);
+}
+
+void CheckData::TemporaryDirectory::add_png(const std::string& name, int width, int height) throw (CheckDataException) {
+    Bytes png;
+    create_png(png, width, height, ColorTypeRGBA, false);
+    add_file(name, png);
+}
+
+std::string CheckData::TemporaryDirectory::prepare(const std::string& name) throw (CheckDataException) {
+    size_t pos = 0;
+    while ((pos = name.find('/', pos)) != std::string::npos) {
+        std::string dir = path + "/" + name.substr(0, pos++);
+        if (std::find(directories.begin(), directories.end(), dir) == directories.end()) {
+            if (mkdir(dir.c_str(), 0700)) {
+                throw CheckDataException("Cannot create directory " + dir);
+            }
+            directories.push_back(dir);
+        }
+    }
+    std::string filename = path + "/" + name;
+    files.push_back(filename);
+
+    return filename;
+}
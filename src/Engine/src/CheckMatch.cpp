@@ -0,0 +1,246 @@
+#include "CheckMatch.hpp"
+
+#include <sstream>
+#include <cstdio>
+
+static const char *ArenaName = "arena";
+static const int ArenaWidth = 40;
+static const int ArenaHeight = 16;
+static const int ArenaTileSize = 16;
+
+/* tile rectangles "x0,y0,x1,y1" of the falling only platforms */
+static const char *ArenaPlatforms[] = { "8,11,15,11", "24,11,31,11", "16,7,23,7", 0 };
+
+struct ArenaObject {
+    const char *name;
+    int x;
+    int y;
+};
+
+static const ArenaObject ArenaObjects[] = {
+    { "spawn", 2, 14 },
+    { "spawn", 12, 10 },
+    { "spawn_blue", 37, 14 },
+    { "spawn_blue", 27, 10 },
+    { "red_flag", 5, 14 },
+    { "blue_flag", 34, 14 },
+    { "coin", 20, 6 }
+};
+
+static const int ArenaObjectCount = sizeof(ArenaObjects) / sizeof(ArenaObject);
+
+void CheckMatch::create_data(CheckData::TemporaryDirectory& dir) throw (CheckDataException) {
+    CheckData::create_game_data(dir);
+
+    std::ostringstream tileset;
+    tileset << "name=" << ArenaName << "\nwidth=" << ArenaTileSize << "\nheight=" << ArenaTileSize
+        << "\ntiletype0=" << Tile::TileTypeBlocking << "\ntiletype1=" << Tile::TileTypeFallingOnlyBlocking << "\n";
+    dir.add_file(std::string("tilesets/") + ArenaName + ".tileset", tileset.str());
+    dir.add_png(std::string("tilesets/") + ArenaName + ".png", ArenaTileSize, ArenaTileSize * 2);
+
+    /* walls left and right, a floor and the platforms */
+    int tiles[ArenaHeight][ArenaWidth];
+    for (int y = 0; y < ArenaHeight; y++) {
+        for (int x = 0; x < ArenaWidth; x++) {
+            bool wall = (!x || x == ArenaWidth - 1 || y == ArenaHeight - 1);
+            tiles[y][x] = (wall ? 0 : -1);
+        }
+    }
+    for (const char **platform = ArenaPlatforms; *platform; platform++) {
+        int x0, y0, x1, y1;
+        sscanf(*platform, "%d,%d,%d,%d", &x0, &y0, &x1, &y1);
+        for (int y = y0; y <= y1; y++) {
+            for (int x = x0; x <= x1; x++) {
+                tiles[y][x] = 1;
+            }
+        }
+    }
+
+    std::ostringstream map;
+    map << "name=" << ArenaName << "\ntileset=" << ArenaName << "\nbackground=check\n";
+    map << "width=" << ArenaWidth << "\nheight=" << ArenaHeight << "\ngame_play_type=0\n";
+    map << "objects=" << ArenaObjectCount << "\n";
+    for (int i = 0; i < ArenaObjectCount; i++) {
+        const ArenaObject& object = ArenaObjects[i];
+        map << "object_name" << i << "=" << object.name << "\nobject_x" << i << "=" << object.x
+            << "\nobject_y" << i << "=" << object.y << "\n";
+    }
+    for (int y = 0; y < ArenaHeight; y++) {
+        map << "tiles" << y << "=";
+        for (int x = 0; x < ArenaWidth; x++) {
+            map << (x ? "," : "") << tiles[y][x];
+        }
+        map << "\ndecoration" << y << "=";
+        for (int x = 0; x < ArenaWidth; x++) {
+            map << (x ? "," : "") << -1;
+        }
+        map << "\n";
+    }
+    dir.add_file(std::string("maps/") + ArenaName + ".map", map.str());
+}
+
+CheckMatch::CheckMatch(Resources& resources, TournamentFactory& factory, GamePlayType type,
+    int player_count, int npc_count, int projectile_count) throw (Exception)
+    : config(type, ArenaName, 10, 0), tournament(0), npc_count(npc_count),
+      projectile_count(projectile_count), tick(0), next_shooter(0)
+{
+    /* the ids as a server hands them out */
+    factory.get_resource_ids().assign();
+    try {
+        for (int i = 0; i < player_count; i++) {
+            char name[32];
+            sprintf(name, "goat%d", i + 1);
+            players.push_back(new Player(resources, 0, static_cast<player_id_t>(i + 1), name, "goat"));
+        }
+
+        tournament = factory.create_tournament(config, true, false, players, 0);
+        tournament->set_team_names("team red", "team blue");
+        size_t sz = players.size();
+        for (size_t i = 0; i < sz; i++) {
+            Player *p = players[i];
+            tournament->player_added(p);
+            p->client_synced = true;
+            tournament->player_joins(p, (i % 2 ? 0 : PlayerServerFlagTeamRed));
+            respawn_player(p);
+        }
+        tournament->delete_responses();
+    } catch (...) {
+        cleanup();
+        throw;
+    }
+}
+
+CheckMatch::~CheckMatch() {
+    cleanup();
+}
+
+Tournament *CheckMatch::get_tournament() const {
+    return tournament;
+}
+
+const MapConfiguration& CheckMatch::get_config() const {
+    return config;
+}
+
+Players& CheckMatch::get_players() {
+    return players;
+}
+
+void CheckMatch::run(int ticks) {
+    for (int i = 0; i < ticks; i++) {
+        script_players();
+        top_up();
+        tournament->update_states(TickNS);
+        tournament->delete_responses();
+        tick++;
+    }
+}
+
+bool CheckMatch::pick(Player *p, Object::ObjectType type) {
+    Tournament::GameObjects& objects = tournament->get_game_objects();
+    for (Tournament::GameObjects::iterator it = objects.begin(); it != objects.end(); it++) {
+        GameObject *obj = &*it;
+        if (obj->object->get_type() == type) {
+            if (!p->is_alive_and_playing()) {
+                respawn_player(p);
+            }
+            const CollisionBox& colbox = p->get_characterset()->get_colbox();
+            int height = obj->object->get_tile()->get_tilegraphic()->get_height();
+            p->state.client_server_state.x = obj->state.x - colbox.x;
+            p->state.client_server_state.y = obj->state.y + height - 1;
+            p->state.client_server_state.accel_x = 0.0f;
+            p->state.client_server_state.accel_y = 0.0f;
+            p->state.client_server_state.key_states = 0;
+            tournament->update_states(TickNS);
+            tournament->delete_responses();
+            tick++;
+
+            return obj->picked;
+        }
+    }
+
+    return false;
+}
+
+void CheckMatch::cleanup() {
+    delete tournament;
+    tournament = 0;
+    for (Players::iterator it = players.begin(); it != players.end(); it++) {
+        delete *it;
+    }
+    players.clear();
+}
+
+void CheckMatch::respawn_player(Player *p) {
+    p->state.server_state.flags &= PlayerServerFlagTeamRed;
+    p->zero();
+    tournament->spawn_player(p);
+}
+
+void CheckMatch::script_players() {
+    size_t sz = players.size();
+    for (size_t i = 0; i < sz; i++) {
+        Player *p = players[i];
+        if (!p->is_alive_and_playing()) {
+            respawn_player(p);
+        }
+
+        /* run back and forth and jump once a second */
+        int t = tick + static_cast<int>(i) * 37;
+        keystates_t keys = ((t % 240) < 120 ? PlayerKeyStateRight : PlayerKeyStateLeft);
+        if (t % 60 < 8) {
+            keys |= PlayerKeyStateJump;
+        }
+        p->state.client_server_state.key_states = keys;
+    }
+}
+
+void CheckMatch::top_up() {
+    size_t sz = players.size();
+
+    Tournament::SpawnableNPCs& npcs = tournament->get_spawnable_npcs();
+    for (size_t i = 0; i < sz && static_cast<int>(npcs.size()) < npc_count; i++) {
+        Player *p = next_alive_player();
+        if (p) {
+            p->state.server_state.frogs = 1;
+            tournament->fire_frog(p, p->state.client_server_state.direction);
+        }
+    }
+
+    /* cycle through shots, grenades and bombs */
+    Tournament::GameAnimations& animations = tournament->get_game_animations();
+    for (size_t i = 0; i < sz && static_cast<int>(animations.size()) < projectile_count; i++) {
+        Player *p = next_alive_player();
+        if (p) {
+            unsigned char direction = p->state.client_server_state.direction;
+            switch (next_shooter % 3) {
+                case 0:
+                    p->state.server_state.ammo = 1;
+                    tournament->fire_shot(p, direction);
+                    break;
+
+                case 1:
+                    p->state.server_state.grenades = 1;
+                    tournament->fire_grenade(p, direction);
+                    break;
+
+                case 2:
+                    p->state.server_state.bombs = 1;
+                    tournament->fire_bomb(p, direction);
+                    break;
+            }
+        }
+    }
+}
+
+Player *CheckMatch::next_alive_player() {
+    size_t sz = players.size();
+    for (size_t i = 0; i < sz; i++) {
+        Player *p = players[next_shooter++ % sz];
+        if (p->is_alive_and_playing()) {
+            return p;
+        }
+    }
+
+    return 0;
+}
@@ -0,0 +1,229 @@
+#include "Checkpoint.hpp"
+#include "CRC64.hpp"
+
+#include <fstream>
+#include <cstdio>
+#include <cstring>
+#include <cerrno>
+
+static const char *CheckpointMagic = "GACP";
+static const size_t CheckpointMagicLength = 4;
+
+Checkpoint::Checkpoint() : pos(0) { }
+
+Checkpoint::~Checkpoint() { }
+
+void Checkpoint::load(const std::string& filename) throw (CheckpointException) {
+    std::ifstream f(filename.c_str(), std::ifstream::in | std::ifstream::binary);
+    if (!f.is_open()) {
+        throw CheckpointException("Can't open checkpoint " + filename);
+    }
+
+    char magic[CheckpointMagicLength];
+    unsigned char header[16];
+    if (!f.read(magic, CheckpointMagicLength) || memcmp(magic, CheckpointMagic, CheckpointMagicLength) ||
+        !f.read(reinterpret_cast<char *>(header), sizeof(header)))
+    {
+        throw CheckpointException("Not a checkpoint: " + filename);
+    }
+
+    /* header is version, payload length and crc */
+    data.assign(header, header + sizeof(header));
+    pos = 0;
+    uint32_t version = read_u32();
+    uint32_t len = read_u32();
+    uint64_t crc = read_u64();
+    if (version != Version) {
+        throw CheckpointException("Unsupported checkpoint version: " + filename);
+    }
+
+    data.resize(len);
+    pos = 0;
+    if (len && !f.read(reinterpret_cast<char *>(&data[0]), len)) {
+        throw CheckpointException("Truncated checkpoint: " + filename);
+    }
+    if (get_hash() != crc) {
+        throw CheckpointException("Corrupt checkpoint: " + filename);
+    }
+}
+
+void Checkpoint::save(const std::string& filename) throw (CheckpointException) {
+    Checkpoint header;
+    header.write_u32(Version);
+    header.write_u32(static_cast<uint32_t>(data.size()));
+    header.write_u64(get_hash());
+
+    /* write aside and rename, a crash never leaves half a checkpoint */
+    std::string tmp_filename(filename + ".tmp");
+    {
+        std::ofstream f(tmp_filename.c_str(), std::ofstream::out | std::ofstream::binary | std::ofstream::trunc);
+        if (!f.is_open()) {
+            throw CheckpointException("Can't create checkpoint " + tmp_filename + " (" + strerror(errno) + ")");
+        }
+        f.write(CheckpointMagic, CheckpointMagicLength);
+        f.write(reinterpret_cast<const char *>(&header.data[0]), header.data.size());
+        if (data.size()) {
+            f.write(reinterpret_cast<const char *>(&data[0]), data.size());
+        }
+        f.close();
+        if (!f) {
+            throw CheckpointException("Write failed: " + tmp_filename);
+        }
+    }
+
+    remove(filename.c_str());
+    if (rename(tmp_filename.c_str(), filename.c_str())) {
+        throw CheckpointException("Can't rename checkpoint to " + filename + " (" + strerror(errno) + ")");
+    }
+}
+
+void Checkpoint::rewind() {
+    pos = 0;
+}
+
+void Checkpoint::clear() {
+    data.clear();
+    pos = 0;
+}
+
+bool Checkpoint::at_end() const {
+    return (pos >= data.size());
+}
+
+uint64_t Checkpoint::get_hash() const {
+    CRC64 crc;
+    if (data.size()) {
+        crc.process(&data[0], data.size());
+    }
+
+    return crc.get_crc();
+}
+
+size_t Checkpoint::get_size() const {
+    return data.size();
+}
+
+const unsigned char *Checkpoint::get_data() const {
+    return (data.size() ? &data[0] : 0);
+}
+
+void Checkpoint::assign(const void *data, size_t len) {
+    const unsigned char *p = static_cast<const unsigned char *>(data);
+    this->data.assign(p, p + len);
+    pos = 0;
+}
+
+void Checkpoint::write_u8(unsigned char value) {
+    data.push_back(value);
+}
+
+void Checkpoint::write_u16(uint16_t value) {
+    data.push_back(value & 0xff);
+    data.push_back((value >> 8) & 0xff);
+}
+
+void Checkpoint::write_u32(uint32_t value) {
+    write_u16(value & 0xffff);
+    write_u16((value >> 16) & 0xffff);
+}
+
+void Checkpoint::write_u64(uint64_t value) {
+    write_u32(static_cast<uint32_t>(value & 0xffffffff));
+    write_u32(static_cast<uint32_t>(value >> 32));
+}
+
+void Checkpoint::write_bool(bool value) {
+    write_u8(value ? 1 : 0);
+}
+
+void Checkpoint::write_float(float value) {
+    write_data(&value, sizeof(value));
+}
+
+void Checkpoint::write_double(double value) {
+    write_data(&value, sizeof(value));
+}
+
+void Checkpoint::write_string(const std::string& value) {
+    size_t len = value.length();
+    if (len > 0xffff) {
+        len = 0xffff;
+    }
+    write_u16(static_cast<uint16_t>(len));
+    write_data(value.data(), len);
+}
+
+void Checkpoint::write_data(const void *data, size_t len) {
+    const unsigned char *p = static_cast<const unsigned char *>(data);
+    this->data.insert(this->data.end(), p, p + len);
+}
+
+unsigned char Checkpoint::read_u8() throw (CheckpointException) {
+    unsigned char value;
+    read_data(&value, 1);
+
+    return value;
+}
+
+uint16_t Checkpoint::read_u16() throw (CheckpointException) {
+    uint16_t lo = read_u8();
+    uint16_t hi = read_u8();
+
+    return static_cast<uint16_t>(lo | (hi << 8));
+}
+
+uint32_t Checkpoint::read_u32() throw (CheckpointException) {
+    uint32_t lo = read_u16();
+    uint32_t hi = read_u16();
+
+    return lo | (hi << 16);
+}
+
+uint64_t Checkpoint::read_u64() throw (CheckpointException) {
+    uint64_t lo = read_u32();
+    uint64_t hi = read_u32();
+
+    return lo | (hi << 32);
+}
+
+bool Checkpoint::read_bool() throw (CheckpointException) {
+    return (read_u8() != 0);
+}
+
+float Checkpoint::read_float() throw (CheckpointException) {
+    float value;
+    read_data(&value, sizeof(value));
+
+    return value;
+}
+
+double Checkpoint::read_double() throw (CheckpointException) {
+    double value;
+    read_data(&value, sizeof(value));
+
+    return value;
+}
+
+std::string Checkpoint::read_string() throw (CheckpointException) {
+    size_t len = read_u16();
+    if (!len) {
+        return std::string();
+    }
+    if (data.size() - pos < len) {
+        throw CheckpointException("Checkpoint ends too early");
+    }
+    std::string value(reinterpret_cast<const char *>(&data[0]) + pos, len);
+    pos += len;
+
+    return value;
+}
+
+void Checkpoint::read_data(void *data, size_t len) throw (CheckpointException) {
+    if (this->data.size() - pos < len) {
+        throw CheckpointException("Checkpoint ends too early");
+    }
+    if (len) {
+        memcpy(data, &this->data[pos], len);
+        pos += len;
+    }
+}
@@ -31,7 +31,9 @@ Client::Client(Resources& resources, Subsystem& subsystem, hostaddr_t host,
       logged_in(false), me(0), updatecnt(0),
       factory(resources, subsystem, this), my_id(0), login_sent(false),
       throw_exception(false), exception_msg(), force_send(false),
-      fhnd(0), running(true), reload_resources(true)
+      fhnd(0), running(true), reload_resources(true), preloader(0),
+      recorder(0), demo(0), demo_headless(false), demo_paused(false),
+      demo_speed(1.0f), demo_time(0), demo_frames(0), demo_messages(0)
 {
     conn = 0;
     get_now(last);
@@ -51,10 +53,39 @@ Client::Client(Resources& resources, Subsystem& subsystem, hostaddr_t host,
     }
     binding.extract_from_config(player_config);
 
+    /* record this match? */
+    if (player_config.get_bool("record_demos")) {
+        start_recording();
+    }
+
     /* start music player */
     subsystem.start_music_player(resources, *this);
 }
 
+Client::Client(Resources& resources, Subsystem& subsystem, Configuration& config,
+    const std::string& demo_filename, bool headless) throw (Exception)
+    : ClientServer(0, 0, "", ""),
+      Gui(resources, subsystem, resources.get_font("normal")),
+      OptionsMenu(*this, resources, subsystem, config, true),
+      resources(resources), subsystem(subsystem), player_config(config),
+      logged_in(false), me(0), updatecnt(0),
+      factory(resources, subsystem, this), my_id(0), login_sent(false),
+      throw_exception(false), exception_msg(), force_send(false),
+      fhnd(0), running(false), reload_resources(true), preloader(0),
+      recorder(0), demo(0), demo_headless(headless), demo_paused(false),
+      demo_speed(1.0f), demo_time(0), demo_frames(0), demo_messages(0)
+{
+    /* no connection, the messages come from the demo, nothing is sent */
+    conn = 0;
+    get_now(last);
+    demo = new DemoPlayer(demo_filename);
+    binding.extract_from_config(player_config);
+
+    if (!demo_headless) {
+        subsystem.start_music_player(resources, *this);
+    }
+}
+
 Client::~Client() {
     /* stop music player */
     subsystem.stop_music_player();
@@ -74,10 +105,23 @@ Client::~Client() {
     }
 
     /* cleanup */
+    if (preloader) {
+        delete preloader;
+    }
+
     for (Players::iterator it = players.begin(); it != players.end(); it++) {
         delete *it;
     }
 
+    /* close demo */
+    if (recorder) {
+        delete recorder;
+    }
+
+    if (demo) {
+        delete demo;
+    }
+
     /* close file if opened */
     if (fhnd) {
         fclose(fhnd);
@@ -136,6 +180,9 @@ void Client::idle() throw (Exception) {
             }
 
             case EventTypeData:
+                if (recorder) {
+                    record_message(DemoCodec::MessageKindServer, evt.data, evt.sz);
+                }
                 sevt_data(evt);
                 break;
         }
@@ -155,7 +202,9 @@ void Client::idle() throw (Exception) {
 
     last = now;
 
-    if (tournament) {
+    if (demo) {
+        play_demo(diff);
+    } else if (tournament) {
         tournament->update_states(diff);
         if (conn) {
             tournament->set_ping_time(conn->ping_time);
@@ -191,6 +240,9 @@ void Client::idle() throw (Exception) {
                 GPlayerClientServerState state;
                 state = me->state.client_server_state;
                 state.to_net();
+                if (recorder) {
+                    record_message(DemoCodec::MessageKindOwnState, &state, GPlayerClientServerStateLen);
+                }
                 {
                     Scope<Mutex> lock(mtx);
                     send_data(conn, factory.get_tournament_id(), GPSUpdatePlayerClientServerState, 0, GPlayerClientServerStateLen, &state);
@@ -249,6 +301,11 @@ void Client::idle() throw (Exception) {
     }
     subsystem.reset_color();
 
+    /* draw demo position */
+    if (demo && !demo_headless) {
+        draw_demo_status();
+    }
+
     /* draw file transfer status */
     if (fhnd) {
         Font *big = resources.get_font("big");
@@ -344,7 +401,33 @@ void Client::reset_key(MappedKey::Device dev, int param, MappedKey& key, int fla
 }
 
 void Client::on_input_event(const InputData& input) {
-    if (!are_options_visible()) {
+    if (demo && !are_options_visible()) {
+        switch (input.data_type) {
+            case InputData::InputDataTypeKeyDown:
+                if (!input.key_repeat) {
+                    demo_key(MappedKey::DeviceKeyboard, input.keycode, true);
+                    if (input.key_type == InputData::InputKeyTypeEscape) {
+                        show_options_menu();
+                    }
+                }
+                break;
+
+            case InputData::InputDataTypeKeyUp:
+                demo_key(MappedKey::DeviceKeyboard, input.keycode, false);
+                break;
+
+            case InputData::InputDataTypeJoyButtonDown:
+                demo_key(MappedKey::DeviceJoyButton, input.param1, true);
+                break;
+
+            case InputData::InputDataTypeJoyButtonUp:
+                demo_key(MappedKey::DeviceJoyButton, input.param1, false);
+                break;
+
+            default:
+                break;
+        }
+    } else if (!are_options_visible()) {
         switch (input.data_type) {
             case InputData::InputDataTypeKeyDown:
                 set_key(MappedKey::DeviceKeyboard, input.keycode);
@@ -402,7 +485,7 @@ void Client::options_closed() {
         memset(&pdesc, 0, GPlayerDescriptionLen);
         strncpy(pdesc.player_name, player_config.get_player_name().c_str(), NameLength - 1);
         strncpy(pdesc.characterset_name, player_config.get_player_skin().c_str(), NameLength - 1);
-        {
+        if (conn) {
             Scope<Mutex> lock(mtx);
             send_data(conn, factory.get_tournament_id(), GPSPlayerChanged, NetFlagsReliable, GPlayerDescriptionLen, &pdesc);
         }
@@ -0,0 +1,178 @@
+#include "Client.hpp"
+#include "Utils.hpp"
+
+#include <ctime>
+
+/* playback runs in frames of 1/60s, seeks in 10s, plays 1/4 to 16x */
+static const ns_t DemoFrame = 1000000000 / 60;
+static const ns_t DemoSeek = 10000000000LL;
+static const double DemoMinSpeed = 0.25f;
+static const double DemoMaxSpeed = 16.0f;
+
+size_t Client::get_demo_frames() const {
+    return demo_frames;
+}
+
+size_t Client::get_demo_messages() const {
+    return demo_messages;
+}
+
+void Client::start_recording() {
+    try {
+        std::string directory = get_home_directory() + dir_separator + UserDirectory;
+        create_directory("demos", directory);
+
+        char filename[64];
+        time_t t = time(0);
+        strftime(filename, sizeof(filename), "demo-%Y%m%d-%H%M%S.gad", localtime(&t));
+        recorder = new DemoRecorder(directory + dir_separator + "demos" + dir_separator + filename);
+        subsystem << "recording demo " << recorder->get_filename() << std::endl;
+    } catch (const Exception& e) {
+        subsystem << e.what() << std::endl;
+    }
+}
+
+void Client::record_message(DemoCodec::MessageKind kind, const void *data, size_t len) {
+    try {
+        recorder->record(kind, data, len);
+    } catch (const DemoException& e) {
+        add_text_msg(std::string(e.what()) + ", recording stopped");
+        delete recorder;
+        recorder = 0;
+    }
+}
+
+void Client::play_demo(ns_t diff) throw (Exception) {
+    if (demo_headless) {
+        /* as fast as it goes, one frame each time */
+        advance_demo(DemoFrame);
+        demo_frames++;
+        if (demo->at_end()) {
+            leave();
+        }
+    } else if (!demo_paused) {
+        advance_demo(static_cast<ns_t>(diff * demo_speed));
+        demo_frames++;
+    }
+}
+
+void Client::advance_demo(ns_t ns) throw (Exception) {
+    /* in frames, a fast forward plays like the match did */
+    while (ns > 0) {
+        ns_t step = (ns > DemoFrame ? DemoFrame : ns);
+        ns -= step;
+        demo_time += step;
+
+        while (!demo->at_end() && demo->get_next_time() <= demo_time / 1000000) {
+            DemoCodec::MessageKind kind;
+            size_t len;
+            unsigned char *data = demo->next(kind, len);
+            if (kind == DemoCodec::MessageKindServer && len >= GTransportLen) {
+                ServerEvent evt(EventTypeData, 0, reinterpret_cast<char *>(data), len);
+                sevt_data(evt);
+                demo_messages++;
+                if (throw_exception) {
+                    /* the server went down, that is where the demo ends */
+                    throw_exception = false;
+                    add_text_msg(exception_msg);
+                }
+            } else if (kind == DemoCodec::MessageKindOwnState && len == GPlayerClientServerStateLen) {
+                /* the recording player is shown like any other */
+                GPlayerClientServerState *state = reinterpret_cast<GPlayerClientServerState *>(data);
+                state->from_net();
+                for (Players::iterator it = players.begin(); it != players.end(); it++) {
+                    Player *p = *it;
+                    if (p->state.id == my_id) {
+                        p->state.client_server_state = *state;
+                        break;
+                    }
+                }
+            }
+        }
+
+        if (tournament) {
+            tournament->update_states(step);
+            Tournament::StateResponses& responses = tournament->get_state_responses();
+            size_t sz = responses.size();
+            for (size_t i = 0; i < sz; i++) {
+                StateResponse *resp = responses[i];
+                if (resp->action == GPCTextMessage) {
+                    std::string msg(reinterpret_cast<const char *>(resp->data), resp->len);
+                    add_text_msg(msg);
+                }
+            }
+            tournament->delete_responses();
+        }
+    }
+}
+
+void Client::seek_demo(ns_t ns) throw (Exception) {
+    ns_t end = static_cast<ns_t>(demo->get_duration()) * 1000000;
+    if (ns > end) {
+        ns = (demo_time > end ? demo_time : end);
+    }
+    if (ns < 0) {
+        ns = 0;
+    }
+
+    /* back means from the start, the match is played again up to there */
+    if (ns < demo_time) {
+        rewind_demo();
+    }
+    advance_demo(ns - demo_time);
+}
+
+void Client::rewind_demo() {
+    if (tournament) {
+        delete tournament;
+        tournament = 0;
+    }
+
+    for (Players::iterator it = players.begin(); it != players.end(); it++) {
+        delete *it;
+    }
+    players.clear();
+    me = 0;
+    my_id = 0;
+
+    demo->rewind();
+    demo_time = 0;
+}
+
+void Client::demo_key(MappedKey::Device dev, int param, bool down) {
+    if (binding.stats.device == dev && binding.stats.param == param) {
+        if (!get_stack_count() && tournament) {
+            tournament->show_stats(down);
+        }
+        return;
+    }
+
+    if (!down || get_stack_count()) {
+        return;
+    }
+
+    if (binding.escape.device == dev && binding.escape.param == param) {
+        show_options_menu();
+    } else if (binding.jump.device == dev && binding.jump.param == param) {
+        demo_paused = !demo_paused;
+    } else if (binding.right.device == dev && binding.right.param == param) {
+        seek_demo(demo_time + DemoSeek);
+    } else if (binding.left.device == dev && binding.left.param == param) {
+        seek_demo(demo_time - DemoSeek);
+    } else if (binding.up.device == dev && binding.up.param == param) {
+        demo_speed = (demo_speed * 2.0f > DemoMaxSpeed ? DemoMaxSpeed : demo_speed * 2.0f);
+    } else if (binding.down.device == dev && binding.down.param == param) {
+        demo_speed = (demo_speed / 2.0f < DemoMinSpeed ? DemoMinSpeed : demo_speed / 2.0f);
+    }
+}
+
+void Client::draw_demo_status() {
+    Font *font = resources.get_font("normal");
+    int pos = static_cast<int>(demo_time / 1000000000);
+    int len = static_cast<int>(demo->get_duration() / 1000);
+    sprintf(buffer, "demo %02d:%02d / %02d:%02d  %gx%s", pos / 60, pos % 60,
+        len / 60, len % 60, demo_speed, (demo_paused ? "  paused" : ""));
+    int tw = font->get_text_width(buffer);
+    subsystem.draw_text(font, subsystem.get_view_width() - tw - 5,
+        subsystem.get_view_height() - font->get_font_height() - 5, buffer);
+}
@@ -55,6 +55,8 @@ void Client::event_login(const Connection *c, data_len_t len, void *data) throw
 
 void Client::event_data(const Connection *c, data_len_t len, void *data) throw (Exception) {
     if (len) {
+        /* the receiver thread does not touch the players */
+        count_received(0, data, len);
         char *p = new char[len];
         memcpy(p, data, len);
         server_events.push(ServerEvent(EventTypeData, c, p, len));
@@ -165,8 +167,14 @@ void Client::sevt_data(ServerEvent& evt) {
 
                 /* reload resources? */
                 if (reload_resources) {
+                    /* the preloader reads the old resources */
+                    if (preloader) {
+                        delete preloader;
+                        preloader = 0;
+                    }
                     resources.reload_resources();
                     load_resources();
+                    factory.get_resource_ids().resolve();
                     reload_resources = false;
                 }
 
@@ -174,7 +182,11 @@ void Client::sevt_data(ServerEvent& evt) {
                 bool warmup = ((tour->flags & TournamentFlagWarmup) != 0);
                 GamePlayType type = static_cast<GamePlayType>(tour->gametype);
                 MapConfiguration config(type, tour->map_name, tour->duration, tour->warmup);
-                tournament = factory.create_tournament(config, false, warmup, players, 0);
+                tournament = factory.create_tournament(config, false, warmup, players, 0, preloader);
+                if (preloader) {
+                    delete preloader;
+                    preloader = 0;
+                }
                 factory.set_tournament_id(tour->tournament_id);
                 tournament->set_following_id(my_id);
                 tournament->set_player_configuration(&player_config);
@@ -222,7 +234,8 @@ void Client::sevt_data(ServerEvent& evt) {
                 p->state.client_server_state = info->client_server_state;
                 p->state.client_state = info->client_state;
 
-                if (p->state.id == my_id) {
+                /* a demo only shows the recording player */
+                if (p->state.id == my_id && !demo) {
                     me = p;
                     p->mark_as_me();
                 }
@@ -349,7 +362,7 @@ void Client::sevt_data(ServerEvent& evt) {
                         for (Tournament::GameObjects::iterator it = objects.begin();
                             it != objects.end(); it++)
                         {
-                            GameObject *obj = *it;
+                            GameObject *obj = &*it;
                             if (obj->state.id == state->id) {
                                 obj->state = *state;
                                 break;
@@ -370,7 +383,7 @@ void Client::sevt_data(ServerEvent& evt) {
                         for (Tournament::GameAnimations::iterator it = animations.begin();
                             it != animations.end(); it++)
                         {
-                            GameAnimation *ani = *it;
+                            GameAnimation *ani = &*it;
                             if (ani->state.id == state->id) {
                                 ani->state = *state;
                                 break;
@@ -391,7 +404,7 @@ void Client::sevt_data(ServerEvent& evt) {
                         for (Tournament::SpawnableNPCs::iterator it = spawnable_npcs.begin();
                             it != spawnable_npcs.end(); it++)
                         {
-                            SpawnableNPC *npc = *it;
+                            SpawnableNPC *npc = &*it;
                             if (npc->state.id == state->id) {
                                 npc->state = *state;
                                 break;
@@ -435,9 +448,10 @@ void Client::sevt_data(ServerEvent& evt) {
 
             case GPCPlaySound:
             {
-                GGenericName *name = reinterpret_cast<GGenericName *>(t->data);
+                GPlaySound *snd = reinterpret_cast<GPlaySound *>(t->data);
+                snd->from_net();
                 try {
-                    subsystem.play_sound(resources.get_sound(name->name), 0);
+                    subsystem.play_sound(factory.get_resource_ids().get_sound(snd->sound_id), 0);
                 } catch (...) {
                     /* chomp */
                 }
@@ -526,6 +540,38 @@ void Client::sevt_data(ServerEvent& evt) {
                 break;
             }
 
+            case GPCNextMap:
+            {
+                GNextMap *next = reinterpret_cast<GNextMap *>(t->data);
+                next->map_name[NameLength - 1] = 0;
+                if (preloader) {
+                    delete preloader;
+                    preloader = 0;
+                }
+
+                /* after a pak download the resources are reloaded first */
+                if (!reload_resources) {
+                    try {
+                        preloader = new MapPreloader(resources, next->map_name, true, 0);
+                    } catch (const ResourcesException&) {
+                        /* not in our paks yet, load it when it is played */
+                    }
+                }
+                break;
+            }
+
+            case GPCResourceId:
+            {
+                GResourceId *rid = reinterpret_cast<GResourceId *>(t->data);
+                rid->from_net();
+                rid->name[NameLength - 1] = 0;
+                if (rid->category < ResourceIds::_CategoryMAX) {
+                    factory.get_resource_ids().set(static_cast<ResourceIds::Category>(rid->category),
+                        rid->id, rid->name);
+                }
+                break;
+            }
+
             case GPCJoinAccepted:
             {
                 if (tournament) {
@@ -669,12 +715,17 @@ void Client::sevt_data(ServerEvent& evt) {
 
             case GPCXferHeader:
             {
+                if (demo) {
+                    break;
+                }
                 reload_resources = true;
                 GXferHeader *header = reinterpret_cast<GXferHeader *>(t->data);
                 header->from_net();
                 if (!fhnd) {
                     xfer_filename = header->filename;
                     current_download_filename = get_home_directory() + dir_separator + UserDirectory + dir_separator + header->filename;
+                    /* idle shared readers still hold the old pak open */
+                    ZipReader::close_unused();
                     fhnd = fopen(current_download_filename.c_str(), "wb");
                     if (fhnd) {
                         total_xfer_sz = remaining_xfer_sz = header->filesize;
@@ -689,6 +740,9 @@ void Client::sevt_data(ServerEvent& evt) {
 
             case GPCXferDataChunk:
             {
+                if (demo) {
+                    break;
+                }
                 GXferDataChunk *chunk = reinterpret_cast<GXferDataChunk *>(t->data);
                 chunk->from_net();
                 if (fhnd) {
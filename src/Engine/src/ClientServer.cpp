@@ -91,6 +91,8 @@ void ClientServer::stacked_broadcast_data_synced(unsigned char tournament_id, co
 void ClientServer::flush_stacked_send_data(const Connection *c, flags_t flags) throw (Exception) {
     if (packet_len) {
         push(c, flags, packet_len, gtrans);
+        count_sent(c, 0, flags, stacked_messages);
+        stacked_messages.clear();
         pb = gtrans;
         packet_len = 0;
     }
@@ -99,6 +101,9 @@ void ClientServer::flush_stacked_send_data(const Connection *c, flags_t flags) t
 void ClientServer::flush_stacked_broadcast_data(flags_t flags) throw (Exception) {
     if (packet_len) {
         broadcast(flags, packet_len, gtrans);
+        count_sent(players, flags, stacked_messages);
+        count_sent(relays, flags, stacked_messages);
+        stacked_messages.clear();
         pb = gtrans;
         packet_len = 0;
     }
@@ -106,12 +111,9 @@ void ClientServer::flush_stacked_broadcast_data(flags_t flags) throw (Exception)
 
 void ClientServer::flush_stacked_broadcast_data_synced(flags_t flags) throw (Exception) {
     if (packet_len) {
-        for (Players::iterator it = players.begin(); it != players.end(); it++) {
-            Player *p = *it;
-            if (p->client_synced) {
-                push(p->get_connection(), flags, packet_len, gtrans);
-            }
-        }
+        push_synced(players, flags, packet_len, stacked_messages);
+        push_synced(relays, flags, packet_len, stacked_messages);
+        stacked_messages.clear();
         pb = gtrans;
         packet_len = 0;
     }
@@ -130,6 +132,7 @@ void ClientServer::send_data(const Connection *c, unsigned char tournament_id,
         }
         gtrans->to_net();
         push(c, flags, GTransportLen + len, gtrans);
+        count_sent(c, 0, flags, cmd, len);
     }
 }
 
@@ -145,6 +148,10 @@ void ClientServer::broadcast_data(unsigned char tournament_id, command_t cmd,
     }
     gtrans->to_net();
     broadcast(flags, GTransportLen + len, gtrans);
+    single_message.clear();
+    single_message.push_back(Bandwidth::Message(cmd, GTransportLen + len));
+    count_sent(players, flags, single_message);
+    count_sent(relays, flags, single_message);
 }
 
 void ClientServer::broadcast_data_synced(unsigned char tournament_id, command_t cmd,
@@ -158,18 +165,20 @@ void ClientServer::broadcast_data_synced(unsigned char tournament_id, command_t
         memcpy(gtrans->data, data, len);
     }
     gtrans->to_net();
-    for (Players::iterator it = players.begin(); it != players.end(); it++) {
-        Player *p = *it;
-        if (p->client_synced) {
-            push(p->get_connection(), flags, GTransportLen + len, gtrans);
-        }
-    }
+    single_message.clear();
+    single_message.push_back(Bandwidth::Message(cmd, GTransportLen + len));
+    push_synced(players, flags, GTransportLen + len, single_message);
+    push_synced(relays, flags, GTransportLen + len, single_message);
 }
 
 hostport_t ClientServer::get_port() const {
     return port;
 }
 
+Bandwidth& ClientServer::get_bandwidth() {
+    return bandwidth;
+}
+
 void ClientServer::set_server(Server *server) {
     this->server = server;
 }
@@ -185,6 +194,42 @@ void ClientServer::reload_config(hostport_t port, pico_size_t num_players,
     server->reload_config();
 }
 
+void ClientServer::profile(const Connection *c, const std::string& params) throw (Exception) {
+    if (!server) {
+        throw Exception("No server, profiling failed");
+    }
+    server->profile(c, params);
+}
+
+void ClientServer::checkpoint(const Connection *c) throw (Exception) {
+    if (!server) {
+        throw Exception("No server, checkpoint failed");
+    }
+    server->checkpoint(c);
+}
+
+void ClientServer::bandwidth_report(const Connection *c, const std::string& params) throw (Exception) {
+    if (!server) {
+        throw Exception("No server, bandwidth report failed");
+    }
+    server->bandwidth_report(c, params);
+}
+
+void ClientServer::allocations(const Connection *c, const std::string& params) throw (Exception) {
+    if (!server) {
+        throw Exception("No server, allocation report failed");
+    }
+    server->allocations(c, params);
+}
+
+void ClientServer::count_received(Player *p, const void *data, size_t len) {
+    Bandwidth::Class cls = Bandwidth::get_class(get_incoming_flags());
+    bandwidth.count(Bandwidth::DirectionReceived, cls, data, len);
+    if (p) {
+        p->bandwidth.count(Bandwidth::DirectionReceived, cls, data, len);
+    }
+}
+
 void ClientServer::stack_data(unsigned char tournament_id, command_t cmd, data_len_t len, const void *data) {
     if (packet_len) {
         pb->flags |= TransportFlagMorePackets;
@@ -203,4 +248,62 @@ void ClientServer::stack_data(unsigned char tournament_id, command_t cmd, data_l
     pb->to_net();
 
     packet_len += GTransportLen + len;
+    stacked_messages.push_back(Bandwidth::Message(cmd, GTransportLen + len));
+}
+
+void ClientServer::count_sent(const Connection *c, Player *p, flags_t flags,
+    const Bandwidth::Datagram& datagram)
+{
+    Bandwidth::Class cls = Bandwidth::get_class(flags);
+    bandwidth.count(Bandwidth::DirectionSent, cls, datagram);
+    if (!p) {
+        p = find_player(c);
+    }
+    if (p) {
+        p->bandwidth.count(Bandwidth::DirectionSent, cls, datagram);
+    }
+}
+
+void ClientServer::count_sent(const Connection *c, Player *p, flags_t flags, command_t cmd, data_len_t len) {
+    single_message.clear();
+    single_message.push_back(Bandwidth::Message(cmd, GTransportLen + len));
+    count_sent(c, p, flags, single_message);
+}
+
+void ClientServer::count_sent(const Players& to, flags_t flags, const Bandwidth::Datagram& datagram) {
+    for (Players::const_iterator it = to.begin(); it != to.end(); it++) {
+        Player *p = *it;
+        if (p->get_connection()) {
+            count_sent(p->get_connection(), p, flags, datagram);
+        }
+    }
+}
+
+void ClientServer::push_synced(const Players& to, flags_t flags, data_len_t len,
+    const Bandwidth::Datagram& datagram) throw (Exception)
+{
+    for (Players::const_iterator it = to.begin(); it != to.end(); it++) {
+        Player *p = *it;
+        if (p->client_synced) {
+            push(p->get_connection(), flags, len, gtrans);
+            if (p->get_connection()) {
+                count_sent(p->get_connection(), p, flags, datagram);
+            }
+        }
+    }
+}
+
+Player *ClientServer::find_player(const Connection *c) {
+    for (Players::iterator it = players.begin(); it != players.end(); it++) {
+        if ((*it)->get_connection() == c) {
+            return *it;
+        }
+    }
+    for (Players::iterator it = relays.begin(); it != relays.end(); it++) {
+        if ((*it)->get_connection() == c) {
+            return *it;
+        }
+    }
+
+    return 0;
 }
@@ -0,0 +1,213 @@
+#include "Demo.hpp"
+
+#include <cstring>
+#include <cerrno>
+
+const char *DemoCodec::Magic = "GADM";
+
+/* time, kind, length and packed length */
+static const size_t DemoRecordHeaderLength = 9;
+
+static void put_u16(unsigned char *p, uint16_t value) {
+    p[0] = value & 0xff;
+    p[1] = (value >> 8) & 0xff;
+}
+
+static void put_u32(unsigned char *p, uint32_t value) {
+    put_u16(p, value & 0xffff);
+    put_u16(p + 2, (value >> 16) & 0xffff);
+}
+
+static uint16_t get_u16(const unsigned char *p) {
+    return static_cast<uint16_t>(p[0] | (p[1] << 8));
+}
+
+static uint32_t get_u32(const unsigned char *p) {
+    return get_u16(p) | (static_cast<uint32_t>(get_u16(p + 2)) << 16);
+}
+
+/* ----------------------------------------------------------------------- */
+/* recorder                                                                */
+/* ----------------------------------------------------------------------- */
+DemoRecorder::DemoRecorder(const std::string& filename) throw (DemoException)
+    : filename(filename)
+{
+    f.open(filename.c_str(), std::ofstream::out | std::ofstream::binary | std::ofstream::trunc);
+    if (!f.is_open()) {
+        throw DemoException("Can't create demo " + filename + " (" + strerror(errno) + ")");
+    }
+
+    unsigned char version[4];
+    put_u32(version, Version);
+    f.write(Magic, MagicLength);
+    f.write(reinterpret_cast<const char *>(version), sizeof(version));
+    get_now(start);
+}
+
+DemoRecorder::~DemoRecorder() {
+    f.close();
+}
+
+const std::string& DemoRecorder::get_filename() const {
+    return filename;
+}
+
+void DemoRecorder::record(MessageKind kind, const void *data, size_t len) throw (DemoException) {
+    if (len > 0xffff) {
+        return;
+    }
+
+    /* difference to the last message of this length */
+    const unsigned char *p = static_cast<const unsigned char *>(data);
+    Data& last = last_messages[len];
+    if (last.size() != len) {
+        last.assign(len, 0);
+    }
+
+    /* zeros as 0 and a count, everything else as it is */
+    packed.resize(DemoRecordHeaderLength);
+    size_t i = 0;
+    while (i < len) {
+        unsigned char c = p[i] ^ last[i];
+        if (c) {
+            packed.push_back(c);
+            i++;
+        } else {
+            size_t run = 0;
+            while (i < len && run < 255 && !(p[i] ^ last[i])) {
+                run++;
+                i++;
+            }
+            packed.push_back(0);
+            packed.push_back(static_cast<unsigned char>(run));
+        }
+    }
+    last.assign(p, p + len);
+
+    gametime_t now;
+    get_now(now);
+    put_u32(&packed[0], static_cast<uint32_t>(diff_ms(start, now)));
+    packed[4] = static_cast<unsigned char>(kind);
+    put_u16(&packed[5], static_cast<uint16_t>(len));
+    put_u16(&packed[7], static_cast<uint16_t>(packed.size() - DemoRecordHeaderLength));
+    f.write(reinterpret_cast<const char *>(&packed[0]), packed.size());
+    if (!f) {
+        throw DemoException("Write failed: " + filename);
+    }
+}
+
+/* ----------------------------------------------------------------------- */
+/* player                                                                  */
+/* ----------------------------------------------------------------------- */
+DemoPlayer::DemoPlayer(const std::string& filename) throw (DemoException)
+    : pos(0), message_count(0), duration(0)
+{
+    std::ifstream f(filename.c_str(), std::ifstream::in | std::ifstream::binary);
+    if (!f.is_open()) {
+        throw DemoException("Can't open demo " + filename);
+    }
+
+    char magic[MagicLength];
+    unsigned char version[4];
+    if (!f.read(magic, MagicLength) || memcmp(magic, Magic, MagicLength) ||
+        !f.read(reinterpret_cast<char *>(version), sizeof(version)))
+    {
+        throw DemoException("Not a demo: " + filename);
+    }
+    if (get_u32(version) != Version) {
+        throw DemoException("Unsupported demo version: " + filename);
+    }
+
+    /* the packed messages stay in memory, seeking back starts over */
+    char buffer[4096];
+    while (f.read(buffer, sizeof(buffer)) || f.gcount()) {
+        data.insert(data.end(), buffer, buffer + f.gcount());
+    }
+
+    /* a recording cut off by a crash ends with its last whole message */
+    size_t sz = data.size();
+    size_t p = 0;
+    while (sz - p >= DemoRecordHeaderLength) {
+        size_t packed_len = get_u16(&data[p + 7]);
+        if (sz - p - DemoRecordHeaderLength < packed_len) {
+            break;
+        }
+        duration = get_u32(&data[p]);
+        message_count++;
+        p += DemoRecordHeaderLength + packed_len;
+    }
+    data.resize(p);
+}
+
+DemoPlayer::~DemoPlayer() { }
+
+ms_t DemoPlayer::get_duration() const {
+    return duration;
+}
+
+size_t DemoPlayer::get_message_count() const {
+    return message_count;
+}
+
+void DemoPlayer::rewind() {
+    pos = 0;
+    last_messages.clear();
+}
+
+bool DemoPlayer::at_end() const {
+    return (pos >= data.size());
+}
+
+ms_t DemoPlayer::get_next_time() const {
+    return (at_end() ? duration : static_cast<ms_t>(get_u32(&data[pos])));
+}
+
+unsigned char *DemoPlayer::next(MessageKind& kind, size_t& len) throw (DemoException) {
+    if (at_end()) {
+        len = 0;
+        return 0;
+    }
+
+    unsigned char k = data[pos + 4];
+    if (k >= _MessageKindMAX) {
+        throw DemoException("Broken demo message");
+    }
+    kind = static_cast<MessageKind>(k);
+    len = get_u16(&data[pos + 5]);
+    size_t packed_len = get_u16(&data[pos + 7]);
+    const unsigned char *p = &data[pos + DemoRecordHeaderLength];
+    pos += DemoRecordHeaderLength + packed_len;
+
+    Data& last = last_messages[len];
+    if (last.size() != len) {
+        last.assign(len, 0);
+    }
+
+    size_t i = 0;
+    size_t j = 0;
+    while (j < packed_len) {
+        unsigned char c = p[j++];
+        if (c) {
+            if (i >= len) {
+                throw DemoException("Broken demo message");
+            }
+            last[i++] ^= c;
+        } else {
+            if (j >= packed_len) {
+                throw DemoException("Broken demo message");
+            }
+            i += p[j++];
+        }
+    }
+    if (i != len) {
+        throw DemoException("Broken demo message");
+    }
+
+    /* the client converts the message in place */
+    message = last;
+    if (!len) {
+        return 0;
+    }
+
+    return &message[0];
+}
@@ -0,0 +1,38 @@
+#include "DemoBenchmark.hpp"
+#include "Resources.hpp"
+#include "Client.hpp"
+#include "Configuration.hpp"
+#include "Globals.hpp"
+
+DemoBenchmark::DemoBenchmark(Subsystem& subsystem, const Parameters& parms) throw (BenchmarkException)
+    : Benchmark(subsystem, parms)
+{
+    if (!get_value("demo").length()) {
+        throw BenchmarkException("No demo given, use demo=<file>");
+    }
+}
+
+DemoBenchmark::~DemoBenchmark() { }
+
+int DemoBenchmark::run() throw (Exception) {
+    const std::string& filename = get_value("demo");
+    Resources resources(subsystem, get_value("data_directory"), Resources::LoadProfileServer);
+    Configuration config(UserDirectory, ConfigFilename);
+    Client client(resources, subsystem, config, filename, true);
+    gametime_t start;
+    gametime_t end;
+
+    get_now(start);
+    client.run();
+    get_now(end);
+
+    size_t frames = client.get_demo_frames();
+    ns_t ns_per_frame = (frames ? diff_ns(start, end) / static_cast<ns_t>(frames) : 0);
+    subsystem << "demo: file=" << filename << " frames=" << frames << " messages="
+        << client.get_demo_messages() << " ns/frame=" << ns_per_frame << std::endl;
+
+    set_result("demo_ns_per_frame", ns_per_frame);
+    save_results();
+
+    return 0;
+}
@@ -20,10 +20,14 @@ Game::Game(Resources& resources, Subsystem& subsystem)
 
 Game::~Game() { }
 
-void Game::run(const std::string& parm) {
+void Game::run(const Parameters& parms) {
 #ifdef DEDICATED_SERVER
-    Server server(resources, subsystem, parm);
-    server.start();
+    if (parms.size() > 1) {
+        run_servers(parms);
+    } else {
+        Server server(resources, subsystem, (parms.size() ? parms[0] : ""));
+        server.start();
+    }
 #else
     if (config.get_bool("fullscreen")) {
         subsystem.toggle_fullscreen();
@@ -35,7 +39,49 @@ void Game::run(const std::string& parm) {
     subsystem.set_deadzone_horizontal(config.get_int("deadzone_horizontal"));
     subsystem.set_deadzone_vertical(config.get_int("deadzone_vertical"));
 
+    /* a recorded match is played right away */
+    if (parms.size()) {
+        Client client(resources, subsystem, config, parms[0], false);
+        client.run();
+        return;
+    }
+
     MainMenu menu(resources, subsystem, config);
     menu.run();
 #endif
 }
+
+/* one server per config file, all of them share the resources and the
+   job system, the last one runs in the foreground */
+typedef std::vector<Server *> Servers;
+
+static void destroy_servers(Servers& servers, size_t threaded) {
+    for (size_t i = 0; i < servers.size(); i++) {
+        if (i < threaded) {
+            servers[i]->stop();
+        }
+        delete servers[i];
+    }
+    servers.clear();
+}
+
+void Game::run_servers(const Parameters& parms) {
+    JobSystem jobs(JobSystem::get_default_worker_count());
+    Servers servers;
+    size_t threaded = parms.size() - 1;
+    try {
+        for (Parameters::const_iterator it = parms.begin(); it != parms.end(); it++) {
+            subsystem << "hosting " << *it << std::endl;
+            servers.push_back(new Server(resources, subsystem, *it, &jobs));
+        }
+        for (size_t i = 0; i < threaded; i++) {
+            servers[i]->start_thread();
+        }
+        servers.back()->start();
+    } catch (...) {
+        destroy_servers(servers, threaded);
+        throw;
+    }
+
+    destroy_servers(servers, threaded);
+}
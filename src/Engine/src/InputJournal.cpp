@@ -0,0 +1,212 @@
+#include "InputJournal.hpp"
+#include "Tournament.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <ctime>
+
+static const char *InputJournalMagic = "GAIJ";
+static const size_t InputJournalMagicLength = 4;
+
+static bool ComparePlayerId(Player *lhs, Player *rhs) {
+    return (lhs->state.id < rhs->state.id);
+}
+
+InputJournal::InputJournal(const std::string& filename, Random& random)
+    throw (InputJournalException)
+    : random(random), tick_number(0), seed_state(0), broken(false)
+{
+    f.open(filename.c_str(), std::ofstream::out | std::ofstream::binary | std::ofstream::trunc);
+    if (!f.is_open()) {
+        throw InputJournalException("Can't create input journal " + filename);
+    }
+
+    Checkpoint header;
+    header.write_u32(Version);
+    f.write(InputJournalMagic, InputJournalMagicLength);
+    f.write(reinterpret_cast<const char *>(header.get_data()), header.get_size());
+
+    /* own seeds, the game keeps its randomness from run to run */
+    seed_state = static_cast<uint32_t>(time(0)) ^ static_cast<uint32_t>(reinterpret_cast<size_t>(this));
+    if (!seed_state) {
+        seed_state = 1;
+    }
+}
+
+InputJournal::~InputJournal() {
+    f.close();
+}
+
+bool InputJournal::is_broken() const {
+    return broken;
+}
+
+void InputJournal::tournament_started(const MapConfiguration& config, bool warmup,
+    bool switch_to_game, bool friendly_fire_alarm, const std::string& team_red,
+    const std::string& team_blue)
+{
+    payload.write_u8(static_cast<unsigned char>(config.type));
+    payload.write_string(config.map_name);
+    payload.write_u32(static_cast<uint32_t>(config.duration));
+    payload.write_u32(static_cast<uint32_t>(config.warmup_in_seconds));
+    payload.write_bool(warmup);
+    payload.write_bool(switch_to_game);
+    payload.write_bool(friendly_fire_alarm);
+    payload.write_string(team_red);
+    payload.write_string(team_blue);
+    write_record(RecordTypeTournament);
+}
+
+void InputJournal::player_added(Player *p, Players& players) {
+    /* the replay keeps the players in the order of the server */
+    player_id_t before_id = 0;
+    Players::iterator it = std::find(players.begin(), players.end(), p);
+    if (it != players.end()) {
+        for (it++; it != players.end(); it++) {
+            if ((*it)->client_synced) {
+                before_id = (*it)->state.id;
+                break;
+            }
+        }
+    }
+
+    GPlayerState state = p->state;
+    state.to_net();
+    payload.write_u16(p->state.id);
+    payload.write_u16(before_id);
+    payload.write_bool(p->bot);
+    payload.write_string(p->get_player_name());
+    payload.write_string(p->get_characterset()->get_name());
+    payload.write_data(&state, GPlayerStateLen);
+    write_record(RecordTypePlayerAdded);
+}
+
+void InputJournal::player_removed(Player *p) {
+    payload.write_u16(p->state.id);
+    write_record(RecordTypePlayerRemoved);
+}
+
+void InputJournal::input(Player *p, unsigned char cmd, const void *data, size_t len) {
+    payload.write_u16(p->state.id);
+    payload.write_u8(cmd);
+    payload.write_u16(static_cast<uint16_t>(len));
+    payload.write_data(data, len);
+    write_record(RecordTypeInput);
+}
+
+void InputJournal::tick(ns_t ns) {
+    tick_number++;
+    payload.write_u64(static_cast<uint64_t>(ns));
+    write_record(RecordTypeTick);
+}
+
+void InputJournal::tick_done(Tournament *tournament, Players& players) {
+    if (tick_number % HashInterval == 0) {
+        payload.write_u64(get_state_hash(tournament, players));
+        write_record(RecordTypeHash);
+        f.flush();
+        if (!f) {
+            broken = true;
+        }
+    }
+}
+
+uint64_t InputJournal::get_state_hash(Tournament *tournament, Players& players) {
+    Checkpoint cp;
+    tournament->write_checkpoint(cp);
+
+    /* the server and the replay list their players in different orders */
+    Players synced;
+    for (Players::iterator it = players.begin(); it != players.end(); it++) {
+        if ((*it)->client_synced) {
+            synced.push_back(*it);
+        }
+    }
+    std::sort(synced.begin(), synced.end(), ComparePlayerId);
+    for (Players::iterator it = synced.begin(); it != synced.end(); it++) {
+        Player *p = *it;
+        GPlayerState state = p->state;
+        state.to_net();
+        cp.write_string(p->get_player_name());
+        cp.write_data(&state, GPlayerStateLen);
+    }
+
+    return cp.get_hash();
+}
+
+void InputJournal::read_header(std::istream& f) throw (InputJournalException) {
+    char magic[InputJournalMagicLength];
+    unsigned char version[4];
+    if (!f.read(magic, InputJournalMagicLength) || memcmp(magic, InputJournalMagic, InputJournalMagicLength) ||
+        !f.read(reinterpret_cast<char *>(version), sizeof(version)))
+    {
+        throw InputJournalException("Not an input journal");
+    }
+
+    Checkpoint header;
+    header.assign(version, sizeof(version));
+    if (header.read_u32() != Version) {
+        throw InputJournalException("Unsupported input journal version");
+    }
+}
+
+bool InputJournal::read_record(std::istream& f, Record& record) throw (InputJournalException) {
+    unsigned char header[HeaderLength];
+    if (!f.read(reinterpret_cast<char *>(header), HeaderLength)) {
+        if (f.gcount()) {
+            throw InputJournalException("Truncated input journal");
+        }
+        return false;
+    }
+
+    /* type, payload length, tick and seed */
+    record.payload.assign(header, HeaderLength);
+    unsigned char type = record.payload.read_u8();
+    size_t len = record.payload.read_u16();
+    record.tick = record.payload.read_u32();
+    record.seed = record.payload.read_u32();
+    if (type >= _RecordTypeMAX) {
+        throw InputJournalException("Broken input journal record");
+    }
+    record.type = static_cast<RecordType>(type);
+
+    std::vector<unsigned char> data(len ? len : 1);
+    if (len && !f.read(reinterpret_cast<char *>(&data[0]), len)) {
+        throw InputJournalException("Truncated input journal");
+    }
+    record.payload.assign(&data[0], len);
+
+    return true;
+}
+
+void InputJournal::write_record(RecordType type) {
+    uint32_t seed = next_seed();
+
+    if (!broken) {
+        Checkpoint header;
+        header.write_u8(static_cast<unsigned char>(type));
+        header.write_u16(static_cast<uint16_t>(payload.get_size()));
+        header.write_u32(tick_number);
+        header.write_u32(seed);
+        f.write(reinterpret_cast<const char *>(header.get_data()), header.get_size());
+        if (payload.get_size()) {
+            f.write(reinterpret_cast<const char *>(payload.get_data()), payload.get_size());
+        }
+        if (!f) {
+            broken = true;
+        }
+    }
+    payload.clear();
+
+    /* what follows the record runs on this seed, in the replay too */
+    random.seed(seed);
+}
+
+uint32_t InputJournal::next_seed() {
+    /* xorshift */
+    seed_state ^= seed_state << 13;
+    seed_state ^= seed_state >> 17;
+    seed_state ^= seed_state << 5;
+
+    return seed_state;
+}
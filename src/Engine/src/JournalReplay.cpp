@@ -0,0 +1,426 @@
+#include "JournalReplay.hpp"
+#include "TournamentFactory.hpp"
+#include "Tournament.hpp"
+#include "JobSystem.hpp"
+#include "Navigation.hpp"
+#include "Utils.hpp"
+
+#include <algorithm>
+#include <fstream>
+#include <cstdlib>
+
+JournalReplay::JournalReplay(Subsystem& subsystem, const Parameters& parms) throw (JournalReplayException)
+    : subsystem(subsystem), phase(0), bots_phase(0), tournament(0), navigation(0),
+      tournament_ticks(0), tournament_hashes(0), diverged_tick(0), tournaments(0),
+      divergences(0)
+{
+    try {
+        for (Parameters::const_iterator it = parms.begin(); it != parms.end(); it++) {
+            StringTokens tokens = tokenize(*it, '=', 2);
+            if (tokens.size() == 2) {
+                set_value(tokens[0], tokens[1]);
+            } else if (it->find('=') == std::string::npos) {
+                read(*it);
+            } else {
+                throw JournalReplayException("Invalid parameter: " + *it);
+            }
+        }
+
+        set_default("data_directory", STRINGIZE_VALUE_OF(DATA_DIRECTORY));
+    } catch (const KeyValueException& e) {
+        throw JournalReplayException(e.what());
+    }
+
+    if (!get_value("journal").length()) {
+        throw JournalReplayException("Usage: goatattack-replay journal=<input journal> [data_directory=<dir>] [jobs=<n>]");
+    }
+}
+
+JournalReplay::~JournalReplay() {
+    cleanup();
+}
+
+int JournalReplay::run() throw (Exception) {
+    const std::string& journal_file = get_value("journal");
+    std::ifstream f(journal_file.c_str(), std::ifstream::in | std::ifstream::binary);
+    if (!f.is_open()) {
+        throw JournalReplayException("Can't open input journal " + journal_file);
+    }
+    InputJournal::read_header(f);
+
+    Resources resources(subsystem, get_value("data_directory"), Resources::LoadProfileServer);
+
+    size_t workers = JobSystem::get_default_worker_count();
+    const std::string& jobs_value = get_value("jobs");
+    if (jobs_value.length()) {
+        workers = static_cast<size_t>(atoi(jobs_value.c_str()));
+    }
+    JobSystem jobs(workers);
+
+    TournamentFactory factory(resources, subsystem, 0);
+    factory.set_job_system(&jobs);
+    factory.set_random(&random);
+
+    phase = profiler.add_phase("update states");
+    bots_phase = profiler.add_phase("bots");
+
+    subsystem << "replaying " << journal_file << ", " << jobs.get_worker_count()
+        << " worker(s)" << std::endl;
+
+    InputJournal::Record record;
+    try {
+        while (InputJournal::read_record(f, record)) {
+            replay(resources, factory, record);
+        }
+        finish_tournament();
+    } catch (...) {
+        cleanup();
+        throw;
+    }
+    cleanup();
+
+    subsystem << tournaments << " tournament(s), " << divergences << " diverged" << std::endl;
+
+    Profiler::Report report;
+    profiler.report(report);
+    for (Profiler::Report::iterator it = report.begin(); it != report.end(); it++) {
+        subsystem << *it << std::endl;
+    }
+
+    return divergences;
+}
+
+void JournalReplay::set_default(const std::string& key, const std::string& value) {
+    if (!get_value(key).length()) {
+        set_value(key, value);
+    }
+}
+
+void JournalReplay::replay(Resources& resources, TournamentFactory& factory,
+    InputJournal::Record& record) throw (Exception)
+{
+    /* the server drew the same numbers after this record */
+    random.seed(record.seed);
+
+    switch (record.type) {
+        case InputJournal::RecordTypeTournament:
+            start_tournament(factory, record.payload);
+            break;
+
+        case InputJournal::RecordTypePlayerAdded:
+            add_player(resources, record.payload);
+            break;
+
+        case InputJournal::RecordTypePlayerRemoved:
+            remove_player(record.payload);
+            break;
+
+        /* a match restored from a checkpoint is skipped */
+        case InputJournal::RecordTypeInput:
+            if (tournament) {
+                apply_input(record.payload);
+            }
+            break;
+
+        case InputJournal::RecordTypeTick:
+            if (tournament) {
+                tick(static_cast<ns_t>(record.payload.read_u64()));
+            }
+            break;
+
+        case InputJournal::RecordTypeHash:
+            if (tournament) {
+                check_hash(record.tick, record.payload.read_u64());
+            }
+            break;
+
+        case InputJournal::_RecordTypeMAX:
+            break;
+    }
+}
+
+void JournalReplay::start_tournament(TournamentFactory& factory, Checkpoint& payload) throw (Exception) {
+    GamePlayType type = static_cast<GamePlayType>(payload.read_u8());
+    std::string name = payload.read_string();
+    int duration = static_cast<int>(payload.read_u32());
+    int warmup_in_seconds = static_cast<int>(payload.read_u32());
+    bool warmup = payload.read_bool();
+    bool switch_to_game = payload.read_bool();
+    bool friendly_fire_alarm = payload.read_bool();
+    std::string team_red = payload.read_string();
+    std::string team_blue = payload.read_string();
+
+    finish_tournament();
+    if (tournament) {
+        delete tournament;
+        tournament = 0;
+    }
+    if (navigation) {
+        delete navigation;
+        navigation = 0;
+    }
+
+    MapConfiguration config(type, name, duration, warmup_in_seconds);
+    tournament = factory.create_tournament(config, true, warmup, players, 0);
+    tournament->set_team_names(team_red, team_blue);
+    tournament->set_friendly_fire_alarm(friendly_fire_alarm);
+    map_name = name;
+    tournament_ticks = 0;
+    tournament_hashes = 0;
+    diverged_tick = 0;
+    tournaments++;
+
+    for (Bots::iterator it = bots.begin(); it != bots.end(); it++) {
+        (*it)->reset();
+    }
+
+    /* as the server does with the new map */
+    for (Players::iterator it = players.begin(); it != players.end(); it++) {
+        Player *p = *it;
+        if (switch_to_game) {
+            p->clear();
+            if (!(p->state.server_state.flags & PlayerServerFlagSpectating)) {
+                tournament->spawn_player(p);
+                p->state.server_state.flags &= ~PlayerServerFlagDead;
+            }
+        } else {
+            p->reset();
+        }
+    }
+}
+
+void JournalReplay::finish_tournament() {
+    if (tournament) {
+        subsystem << map_name << ": ticks=" << tournament_ticks << " hashes=" << tournament_hashes
+            << (diverged_tick ? " diverged" : " ok") << std::endl;
+    }
+}
+
+void JournalReplay::add_player(Resources& resources, Checkpoint& payload) throw (Exception) {
+    player_id_t id = payload.read_u16();
+    player_id_t before_id = payload.read_u16();
+    bool bot = payload.read_bool();
+    std::string name = payload.read_string();
+    std::string characterset_name = payload.read_string();
+    GPlayerState state;
+    payload.read_data(&state, GPlayerStateLen);
+    state.from_net();
+
+    Player *p = new Player(resources, 0, id, name, characterset_name);
+    p->state = state;
+    p->client_synced = true;
+    p->bot = bot;
+
+    Players::iterator pos = players.end();
+    if (before_id) {
+        for (Players::iterator it = players.begin(); it != players.end(); it++) {
+            if ((*it)->state.id == before_id) {
+                pos = it;
+                break;
+            }
+        }
+    }
+    players.insert(pos, p);
+
+    if (bot) {
+        bots.push_back(new Bot(p));
+    }
+    if (tournament) {
+        tournament->player_added(p);
+    }
+}
+
+void JournalReplay::remove_player(Checkpoint& payload) throw (Exception) {
+    Player *p = find_player(payload.read_u16());
+    if (tournament) {
+        tournament->player_removed(p);
+    }
+
+    for (Bots::iterator it = bots.begin(); it != bots.end(); it++) {
+        if ((*it)->get_player() == p) {
+            delete *it;
+            bots.erase(it);
+            break;
+        }
+    }
+
+    players.erase(std::find(players.begin(), players.end(), p));
+    delete p;
+}
+
+void JournalReplay::apply_input(Checkpoint& payload) throw (Exception) {
+    Player *p = find_player(payload.read_u16());
+    unsigned char cmd = payload.read_u8();
+    size_t len = payload.read_u16();
+    std::vector<unsigned char> data(len + 1);
+    payload.read_data(&data[0], len);
+
+    /* same as the server in event_data */
+    size_t needed = 1;
+    switch (cmd) {
+        case GPSUpdatePlayerClientServerState:
+            needed = GPlayerClientServerStateLen;
+            break;
+
+        case GPSRespawnRequest:
+            needed = 0;
+            break;
+
+        case GPSJoinRequest:
+            needed = sizeof(playerflags_t);
+            break;
+
+        case GPSPlayerChanged:
+            needed = GPlayerDescriptionLen;
+            break;
+
+        case GPSRoundFinished:
+            needed = sizeof(GTransportTime);
+            break;
+    }
+    if (len < needed) {
+        throw JournalReplayException("Broken input record");
+    }
+
+    switch (cmd) {
+        case GPSUpdatePlayerClientServerState:
+        {
+            GPlayerClientServerState *state = reinterpret_cast<GPlayerClientServerState *>(&data[0]);
+            state->from_net();
+            p->state.client_server_state = *state;
+            break;
+        }
+
+        case GPSRespawnRequest:
+            p->respawning = true;
+            break;
+
+        case GPSJoinRequest:
+        {
+            /* bots switch sides, see Server::join_bot */
+            playerflags_t *flags = reinterpret_cast<playerflags_t *>(&data[0]);
+            if (p->bot) {
+                p->state.server_state.flags &= ~PlayerServerFlagTeamRed;
+            }
+            if (tournament->get_game_state().seconds_remaining && tournament->player_joins(p, *flags)) {
+                p->respawning = true;
+            }
+            break;
+        }
+
+        case GPSShot:
+            tournament->fire_shot(p, data[0]);
+            break;
+
+        case GPSGrenade:
+            tournament->fire_grenade(p, data[0]);
+            break;
+
+        case GPSBomb:
+            tournament->fire_bomb(p, data[0]);
+            break;
+
+        case GPSFrog:
+            tournament->fire_frog(p, data[0]);
+            break;
+
+        case GPSPlayerChanged:
+        {
+            GPlayerDescription *pdesc = reinterpret_cast<GPlayerDescription *>(&data[0]);
+            p->set_player_name(pdesc->player_name);
+            try {
+                p->set_characterset(pdesc->characterset_name);
+            } catch (const Exception& e) {
+                subsystem << e.what() << std::endl;
+            }
+            break;
+        }
+
+        case GPSRoundFinished:
+        {
+            GTransportTime *race = reinterpret_cast<GTransportTime *>(&data[0]);
+            race->from_net();
+            tournament->round_finished_set_time(p, race);
+            break;
+        }
+    }
+}
+
+void JournalReplay::tick(ns_t ns) {
+    if (!navigation && bots.size()) {
+        navigation = new Navigation(tournament->get_map(), tournament->get_tileset(),
+            bots[0]->get_player()->get_characterset()->get_colbox().height);
+    }
+
+    {
+        ProfilerScope scope(&profiler, bots_phase);
+        for (Bots::iterator it = bots.begin(); it != bots.end(); it++) {
+            Bot *bot = *it;
+            if (!(bot->get_player()->state.server_state.flags & PlayerServerFlagSpectating)) {
+                bot->think(*tournament, *navigation, players, ns);
+            }
+        }
+    }
+
+    {
+        ProfilerScope scope(&profiler, phase);
+        tournament->update_states(ns);
+    }
+    tournament->delete_responses();
+
+    /* respawn requests, as the server handles them after the tick */
+    for (Players::iterator it = players.begin(); it != players.end(); it++) {
+        Player *p = *it;
+        if (p->respawning) {
+            p->respawning = false;
+            if (!p->is_alive_and_playing()) {
+                p->state.server_state.flags &= PlayerServerFlagTeamRed;
+                p->zero();
+                if (p->bot) {
+                    tournament->spawn_player(p);
+                }
+            }
+        }
+    }
+
+    tournament_ticks++;
+}
+
+void JournalReplay::check_hash(uint32_t tick, uint64_t hash) {
+    tournament_hashes++;
+    if (!diverged_tick && InputJournal::get_state_hash(tournament, players) != hash) {
+        /* everything after the first difference differs too */
+        diverged_tick = tick;
+        divergences++;
+        subsystem << map_name << ": diverged at tick " << tick << std::endl;
+    }
+}
+
+Player *JournalReplay::find_player(player_id_t id) throw (JournalReplayException) {
+    for (Players::iterator it = players.begin(); it != players.end(); it++) {
+        if ((*it)->state.id == id) {
+            return *it;
+        }
+    }
+
+    throw JournalReplayException("Input journal refers to an unknown player");
+}
+
+void JournalReplay::cleanup() {
+    if (tournament) {
+        delete tournament;
+        tournament = 0;
+    }
+    if (navigation) {
+        delete navigation;
+        navigation = 0;
+    }
+    for (Bots::iterator it = bots.begin(); it != bots.end(); it++) {
+        delete *it;
+    }
+    bots.clear();
+    for (Players::iterator it = players.begin(); it != players.end(); it++) {
+        delete *it;
+    }
+    players.clear();
+}
@@ -0,0 +1,86 @@
+#include "MapPreloader.hpp"
+
+MapPreloader::MapPreloader(Resources& resources, const std::string& map_name, bool lightmap,
+    int navigation_player_height) throw (ResourcesException)
+    : map_name(map_name), map(resources.get_map_header(map_name)),
+      tileset(resources.get_tileset(map->get_tileset())), lightmap(lightmap),
+      navigation_player_height(navigation_player_height), running(false),
+      lightmap_loaded(false), lightmap_image(0), navigation(0)
+{
+    running = thread_start();
+    if (!running) {
+        /* no thread, no hitch saved, but still correct */
+        prepare();
+    }
+}
+
+MapPreloader::~MapPreloader() {
+    wait();
+
+    if (lightmap_image) {
+        delete lightmap_image;
+    }
+
+    if (navigation) {
+        delete navigation;
+    }
+}
+
+const std::string& MapPreloader::get_map_name() const {
+    return map_name;
+}
+
+void MapPreloader::wait() {
+    if (running) {
+        thread_join();
+        running = false;
+    }
+}
+
+bool MapPreloader::has_lightmap_image() {
+    wait();
+
+    return lightmap_loaded;
+}
+
+PNG *MapPreloader::get_lightmap_image() {
+    wait();
+
+    return lightmap_image;
+}
+
+Navigation *MapPreloader::release_navigation() {
+    wait();
+
+    Navigation *nav = navigation;
+    navigation = 0;
+
+    return nav;
+}
+
+void MapPreloader::prepare() {
+    /* the tiles of a map from the cache are read here */
+    try {
+        map->load();
+    } catch (const Exception&) {
+        /* the tournament retries and reports it */
+        return;
+    }
+
+    if (lightmap) {
+        try {
+            lightmap_image = map->load_lightmap_image();
+            lightmap_loaded = true;
+        } catch (const Exception&) {
+            /* the tournament retries and reports it */
+        }
+    }
+
+    if (navigation_player_height > 0) {
+        navigation = new Navigation(*map, tileset, navigation_player_height);
+    }
+}
+
+void MapPreloader::thread() {
+    prepare();
+}
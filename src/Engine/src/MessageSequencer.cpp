@@ -30,7 +30,7 @@ MessageSequencer::MessageSequencer(hostport_t port, pico_size_t max_heaps,
     const std::string& name, const std::string& password) throw (Exception)
     : max_heaps(max_heaps), is_client(false), name(name), password(password), socket(port),
       pmsg(reinterpret_cast<NetMessage *>(buffer)),
-      pdata(reinterpret_cast<NetMessageData *>(pmsg->data))
+      pdata(reinterpret_cast<NetMessageData *>(pmsg->data)), incoming_flags(0)
 {
     memset(buffer, 0, sizeof buffer);
 }
@@ -39,7 +39,7 @@ MessageSequencer::MessageSequencer(hostaddr_t server_host, hostport_t server_por
     throw (Exception)
     : max_heaps(1), is_client(true), name(), password(), socket(),
       pmsg(reinterpret_cast<NetMessage *>(buffer)),
-      pdata(reinterpret_cast<NetMessageData *>(pmsg->data))
+      pdata(reinterpret_cast<NetMessageData *>(pmsg->data)), incoming_flags(0)
 {
     memset(buffer, 0, sizeof buffer);
 
@@ -124,8 +124,7 @@ void MessageSequencer::push(const Connection *c, command_t cmd, flags_t flags,
                 cmd, len, alloc_data);
             h->out_queue.push_back(m);
         } else {
-            slack_send(h->host, h->port, ++h->last_send_unrel_seq_no,
-                flags, cmd, len, data);
+            slack_send(h, ++h->last_send_unrel_seq_no, flags, cmd, len, data);
         }
     }
 }
@@ -146,6 +145,10 @@ bool MessageSequencer::cycle() throw (Exception) {
         again = true;
         pmsg->from_net();
         pdata->from_net();
+        if (pmsg->cmd < _NetCommandMAX) {
+            traffic.datagrams_received[pmsg->cmd]++;
+            traffic.bytes_received[pmsg->cmd] += sz;
+        }
 
         if (pmsg->cmd == NetCommandStatReq) {
             /* server status request */
@@ -153,7 +156,7 @@ bool MessageSequencer::cycle() throw (Exception) {
                 ServerStatusMsg *stat = reinterpret_cast<ServerStatusMsg *>(pdata->data);
                 stat->protocol_version = ProtocolVersion;
                 stat->max_heaps = max_heaps;
-                stat->cur_heaps = static_cast<pico_size_t>(heaps.size());
+                stat->cur_heaps = count_heaps(false);
                 stat->flags = (password.length() ? ServerStatusFlagNeedPassword : 0);
                 stat->len = static_cast<data_len_t>(name.length());
                 int len = stat->len;
@@ -189,10 +192,12 @@ bool MessageSequencer::cycle() throw (Exception) {
                 if (!is_client && !find_heap(host, port)) {
                     NetLogin *login = reinterpret_cast<NetLogin *>(pdata->data);
                     std::string pwd(login->pwd);
+                    bool relay = is_relay_login(login->len, login->data);
                     if (password.length() && pwd != password) {
                         slack_send(host, port, 0, 0, NetCommandWrongPassword, 0, 0);
-                    } else if (heaps.size() < max_heaps) {
+                    } else if (relay ? count_heaps(true) < MaxRelayHeaps : count_heaps(false) < max_heaps) {
                         h = new SequencerHeap(host, port);
+                        h->relay = relay;
                         heaps.push_back(h);
                     } else {
                         slack_send(host, port, 0, 0, NetCommandServerFull, 0, 0);
@@ -204,6 +209,8 @@ bool MessageSequencer::cycle() throw (Exception) {
 
             /* process, if valid heap */
             if (h) {
+                h->datagrams_received++;
+                h->bytes_received += sz;
                 if (pmsg->flags & NetFlagsReliable) {
                     /* queueing */
                     if (pmsg->seq_no > h->last_recv_rel_seq_no) {
@@ -220,6 +227,9 @@ bool MessageSequencer::cycle() throw (Exception) {
                     }
                 } else {
                     if (pmsg->seq_no > h->last_recv_unrel_seq_no) {
+                        if (h->last_recv_unrel_seq_no && pmsg->seq_no > h->last_recv_unrel_seq_no + 1) {
+                            h->lost += pmsg->seq_no - h->last_recv_unrel_seq_no - 1;
+                        }
                         h->last_recv_unrel_seq_no = pmsg->seq_no;
                         process_incoming(h, pmsg);
                     }
@@ -276,7 +286,10 @@ bool MessageSequencer::cycle() throw (Exception) {
                         recycle = true;
                         break;
                     } else {
-                        slack_send(h->host, h->port, tmp_smsg->seq_no, tmp_smsg->flags,
+                        if (tmp_smsg->resends > 1) {
+                            h->resends++;
+                        }
+                        slack_send(h, tmp_smsg->seq_no, tmp_smsg->flags,
                             tmp_smsg->cmd, tmp_smsg->len, tmp_smsg->data);
                     }
                 }
@@ -314,7 +327,7 @@ void MessageSequencer::kill(const Connection *c) throw (Exception) {
 void MessageSequencer::new_settings(hostport_t port, pico_size_t num_heaps,
     const std::string& name, const std::string& password) throw (Exception)
 {
-    int current = static_cast<int>(heaps.size());
+    int current = count_heaps(false);
     if (current >= num_heaps) {
         char temp_buffer[256];
         sprintf(temp_buffer, "Cannot set num_heaps to %d, %d are logged in", num_heaps, current);
@@ -326,10 +339,18 @@ void MessageSequencer::new_settings(hostport_t port, pico_size_t num_heaps,
     socket.set_port(port);
 }
 
+const NetTraffic& MessageSequencer::get_traffic() const {
+    return traffic;
+}
+
+flags_t MessageSequencer::get_incoming_flags() const {
+    return incoming_flags;
+}
+
 void MessageSequencer::ack(SequencerHeap *heap, sequence_no_t seq_no) throw (Exception) {
     sequence_no_t net_seq_no = htonl(seq_no);
-    slack_send(heap->host, heap->port, ++heap->last_send_unrel_seq_no,
-        0, NetCommandAcknowledge, sizeof(sequence_no_t), &net_seq_no);
+    slack_send(heap, ++heap->last_send_unrel_seq_no, 0, NetCommandAcknowledge,
+        sizeof(sequence_no_t), &net_seq_no);
 }
 
 void MessageSequencer::process_incoming(SequencerHeap *heap, NetMessage *msg) throw (Exception) {
@@ -391,6 +412,7 @@ void MessageSequencer::process_incoming(SequencerHeap *heap, NetMessage *msg) th
 
         case NetCommandData:
         {
+            incoming_flags = msg->flags;
             data->data[data->len] = 0;
             event_data(heap, data->len, data->data);
             break;
@@ -432,6 +454,17 @@ SequencerHeap *MessageSequencer::find_heap(const Connection *c) {
     return 0;
 }
 
+pico_size_t MessageSequencer::count_heaps(bool relays) const {
+    pico_size_t count = 0;
+    for (SequencerHeaps::const_iterator it = heaps.begin(); it != heaps.end(); it++) {
+        if ((*it)->relay == relays) {
+            count++;
+        }
+    }
+
+    return count;
+}
+
 void MessageSequencer::delete_heap(SequencerHeap *heap) {
     for (SequencerHeaps::iterator it = heaps.begin(); it != heaps.end(); it++) {
         SequencerHeap *h = *it;
@@ -482,6 +515,18 @@ void MessageSequencer::slack_send(hostaddr_t host, hostport_t port,
     }
 
     socket.send(host, port, pmsg, MsgHeaderLength + len);
+    if (cmd < _NetCommandMAX) {
+        traffic.datagrams_sent[cmd]++;
+        traffic.bytes_sent[cmd] += MsgHeaderLength + len;
+    }
+}
+
+void MessageSequencer::slack_send(SequencerHeap *heap, sequence_no_t seq_no,
+    flags_t flags, command_t cmd, data_len_t len, const void *data) throw (Exception)
+{
+    heap->datagrams_sent++;
+    heap->bytes_sent += MsgHeaderLength + len;
+    slack_send(heap->host, heap->port, seq_no, flags, cmd, len, data);
 }
 
 void MessageSequencer::delete_all_heaps() {
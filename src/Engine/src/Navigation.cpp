@@ -0,0 +1,393 @@
+#include "Navigation.hpp"
+#include "Tournament.hpp"
+
+#include <queue>
+#include <functional>
+#include <algorithm>
+#include <cstdlib>
+
+static const int NavigationSearchRadius = 3;
+static const int NavigationMaxJumpSteps = 1000;
+
+Navigation::Navigation(Map& map, Tileset *tileset, int player_height)
+    : width(map.get_width()), height(map.get_height()),
+      tile_width(tileset->get_tile_width()), tile_height(tileset->get_tile_height()),
+      clearance((player_height + tile_height - 1) / tile_height), jump_tiles(0),
+      search_id(0)
+{
+    if (clearance < 1) {
+        clearance = 1;
+    }
+
+    /* classify tiles */
+    short **map_array = map.get_map();
+    cells.resize(width * height, CellFree);
+    for (int y = 0; y < height; y++) {
+        for (int x = 0; x < width; x++) {
+            short index = map_array[y][x];
+            if (index > -1) {
+                unsigned char& cell = cells[y * width + x];
+                switch (tileset->get_tile(index)->get_tile_type()) {
+                    case Tile::TileTypeBlocking:
+                    case Tile::TileTypeBaseRed:
+                    case Tile::TileTypeBaseBlue:
+                        cell = CellSolid;
+                        break;
+
+                    case Tile::TileTypeFallingOnlyBlocking:
+                        cell = CellPlatform;
+                        break;
+
+                    case Tile::TileTypeFallingOnlyBlockingNoDescending:
+                        cell = CellPlatformNoDescending;
+                        break;
+
+                    case Tile::TileTypeKilling:
+                        cell = CellKilling;
+                        break;
+
+                    default:
+                        break;
+                }
+            }
+        }
+    }
+
+    calculate_jump();
+
+    /* standable cells become nodes */
+    node_at.resize(width * height, -1);
+    for (int y = 0; y < height; y++) {
+        for (int x = 0; x < width; x++) {
+            if (is_standable(x, y)) {
+                node_at[y * width + x] = static_cast<int>(nodes.size());
+                nodes.push_back(Node(x, y));
+            }
+        }
+    }
+
+    size_t sz = nodes.size();
+    for (size_t i = 0; i < sz; i++) {
+        Node& node = nodes[i];
+        node.first_edge = edges.size();
+        create_edges(node.tilex, node.tiley);
+        node.edge_count = edges.size() - node.first_edge;
+    }
+
+    cost.resize(sz, 0.0f);
+    parent.resize(sz, -1);
+    visited.resize(sz, 0);
+}
+
+Navigation::~Navigation() { }
+
+size_t Navigation::get_node_count() const {
+    return nodes.size();
+}
+
+const Navigation::Node& Navigation::get_node(int index) const {
+    return nodes[index];
+}
+
+const Navigation::Edge *Navigation::get_edge(int from, int to) const {
+    const Node& node = nodes[from];
+    for (size_t i = 0; i < node.edge_count; i++) {
+        const Edge& edge = edges[node.first_edge + i];
+        if (edge.to == to) {
+            return &edge;
+        }
+    }
+
+    return 0;
+}
+
+int Navigation::get_tile_width() const {
+    return tile_width;
+}
+
+int Navigation::get_tile_height() const {
+    return tile_height;
+}
+
+int Navigation::get_standing_node(double x, double y) const {
+    if (x < 0.0f || y < 0.0f) {
+        return -1;
+    }
+
+    return get_node_at(static_cast<int>(x) / tile_width, static_cast<int>(y) / tile_height);
+}
+
+int Navigation::get_nearest_node(double x, double y) const {
+    int tx = static_cast<int>(x) / tile_width;
+    int ty = static_cast<int>(y) / tile_height;
+    if (tx < 0) tx = 0;
+    if (tx > width - 1) tx = width - 1;
+    if (ty < 0) ty = 0;
+    if (ty > height - 1) ty = height - 1;
+
+    /* the ground below */
+    for (int y = ty; y < height; y++) {
+        int node = get_node_at(tx, y);
+        if (node > -1) {
+            return node;
+        }
+        if (get_cell(tx, y) == CellSolid) {
+            break;
+        }
+    }
+
+    /* something close by */
+    for (int r = 1; r <= NavigationSearchRadius; r++) {
+        for (int dy = -r; dy <= r; dy++) {
+            for (int dx = -r; dx <= r; dx++) {
+                if (abs(dx) == r || abs(dy) == r) {
+                    int node = get_node_at(tx + dx, ty + dy);
+                    if (node > -1) {
+                        return node;
+                    }
+                }
+            }
+        }
+    }
+
+    return -1;
+}
+
+int Navigation::get_random_node(Random& random) const {
+    if (nodes.empty()) {
+        return -1;
+    }
+
+    return random.next() % static_cast<int>(nodes.size());
+}
+
+bool Navigation::find_path(int from, int to, Path& path) {
+    path.clear();
+    if (from < 0 || to < 0) {
+        return false;
+    }
+
+    search_id++;
+    if (!search_id) {
+        std::fill(visited.begin(), visited.end(), 0);
+        search_id = 1;
+    }
+
+    /* a* with the horizontal distance as heuristic, no edge is cheaper
+       than the columns it crosses */
+    typedef std::pair<double, int> Entry;
+    std::priority_queue<Entry, std::vector<Entry>, std::greater<Entry> > open;
+    int goalx = nodes[to].tilex;
+
+    cost[from] = 0.0f;
+    parent[from] = -1;
+    visited[from] = search_id;
+    open.push(Entry(abs(nodes[from].tilex - goalx), from));
+
+    while (!open.empty()) {
+        Entry entry = open.top();
+        open.pop();
+        int n = entry.second;
+        if (n == to) {
+            break;
+        }
+
+        if (entry.first > cost[n] + abs(nodes[n].tilex - goalx) + Epsilon) {
+            continue;
+        }
+
+        const Node& node = nodes[n];
+        for (size_t i = 0; i < node.edge_count; i++) {
+            const Edge& edge = edges[node.first_edge + i];
+            int m = edge.to;
+            double c = cost[n] + edge.cost;
+            if (visited[m] != search_id || c < cost[m]) {
+                visited[m] = search_id;
+                cost[m] = c;
+                parent[m] = n;
+                open.push(Entry(c + abs(nodes[m].tilex - goalx), m));
+            }
+        }
+    }
+
+    if (visited[to] != search_id) {
+        return false;
+    }
+
+    for (int n = to; n != -1; n = parent[n]) {
+        path.push_back(n);
+    }
+    std::reverse(path.begin(), path.end());
+
+    return true;
+}
+
+Navigation::Cell Navigation::get_cell(int x, int y) const {
+    if (x < 0 || x > width - 1) {
+        return CellSolid;
+    }
+
+    if (y < 0) {
+        return CellFree;
+    }
+
+    /* never leave the map at the bottom */
+    if (y > height - 1) {
+        return CellKilling;
+    }
+
+    return static_cast<Cell>(cells[y * width + x]);
+}
+
+bool Navigation::is_body_free(int x, int y) const {
+    for (int i = 0; i < clearance; i++) {
+        Cell cell = get_cell(x, y - i);
+        if (cell == CellSolid || cell == CellKilling) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+bool Navigation::is_standable(int x, int y) const {
+    if (x < 0 || x > width - 1 || y < 0 || y > height - 1) {
+        return false;
+    }
+
+    if (!is_body_free(x, y)) {
+        return false;
+    }
+
+    Cell below = get_cell(x, y + 1);
+
+    return (below == CellSolid || below == CellPlatform || below == CellPlatformNoDescending);
+}
+
+int Navigation::get_node_at(int x, int y) const {
+    if (x < 0 || x > width - 1 || y < 0 || y > height - 1) {
+        return -1;
+    }
+
+    return node_at[y * width + x];
+}
+
+void Navigation::calculate_jump() {
+    /* replay the jump of Tournament::integrate_player with the jump key
+       held and the run starting from rest, per height in tiles keep the
+       columns covered until the player sinks below that height again */
+    double accel_x = 0.0f;
+    double accel_y = 0.0f;
+    double jump_accel_y = -YInitialJumpImpulse;
+    double x = 0.0f;
+    double y = 0.0f;
+    std::vector<double> distance;
+
+    for (int step = 0; step < NavigationMaxJumpSteps; step++) {
+        accel_x += XAccel;
+        if (accel_x > XMaxAccel) {
+            accel_x = XMaxAccel;
+        }
+
+        accel_y += YAccelGravity;
+        if (accel_y > YMaxAccel) {
+            accel_y = YMaxAccel;
+        }
+
+        if (accel_y + jump_accel_y < -Epsilon) {
+            jump_accel_y += YDecelJump;
+        } else {
+            jump_accel_y += YDecelJumpNormal;
+        }
+
+        if (jump_accel_y > -Epsilon) {
+            jump_accel_y = 0.0f;
+        }
+
+        x += accel_x;
+        y += accel_y + jump_accel_y;
+        if (y >= 0.0f) {
+            break;
+        }
+
+        int tiles = static_cast<int>(-y) / tile_height;
+        if (static_cast<int>(distance.size()) < tiles + 1) {
+            distance.resize(tiles + 1, 0.0f);
+        }
+        for (int i = 0; i <= tiles; i++) {
+            distance[i] = x;
+        }
+    }
+
+    /* keep a tile as safety margin */
+    jump_tiles = static_cast<int>(distance.size()) - 1;
+    if (jump_tiles < 0) {
+        jump_tiles = 0;
+    }
+    jump_reach.resize(jump_tiles + 1, 0);
+    for (int i = 0; i <= jump_tiles && i < static_cast<int>(distance.size()); i++) {
+        int reach = static_cast<int>(distance[i]) / tile_width - 1;
+        jump_reach[i] = (reach < 1 ? 1 : reach);
+    }
+}
+
+void Navigation::create_edges(int x, int y) {
+    /* walk or fall down sideways */
+    for (int side = -1; side <= 1; side += 2) {
+        int nx = x + side;
+        int to = get_node_at(nx, y);
+        if (to > -1) {
+            edges.push_back(Edge(to, EdgeTypeWalk, 1.0f));
+        } else if (is_body_free(nx, y)) {
+            to = find_landing(nx, y);
+            if (to > -1) {
+                edges.push_back(Edge(to, EdgeTypeFall, 1.0f + (nodes[to].tiley - y) * 0.25f));
+            }
+        }
+    }
+
+    /* drop through a platform */
+    if (get_cell(x, y + 1) == CellPlatform) {
+        int to = find_landing(x, y + 1);
+        if (to > -1) {
+            edges.push_back(Edge(to, EdgeTypeDrop, 1.0f + (nodes[to].tiley - y) * 0.25f));
+        }
+    }
+
+    /* jump up or over gaps */
+    for (int dy = 0; dy <= jump_tiles; dy++) {
+        if (!is_body_free(x, y - dy)) {
+            break;
+        }
+        int reach = jump_reach[dy];
+        for (int side = -1; side <= 1; side += 2) {
+            for (int d = 1; d <= reach; d++) {
+                int nx = x + side * d;
+                if (!is_body_free(nx, y - dy)) {
+                    break;
+                }
+                if (!dy && d == 1) {
+                    continue;
+                }
+                int to = get_node_at(nx, y - dy);
+                if (to > -1) {
+                    edges.push_back(Edge(to, EdgeTypeJump, 1.0f + dy + d));
+                }
+            }
+        }
+    }
+}
+
+int Navigation::find_landing(int x, int y) const {
+    for (int ny = y; ny < height; ny++) {
+        if (!is_body_free(x, ny)) {
+            return -1;
+        }
+        int node = get_node_at(x, ny);
+        if (node > -1) {
+            return node;
+        }
+    }
+
+    return -1;
+}
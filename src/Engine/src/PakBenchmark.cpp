@@ -0,0 +1,173 @@
+#include "PakBenchmark.hpp"
+#include "ZipReader.hpp"
+#include "Directory.hpp"
+
+#include <cstdlib>
+#include <cstdio>
+#include <cstring>
+
+/* the synthetic pak spreads its files over some directories */
+static const int BenchmarkPakDirectories = 16;
+static const int BenchmarkPakMaxEntries = 65535;
+
+static void put16(std::vector<unsigned char>& data, unsigned int v) {
+    data.push_back(v & 0xff);
+    data.push_back((v >> 8) & 0xff);
+}
+
+static void put32(std::vector<unsigned char>& data, unsigned int v) {
+    put16(data, v & 0xffff);
+    put16(data, (v >> 16) & 0xffff);
+}
+
+PakBenchmark::PakBenchmark(Subsystem& subsystem, const Parameters& parms) throw (BenchmarkException)
+    : Benchmark(subsystem, parms), entries(0)
+{
+    set_default("entries", "10000");
+    set_default("file", "benchmark.pak");
+
+    entries = atoi(get_value("entries").c_str());
+    if (entries < 1 || entries > BenchmarkPakMaxEntries) {
+        throw BenchmarkException("Invalid number of pak entries");
+    }
+}
+
+PakBenchmark::~PakBenchmark() { }
+
+int PakBenchmark::run() throw (Exception) {
+    const std::string& filename = get_value("file");
+    std::vector<std::string> names;
+    char name[64];
+    write_pak(filename, names);
+
+    gametime_t start;
+    gametime_t opened;
+    gametime_t looked_up;
+    gametime_t scanned;
+    gametime_t listed;
+    int found = 0;
+    int linear_found = 0;
+    int listed_entries = 0;
+    try {
+        get_now(start);
+        ZipReader zip(filename);
+        get_now(opened);
+
+        for (int i = 0; i < entries; i++) {
+            found += (zip.file_exists(names[i]) ? 1 : 0);
+        }
+        get_now(looked_up);
+
+        /* the same lookups walking the central directory, for comparison */
+        const ZipReader::Files& files = zip.get_files();
+        for (int i = 0; i < entries; i++) {
+            for (ZipReader::Files::const_iterator it = files.begin(); it != files.end(); it++) {
+                if (it->filename == names[i]) {
+                    linear_found++;
+                    break;
+                }
+            }
+        }
+        get_now(scanned);
+
+        for (int i = 0; i < BenchmarkPakDirectories; i++) {
+            sprintf(name, "dir%d", i);
+            Directory dir(name, ".dat", &zip);
+            while (dir.get_entry()) {
+                listed_entries++;
+            }
+        }
+        get_now(listed);
+    } catch (...) {
+        remove(filename.c_str());
+        throw;
+    }
+    remove(filename.c_str());
+
+    if (found != entries || linear_found != entries || listed_entries != entries) {
+        throw BenchmarkException("Synthetic pak entries are missing");
+    }
+
+    ns_t open_ns = diff_ns(start, opened);
+    ns_t lookup_ns = diff_ns(opened, looked_up) / entries;
+    ns_t linear_ns = diff_ns(looked_up, scanned) / entries;
+    ns_t list_ns = diff_ns(scanned, listed) / BenchmarkPakDirectories;
+    subsystem << "pak: entries=" << entries << " open ns=" << open_ns << " ns/lookup=" << lookup_ns
+        << " ns/linear lookup=" << linear_ns << " ns/directory=" << list_ns << std::endl;
+
+    set_result("pak_open_ns", open_ns);
+    set_result("pak_ns_per_lookup", lookup_ns);
+    set_result("pak_ns_per_directory", list_ns);
+    save_results();
+
+    return 0;
+}
+
+void PakBenchmark::write_pak(const std::string& filename, std::vector<std::string>& names)
+    throw (BenchmarkException)
+{
+    /* stored entries with four bytes each, then the central directory */
+    std::vector<unsigned char> data;
+    std::vector<unsigned char> central;
+    char name[64];
+    for (int i = 0; i < entries; i++) {
+        sprintf(name, "dir%d/file%d.dat", i % BenchmarkPakDirectories, i);
+        names.push_back(name);
+        unsigned int len = static_cast<unsigned int>(strlen(name));
+        unsigned int ofs = static_cast<unsigned int>(data.size());
+        unsigned char content[4] = { 'g', 'o', 'a', 't' };
+        unsigned int crc = static_cast<unsigned int>(crc32(0, content, sizeof content));
+
+        put32(data, 0x04034b50);
+        put16(data, 20);
+        put16(data, 0);
+        put16(data, 0);
+        put32(data, 0);
+        put32(data, crc);
+        put32(data, sizeof content);
+        put32(data, sizeof content);
+        put16(data, len);
+        put16(data, 0);
+        data.insert(data.end(), name, name + len);
+        data.insert(data.end(), content, content + sizeof content);
+
+        put32(central, 0x02014b50);
+        put16(central, 20);
+        put16(central, 20);
+        put16(central, 0);
+        put16(central, 0);
+        put32(central, 0);
+        put32(central, crc);
+        put32(central, sizeof content);
+        put32(central, sizeof content);
+        put16(central, len);
+        put16(central, 0);
+        put16(central, 0);
+        put16(central, 0);
+        put16(central, 0);
+        put32(central, 0);
+        put32(central, ofs);
+        central.insert(central.end(), name, name + len);
+    }
+    unsigned int central_ofs = static_cast<unsigned int>(data.size());
+    data.insert(data.end(), central.begin(), central.end());
+    put32(data, 0x06054b50);
+    put16(data, 0);
+    put16(data, 0);
+    put16(data, entries);
+    put16(data, entries);
+    put32(data, static_cast<unsigned int>(central.size()));
+    put32(data, central_ofs);
+    put16(data, 0);
+
+    FILE *f = fopen(filename.c_str(), "wb");
+    if (!f) {
+        throw BenchmarkException("Cannot write " + filename);
+    }
+    size_t written = fwrite(&data[0], 1, data.size(), f);
+    fclose(f);
+    if (written != data.size()) {
+        remove(filename.c_str());
+        throw BenchmarkException("Cannot write " + filename);
+    }
+}
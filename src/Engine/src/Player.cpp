@@ -8,7 +8,7 @@ Player::Player(Resources& resources, const Connection *c, player_id_t player_id,
       respawning(false), joining(false), force_broadcast(false),
       flag_pick_refused_counter(0), flag_pick_refused(false), client_synced(false),
       server_force_quit_client(false), server_force_quit_client_counter(0),
-      server_admin(false)
+      server_admin(false), bot(false), relay(false)
 {
     reset();
 }
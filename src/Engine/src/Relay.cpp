@@ -0,0 +1,951 @@
+#include "Relay.hpp"
+#include "Utils.hpp"
+#include "Globals.hpp"
+
+#include <cstdlib>
+#include <cstring>
+#include <cerrno>
+
+/* folded records are found by a key of group, sub key and id */
+enum RelayRecordGroup {
+    RelayRecordGroupNone = 0,
+    RelayRecordGroupCommand,
+    RelayRecordGroupPhase,
+    RelayRecordGroupObject,
+    RelayRecordGroupNPC,
+    RelayRecordGroupScore
+};
+
+static const ms_t RelayQuitMS = 2000;
+static const ns_t RelayIdleNS = 1000000;
+
+static int make_key(int group, int sub, int id) {
+    return (group << 24) | ((sub & 0xff) << 16) | (id & 0xffff);
+}
+
+static std::vector<unsigned char> copy_transport(const GTransport *t) {
+    const unsigned char *p = reinterpret_cast<const unsigned char *>(t);
+    std::vector<unsigned char> transport(p, p + GTransportLen + ntohs(t->len));
+    reinterpret_cast<GTransport *>(&transport[0])->flags = 0;
+
+    return transport;
+}
+
+static uint16_t get_net_id(const GTransport *t, size_t offset) {
+    uint16_t id;
+    memcpy(&id, t->data + offset, sizeof(id));
+
+    return ntohs(id);
+}
+
+/* one message, to the server if there is no connection */
+static void send_message(MessageSequencer& sequencer, const Connection *c, command_t cmd,
+    data_len_t len, const void *data) throw (Exception)
+{
+    RelayChain chain;
+    chain.add(cmd, 0, len, data);
+    if (c) {
+        sequencer.push(c, NetFlagsReliable, chain.get_size(), chain.get_data());
+    } else {
+        sequencer.push(NetFlagsReliable, chain.get_size(), chain.get_data());
+    }
+}
+
+static void send_pak_hashes(Resources& resources, MessageSequencer& sequencer,
+    RelayChain& chain) throw (Exception)
+{
+    const Resources::LoadedPaks& paks = resources.get_loaded_paks();
+    GPakHash gph;
+    chain.clear();
+    for (Resources::LoadedPaks::const_iterator it = paks.begin(); it != paks.end(); it++) {
+        const Resources::LoadedPak& pak = *it;
+        memset(&gph, 0, GPakHashLen);
+        strncpy(gph.pak_name, pak.pak_short_name.c_str(), NameLength - 1);
+        strncpy(gph.pak_hash, pak.pak_hash.c_str(), GPakHash::HashLength);
+        gph.to_net();
+        if (!chain.add(GPSPakSyncHash, 0, GPakHashLen, &gph)) {
+            sequencer.push(NetFlagsReliable, chain.get_size(), chain.get_data());
+            chain.clear();
+            chain.add(GPSPakSyncHash, 0, GPakHashLen, &gph);
+        }
+    }
+    if (!chain.add(GPSPakSyncHashFinished, 0, 0, 0)) {
+        sequencer.push(NetFlagsReliable, chain.get_size(), chain.get_data());
+        chain.clear();
+        chain.add(GPSPakSyncHashFinished, 0, 0, 0);
+    }
+    sequencer.push(NetFlagsReliable, chain.get_size(), chain.get_data());
+    chain.clear();
+}
+
+/* ----------------------------------------------------------------------- */
+/* chain                                                                   */
+/* ----------------------------------------------------------------------- */
+RelayChain::RelayChain() : size(0), last(0) { }
+
+bool RelayChain::add(command_t cmd, unsigned char tournament_id, data_len_t len, const void *data) {
+    if (size + GTransportLen + len > sizeof(buffer)) {
+        return false;
+    }
+
+    if (last) {
+        last->flags |= TransportFlagMorePackets;
+    }
+    last = reinterpret_cast<GTransport *>(buffer + size);
+    last->cmd = cmd;
+    last->flags = 0;
+    last->tournament_id = tournament_id;
+    last->len = htons(len);
+    if (len) {
+        memcpy(last->data, data, len);
+    }
+    size += GTransportLen + len;
+
+    return true;
+}
+
+bool RelayChain::add(const GTransport *t) {
+    return add(t->cmd, t->tournament_id, ntohs(t->len), t->data);
+}
+
+void RelayChain::clear() {
+    size = 0;
+    last = 0;
+}
+
+bool RelayChain::is_empty() const {
+    return (size == 0);
+}
+
+const unsigned char *RelayChain::get_data() const {
+    return buffer;
+}
+
+data_len_t RelayChain::get_size() const {
+    return static_cast<data_len_t>(size);
+}
+
+/* ----------------------------------------------------------------------- */
+/* upstream and downstream                                                 */
+/* ----------------------------------------------------------------------- */
+RelayUpstream::RelayUpstream(Relay& relay, hostaddr_t host, hostport_t port) throw (Exception)
+    : MessageSequencer(host, port), relay(relay) { }
+
+RelayUpstream::~RelayUpstream() { }
+
+void RelayUpstream::event_access_denied(RefusalReason reason) throw (Exception) {
+    relay.upstream_access_denied(reason);
+}
+
+void RelayUpstream::event_login(const Connection *c, data_len_t len, void *data) throw (Exception) {
+    relay.upstream_login(c);
+}
+
+void RelayUpstream::event_data(const Connection *c, data_len_t len, void *data) throw (Exception) {
+    relay.upstream_data(get_incoming_flags(), len, data);
+}
+
+void RelayUpstream::event_logout(const Connection *c, LogoutReason reason) throw (Exception) {
+    relay.upstream_logout(reason);
+}
+
+RelayDownstream::RelayDownstream(Relay& relay, hostport_t port, pico_size_t max_spectators,
+    const std::string& name, const std::string& password) throw (Exception)
+    : MessageSequencer(port, max_spectators, name, password), relay(relay) { }
+
+RelayDownstream::~RelayDownstream() { }
+
+void RelayDownstream::event_login(const Connection *c, data_len_t len, void *data) throw (Exception) {
+    relay.downstream_login(c, len, data);
+}
+
+void RelayDownstream::event_data(const Connection *c, data_len_t len, void *data) throw (Exception) {
+    relay.downstream_data(c, len, data);
+}
+
+void RelayDownstream::event_logout(const Connection *c, LogoutReason reason) throw (Exception) {
+    relay.downstream_logout(c);
+}
+
+/* ----------------------------------------------------------------------- */
+/* relay                                                                   */
+/* ----------------------------------------------------------------------- */
+Relay::Relay(Subsystem& subsystem, const Parameters& parms) throw (RelayException)
+    : subsystem(subsystem), resources(0), upstream(0), downstream(0), running(false),
+      upstream_synced(false), delay(0), report_interval(0)
+{
+    try {
+        for (Parameters::const_iterator it = parms.begin(); it != parms.end(); it++) {
+            StringTokens tokens = tokenize(*it, '=', 2);
+            if (tokens.size() == 2) {
+                set_value(tokens[0], tokens[1]);
+            } else if (it->find('=') == std::string::npos) {
+                read(*it);
+            } else {
+                throw RelayException("Invalid parameter: " + *it);
+            }
+        }
+
+        set_default("data_directory", STRINGIZE_VALUE_OF(DATA_DIRECTORY));
+        set_default("server", "127.0.0.1");
+        set_default("port", "25111");
+        set_default("player_name", "relay");
+        set_default("relay_name", "goat attack relay");
+        set_default("relay_port", "25114");
+        set_default("relay_host", "127.0.0.1");
+        set_default("max_spectators", "64");
+        set_default("delay", "0");
+        set_default("report_interval", "60");
+        set_default("probe", "0");
+        set_default("probe_seconds", "30");
+    } catch (const KeyValueException& e) {
+        throw RelayException(e.what());
+    }
+
+    delay = static_cast<ns_t>(atof(get_value("delay").c_str()) * 1000000000.0);
+    report_interval = atoi(get_value("report_interval").c_str()) * 1000;
+}
+
+Relay::~Relay() {
+    for (Spectators::iterator it = spectators.begin(); it != spectators.end(); it++) {
+        Spectator *s = *it;
+        ZipReader::release(s->zip);
+        delete s;
+    }
+    clear_delayed();
+
+    if (downstream) {
+        delete downstream;
+    }
+    if (upstream) {
+        delete upstream;
+    }
+    if (resources) {
+        delete resources;
+    }
+}
+
+int Relay::run() throw (Exception) {
+    /* the paks are needed for both handshakes */
+    resources = new Resources(subsystem, get_value("data_directory"), Resources::LoadProfileServer);
+
+    if (atoi(get_value("probe").c_str()) > 0) {
+        return run_probe();
+    }
+
+    return run_relay();
+}
+
+int Relay::run_relay() throw (Exception) {
+    hostaddr_t host = resolve_host(get_value("server"));
+    if (!host) {
+        throw RelayException("Cannot resolve " + get_value("server"));
+    }
+    hostport_t port = static_cast<hostport_t>(atoi(get_value("port").c_str()));
+    hostport_t relay_port = static_cast<hostport_t>(atoi(get_value("relay_port").c_str()));
+    int max_spectators = atoi(get_value("max_spectators").c_str());
+    if (max_spectators < 1 || max_spectators > 255) {
+        throw RelayException("max_spectators must be between 1 and 255");
+    }
+
+    upstream = new RelayUpstream(*this, host, port);
+    downstream = new RelayDownstream(*this, relay_port, static_cast<pico_size_t>(max_spectators),
+        get_value("relay_name"), get_value("relay_password"));
+
+    /* the game server keeps a relay out of the match */
+    GPlayerLogin login;
+    memset(&login, 0, GPlayerLoginLen);
+    strncpy(login.desc.player_name, get_value("player_name").c_str(), NameLength - 1);
+    strncpy(login.desc.characterset_name, get_value("characterset").c_str(), NameLength - 1);
+    login.flags = LoginFlagRelay;
+    upstream->login(get_value("server_password"), GPlayerLoginLen, &login);
+
+    subsystem << "relaying " << get_value("server") << ":" << port << " on port " << relay_port
+        << ", " << (delay / 1000000000.0) << "s delay" << std::endl;
+
+    gametime_t last;
+    gametime_t now;
+    get_now(last);
+    ms_t report_counter = 0;
+
+    running = true;
+    while (running) {
+        while (upstream->cycle());
+        deliver_due();
+        while (downstream->cycle());
+
+        get_now(now);
+        ms_t diff = diff_ms(last, now);
+        if (diff > 0) {
+            last = now;
+            update_spectators(diff);
+            if (report_interval > 0) {
+                report_counter += diff;
+                if (report_counter >= report_interval) {
+                    report_counter = 0;
+                    report();
+                }
+            }
+        }
+        wait_ns(RelayIdleNS);
+    }
+
+    /* whatever was still held back and the quit go out before leaving */
+    clear_delayed();
+    const std::string& msg = (quit_message.length() ? quit_message : std::string("The relay lost the game server."));
+    for (Spectators::iterator it = spectators.begin(); it != spectators.end(); it++) {
+        send_message(*downstream, (*it)->c, GPCServerQuit, static_cast<data_len_t>(msg.length()), msg.c_str());
+    }
+    get_now(last);
+    do {
+        while (downstream->cycle());
+        wait_ns(RelayIdleNS);
+        get_now(now);
+    } while (spectators.size() && diff_ms(last, now) < RelayQuitMS);
+
+    subsystem << msg << std::endl;
+    report();
+
+    return 1;
+}
+
+int Relay::run_probe() throw (Exception) {
+    hostaddr_t host = resolve_host(get_value("relay_host"));
+    if (!host) {
+        throw RelayException("Cannot resolve " + get_value("relay_host"));
+    }
+    hostport_t port = static_cast<hostport_t>(atoi(get_value("relay_port").c_str()));
+    int count = atoi(get_value("probe").c_str());
+    ms_t duration = atoi(get_value("probe_seconds").c_str()) * 1000;
+
+    std::vector<RelayProbe *> probes;
+    int failed = 0;
+    try {
+        for (int i = 0; i < count; i++) {
+            char name[NameLength];
+            sprintf(name, "probe%d", i + 1);
+            probes.push_back(new RelayProbe(*resources, host, port, name, get_value("relay_password")));
+        }
+
+        gametime_t start;
+        gametime_t now;
+        get_now(start);
+        ms_t elapsed = 0;
+        while (elapsed < duration) {
+            for (size_t i = 0; i < probes.size(); i++) {
+                while (probes[i]->cycle());
+            }
+            wait_ns(RelayIdleNS);
+            get_now(now);
+            elapsed = diff_ms(start, now);
+        }
+
+        for (size_t i = 0; i < probes.size(); i++) {
+            RelayProbe *probe = probes[i];
+            const NetTraffic& traffic = probe->get_traffic();
+            uint64_t datagrams = 0;
+            uint64_t bytes = 0;
+            for (int j = 0; j < _NetCommandMAX; j++) {
+                datagrams += traffic.datagrams_received[j];
+                bytes += traffic.bytes_received[j];
+            }
+            std::string quit;
+            if (probe->get_quit_message().length()) {
+                quit = ", quit: " + probe->get_quit_message();
+            }
+            subsystem << "probe" << (i + 1) << ": " << (probe->is_synced() ? "synced" : "not synced")
+                << ", " << probe->get_messages() << " messages, " << datagrams << " datagrams, "
+                << bytes << " bytes" << quit << std::endl;
+            if (!probe->is_synced()) {
+                failed++;
+            }
+        }
+    } catch (...) {
+        for (size_t i = 0; i < probes.size(); i++) {
+            delete probes[i];
+        }
+        throw;
+    }
+
+    for (size_t i = 0; i < probes.size(); i++) {
+        if (probes[i]->is_connected()) {
+            probes[i]->logout();
+            while (probes[i]->cycle());
+        }
+        delete probes[i];
+    }
+
+    return failed;
+}
+
+void Relay::set_default(const std::string& key, const std::string& value) {
+    if (!get_value(key).length()) {
+        set_value(key, value);
+    }
+}
+
+void Relay::upstream_access_denied(MessageSequencer::RefusalReason reason) {
+    quit_message = (reason == MessageSequencer::RefusalReasonServerFull ?
+        "The game server is full." : "Wrong game server password.");
+    running = false;
+}
+
+void Relay::upstream_login(const Connection *c) throw (Exception) {
+    subsystem << "connected to the game server" << std::endl;
+    send_pak_hashes(*resources, *upstream, chain);
+}
+
+void Relay::upstream_data(flags_t flags, data_len_t len, const void *data) throw (Exception) {
+    /* the handshake with the game server is answered right away */
+    const unsigned char *p = static_cast<const unsigned char *>(data);
+    size_t pos = 0;
+    while (len - pos >= static_cast<size_t>(GTransportLen)) {
+        const GTransport *t = reinterpret_cast<const GTransport *>(p + pos);
+        size_t sz = GTransportLen + ntohs(t->len);
+        if (sz > len - pos) {
+            break;
+        }
+        switch (t->cmd) {
+            case GPCXferHeader:
+            {
+                /* the relay serves its own paks, a missing one is not kept */
+                const GXferHeader *header = reinterpret_cast<const GXferHeader *>(t->data);
+                std::string filename(header->filename, strnlen(header->filename, FilenameLen));
+                subsystem << "WARNING: the game server sends " << filename
+                    << ", spectators without it cannot follow" << std::endl;
+                break;
+            }
+
+            case GPCXferDataChunk:
+                send_message(*upstream, 0, GPSPakSyncAck, 0, 0);
+                break;
+
+            case GPCServerQuit:
+                quit_message.assign(reinterpret_cast<const char *>(t->data), ntohs(t->len));
+                break;
+        }
+        pos += sz;
+        if (!(t->flags & TransportFlagMorePackets)) {
+            break;
+        }
+    }
+
+    /* the stream itself goes through the delay */
+    if (delay > 0) {
+        Delayed *d = new Delayed;
+        get_now(d->received);
+        d->flags = flags;
+        d->data.assign(p, p + len);
+        delayed.push_back(d);
+    } else {
+        deliver(flags, p, len);
+    }
+}
+
+void Relay::upstream_logout(MessageSequencer::LogoutReason reason) {
+    running = false;
+}
+
+void Relay::deliver_due() throw (Exception) {
+    if (delayed.empty()) {
+        return;
+    }
+
+    gametime_t now;
+    get_now(now);
+    while (!delayed.empty()) {
+        Delayed *d = delayed.front();
+        if (diff_ns(d->received, now) < delay) {
+            break;
+        }
+        delayed.pop_front();
+        try {
+            deliver(d->flags, &d->data[0], d->data.size());
+        } catch (...) {
+            delete d;
+            throw;
+        }
+        delete d;
+    }
+}
+
+void Relay::deliver(flags_t flags, const unsigned char *data, size_t len) throw (Exception) {
+    /* fold into the join state and pass on what concerns spectators */
+    forward.clear();
+    size_t pos = 0;
+    while (len - pos >= static_cast<size_t>(GTransportLen)) {
+        const GTransport *t = reinterpret_cast<const GTransport *>(data + pos);
+        size_t sz = GTransportLen + ntohs(t->len);
+        if (sz > len - pos) {
+            break;
+        }
+        apply(t);
+        switch (t->cmd) {
+            case GPCIdentifyPlayer:
+            case GPCJoinAccepted:
+            case GPCJoinRefused:
+            case GPCXferHeader:
+            case GPCXferDataChunk:
+            case GPCPakHash:
+                break;
+
+            default:
+                forward.add(t);
+                break;
+        }
+        pos += sz;
+        if (!(t->flags & TransportFlagMorePackets)) {
+            break;
+        }
+    }
+
+    if (!forward.is_empty()) {
+        for (Spectators::iterator it = spectators.begin(); it != spectators.end(); it++) {
+            Spectator *s = *it;
+            if (s->synced && !s->quitting) {
+                downstream->push(s->c, flags, forward.get_size(), forward.get_data());
+            }
+        }
+    }
+}
+
+void Relay::apply(const GTransport *t) {
+    data_len_t len = ntohs(t->len);
+
+    switch (t->cmd) {
+        case GPCIdentifyPlayer:
+            identify = copy_transport(t);
+            break;
+
+        case GPCAddPlayer:
+        case GPCResetPlayer:
+            if (len >= GPlayerInfoLen) {
+                /* a reset is the latest add of that player */
+                Transport& transport = players[get_net_id(t, 0)];
+                transport = copy_transport(t);
+                reinterpret_cast<GTransport *>(&transport[0])->cmd = GPCAddPlayer;
+            }
+            break;
+
+        case GPCPlayerChanged:
+            if (len >= GPlayerDescriptionLen) {
+                PlayerRecords::iterator it = players.find(get_net_id(t, 0));
+                if (it != players.end()) {
+                    const GPlayerDescription *desc = reinterpret_cast<const GPlayerDescription *>(t->data);
+                    GPlayerInfo *info = reinterpret_cast<GPlayerInfo *>(reinterpret_cast<GTransport *>(&it->second[0])->data);
+                    memcpy(info->desc.player_name, desc->player_name, NameLength);
+                    memcpy(info->desc.characterset_name, desc->characterset_name, NameLength);
+                }
+            }
+            break;
+
+        case GPCRemovePlayer:
+            if (len >= sizeof(player_id_t)) {
+                players.erase(get_net_id(t, 0));
+            }
+            break;
+
+        case GPCResourceId:
+            resource_ids.push_back(Record(0, copy_transport(t)));
+            break;
+
+        case GPCMapState:
+            map_records.clear();
+            store_map_record(make_key(RelayRecordGroupCommand, 0, t->cmd), copy_transport(t));
+            break;
+
+        case GPCReady:
+            if (!upstream_synced) {
+                /* spectators are let in from here on */
+                upstream_synced = true;
+                subsystem << "synced with the game server" << std::endl;
+            }
+            store_map_record(make_key(RelayRecordGroupCommand, 0, t->cmd), copy_transport(t));
+            break;
+
+        case GPCNextMap:
+        case GPCTimeRemaining:
+        case GPCTeamScore:
+            store_map_record(make_key(RelayRecordGroupCommand, 0, t->cmd), copy_transport(t));
+            break;
+
+        case GPCWarmUp:
+        case GPCGameBegins:
+        case GPCGameOver:
+            store_map_record(make_key(RelayRecordGroupPhase, 0, 0), copy_transport(t));
+            break;
+
+        case GPCPlaceObject:
+        case GPCPickObject:
+            if (len >= sizeof(identifier_t)) {
+                store_map_record(make_key(RelayRecordGroupObject, 0, get_net_id(t, 0)), copy_transport(t));
+            }
+            break;
+
+        case GPCSpawnObject:
+            if (len >= GSpawnObjectLen) {
+                store_map_record(make_key(RelayRecordGroupObject, 0, get_net_id(t, sizeof(resource_id_t))), copy_transport(t));
+            }
+            break;
+
+        case GPCSpawnNPC:
+            if (len >= GSpawnNPCLen) {
+                store_map_record(make_key(RelayRecordGroupNPC, 0, get_net_id(t, 2 * sizeof(resource_id_t))), copy_transport(t));
+            }
+            break;
+
+        case GPCRemoveNPC:
+            if (len >= GRemoveNPCLen) {
+                erase_map_record(make_key(RelayRecordGroupNPC, 0, get_net_id(t, 0)));
+            }
+            break;
+
+        case GPCScoreTransportRaw:
+            /* every raw score starts with the player, the latest counts */
+            if (len >= sizeof(player_id_t)) {
+                store_map_record(make_key(RelayRecordGroupScore, len, get_net_id(t, 0)), copy_transport(t));
+            }
+            break;
+
+        case GPCGenericData:
+            map_records.push_back(Record(0, copy_transport(t)));
+            break;
+
+        case GPCServerMessage:
+            server_message = copy_transport(t);
+            break;
+
+        case GPCClanNames:
+            clan_names = copy_transport(t);
+            break;
+    }
+}
+
+void Relay::store_map_record(int key, const Transport& transport) {
+    erase_map_record(key);
+    map_records.push_back(Record(key, transport));
+}
+
+void Relay::erase_map_record(int key) {
+    for (Records::iterator it = map_records.begin(); it != map_records.end(); it++) {
+        if (it->key == key) {
+            map_records.erase(it);
+            break;
+        }
+    }
+}
+
+void Relay::downstream_login(const Connection *c, data_len_t len, void *data) throw (Exception) {
+    std::string name("spectator");
+    if (len >= GPlayerDescriptionLen) {
+        GPlayerDescription *desc = reinterpret_cast<GPlayerDescription *>(data);
+        desc->player_name[NameLength - 1] = 0;
+        name = desc->player_name;
+    }
+
+    Spectator *s = new Spectator(c, name);
+    spectators.push_back(s);
+    if (!upstream_synced) {
+        quit_spectator(s, "The relay is not connected to the game server yet.");
+        return;
+    }
+
+    const Resources::LoadedPaks& paks = resources->get_loaded_paks();
+    for (Resources::LoadedPaks::const_iterator it = paks.begin(); it != paks.end(); it++) {
+        s->paks.push_back(&*it);
+    }
+    subsystem << name << " is watching" << std::endl;
+}
+
+void Relay::downstream_data(const Connection *c, data_len_t len, void *data) throw (Exception) {
+    Spectator *s = find_spectator(c);
+    if (!s || s->quitting) {
+        return;
+    }
+
+    GTransport *t = reinterpret_cast<GTransport *>(data);
+    while (true) {
+        t->from_net();
+        switch (t->cmd) {
+            case GPSPakSyncHash:
+            {
+                GPakHash *hash = reinterpret_cast<GPakHash *>(t->data);
+                hash->from_net();
+                std::string pak_name(hash->pak_name, strnlen(hash->pak_name, NameLength));
+                std::string pak_hash(hash->pak_hash, GPakHash::HashLength);
+                for (PakList::iterator it = s->paks.begin(); it != s->paks.end(); it++) {
+                    if ((*it)->pak_short_name == pak_name) {
+                        if ((*it)->pak_hash == pak_hash) {
+                            s->paks.erase(it);
+                        }
+                        break;
+                    }
+                }
+                break;
+            }
+
+            case GPSPakSyncHashFinished:
+            case GPSPakSyncAck:
+            {
+                try {
+                    sync_paks(s);
+                } catch (const RelayException& e) {
+                    quit_spectator(s, e.what());
+                }
+                break;
+            }
+        }
+
+        /* advance to next element */
+        if (t->flags & TransportFlagMorePackets) {
+            unsigned char *tpb = reinterpret_cast<unsigned char *>(t);
+            tpb += GTransportLen;
+            tpb += t->len;
+            t = reinterpret_cast<GTransport *>(tpb);
+        } else {
+            break;
+        }
+    }
+}
+
+void Relay::downstream_logout(const Connection *c) {
+    for (Spectators::iterator it = spectators.begin(); it != spectators.end(); it++) {
+        Spectator *s = *it;
+        if (s->c == c) {
+            ZipReader::release(s->zip);
+            if (!s->quitting) {
+                subsystem << s->name << " stopped watching" << std::endl;
+            }
+            delete s;
+            spectators.erase(it);
+            break;
+        }
+    }
+}
+
+void Relay::sync_paks(Spectator *s) throw (Exception) {
+    if (s->synced) {
+        return;
+    }
+
+    /* the same transfer the game server does, on the shared reader */
+    if (s->paks.size()) {
+        const Resources::LoadedPak *pak = s->paks[0];
+        if (!s->zip) {
+            try {
+                s->zip = ZipReader::open(pak->pak_name);
+            } catch (const ZipReaderException& e) {
+                throw RelayException(e.what());
+            }
+            GXferHeader header;
+            memset(&header, 0, GXferHeaderLen);
+            strncpy(header.filename, pak->pak_short_name.c_str(), FilenameLen - 1);
+            header.filesize = static_cast<datasize_t>(s->zip->get_size());
+            s->size = header.filesize;
+            s->remaining = header.filesize;
+            header.to_net();
+            send_message(*downstream, s->c, GPCXferHeader, GXferHeaderLen, &header);
+        }
+
+        GXferDataChunk *chunk = reinterpret_cast<GXferDataChunk *>(pak_buffer);
+        datasize_t csz = PacketMaxSize - GXferDataChunkLen - GTransportLen;
+        if (csz > s->remaining) {
+            csz = s->remaining;
+        }
+        memset(chunk, 0, sizeof(pak_buffer));
+        chunk->chunksize = csz = static_cast<datasize_t>(s->zip->read_at(chunk->data, csz, s->size - s->remaining));
+        chunk->to_net();
+        send_message(*downstream, s->c, GPCXferDataChunk, GXferDataChunkLen + csz, chunk);
+
+        s->remaining -= csz;
+        if (!s->remaining || !csz) {
+            ZipReader::release(s->zip);
+            s->zip = 0;
+            s->paks.erase(s->paks.begin());
+        }
+        return;
+    }
+
+    send_join_state(s);
+    s->synced = true;
+}
+
+void Relay::send_join_state(Spectator *s) throw (Exception) {
+    /* in the order the game server sends it to a new client */
+    chain.clear();
+    if (identify.size()) {
+        send_transport(s, identify);
+    }
+    for (PlayerRecords::iterator it = players.begin(); it != players.end(); it++) {
+        send_transport(s, it->second);
+    }
+    for (Records::iterator it = resource_ids.begin(); it != resource_ids.end(); it++) {
+        send_transport(s, it->transport);
+    }
+    for (Records::iterator it = map_records.begin(); it != map_records.end(); it++) {
+        send_transport(s, it->transport);
+    }
+    if (server_message.size()) {
+        send_transport(s, server_message);
+    }
+    if (clan_names.size()) {
+        send_transport(s, clan_names);
+    }
+    flush_chain(s);
+}
+
+void Relay::send_transport(Spectator *s, const Transport& transport) throw (Exception) {
+    const GTransport *t = reinterpret_cast<const GTransport *>(&transport[0]);
+    if (!chain.add(t)) {
+        flush_chain(s);
+        chain.add(t);
+    }
+}
+
+void Relay::flush_chain(Spectator *s) throw (Exception) {
+    if (!chain.is_empty()) {
+        downstream->push(s->c, NetFlagsReliable, chain.get_size(), chain.get_data());
+        chain.clear();
+    }
+}
+
+void Relay::quit_spectator(Spectator *s, const std::string& message) throw (Exception) {
+    /* the client leaves by itself, the rest is done after a while */
+    send_message(*downstream, s->c, GPCServerQuit, static_cast<data_len_t>(message.length()), message.c_str());
+    s->quitting = true;
+    s->quit_counter = RelayQuitMS;
+}
+
+void Relay::update_spectators(ms_t diff) throw (Exception) {
+    for (Spectators::iterator it = spectators.begin(); it != spectators.end(); it++) {
+        Spectator *s = *it;
+        if (s->quitting) {
+            s->quit_counter -= diff;
+            if (s->quit_counter <= 0) {
+                downstream->kill(s->c);
+                break;
+            }
+        }
+    }
+}
+
+Relay::Spectator *Relay::find_spectator(const Connection *c) {
+    for (Spectators::iterator it = spectators.begin(); it != spectators.end(); it++) {
+        if ((*it)->c == c) {
+            return *it;
+        }
+    }
+
+    return 0;
+}
+
+void Relay::clear_delayed() {
+    for (DelayQueue::iterator it = delayed.begin(); it != delayed.end(); it++) {
+        delete *it;
+    }
+    delayed.clear();
+}
+
+void Relay::report() {
+    size_t watching = 0;
+    for (Spectators::iterator it = spectators.begin(); it != spectators.end(); it++) {
+        if ((*it)->synced) {
+            watching++;
+        }
+    }
+
+    uint64_t bytes_in = 0;
+    uint64_t bytes_out = 0;
+    if (upstream) {
+        const NetTraffic& traffic = upstream->get_traffic();
+        for (int i = 0; i < _NetCommandMAX; i++) {
+            bytes_in += traffic.bytes_received[i];
+        }
+    }
+    if (downstream) {
+        const NetTraffic& traffic = downstream->get_traffic();
+        for (int i = 0; i < _NetCommandMAX; i++) {
+            bytes_out += traffic.bytes_sent[i];
+        }
+    }
+
+    subsystem << "relay: " << watching << " spectator(s), " << map_records.size()
+        << " state record(s), " << delayed.size() << " held back, " << bytes_in
+        << " bytes in, " << bytes_out << " bytes out" << std::endl;
+}
+
+/* ----------------------------------------------------------------------- */
+/* probe                                                                   */
+/* ----------------------------------------------------------------------- */
+RelayProbe::RelayProbe(Resources& resources, hostaddr_t host, hostport_t port,
+    const std::string& name, const std::string& password) throw (Exception)
+    : MessageSequencer(host, port), resources(resources), connected(false), synced(false),
+      messages(0)
+{
+    GPlayerDescription desc;
+    memset(&desc, 0, GPlayerDescriptionLen);
+    strncpy(desc.player_name, name.c_str(), NameLength - 1);
+    login(password, GPlayerDescriptionLen, &desc);
+}
+
+RelayProbe::~RelayProbe() { }
+
+bool RelayProbe::is_connected() const {
+    return connected;
+}
+
+bool RelayProbe::is_synced() const {
+    return synced;
+}
+
+uint64_t RelayProbe::get_messages() const {
+    return messages;
+}
+
+const std::string& RelayProbe::get_quit_message() const {
+    return quit_message;
+}
+
+void RelayProbe::event_access_denied(RefusalReason reason) throw (Exception) {
+    quit_message = (reason == RefusalReasonServerFull ? "relay is full" : "wrong password");
+}
+
+void RelayProbe::event_login(const Connection *c, data_len_t len, void *data) throw (Exception) {
+    connected = true;
+    send_pak_hashes(resources, *this, chain);
+}
+
+void RelayProbe::event_data(const Connection *c, data_len_t len, void *data) throw (Exception) {
+    GTransport *t = reinterpret_cast<GTransport *>(data);
+    while (true) {
+        t->from_net();
+        messages++;
+        switch (t->cmd) {
+            case GPCXferDataChunk:
+                send_message(*this, 0, GPSPakSyncAck, 0, 0);
+                break;
+
+            case GPCReady:
+                synced = true;
+                break;
+
+            case GPCServerQuit:
+                quit_message.assign(reinterpret_cast<char *>(t->data), t->len);
+                break;
+        }
+
+        /* advance to next element */
+        if (t->flags & TransportFlagMorePackets) {
+            unsigned char *tpb = reinterpret_cast<unsigned char *>(t);
+            tpb += GTransportLen;
+            tpb += t->len;
+            t = reinterpret_cast<GTransport *>(tpb);
+        } else {
+            break;
+        }
+    }
+}
+
+void RelayProbe::event_logout(const Connection *c, LogoutReason reason) throw (Exception) {
+    connected = false;
+}
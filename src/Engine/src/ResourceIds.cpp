@@ -0,0 +1,202 @@
+#include "ResourceIds.hpp"
+
+#include <cstdio>
+#include <utility>
+
+static const char *category_names[] = { "animation", "sound", "object", "npc" };
+
+ResourceIds::ResourceIds(Resources& resources) : resources(resources) { }
+
+ResourceIds::~ResourceIds() { }
+
+void ResourceIds::assign() {
+    clear();
+
+    Resources::ResourceObjects *objects[_CategoryMAX];
+    objects[CategoryAnimation] = &resources.get_animations();
+    objects[CategorySound] = &resources.get_sounds();
+    objects[CategoryObject] = &resources.get_objects();
+    objects[CategoryNPC] = &resources.get_npcs();
+
+    for (int i = 0; i < _CategoryMAX; i++) {
+        Resources::ResourceObjects& ros = *objects[i];
+        size_t sz = ros.size();
+        if (sz > ResourceIdNone) {
+            sz = ResourceIdNone;
+        }
+        for (size_t id = 0; id < sz; id++) {
+            Entry entry;
+            entry.name = get_properties(static_cast<Category>(i), ros[id].object)->get_name();
+            entry.object = ros[id].object;
+            entries[i].push_back(entry);
+            names[i].insert(std::make_pair(entry.name, static_cast<resource_id_t>(id)));
+            map_id(static_cast<Category>(i), static_cast<resource_id_t>(id), entry.object);
+        }
+    }
+}
+
+void ResourceIds::clear() {
+    for (int i = 0; i < _CategoryMAX; i++) {
+        entries[i].clear();
+        names[i].clear();
+        ids[i].clear();
+    }
+}
+
+void ResourceIds::set(Category category, resource_id_t id, const std::string& name) {
+    if (category < 0 || category >= _CategoryMAX || id == ResourceIdNone) {
+        return;
+    }
+
+    Entries& ents = entries[category];
+    if (id >= ents.size()) {
+        ents.resize(id + 1);
+    }
+    Entry& entry = ents[id];
+    entry.name = name;
+    entry.object = find(category, name);
+    names[category][name] = id;
+    if (entry.object) {
+        map_id(category, id, entry.object);
+    }
+}
+
+void ResourceIds::resolve() {
+    for (int i = 0; i < _CategoryMAX; i++) {
+        Category category = static_cast<Category>(i);
+        ids[i].clear();
+        resource_id_t id = 0;
+        for (Entries::iterator it = entries[i].begin(); it != entries[i].end(); it++, id++) {
+            Entry& entry = *it;
+            entry.object = find(category, entry.name);
+            if (entry.object) {
+                map_id(category, id, entry.object);
+            }
+        }
+    }
+}
+
+const ResourceIds::Entries& ResourceIds::get_entries(Category category) const {
+    return entries[category];
+}
+
+resource_id_t ResourceIds::get_id(Category category, const std::string& name) const {
+    if (name.length()) {
+        Names::const_iterator it = names[category].find(name);
+        if (it != names[category].end()) {
+            return it->second;
+        }
+    }
+
+    return ResourceIdNone;
+}
+
+resource_id_t ResourceIds::get_id(const Animation *animation) const {
+    return lookup_id(CategoryAnimation, animation);
+}
+
+resource_id_t ResourceIds::get_id(const Sound *sound) const {
+    return lookup_id(CategorySound, sound);
+}
+
+resource_id_t ResourceIds::get_id(const Object *object) const {
+    return lookup_id(CategoryObject, object);
+}
+
+resource_id_t ResourceIds::get_id(const NPC *npc) const {
+    return lookup_id(CategoryNPC, npc);
+}
+
+Animation *ResourceIds::get_animation(resource_id_t id) throw (ResourcesException) {
+    return static_cast<Animation *>(get(CategoryAnimation, id));
+}
+
+Sound *ResourceIds::get_sound(resource_id_t id) throw (ResourcesException) {
+    return static_cast<Sound *>(get(CategorySound, id));
+}
+
+Object *ResourceIds::get_object(resource_id_t id) throw (ResourcesException) {
+    return static_cast<Object *>(get(CategoryObject, id));
+}
+
+NPC *ResourceIds::get_npc(resource_id_t id) throw (ResourcesException) {
+    return static_cast<NPC *>(get(CategoryNPC, id));
+}
+
+Properties *ResourceIds::get_properties(Category category, void *object) {
+    switch (category) {
+        case CategoryAnimation:
+            return static_cast<Animation *>(object);
+
+        case CategorySound:
+            return static_cast<Sound *>(object);
+
+        case CategoryObject:
+            return static_cast<Object *>(object);
+
+        case CategoryNPC:
+            return static_cast<NPC *>(object);
+
+        default:
+            break;
+    }
+
+    return 0;
+}
+
+resource_id_t ResourceIds::lookup_id(Category category, const Properties *props) const {
+    if (props) {
+        const Ids& cids = ids[category];
+        size_t index = props->get_resource_index();
+        if (index < cids.size()) {
+            return cids[index];
+        }
+    }
+
+    return ResourceIdNone;
+}
+
+void ResourceIds::map_id(Category category, resource_id_t id, void *object) {
+    Ids& cids = ids[category];
+    size_t index = get_properties(category, object)->get_resource_index();
+    if (index >= cids.size()) {
+        cids.resize(index + 1, ResourceIdNone);
+    }
+    cids[index] = id;
+}
+
+void *ResourceIds::find(Category category, const std::string& name) {
+    try {
+        switch (category) {
+            case CategoryAnimation:
+                return resources.get_animation(name);
+
+            case CategorySound:
+                return resources.get_sound(name);
+
+            case CategoryObject:
+                return resources.get_object(name);
+
+            case CategoryNPC:
+                return resources.get_npc(name);
+
+            default:
+                break;
+        }
+    } catch (const ResourcesException&) {
+        /* chomp */
+    }
+
+    return 0;
+}
+
+void *ResourceIds::get(Category category, resource_id_t id) throw (ResourcesException) {
+    const Entries& ents = entries[category];
+    if (id < ents.size() && ents[id].object) {
+        return ents[id].object;
+    }
+
+    char buffer[64];
+    sprintf(buffer, "%s id %d not found", category_names[category], static_cast<int>(id));
+    throw ResourcesException(buffer);
+}
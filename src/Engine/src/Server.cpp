@@ -1,6 +1,7 @@
 #include "Server.hpp"
 #include "Timing.hpp"
 #include "Utils.hpp"
+#include "AllocationTracker.hpp"
 
 #include <string>
 #include <cstdlib>
@@ -17,6 +18,15 @@ const ns_t CalcCycleNS = CycleS / CalcCyclesPerS;
 const int BroadcastsPerS = 15;
 const int BroadcastCount = CalcCyclesPerS / BroadcastsPerS;
 
+/* a scrape sees numbers at most a second old */
+const ms_t MetricsPublishMS = 1000;
+
+/* the heaviest message types of a bandwidth report */
+const size_t BandwidthReportLines = 12;
+
+/* the most allocating call sites of an allocation report */
+const size_t AllocationReportSites = 12;
+
 const char *logout_messages[] = {
     "gone, gone... gone",
     "ended in smoke",
@@ -37,8 +47,22 @@ const char *non_downloadable_pak_files[] = {
     0
 };
 
+const char *profile_phase_names[] = {
+    "tick",
+    "cycle",
+    "update_states",
+    "responses",
+    "new_map",
+    "broadcast",
+    "logger",
+    "master_server",
+    "bots",
+    0
+};
+
 const char *DefaultTeamRed = "team red";
 const char *DefaultTeamBlue = "team blue";
+const char *DefaultBotName = "bot";
 
 /* ingame server constructor */
 Server::Server(Resources& resources, Subsystem& subsystem,
@@ -47,23 +71,31 @@ Server::Server(Resources& resources, Subsystem& subsystem,
     : Properties(""), ClientServer(port, num_players, server_name, ""),
       resources(resources), subsystem(subsystem),
       factory(resources, subsystem, 0),
+      own_jobs(new JobSystem(JobSystem::get_default_worker_count())),
       nbr_logout_msg(0), running(false), current_config(0), score_board_counter(0),
       warmup(false), hold_disconnected_players(false), reconnect_kills(0),
       hdp_counter(0), master_server(0), ms_counter(0), master_socket(),
       rotation_current_index(0), team_red_name(DefaultTeamRed), team_blue_name(DefaultTeamBlue),
       log_file(0), logger(subsystem.get_stream(), true), server_admin(0),
-      reload_map_rotation(false)
+      reload_map_rotation(false), bot_count(0), navigation(0), preloader(0),
+      checkpoint_interval(0), checkpoint_counter(0), journal(0), metrics(0),
+      metrics_counter(0), bandwidth_log_interval(0), bandwidth_log_counter(0)
 {
+    factory.get_resource_ids().assign();
+    factory.set_job_system(own_jobs);
+    factory.set_random(&game_random);
+    setup_profiler();
     map_configs.push_back(MapConfiguration(type, map_name, duration, warmup));
 }
 
 /* dedicated server constructor */
 Server::Server(Resources& resources, Subsystem& subsystem,
-    const std::string& server_config_file) throw (Exception)
+    const std::string& server_config_file, JobSystem *jobs) throw (Exception)
     : Properties(server_config_file),
       ClientServer(atoi(get_value("port").c_str()), atoi(get_value("num_players").c_str()), get_value("server_name"), get_value("server_password")),
       resources(resources), subsystem(subsystem),
       factory(resources, subsystem, 0),
+      own_jobs(jobs ? 0 : new JobSystem(JobSystem::get_default_worker_count())),
       nbr_logout_msg(0), running(false), current_config(0), score_board_counter(0),
       warmup(false), hold_disconnected_players(atoi(get_value("hold_disconnected_player").c_str()) != 0 ? true : false),
       reconnect_kills(atoi(get_value("reconnect_kills").c_str())),
@@ -72,17 +104,63 @@ Server::Server(Resources& resources, Subsystem& subsystem,
       team_red_name(get_value("clan_red_name")),
       team_blue_name(get_value("clan_blue_name")),
       log_file(0), logger(create_log_stream(), true), server_admin(0),
-      reload_map_rotation(false)
+      reload_map_rotation(false), bot_count(atoi(get_value("bots").c_str())), navigation(0),
+      preloader(0), checkpoint_file(get_value("checkpoint_file")),
+      checkpoint_interval(atoi(get_value("checkpoint_interval").c_str()) * 1000),
+      checkpoint_counter(0), journal(0), metrics(0), metrics_counter(0),
+      bandwidth_log_interval(atoi(get_value("bandwidth_log_interval").c_str()) * 1000),
+      bandwidth_log_counter(0)
 {
+    factory.get_resource_ids().assign();
+    factory.set_job_system(jobs ? jobs : own_jobs);
+    factory.set_random(&game_random);
+    setup_profiler();
     load_map_rotation();
     check_team_names();
 
+    /* file logging goes through a writer thread, off the tick */
+    if (log_file) {
+        if (!logger.start_writer(get_value("logfile_format") == "binary")) {
+            subsystem << "can't start log writer, logging synchronously" << std::endl;
+        }
+    }
+
+    /* record the inputs for an offline replay */
+    const std::string& journal_file = get_value("input_journal");
+    if (journal_file.length()) {
+        try {
+            journal = new InputJournal(journal_file, game_random);
+        } catch (const InputJournalException& e) {
+            subsystem << e.what() << std::endl;
+        }
+    }
+
+    /* metrics for a prometheus scraper */
+    int metrics_port = atoi(get_value("metrics_port").c_str());
+    if (metrics_port) {
+        std::string metrics_address = get_value("metrics_address");
+        try {
+            metrics = new ServerMetrics((metrics_address.length() ? metrics_address : "127.0.0.1"),
+                static_cast<hostport_t>(metrics_port));
+        } catch (const ServerMetricsException& e) {
+            subsystem << e.what() << std::endl;
+        }
+    }
+
     /* create server admin console */
     set_server(this);
     server_admin = new ServerAdmin(resources, *this, *this);
+
+    /* continue the match of a previous run */
+    restore_checkpoint();
 }
 
 Server::~Server() {
+    /* wait for the worker */
+    if (preloader) {
+        delete preloader;
+    }
+
     /* delete server console */
     if (server_admin) {
         delete server_admin;
@@ -95,6 +173,18 @@ Server::~Server() {
     for (Players::iterator it = players.begin(); it != players.end(); it++) {
         delete *it;
     }
+    for (Players::iterator it = relays.begin(); it != relays.end(); it++) {
+        delete *it;
+    }
+
+    /* free bots */
+    for (Bots::iterator it = bots.begin(); it != bots.end(); it++) {
+        delete *it;
+    }
+
+    if (navigation) {
+        delete navigation;
+    }
 
     cleanup_held_players();
 
@@ -103,9 +193,23 @@ Server::~Server() {
         tournament = 0;
     }
 
+    if (journal) {
+        delete journal;
+    }
+
+    if (metrics) {
+        delete metrics;
+    }
+
+    /* the writer must be done with the file */
+    logger.stop_writer();
     if (log_file) {
         delete log_file;
     }
+
+    if (own_jobs) {
+        delete own_jobs;
+    }
 }
 
 void Server::start() throw (ServerException) {
@@ -113,6 +217,11 @@ void Server::start() throw (ServerException) {
     running = true;
     thread();
 #else
+    start_thread();
+#endif
+}
+
+void Server::start_thread() throw (ServerException) {
     if (!running) {
         running = true;
         if (!thread_start()) {
@@ -120,7 +229,6 @@ void Server::start() throw (ServerException) {
             throw ServerException("Starting server thread failed.");
         }
     }
-#endif
 }
 
 void Server::stop() {
@@ -138,11 +246,114 @@ void Server::reload_config() throw (ServerException) {
     master_server = resolve_host(get_value("master_server"));
     team_red_name = get_value("clan_red_name");
     team_blue_name = get_value("clan_blue_name");
+    bot_count = atoi(get_value("bots").c_str());
+    checkpoint_file = get_value("checkpoint_file");
+    checkpoint_interval = atoi(get_value("checkpoint_interval").c_str()) * 1000;
+    bandwidth_log_interval = atoi(get_value("bandwidth_log_interval").c_str()) * 1000;
     check_team_names();
     reload_map_rotation = true;
     factory.set_tournament_server_flags(*this, tournament);
 }
 
+void Server::profile(const Connection *c, const std::string& params) throw (Exception) {
+    Profiler::Report lines;
+    if (params == "reset") {
+        profiler.reset();
+        lines.push_back("profiler reset");
+    } else if (params == "trace") {
+        if (!profiler.is_tracing()) {
+            throw ServerException("Tracing is disabled, set profiler_trace_events");
+        }
+        profiler.write_trace(trace_file);
+        lines.push_back("trace written to " + trace_file);
+    } else if (!params.length()) {
+        profiler.report(lines);
+    } else {
+        throw ServerException("Usage: /profile [reset|trace]");
+    }
+
+    for (Profiler::Report::iterator it = lines.begin(); it != lines.end(); it++) {
+        const std::string& line = *it;
+        subsystem << line << std::endl;
+        send_data(c, 0, GPCTextMessage, NetFlagsReliable, line.length(), line.c_str());
+    }
+}
+
+void Server::checkpoint(const Connection *c) throw (Exception) {
+    if (!checkpoint_file.length()) {
+        throw ServerException("No checkpoint_file configured");
+    }
+    save_checkpoint();
+
+    std::string msg("checkpoint written to " + checkpoint_file);
+    subsystem << msg << std::endl;
+    send_data(c, 0, GPCTextMessage, NetFlagsReliable, msg.length(), msg.c_str());
+}
+
+void Server::bandwidth_report(const Connection *c, const std::string& params) throw (Exception) {
+    Bandwidth::Report lines;
+    if (params == "reset") {
+        get_bandwidth().reset();
+        for (Players::iterator it = players.begin(); it != players.end(); it++) {
+            (*it)->bandwidth.reset();
+        }
+        lines.push_back("bandwidth counters reset");
+    } else if (!params.length()) {
+        get_bandwidth().report(lines, true, BandwidthReportLines);
+    } else {
+        Player *p = 0;
+        for (Players::iterator it = players.begin(); it != players.end(); it++) {
+            if ((*it)->get_player_name() == params) {
+                p = *it;
+                break;
+            }
+        }
+        if (!p) {
+            throw ServerException("Usage: /bandwidth [player name|reset]");
+        }
+        lines.push_back("bandwidth of " + p->get_player_name());
+        p->bandwidth.report(lines, true, BandwidthReportLines);
+    }
+
+    for (Bandwidth::Report::iterator it = lines.begin(); it != lines.end(); it++) {
+        const std::string& line = *it;
+        subsystem << line << std::endl;
+        send_data(c, 0, GPCTextMessage, NetFlagsReliable, line.length(), line.c_str());
+    }
+}
+
+void Server::allocations(const Connection *c, const std::string& params) throw (Exception) {
+    AllocationTracker::Report lines;
+    if (AllocationTracker::is_available() && !AllocationTracker::is_attached()) {
+        throw ServerException("Allocations are tracked in another server");
+    }
+    if (params == "reset") {
+        if (!AllocationTracker::is_available()) {
+            throw ServerException("Allocation tracking is not built in");
+        }
+        AllocationTracker::reset();
+        lines.push_back("allocation counters reset");
+    } else if (!params.length()) {
+        AllocationTracker::report(lines, AllocationReportSites);
+    } else {
+        throw ServerException("Usage: /allocations [reset]");
+    }
+
+    for (AllocationTracker::Report::iterator it = lines.begin(); it != lines.end(); it++) {
+        const std::string& line = *it;
+        subsystem << line << std::endl;
+        send_data(c, 0, GPCTextMessage, NetFlagsReliable, line.length(), line.c_str());
+    }
+}
+
+void Server::log_bandwidth() {
+    Bandwidth::Report lines;
+    get_bandwidth().report(lines, true, BandwidthReportLines);
+    for (Bandwidth::Report::iterator it = lines.begin(); it != lines.end(); it++) {
+        subsystem << *it << std::endl;
+    }
+}
+
 void Server::thread() {
     char msbuf[64];
     bool done;
@@ -165,6 +376,9 @@ void Server::thread() {
 
         /* init */
         get_now(last);
+        if (!AllocationTracker::attach()) {
+            subsystem << "allocations are tracked in another server, not in this one" << std::endl;
+        }
 
         /* loop */
         int send_counter = 0;
@@ -172,6 +386,7 @@ void Server::thread() {
             try {
                 /* process incoming messages */
                 try {
+                    ProfilerScope scope(&profiler, ProfilePhaseCycle);
                     while (cycle());
                 } catch (const Exception& e) {
                     subsystem << e.what() << std::endl;
@@ -181,13 +396,27 @@ void Server::thread() {
                 get_now(now);
                 diff_now = diff_ns(last, now) + diff_last;
                 if (diff_now >= CalcCycleNS) {
+                    ProfilerScope tick_scope(&profiler, ProfilePhaseTick);
                     diff_milliseconds = diff_ms(last, now);
                     diff_last = diff_now - CalcCycleNS;
                     last = now;
 
                     /* tournament update */
                     if (tournament) {
-                        tournament->update_states(diff_now);
+                        {
+                            ProfilerScope scope(&profiler, ProfilePhaseBots);
+                            update_bots();
+                            join_bots();
+                            if (journal) {
+                                journal->tick(diff_now);
+                            }
+                            think_bots(diff_now);
+                        }
+                        {
+                            ProfilerScope scope(&profiler, ProfilePhaseUpdateStates);
+                            tournament->update_states(diff_now);
+                        }
+                        ProfilerScope scope(&profiler, ProfilePhaseResponses);
                         Tournament::StateResponses& responses = tournament->get_state_responses();
                         size_t sz = responses.size();
                         for (size_t i = 0; i < sz; i++) {
@@ -196,6 +425,12 @@ void Server::thread() {
                         }
                         tournament->delete_responses();
 
+                        /* the response arena only grows until it fits a busy tick */
+                        size_t heap_allocations = tournament->get_response_heap_allocations();
+                        if (heap_allocations && metrics) {
+                            metrics->get_sample().response_heap_allocations += heap_allocations;
+                        }
+
                         /* respawn request of player? */
                         for (Players::iterator it = players.begin(); it != players.end(); it++) {
                             Player *p = *it;
@@ -205,6 +440,10 @@ void Server::thread() {
                                     if (!p->is_alive_and_playing()) {
                                         p->state.server_state.flags &= PlayerServerFlagTeamRed;
                                         p->zero();
+                                        /* clients spawn themselves, bots are placed here */
+                                        if (p->bot) {
+                                            tournament->spawn_player(p);
+                                        }
                                         GPlayerState state;
                                         memset(&state, 0, GPlayerStateLen);
                                         state = p->state;
@@ -217,6 +456,37 @@ void Server::thread() {
 
                         /* flush */
                         flush_stacked_broadcast_data_synced(NetFlagsReliable);
+
+                        if (journal) {
+                            journal->tick_done(tournament, players);
+                            if (journal->is_broken()) {
+                                subsystem << "can't write input journal, journal stopped" << std::endl;
+                                delete journal;
+                                journal = 0;
+                            }
+                        }
+                    }
+
+                    /* checkpoint the match from time to time */
+                    if (tournament && checkpoint_interval > 0) {
+                        checkpoint_counter += diff_milliseconds;
+                        if (checkpoint_counter >= checkpoint_interval) {
+                            checkpoint_counter = 0;
+                            try {
+                                save_checkpoint();
+                            } catch (const Exception& e) {
+                                subsystem << e.what() << std::endl;
+                            }
+                        }
+                    }
+
+                    /* dump the traffic per message type from time to time */
+                    if (bandwidth_log_interval > 0) {
+                        bandwidth_log_counter += diff_milliseconds;
+                        if (bandwidth_log_counter >= bandwidth_log_interval) {
+                            bandwidth_log_counter = 0;
+                            log_bandwidth();
+                        }
                     }
 
                     bool new_tournament = false;
@@ -238,6 +508,7 @@ void Server::thread() {
                     }
 
                     if (new_tournament) {
+                        ProfilerScope scope(&profiler, ProfilePhaseNewMap);
                         /* broadcast new tournament */
                         if (players.size()) {
                             bool switch_to_game = select_map();
@@ -259,7 +530,7 @@ void Server::thread() {
                             for (Tournament::GameObjects::iterator it = objects.begin();
                                 it != objects.end(); it++)
                             {
-                                GameObject *obj = *it;
+                                GameObject *obj = &*it;
                                 if (!obj->picked) {
                                     gpo.id = obj->state.id;
                                     gpo.flags = 0;
@@ -317,6 +588,9 @@ void Server::thread() {
                             /* send ready */
                             stacked_broadcast_data_synced(factory.get_tournament_id(), GPCReady, NetFlagsReliable, 0, 0);
 
+                            /* clients prepare the next map during this round */
+                            send_next_map(0);
+
                             /* send notification */
                             stacked_broadcast_data_synced(factory.get_tournament_id(), (warmup ? GPCWarmUp : GPCGameBegins), NetFlagsReliable, 0, 0);
 
@@ -331,6 +605,7 @@ void Server::thread() {
                             flush_stacked_broadcast_data_synced(NetFlagsReliable);
                         }
                     } else {
+                        ProfilerScope scope(&profiler, ProfilePhaseBroadcast);
                         /* broadcast */
                         done = false;
                         send_counter++;
@@ -371,7 +646,7 @@ void Server::thread() {
                                 for (Tournament::GameObjects::iterator it = objects.begin();
                                     it != objects.end(); it++)
                                 {
-                                    GameObject *obj = *it;
+                                    GameObject *obj = &*it;
                                     if (obj->object->get_physics()) {
                                         objstat = obj->state;
                                         objstat.to_net();
@@ -387,7 +662,7 @@ void Server::thread() {
                                 for (Tournament::GameAnimations::iterator it = animations.begin();
                                     it != animations.end(); it++)
                                 {
-                                    GameAnimation *ani = *it;
+                                    GameAnimation *ani = &*it;
                                     if (ani->animation->get_physics()) {
                                        anistat = ani->state;
                                        anistat.to_net();
@@ -401,7 +676,7 @@ void Server::thread() {
                                 for (Tournament::SpawnableNPCs::iterator it = spawnable_npcs.begin();
                                     it != spawnable_npcs.end(); it++)
                                 {
-                                    SpawnableNPC *npc = *it;
+                                    SpawnableNPC *npc = &*it;
                                     npcstat = npc->state;
                                     npcstat.to_net();
                                     stacked_broadcast_data_synced(factory.get_tournament_id(), GPCUpdateSpawnableNPC, 0, GNPCStateLen, &npcstat);
@@ -455,12 +730,18 @@ void Server::thread() {
                             }
                         }
                     }
+
+                    if (metrics) {
+                        update_metrics(now, diff_milliseconds);
+                    }
+                    AllocationTracker::tick();
                 }
 
                 /* update master server all 5 seconds */
                 if (master_server) {
                     ms_counter++;
                     if (ms_counter >= 10000) {
+                        ProfilerScope scope(&profiler, ProfilePhaseMasterServer);
                         ms_counter = 0;
                         sprintf(msbuf, "%hu", get_port());
                         master_socket.send(master_server, 25112, msbuf, strlen(msbuf));
@@ -468,16 +749,8 @@ void Server::thread() {
                 }
 
                 /* delayed force quit clients? (once per cycle) */
-                for (Players::iterator it = players.begin(); it != players.end(); it++) {
-                    Player *p = *it;
-                    if (p->server_force_quit_client) {
-                        p->server_force_quit_client_counter--;
-                        if (!p->server_force_quit_client_counter) {
-                            kill(p->get_connection());
-                            break;
-                        }
-                    }
-                }
+                force_quit_clients(players);
+                force_quit_clients(relays);
 
                 /* wait for 1 ms */
                 wait_ns(1000000);
@@ -486,33 +759,37 @@ void Server::thread() {
                 broadcast_data(0, GPCServerQuit, NetFlagsReliable, strlen(e.what()), e.what());
             }
         }
+
+        /* leave a checkpoint to continue from */
+        if (tournament && checkpoint_file.length()) {
+            save_checkpoint();
+        }
     } catch (const Exception& e) {
         subsystem << e.what() << std::endl;
     }
+    AllocationTracker::detach();
+}
+
+bool Server::is_relay_login(data_len_t len, const void *data) {
+    if (len < GPlayerLoginLen) {
+        return false;
+    }
+
+    return ((reinterpret_cast<const GPlayerLogin *>(data)->flags & LoginFlagRelay) != 0);
 }
 
 void Server::event_login(const Connection *c, data_len_t len, void *data) throw (Exception) {
     GPlayerDescription *desc = reinterpret_cast<GPlayerDescription *>(data);
     desc->player_name[NameLength - 1] = 0;
     desc->characterset_name[NameLength - 1] = 0;
-    size_t sz = players.size();
+    if (is_relay_login(len, data)) {
+        relay_login(c, desc);
+        return;
+    }
 
-    /* brute force finding routine, have to improve it sometime */
-    player_id_t player_id = 1;
+    size_t sz = players.size();
+    player_id_t player_id = get_free_player_id();
     bool found;
-    do {
-        found = false;
-        for (size_t i = 0; i < sz; i++) {
-            Player *p = players[i];
-            if (p->state.id == player_id) {
-                found = true;
-                break;
-            }
-        }
-        if(found) {
-            player_id++;
-        }
-    } while (found);
 
     /* add new player */
     Player *p = new Player(resources, c, player_id, desc->player_name,
@@ -521,27 +798,27 @@ void Server::event_login(const Connection *c, data_len_t len, void *data) throw
     sz++;
     std::string msg(p->get_player_name() + " connected");
 
-    /* reattach disconnect player? */
+    /* reattach disconnect player? restored ones are held too */
     found = false;
-    if (hold_disconnected_players) {
-        for (HeldPlayerStats::iterator it = held_player_stats.begin();
-            it != held_player_stats.end(); it++)
-        {
-            PlayerStats *ps = *it;
-            if (ps->host == c->host && ps->player_name == p->get_player_name()) {
-                /* reconnect if same tournament */
-                if (ps->tournament_id == factory.get_tournament_id()) {
-                    found = true;
-                    p->state.server_state = ps->server_state;
-                    p->state.client_server_state = ps->client_server_state;
+    for (HeldPlayerStats::iterator it = held_player_stats.begin();
+        it != held_player_stats.end(); it++)
+    {
+        PlayerStats *ps = *it;
+        if (ps->host == c->host && ps->player_name == p->get_player_name()) {
+            /* reconnect if same tournament */
+            if (ps->tournament_id == factory.get_tournament_id()) {
+                found = true;
+                p->state.server_state = ps->server_state;
+                p->state.client_server_state = ps->client_server_state;
+                if (!ps->restored) {
                     p->state.server_state.kills += reconnect_kills;
                     p->state.server_state.score -= reconnect_kills;
-                    p->state.server_state.flags |= PlayerServerFlagDead;
                 }
-                delete ps;
-                held_player_stats.erase(it);
-                break;
+                p->state.server_state.flags |= PlayerServerFlagDead;
             }
+            delete ps;
+            held_player_stats.erase(it);
+            break;
         }
     }
     if (found) {
@@ -607,7 +884,15 @@ void Server::event_data(const Connection *c, data_len_t len, void *data) throw (
         }
     }
 
-    if (p) {
+    if (!p) {
+        for (Players::iterator it = relays.begin(); it != relays.end(); it++) {
+            if ((*it)->get_connection() == c) {
+                relay_data(*it, len, data);
+                break;
+            }
+        }
+    } else {
+        count_received(p, data, len);
         GTransport *t = reinterpret_cast<GTransport *>(data);
         while (true) {
             t->from_net();
@@ -616,6 +901,7 @@ void Server::event_data(const Connection *c, data_len_t len, void *data) throw (
                 {
                     if (t->tournament_id == factory.get_tournament_id()) {
                         if (p->client_synced) {
+                            journal_input(p, t);
                             GPlayerClientServerState *state = reinterpret_cast<GPlayerClientServerState *>(t->data);
                             state->from_net();
                             p->state.client_server_state = *state;
@@ -628,6 +914,7 @@ void Server::event_data(const Connection *c, data_len_t len, void *data) throw (
                 {
                     if (t->tournament_id == factory.get_tournament_id()) {
                         if (p->client_synced) {
+                            journal_input(p, t);
                             p->respawning = true;
                         }
                     }
@@ -638,6 +925,7 @@ void Server::event_data(const Connection *c, data_len_t len, void *data) throw (
                 {
                     if (t->tournament_id == factory.get_tournament_id()) {
                         if (p->client_synced) {
+                            journal_input(p, t);
                             playerflags_t *flags = reinterpret_cast<playerflags_t *>(t->data);
                             if (tournament) {
                                 if (tournament->get_game_state().seconds_remaining) {
@@ -678,6 +966,7 @@ void Server::event_data(const Connection *c, data_len_t len, void *data) throw (
                     if (t->tournament_id == factory.get_tournament_id()) {
                         if (p->client_synced) {
                             if (tournament) {
+                                journal_input(p, t);
                                 unsigned char *dir = reinterpret_cast<unsigned char *>(t->data);
                                 tournament->fire_shot(p, *dir);
                             }
@@ -691,6 +980,7 @@ void Server::event_data(const Connection *c, data_len_t len, void *data) throw (
                     if (t->tournament_id == factory.get_tournament_id()) {
                         if (p->client_synced) {
                             if (tournament) {
+                                journal_input(p, t);
                                 unsigned char *dir = reinterpret_cast<unsigned char *>(t->data);
                                 tournament->fire_grenade(p, *dir);
                             }
@@ -704,6 +994,7 @@ void Server::event_data(const Connection *c, data_len_t len, void *data) throw (
                     if (t->tournament_id == factory.get_tournament_id()) {
                         if (p->client_synced) {
                             if (tournament) {
+                                journal_input(p, t);
                                 unsigned char *dir = reinterpret_cast<unsigned char *>(t->data);
                                 tournament->fire_bomb(p, *dir);
                             }
@@ -717,6 +1008,7 @@ void Server::event_data(const Connection *c, data_len_t len, void *data) throw (
                     if (t->tournament_id == factory.get_tournament_id()) {
                         if (p->client_synced) {
                             if (tournament) {
+                                journal_input(p, t);
                                 unsigned char *dir = reinterpret_cast<unsigned char *>(t->data);
                                 tournament->fire_frog(p, *dir);
                             }
@@ -727,6 +1019,9 @@ void Server::event_data(const Connection *c, data_len_t len, void *data) throw (
 
                 case GPSPlayerChanged:
                 {
+                    if (p->client_synced) {
+                        journal_input(p, t);
+                    }
                     GPlayerDescription *pdesc = reinterpret_cast<GPlayerDescription *>(t->data);
                     std::string old_name = p->get_player_name();
                     std::string new_name(pdesc->player_name);
@@ -755,6 +1050,7 @@ void Server::event_data(const Connection *c, data_len_t len, void *data) throw (
                     if (t->tournament_id == factory.get_tournament_id()) {
                         if (p->client_synced) {
                             if (tournament) {
+                                journal_input(p, t);
                                 GTransportTime *race = reinterpret_cast<GTransportTime *>(t->data);
                                 race->from_net();
                                 tournament->round_finished_set_time(p, race);
@@ -766,38 +1062,7 @@ void Server::event_data(const Connection *c, data_len_t len, void *data) throw (
 
                 case GPSPakSyncHash:
                 {
-                    GPakHash *hash = reinterpret_cast<GPakHash *>(t->data);
-                    hash->from_net();
-                    std::string pak_name = hash->pak_name;
-                    std::string pak_hash(hash->pak_hash, GPakHash::HashLength);
-                    const Resources::LoadedPaks& my_paks = resources.get_loaded_paks();
-                    for (Resources::LoadedPaks::const_iterator it = my_paks.begin(); it != my_paks.end(); it++) {
-                        const Resources::LoadedPak& my_pak = *it;
-                        if (my_pak.pak_short_name == pak_name) {
-                            if (my_pak.pak_hash == pak_hash) {
-                                /* hash is correct, remove from download list */
-                                PlayerClientPak *pcpak = get_player_client_pak(p);
-                                for (ClientPaks::iterator it = pcpak->client_paks.begin(); it != pcpak->client_paks.end(); it++) {
-                                    ClientPak& cpak = *it;
-                                    if (cpak.pak->pak_short_name == my_pak.pak_short_name) {
-                                        pcpak->client_paks.erase(it);
-                                        break;
-                                    }
-                                }
-                            } else {
-                                /* non downloadable pak file? */
-                                const char **ptr = non_downloadable_pak_files;
-                                while (*ptr) {
-                                    if (!strcmp(*ptr, pak_name.c_str())) {
-                                        quit_client(c, p, "Main pak '" + pak_name + "' has a different hash.");
-                                        break;
-                                    }
-                                    ptr++;
-                                }
-                            }
-                            break;
-                        }
-                    }
+                    check_pak_hash(c, p, reinterpret_cast<GPakHash *>(t->data));
                     break;
                 }
 
@@ -827,6 +1092,10 @@ void Server::event_data(const Connection *c, data_len_t len, void *data) throw (
 }
 
 void Server::event_logout(const Connection *c, LogoutReason reason) throw (Exception) {
+    if (relay_logout(c)) {
+        return;
+    }
+
     for (Players::iterator it = players.begin(); it != players.end(); it++) {
         Player *p = *it;
         if (p->get_connection() == c) {
@@ -839,6 +1108,7 @@ void Server::event_logout(const Connection *c, LogoutReason reason) throw (Excep
                     pst->tournament_id = factory.get_tournament_id();
                     pst->server_state = p->state.server_state;
                     pst->client_server_state = p->state.client_server_state;
+                    pst->restored = false;
                     held_player_stats.push_back(pst);
                 }
             }
@@ -865,6 +1135,9 @@ void Server::event_logout(const Connection *c, LogoutReason reason) throw (Excep
             /* send remove to all clients if client is synced */
             if (p->client_synced) {
                 /* inform tournament */
+                if (journal) {
+                    journal->player_removed(p);
+                }
                 if (tournament) {
                     tournament->player_removed(p);
                 }
@@ -880,7 +1153,8 @@ void Server::event_logout(const Connection *c, LogoutReason reason) throw (Excep
                 if (tournament) {
                     GAnimation ani;
                     memset(&ani, 0, sizeof(GAnimation));
-                    strncpy(ani.animation_name, "disappear", NameLength - 1);
+                    ani.animation_id = factory.get_resource_ids().get_id(ResourceIds::CategoryAnimation, "disappear");
+                    ani.sound_id = ResourceIdNone;
                     const CollisionBox& colbox = p->get_characterset()->get_colbox();
                     ani.id = tournament->create_animation_id();
                     ani.x = p->state.client_server_state.x + colbox.x;
@@ -890,7 +1164,7 @@ void Server::event_logout(const Connection *c, LogoutReason reason) throw (Excep
                 }
 
                 /* send bye bye message */
-                int msgidx = rand() % nbr_logout_msg;
+                int msgidx = random.next() % nbr_logout_msg;
                 std::string text(logout_messages[msgidx]);
                 Font *font = resources.get_font("normal");
                 GTextAnimation tani;
@@ -921,6 +1195,9 @@ void Server::event_logout(const Connection *c, LogoutReason reason) throw (Excep
         }
     }
 
+    /* bots fill the empty slot or leave with the last human */
+    update_bots();
+
     /* if last player, close tournament */
     if (!players.size()) {
         if (tournament) {
@@ -931,6 +1208,23 @@ void Server::event_logout(const Connection *c, LogoutReason reason) throw (Excep
     }
 }
 
+void Server::setup_profiler() {
+    for (const char **name = profile_phase_names; *name; name++) {
+        profiler.add_phase(*name);
+    }
+
+    int events = atoi(get_value("profiler_trace_events").c_str());
+    if (events > 0) {
+        profiler.enable_trace(events);
+        trace_file = get_value("profiler_trace_file");
+        if (!trace_file.length()) {
+            trace_file = "trace.json";
+        }
+    }
+
+    logger.set_profiler(&profiler, ProfilePhaseLogger);
+}
+
 bool Server::select_map() {
     bool switch_to_game = false;
 
@@ -969,14 +1263,263 @@ bool Server::select_map() {
         }
     }
 
-    tournament = factory.create_tournament(*current_config, true, warmup, players, &logger);
+    if (journal) {
+        journal->tournament_started(*current_config, warmup, switch_to_game,
+            atoi(get_value("friendly_fire_alarm").c_str()) != 0, team_red_name, team_blue_name);
+    }
+    tournament = factory.create_tournament(*current_config, true, warmup, players, &logger, preloader);
     tournament->set_team_names(team_red_name, team_blue_name);
     factory.set_tournament_server_flags(*this, tournament);
+
+    /* the navigation graph belongs to the old map, take the preloaded one */
+    if (navigation) {
+        delete navigation;
+        navigation = 0;
+    }
+    if (preloader) {
+        if (preloader->get_map_name() == current_config->map_name) {
+            navigation = preloader->release_navigation();
+        }
+        delete preloader;
+        preloader = 0;
+    }
+    for (Bots::iterator it = bots.begin(); it != bots.end(); it++) {
+        (*it)->reset();
+    }
+
+    preload_next_map();
     score_board_counter = 30000;
 
     return switch_to_game;
 }
 
+void Server::preload_next_map() {
+    /* after the warm up the same map is played, otherwise the next in rotation */
+    const MapConfiguration *next = current_config;
+    if (!warmup && !map_configs.empty()) {
+        next = &map_configs[rotation_current_index];
+    }
+    next_map_name = next->map_name;
+
+    /* the server itself has only the bot navigation to prepare */
+    if (bot_count > 0) {
+        try {
+            int height = get_bot_characterset()->get_colbox().height;
+            preloader = new MapPreloader(resources, next_map_name, false, height);
+        } catch (const ResourcesException& e) {
+            subsystem << e.what() << std::endl;
+        }
+    }
+}
+
+void Server::send_next_map(const Connection *c) {
+    if (next_map_name.length()) {
+        GNextMap next;
+        memset(&next, 0, GNextMapLen);
+        strncpy(next.map_name, next_map_name.c_str(), NameLength - 1);
+        if (c) {
+            stacked_send_data(c, factory.get_tournament_id(), GPCNextMap, NetFlagsReliable, GNextMapLen, &next);
+        } else {
+            stacked_broadcast_data_synced(factory.get_tournament_id(), GPCNextMap, NetFlagsReliable, GNextMapLen, &next);
+        }
+    }
+}
+
+player_id_t Server::get_free_player_id() {
+    size_t sz = players.size();
+
+    /* brute force finding routine, have to improve it sometime */
+    player_id_t player_id = 1;
+    bool found;
+    do {
+        found = false;
+        for (size_t i = 0; i < sz; i++) {
+            Player *p = players[i];
+            if (p->state.id == player_id) {
+                found = true;
+                break;
+            }
+        }
+        if(found) {
+            player_id++;
+        }
+    } while (found);
+
+    return player_id;
+}
+
+Characterset *Server::get_bot_characterset() throw (ResourcesException) {
+    const std::string& name = get_value("bot_characterset");
+    if (name.length()) {
+        return resources.get_characterset(name);
+    }
+
+    Resources::ResourceObjects& sets = resources.get_charactersets();
+    if (!sets.size()) {
+        throw ResourcesException("No characterset found for bots");
+    }
+
+    return static_cast<Characterset *>(sets[0].object);
+}
+
+void Server::update_bots() throw (Exception) {
+    /* bots only keep humans company */
+    int humans = 0;
+    for (Players::iterator it = players.begin(); it != players.end(); it++) {
+        if (!(*it)->bot) {
+            humans++;
+        }
+    }
+
+    int wanted = (humans ? bot_count - humans : 0);
+    if (wanted < 0) {
+        wanted = 0;
+    }
+
+    while (static_cast<int>(bots.size()) > wanted) {
+        remove_bot();
+    }
+
+    if (tournament && wanted) {
+        if (!navigation) {
+            navigation = new Navigation(tournament->get_map(), tournament->get_tileset(),
+                get_bot_characterset()->get_colbox().height);
+        }
+        while (static_cast<int>(bots.size()) < wanted) {
+            add_bot();
+        }
+    }
+}
+
+void Server::add_bot() throw (Exception) {
+    player_id_t player_id = get_free_player_id();
+    std::string name(get_value("bot_name"));
+    if (!name.length()) {
+        name = DefaultBotName;
+    }
+    char number[16];
+    sprintf(number, " %d", static_cast<int>(player_id));
+    name += number;
+
+    Player *p = new Player(resources, 0, player_id, name, get_bot_characterset()->get_name());
+    p->bot = true;
+    p->client_synced = true;
+    players.push_back(p);
+    bots.push_back(new Bot(p));
+
+    /* announce to all clients */
+    GPlayerInfo info;
+    memset(&info, 0, sizeof(GPlayerInfo));
+    strncpy(info.desc.player_name, p->get_player_name().c_str(), NameLength - 1);
+    strncpy(info.desc.characterset_name, p->get_characterset()->get_name().c_str(), NameLength - 1);
+    info.id = p->state.id;
+    info.server_state = p->state.server_state;
+    info.client_server_state = p->state.client_server_state;
+    info.client_state = p->state.client_state;
+    info.to_net();
+    broadcast_data(factory.get_tournament_id(), GPCAddPlayer, NetFlagsReliable, GPlayerInfoLen, &info);
+
+    std::string msg(p->get_player_name() + " connected");
+    logger.log(ServerLogger::LogTypePlayerConnect, msg, p);
+    broadcast_data(factory.get_tournament_id(), GPCTextMessage, NetFlagsReliable, static_cast<data_len_t>(msg.length()), msg.c_str());
+
+    if (journal) {
+        journal->player_added(p, players);
+    }
+    tournament->player_added(p);
+    if (tournament->get_game_state().seconds_remaining) {
+        join_bot(p);
+    }
+}
+
+void Server::remove_bot() {
+    Bot *bot = bots.back();
+    bots.pop_back();
+    Player *p = bot->get_player();
+    delete bot;
+
+    if (journal) {
+        journal->player_removed(p);
+    }
+    if (tournament) {
+        tournament->player_removed(p);
+    }
+
+    player_id_t id = htons(p->state.id);
+    stacked_broadcast_data_synced(factory.get_tournament_id(), GPCRemovePlayer, NetFlagsReliable, sizeof(id), &id);
+    flush_stacked_broadcast_data_synced(NetFlagsReliable);
+
+    std::string msg(p->get_player_name() + " disconnected");
+    logger.log(ServerLogger::LogTypePlayerDisconnect, msg, p);
+    broadcast_data(factory.get_tournament_id(), GPCTextMessage, NetFlagsReliable, static_cast<data_len_t>(msg.length()), msg.c_str());
+
+    Players::iterator it = std::find(players.begin(), players.end(), p);
+    if (it != players.end()) {
+        players.erase(it);
+    }
+    delete p;
+}
+
+void Server::join_bot(Player *p) {
+    /* fill up the smaller team */
+    int red = 0;
+    int blue = 0;
+    for (Players::iterator it = players.begin(); it != players.end(); it++) {
+        Player *tp = *it;
+        if (tp != p && !(tp->state.server_state.flags & PlayerServerFlagSpectating)) {
+            if (tp->state.server_state.flags & PlayerServerFlagTeamRed) {
+                red++;
+            } else {
+                blue++;
+            }
+        }
+    }
+
+    /* journaled like the join request of a client */
+    playerflags_t flags = (red < blue ? PlayerServerFlagTeamRed : 0);
+    if (journal) {
+        journal->input(p, GPSJoinRequest, &flags, sizeof(flags));
+    }
+    p->state.server_state.flags &= ~PlayerServerFlagTeamRed;
+    if (tournament->player_joins(p, flags)) {
+        p->respawning = true;
+    }
+}
+
+void Server::join_bots() {
+    if (!navigation || !tournament->get_game_state().seconds_remaining) {
+        return;
+    }
+
+    /* a new map puts everybody back to the stands */
+    for (Bots::iterator it = bots.begin(); it != bots.end(); it++) {
+        Player *p = (*it)->get_player();
+        if ((p->state.server_state.flags & PlayerServerFlagSpectating) && !p->respawning) {
+            join_bot(p);
+        }
+    }
+}
+
+void Server::think_bots(ns_t ns) {
+    if (!navigation) {
+        return;
+    }
+
+    for (Bots::iterator it = bots.begin(); it != bots.end(); it++) {
+        Bot *bot = *it;
+        if (!(bot->get_player()->state.server_state.flags & PlayerServerFlagSpectating)) {
+            bot->think(*tournament, *navigation, players, ns);
+        }
+    }
+}
+
+void Server::journal_input(Player *p, GTransport *t) {
+    /* before the payload is turned to host order */
+    if (journal) {
+        journal->input(p, t->cmd, t->data, t->len);
+    }
+}
+
 void Server::cleanup_held_players() {
     for (HeldPlayerStats::iterator it = held_player_stats.begin();
         it != held_player_stats.end(); it++)
@@ -992,15 +1535,169 @@ void Server::quit_client(const Connection *c, Player *p, const std::string& mess
     p->server_force_quit_client_counter = 50;
 }
 
+void Server::relay_login(const Connection *c, const GPlayerDescription *desc) {
+    /* no player id, no slot and no entry in the player list */
+    Player *r = new Player(resources, c, 0, desc->player_name, desc->characterset_name);
+    r->relay = true;
+    relays.push_back(r);
+    logger.log(ServerLogger::LogTypePlayerConnect, "relay " + r->get_player_name() + " connected");
+
+    /* the relay sees the players as a spectator */
+    for (Players::iterator it = players.begin(); it != players.end(); it++) {
+        Player *p = *it;
+
+        memset(gplayerinfo, 0, sizeof(GPlayerInfo));
+
+        strncpy(gplayerinfo->desc.player_name, p->get_player_name().c_str(),
+            NameLength - 1);
+
+        strncpy(gplayerinfo->desc.characterset_name, p->get_characterset()->get_name().c_str(),
+            NameLength - 1);
+
+        gplayerinfo->id = p->state.id;
+        gplayerinfo->server_state = p->state.server_state;
+        gplayerinfo->client_server_state = p->state.client_server_state;
+        gplayerinfo->client_state = p->state.client_state;
+        gplayerinfo->to_net();
+        send_data(c, factory.get_tournament_id(), GPCAddPlayer, NetFlagsReliable, GPlayerInfoLen, gplayerinfo);
+    }
+
+    /* paks are synced like for clients */
+    player_client_paks.push_back(PlayerClientPak(r));
+    PlayerClientPak *pcpak = get_player_client_pak(r);
+    const Resources::LoadedPaks& my_paks = resources.get_loaded_paks();
+    for (Resources::LoadedPaks::const_iterator it = my_paks.begin(); it != my_paks.end(); it++) {
+        pcpak->client_paks.push_back(ClientPak(&*it));
+    }
+}
+
+void Server::relay_data(Player *r, data_len_t len, void *data) throw (Exception) {
+    const Connection *c = r->get_connection();
+    count_received(r, data, len);
+    GTransport *t = reinterpret_cast<GTransport *>(data);
+    while (true) {
+        t->from_net();
+        switch (t->cmd) {
+            case GPSPakSyncHash:
+                check_pak_hash(c, r, reinterpret_cast<GPakHash *>(t->data));
+                break;
+
+            case GPSPakSyncHashFinished:
+            case GPSPakSyncAck:
+                try {
+                    process_sync_pak(c, r);
+                } catch (const ServerException& e) {
+                    quit_client(c, r, e.what());
+                }
+                break;
+        }
+
+        /* advance to next element */
+        if (t->flags & TransportFlagMorePackets) {
+            unsigned char *tpb = reinterpret_cast<unsigned char *>(t);
+            tpb += GTransportLen;
+            tpb += t->len;
+            t = reinterpret_cast<GTransport *>(tpb);
+        } else {
+            break;
+        }
+    }
+}
+
+bool Server::relay_logout(const Connection *c) {
+    for (Players::iterator it = relays.begin(); it != relays.end(); it++) {
+        Player *r = *it;
+        if (r->get_connection() == c) {
+            logger.log(ServerLogger::LogTypePlayerDisconnect, "relay " + r->get_player_name() + " disconnected");
+            destroy_paks(r);
+            relays.erase(it);
+            delete r;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+void Server::check_pak_hash(const Connection *c, Player *p, GPakHash *hash) {
+    hash->from_net();
+    std::string pak_name = hash->pak_name;
+    std::string pak_hash(hash->pak_hash, GPakHash::HashLength);
+    const Resources::LoadedPaks& my_paks = resources.get_loaded_paks();
+    for (Resources::LoadedPaks::const_iterator it = my_paks.begin(); it != my_paks.end(); it++) {
+        const Resources::LoadedPak& my_pak = *it;
+        if (my_pak.pak_short_name == pak_name) {
+            if (my_pak.pak_hash == pak_hash) {
+                /* hash is correct, remove from download list */
+                PlayerClientPak *pcpak = get_player_client_pak(p);
+                for (ClientPaks::iterator it = pcpak->client_paks.begin(); it != pcpak->client_paks.end(); it++) {
+                    ClientPak& cpak = *it;
+                    if (cpak.pak->pak_short_name == my_pak.pak_short_name) {
+                        pcpak->client_paks.erase(it);
+                        break;
+                    }
+                }
+            } else {
+                /* non downloadable pak file? */
+                const char **ptr = non_downloadable_pak_files;
+                while (*ptr) {
+                    if (!strcmp(*ptr, pak_name.c_str())) {
+                        quit_client(c, p, "Main pak '" + pak_name + "' has a different hash.");
+                        break;
+                    }
+                    ptr++;
+                }
+            }
+            break;
+        }
+    }
+}
+
+void Server::force_quit_clients(Players& clients) {
+    for (Players::iterator it = clients.begin(); it != clients.end(); it++) {
+        Player *p = *it;
+        if (p->server_force_quit_client) {
+            p->server_force_quit_client_counter--;
+            if (!p->server_force_quit_client_counter) {
+                kill(p->get_connection());
+                break;
+            }
+        }
+    }
+}
+
 void Server::sync_client(const Connection *c, Player *p) {
     /* ----------------------------------- */
     /* INITIAL GAME STATE SETUP FOR CLIENT */
     /* ----------------------------------- */
 
-    /* inform tournament */
-    if (tournament) {
-        tournament->player_added(p);
+    /* inform tournament, a relay only watches */
+    if (!p->relay) {
+        if (journal) {
+            journal->player_added(p, players);
+        }
+        if (tournament) {
+            tournament->player_added(p);
+        }
+    }
+
+    /* send resource id table */
+    ResourceIds& resource_ids = factory.get_resource_ids();
+    GResourceId rid;
+    for (int i = 0; i < ResourceIds::_CategoryMAX; i++) {
+        ResourceIds::Category category = static_cast<ResourceIds::Category>(i);
+        const ResourceIds::Entries& entries = resource_ids.get_entries(category);
+        size_t sz = entries.size();
+        for (size_t j = 0; j < sz; j++) {
+            memset(&rid, 0, GResourceIdLen);
+            rid.category = static_cast<unsigned char>(category);
+            rid.id = static_cast<resource_id_t>(j);
+            strncpy(rid.name, entries[j].name.c_str(), NameLength - 1);
+            rid.to_net();
+            stacked_send_data(c, factory.get_tournament_id(), GPCResourceId, NetFlagsReliable, GResourceIdLen, &rid);
+        }
     }
+    flush_stacked_send_data(c, NetFlagsReliable);
 
     /* send current gameplay state */
     if (current_config) {
@@ -1014,6 +1711,7 @@ void Server::sync_client(const Connection *c, Player *p) {
         gt.tournament_id = factory.get_tournament_id();
         gt.to_net();
         stacked_send_data(c, factory.get_tournament_id(), GPCMapState, NetFlagsReliable, GTournamentLen, &gt);
+        send_next_map(c);
     }
 
     /* send subclassed tournament states */
@@ -1037,10 +1735,10 @@ void Server::sync_client(const Connection *c, Player *p) {
         for (Tournament::GameObjects::iterator it = objects.begin();
             it != objects.end(); it++)
         {
-            GameObject *obj = *it;
+            GameObject *obj = &*it;
             if (obj->spawned_object) {
                 memset(&so, 0, GSpawnObjectLen);
-                strncpy(so.object_name, obj->object->get_name().c_str(), NameLength - 1);
+                so.object_id = resource_ids.get_id(obj->object);
                 so.flags = 0;
                 so.id = obj->state.id;
                 so.x = static_cast<pos_t>(round(obj->state.x));
@@ -1063,10 +1761,11 @@ void Server::sync_client(const Connection *c, Player *p) {
         for (Tournament::SpawnableNPCs::iterator it = spawnable_npcs.begin();
             it != spawnable_npcs.end(); it++)
         {
-            SpawnableNPC *npc = *it;
+            SpawnableNPC *npc = &*it;
 
             memset(&npcspwn, 0, GSpawnNPCLen);
-            strncpy(npcspwn.npc_name, npc->npc->get_name().c_str(), NameLength - 1);
+            npcspwn.npc_id = resource_ids.get_id(npc->npc);
+            npcspwn.sound_id = ResourceIdNone;
             npcspwn.id = npc->state.id;
             npcspwn.owner = npc->state.owner;
             npcspwn.direction = npc->state.direction;
@@ -1085,12 +1784,11 @@ void Server::sync_client(const Connection *c, Player *p) {
         for (Tournament::GameAnimations::iterator it = animations.begin();
             it != animations.end(); it++)
         {
-            GameAnimation *ani = *it;
+            GameAnimation *ani = &*it;
             if (ani->animation->get_physics()) {
                 gani.id = ani->state.id;
-                memset(gani.animation_name, 0, NameLength);
-                strncpy(gani.animation_name, ani->animation->get_name().c_str(), NameLength - 1);
-                memset(gani.sound_name, 0, NameLength);
+                gani.animation_id = resource_ids.get_id(ani->animation);
+                gani.sound_id = ResourceIdNone;
                 gani.duration = ani->state.duration;
                 gani.owner = ani->state.owner;
                 gani.x = ani->state.x;
@@ -1161,37 +1859,44 @@ void Server::process_sync_pak(const Connection *c, Player *p) throw (ServerExcep
         if (!pcpak->current_client_pak) {
             synced = true;
         } else {
-            /* send header */
-            if (!pcpak->f) {
-                pcpak->f = fopen(pcpak->current_client_pak->pak->pak_name.c_str(), "rb");
-                if (!pcpak->f) {
-                    throw ServerException(strerror(errno));
+            /* send header, all clients share the reader of the pak */
+            if (!pcpak->zip) {
+                try {
+                    pcpak->zip = ZipReader::open(pcpak->current_client_pak->pak->pak_name);
+                } catch (const ZipReaderException& e) {
+                    throw ServerException(e.what());
                 }
                 GXferHeader header;
                 memset(&header, 0, GXferHeaderLen);
                 strncpy(header.filename, pcpak->current_client_pak->pak->pak_short_name.c_str(), FilenameLen - 1);
-                fseek(pcpak->f, 0, SEEK_END);
-                header.filesize = static_cast<datasize_t>(ftell(pcpak->f));
+                header.filesize = static_cast<datasize_t>(pcpak->zip->get_size());
+                pcpak->current_client_pak->size = header.filesize;
                 pcpak->current_client_pak->remaining = header.filesize;
-                fseek(pcpak->f, 0, SEEK_SET);
                 header.to_net();
                 send_data(c, 0, GPCXferHeader, NetFlagsReliable, GXferHeaderLen, &header);
             }
 
             /* send packet */
             GXferDataChunk *chunk = reinterpret_cast<GXferDataChunk *>(pak_buffer);
-            datasize_t csz;
+            datasize_t csz = PacketMaxSize - GXferDataChunkLen;
+            ClientPak *cpak = pcpak->current_client_pak;
+            if (csz > cpak->remaining) {
+                csz = cpak->remaining;
+            }
             memset(chunk, 0, sizeof(pak_buffer));
-            chunk->chunksize = csz = static_cast<datasize_t>(fread(chunk->data, 1, PacketMaxSize - GXferDataChunkLen, pcpak->f));
+            chunk->chunksize = csz = static_cast<datasize_t>(pcpak->zip->read_at(chunk->data, csz, cpak->size - cpak->remaining));
+            if (!csz) {
+                throw ServerException("Can't read package: " + cpak->pak->pak_name);
+            }
             chunk->to_net();
             send_data(c, 0, GPCXferDataChunk, NetFlagsReliable, GXferDataChunkLen + csz, chunk);
 
             /* last packet? */
-            pcpak->current_client_pak->remaining -= csz;
-            if (!pcpak->current_client_pak->remaining) {
-                fclose(pcpak->f);
-                pcpak->f = 0;
-                pcpak->current_client_pak->synced = true;
+            cpak->remaining -= csz;
+            if (!cpak->remaining) {
+                ZipReader::release(pcpak->zip);
+                pcpak->zip = 0;
+                cpak->synced = true;
                 pcpak->current_client_pak = 0;
             }
         }
@@ -1225,9 +1930,7 @@ void Server::destroy_paks(Player *p) {
     {
         PlayerClientPak& pak = *pit;
         if (!p || pak.p == p) {
-            if (pak.f) {
-                fclose(pak.f);
-            }
+            ZipReader::release(pak.zip);
             if (p) {
                 player_client_paks.erase(pit);
                 break;
@@ -1265,7 +1968,7 @@ void Server::load_map_rotation() {
         if (map_type_str.length()) {
             type = static_cast<GamePlayType>(atoi(get_value(kvb).c_str()));
         } else {
-            type = resources.get_map(map_name)->get_game_play_type();
+            type = resources.get_map_header(map_name)->get_game_play_type();
         }
 
         sprintf(kvb, "duration%d", i);
@@ -1282,7 +1985,11 @@ void Server::load_map_rotation() {
 std::ostream& Server::create_log_stream() {
     const std::string& log_filename = get_value("logfile");
     if (log_filename.length()) {
-        log_file = new std::ofstream(log_filename.c_str(), std::ofstream::out | std::ofstream::app);
+        std::ios_base::openmode mode = std::ofstream::out | std::ofstream::app;
+        if (get_value("logfile_format") == "binary") {
+            mode |= std::ofstream::binary;
+        }
+        log_file = new std::ofstream(log_filename.c_str(), mode);
         if (log_file->is_open()) {
             return *log_file;
         }
@@ -1316,3 +2023,169 @@ ScopeServer::ScopeServer(Server& server) : server(server) {
 ScopeServer::~ScopeServer() {
     server.stop();
 }
+
+void Server::save_checkpoint() throw (Exception) {
+    if (!tournament || !checkpoint_file.length()) {
+        return;
+    }
+
+    /* map configuration */
+    Checkpoint cp;
+    cp.write_u8(static_cast<unsigned char>(current_config->type));
+    cp.write_string(current_config->map_name);
+    cp.write_u32(static_cast<uint32_t>(current_config->duration));
+    cp.write_u32(static_cast<uint32_t>(current_config->warmup_in_seconds));
+    cp.write_bool(warmup);
+    cp.write_u32(static_cast<uint32_t>(rotation_current_index));
+
+    /* players come back through the held player stats */
+    uint16_t count = 0;
+    for (Players::iterator it = players.begin(); it != players.end(); it++) {
+        Player *p = *it;
+        if (!p->bot && !(p->state.server_state.flags & PlayerServerFlagSpectating)) {
+            count++;
+        }
+    }
+    cp.write_u16(count);
+    for (Players::iterator it = players.begin(); it != players.end(); it++) {
+        Player *p = *it;
+        if (!p->bot && !(p->state.server_state.flags & PlayerServerFlagSpectating)) {
+            GPlayerServerState server_state = p->state.server_state;
+            GPlayerClientServerState client_server_state = p->state.client_server_state;
+            /* carried items are dropped, see get_checkpoint_object */
+            server_state.flags &= ~(PlayerServerFlagHasOppositeFlag | PlayerServerFlagHasCoin);
+            server_state.to_net();
+            client_server_state.to_net();
+            cp.write_string(p->get_player_name());
+            cp.write_u32(p->get_connection() ? p->get_connection()->host : 0);
+            cp.write_data(&server_state, sizeof(server_state));
+            cp.write_data(&client_server_state, sizeof(client_server_state));
+        }
+    }
+
+    tournament->write_checkpoint(cp);
+    cp.save(checkpoint_file);
+}
+
+void Server::restore_checkpoint() {
+    if (!checkpoint_file.length()) {
+        return;
+    }
+
+    std::ifstream f(checkpoint_file.c_str());
+    if (!f.is_open()) {
+        return;
+    }
+    f.close();
+
+    HeldPlayerStats restored;
+    try {
+        Checkpoint cp;
+        cp.load(checkpoint_file);
+
+        restored_config.type = static_cast<GamePlayType>(cp.read_u8());
+        restored_config.map_name = cp.read_string();
+        restored_config.duration = static_cast<int>(cp.read_u32());
+        restored_config.warmup_in_seconds = static_cast<int>(cp.read_u32());
+        bool restored_warmup = cp.read_bool();
+        size_t index = cp.read_u32();
+
+        uint16_t count = cp.read_u16();
+        for (uint16_t i = 0; i < count; i++) {
+            PlayerStats *pst = new PlayerStats;
+            restored.push_back(pst);
+            get_now(pst->disconnect_time);
+            pst->player_name = cp.read_string();
+            pst->host = cp.read_u32();
+            cp.read_data(&pst->server_state, sizeof(pst->server_state));
+            cp.read_data(&pst->client_server_state, sizeof(pst->client_server_state));
+            pst->server_state.from_net();
+            pst->client_server_state.from_net();
+            pst->restored = true;
+        }
+
+        /* same tournament as before the restart */
+        current_config = &restored_config;
+        warmup = restored_warmup;
+        rotation_current_index = (index < map_configs.size() ? index : 0);
+        tournament = factory.create_tournament(restored_config, true, warmup, players, &logger);
+        tournament->set_team_names(team_red_name, team_blue_name);
+        factory.set_tournament_server_flags(*this, tournament);
+        tournament->read_checkpoint(cp);
+
+        for (HeldPlayerStats::iterator it = restored.begin(); it != restored.end(); it++) {
+            (*it)->tournament_id = factory.get_tournament_id();
+            held_player_stats.push_back(*it);
+        }
+        restored.clear();
+
+        preload_next_map();
+        score_board_counter = 30000;
+        subsystem << "match on " << restored_config.map_name << " restored from "
+            << checkpoint_file << std::endl;
+    } catch (const Exception& e) {
+        subsystem << "checkpoint not restored: " << e.what() << std::endl;
+        for (HeldPlayerStats::iterator it = restored.begin(); it != restored.end(); it++) {
+            delete *it;
+        }
+        if (tournament) {
+            delete tournament;
+            tournament = 0;
+        }
+    }
+
+    /* used once, a crash loop must not bring it back */
+    remove(checkpoint_file.c_str());
+}
+
+void Server::update_metrics(const gametime_t& tick_start, ms_t diff_milliseconds) {
+    ServerMetrics::Sample& sample = metrics->get_sample();
+    gametime_t tick_end;
+    get_now(tick_end);
+    sample.observe_tick(diff_ns(tick_start, tick_end));
+
+    metrics_counter += diff_milliseconds;
+    if (metrics_counter < MetricsPublishMS) {
+        return;
+    }
+    metrics_counter = 0;
+
+    sample.server_name = get_value("server_name");
+    sample.max_players = atoi(get_value("num_players").c_str());
+    sample.players = 0;
+    sample.bots = 0;
+    sample.connections.clear();
+    for (Players::iterator it = players.begin(); it != players.end(); it++) {
+        Player *p = *it;
+        if (p->bot) {
+            sample.bots++;
+        } else {
+            sample.players++;
+        }
+
+        const Connection *c = p->get_connection();
+        if (c) {
+            ServerMetrics::ConnectionSample cs;
+            cs.player_name = p->get_player_name();
+            cs.connection = *c;
+            sample.connections.push_back(cs);
+        }
+    }
+
+    sample.pak_transfers.clear();
+    for (PlayerClientPaks::iterator it = player_client_paks.begin(); it != player_client_paks.end(); it++) {
+        PlayerClientPak& pcpak = *it;
+        if (pcpak.current_client_pak) {
+            ServerMetrics::PakTransferSample ps;
+            ps.player_name = pcpak.p->get_player_name();
+            ps.pak_name = pcpak.current_client_pak->pak->pak_short_name;
+            ps.size = pcpak.current_client_pak->size;
+            ps.remaining = pcpak.current_client_pak->remaining;
+            sample.pak_transfers.push_back(ps);
+        }
+    }
+
+    sample.traffic = get_traffic();
+    sample.log_records_dropped = logger.get_dropped_records();
+    metrics->publish();
+}
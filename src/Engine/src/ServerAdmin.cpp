@@ -17,6 +17,10 @@ ServerAdmin::ServerCommand ServerAdmin::server_commands[] = {
     { "set", &ServerAdmin::sc_set },
     { "reset", &ServerAdmin::sc_reset },
     { "vote", &ServerAdmin::sc_vote },
+    { "profile", &ServerAdmin::sc_profile },
+    { "checkpoint", &ServerAdmin::sc_checkpoint },
+    { "bandwidth", &ServerAdmin::sc_bandwidth },
+    { "allocations", &ServerAdmin::sc_allocations },
     { 0, 0 }
 };
 
@@ -96,6 +100,9 @@ void ServerAdmin::sc_kick(const Connection *c, Player *p, const std::string& par
             if (v->get_connection() == c) {
                 throw ServerAdminException("You cannot kick yourself");
             }
+            if (v->bot) {
+                throw ServerAdminException("Bots have no connection, lower 'bots' instead");
+            }
             found = true;
             server.kill(v->get_connection());
             std::string msg(p->get_player_name() + " kicked " + pn);
@@ -134,7 +141,7 @@ void ServerAdmin::sc_map(const Connection *c, Player *p, const std::string& para
 
     Map *map = 0;
     try {
-        map = resources.get_map(tokens[0]);
+        map = resources.get_map_header(tokens[0]);
     } catch (const ResourcesException& e) {
         throw ServerAdminException(e.what());
     }
@@ -223,6 +230,43 @@ void ServerAdmin::sc_vote(const Connection *c, Player *p, const std::string& par
     throw_not_implemented();
 }
 
+void ServerAdmin::sc_profile(const Connection *c, Player *p, const std::string& params) throw (ServerAdminException) {
+    check_if_authorized(p);
+    try {
+        server.profile(c, params);
+    } catch (const Exception& e) {
+        throw ServerAdminException(e.what());
+    }
+}
+
+void ServerAdmin::sc_checkpoint(const Connection *c, Player *p, const std::string& params) throw (ServerAdminException) {
+    check_if_authorized(p);
+    check_if_no_params(params);
+    try {
+        server.checkpoint(c);
+    } catch (const Exception& e) {
+        throw ServerAdminException(e.what());
+    }
+}
+
+void ServerAdmin::sc_bandwidth(const Connection *c, Player *p, const std::string& params) throw (ServerAdminException) {
+    check_if_authorized(p);
+    try {
+        server.bandwidth_report(c, params);
+    } catch (const Exception& e) {
+        throw ServerAdminException(e.what());
+    }
+}
+
+void ServerAdmin::sc_allocations(const Connection *c, Player *p, const std::string& params) throw (ServerAdminException) {
+    check_if_authorized(p);
+    try {
+        server.allocations(c, params);
+    } catch (const Exception& e) {
+        throw ServerAdminException(e.what());
+    }
+}
+
 /* helper functions */
 void ServerAdmin::check_if_authorized(Player *p) throw (ServerAdminException) {
     if (!p->server_admin) {
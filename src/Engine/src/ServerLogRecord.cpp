@@ -0,0 +1,340 @@
+#include "ServerLogRecord.hpp"
+#include "ServerLogger.hpp"
+
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+
+static void put_u16(unsigned char *p, uint32_t v) {
+    p[0] = v & 0xff;
+    p[1] = (v >> 8) & 0xff;
+}
+
+static void put_u32(unsigned char *p, uint32_t v) {
+    p[0] = v & 0xff;
+    p[1] = (v >> 8) & 0xff;
+    p[2] = (v >> 16) & 0xff;
+    p[3] = (v >> 24) & 0xff;
+}
+
+static uint32_t get_u16(const unsigned char *p) {
+    return p[0] | (p[1] << 8);
+}
+
+static uint32_t get_u32(const unsigned char *p) {
+    return p[0] | (p[1] << 8) | (p[2] << 16) | (static_cast<uint32_t>(p[3]) << 24);
+}
+
+ServerLogRecord::ServerLogRecord() {
+    clear(0, 0);
+}
+
+void ServerLogRecord::clear(unsigned char type, uint32_t time) {
+    this->time = time;
+    this->type = type;
+    number_count = 0;
+    for (int i = 0; i < MaxStrings; i++) {
+        string_length[i] = 0;
+        strings[i][0] = 0;
+    }
+}
+
+void ServerLogRecord::set_string(StringSlot slot, const char *s) {
+    size_t len = strlen(s);
+    if (len > MaxStringLength) {
+        len = MaxStringLength;
+    }
+    memcpy(strings[slot], s, len);
+    strings[slot][len] = 0;
+    string_length[slot] = static_cast<unsigned char>(len);
+}
+
+void ServerLogRecord::set_string(StringSlot slot, const std::string& s) {
+    set_string(slot, s.c_str());
+}
+
+void ServerLogRecord::add_int(int value) {
+    if (number_count < MaxNumbers) {
+        numbers[number_count++] = static_cast<uint32_t>(value);
+    }
+}
+
+void ServerLogRecord::add_float(float value) {
+    uint32_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    if (number_count < MaxNumbers) {
+        numbers[number_count++] = bits;
+    }
+}
+
+int ServerLogRecord::get_int(size_t index) const {
+    return (index < number_count ? static_cast<int>(numbers[index]) : 0);
+}
+
+float ServerLogRecord::get_float(size_t index) const {
+    float value = 0.0f;
+    if (index < number_count) {
+        memcpy(&value, &numbers[index], sizeof(value));
+    }
+
+    return value;
+}
+
+size_t ServerLogRecord::encode(unsigned char *into) const {
+    unsigned char *p = into + HeaderLength;
+    for (int i = 0; i < MaxStrings; i++) {
+        *p++ = string_length[i];
+        memcpy(p, strings[i], string_length[i]);
+        p += string_length[i];
+    }
+    for (int i = 0; i < number_count; i++) {
+        put_u32(p, numbers[i]);
+        p += 4;
+    }
+
+    size_t len = p - into;
+    put_u16(into, len);
+    into[2] = type;
+    into[3] = number_count;
+    put_u32(into + 4, time);
+
+    return len;
+}
+
+bool ServerLogRecord::decode(const unsigned char *from, size_t len) {
+    if (len < HeaderLength || get_length(from) != len || from[3] > MaxNumbers) {
+        return false;
+    }
+
+    clear(from[2], get_u32(from + 4));
+    const unsigned char *p = from + HeaderLength;
+    const unsigned char *end = from + len;
+    for (int i = 0; i < MaxStrings; i++) {
+        if (p >= end || p + 1 + *p > end) {
+            return false;
+        }
+        string_length[i] = *p++;
+        memcpy(strings[i], p, string_length[i]);
+        strings[i][string_length[i]] = 0;
+        p += string_length[i];
+    }
+    number_count = from[3];
+    if (p + number_count * 4 != end) {
+        return false;
+    }
+    for (int i = 0; i < number_count; i++) {
+        numbers[i] = get_u32(p);
+        p += 4;
+    }
+
+    return true;
+}
+
+bool ServerLogRecord::format(std::string& line, const std::string& map_name,
+    const std::string& map_description) const
+{
+    char time_buffer[128];
+    char buffer[4096];
+    char subbuffer[1024];
+
+    time_t t = time;
+    strftime(time_buffer, sizeof(time_buffer), "%Y-%m-%d %H:%M:%S", localtime(&t));
+
+    std::string text(make_quote(strings[StringText]));
+    std::string player1(make_quote(strings[StringPlayer1]));
+
+    switch (type) {
+        case ServerLogger::LogTypePlayerConnect:
+        case ServerLogger::LogTypePlayerDisconnect:
+            /* TIME LOG TEXT PLAYER_NAME */
+            sprintf(buffer, "%s %03d %s %s", time_buffer, type,
+                text.c_str(),
+                player1.c_str());
+            break;
+
+        case ServerLogger::LogTypeNewMap:
+            /* TIME LOG MAP MAP_DESC */
+            sprintf(buffer, "%s %03d %s %s", time_buffer, type,
+                map_name.c_str(),
+                map_description.c_str());
+            break;
+
+        case ServerLogger::LogTypeChatMessage:
+        case ServerLogger::LogTypeWarmUp:
+        case ServerLogger::LogTypeGameBegins:
+        case ServerLogger::LogTypeGameOver:
+        case ServerLogger::LogTypeRedFlagReturned:
+        case ServerLogger::LogTypeBlueFlagReturned:
+        case ServerLogger::LogTypeEndOfStats:
+            /* TIME LOG MAP MAP_DESC TEXT */
+            sprintf(buffer, "%s %03d %s %s %s", time_buffer, type,
+                map_name.c_str(),
+                map_description.c_str(),
+                text.c_str());
+            break;
+
+        case ServerLogger::LogTypeFrag:
+            /* TIME LOG MAP MAP_DESC TEXT FRAG_PLAYER KILL_PLAYER REASON */
+            sprintf(buffer, "%s %03d %s %s %s %s %s %s", time_buffer, type,
+                map_name.c_str(),
+                map_description.c_str(),
+                text.c_str(),
+                player1.c_str(),
+                make_quote(strings[StringPlayer2]).c_str(),
+                make_quote(strings[StringData1]).c_str());
+            break;
+
+        case ServerLogger::LogTypeKill:
+            /* TIME LOG MAP MAP_DESC TEXT PLAYER_NAME REASON */
+            sprintf(buffer, "%s %03d %s %s %s %s %s", time_buffer, type,
+                map_name.c_str(),
+                map_description.c_str(),
+                text.c_str(),
+                player1.c_str(),
+                make_quote(strings[StringData1]).c_str());
+            break;
+
+        case ServerLogger::LogTypeRedTeamJoin:
+        case ServerLogger::LogTypeBlueTeamJoin:
+        case ServerLogger::LogTypeRedFlagPicked:
+        case ServerLogger::LogTypeRedFlagDropped:
+        case ServerLogger::LogTypeRedFlagSaved:
+        case ServerLogger::LogTypeBlueFlagPicked:
+        case ServerLogger::LogTypeBlueFlagDropped:
+        case ServerLogger::LogTypeBlueFlagSaved:
+        case ServerLogger::LogTypeCoinPicked:
+        case ServerLogger::LogTypeCoinDropped:
+        case ServerLogger::LogTypeJoin:
+        case ServerLogger::LogTypeTeamRedScored:
+        case ServerLogger::LogTypeTeamBlueScored:
+            /* TIME LOG MAP MAP_DESC TEXT PLAYER_NAME */
+            sprintf(buffer, "%s %03d %s %s %s %s", time_buffer, type,
+                map_name.c_str(),
+                map_description.c_str(),
+                text.c_str(),
+                player1.c_str());
+            break;
+
+        case ServerLogger::LogTypeRoundFinished:
+            /* TIME LOG MAP MAP_DESC TEXT PLAYER TIME_IN_S */
+            sprintf(buffer, "%s %03d %s %s %s %s %.2f", time_buffer, type,
+                map_name.c_str(),
+                map_description.c_str(),
+                text.c_str(),
+                player1.c_str(),
+                get_float(0));
+            break;
+
+        case ServerLogger::LogTypeStatsTDMTeamScore:
+        case ServerLogger::LogTypeStatsCTFTeamScore:
+        case ServerLogger::LogTypeStatsGOHTeamScore:
+            /* TIME LOG MAP MAP_DESC TEXT TEAM_RED SCORE TEAM_BLUE SCORE */
+            sprintf(subbuffer, "%s %d %s %d",
+                make_quote(strings[StringData1]).c_str(),
+                get_int(0),
+                make_quote(strings[StringData2]).c_str(),
+                get_int(1));
+
+            sprintf(buffer, "%s %03d %s %s %s %s", time_buffer, type,
+                map_name.c_str(),
+                map_description.c_str(),
+                text.c_str(),
+                subbuffer);
+            break;
+
+        case ServerLogger::LogTypeStatsDM:
+        case ServerLogger::LogTypeStatsTDMTeamRed:
+        case ServerLogger::LogTypeStatsTDMTeamBlue:
+        case ServerLogger::LogTypeStatsCTFTeamRed:
+        case ServerLogger::LogTypeStatsCTFTeamBlue:
+        case ServerLogger::LogTypeStatsGOHTeamRed:
+        case ServerLogger::LogTypeStatsGOHTeamBlue:
+            /* TIME LOG MAP MAP_DESC TEXT RANK PLAYER SCORE FRAGS KILLS */
+            sprintf(subbuffer, "%d %s %d %d %d", get_int(0),
+                player1.c_str(),
+                get_int(1),
+                get_int(2),
+                get_int(3));
+
+            sprintf(buffer, "%s %03d %s %s %s %s", time_buffer, type,
+                map_name.c_str(),
+                map_description.c_str(),
+                text.c_str(),
+                subbuffer);
+            break;
+
+        case ServerLogger::LogTypeStatsSR:
+            /* TIME LOG MAP MAP_DESC TEXT RANK PLAYER LAPS BEST LAST */
+            if (number_count < 4) {
+                sprintf(subbuffer, "%d %s %d N/A N/A", get_int(0),
+                    player1.c_str(),
+                    get_int(1));
+            } else {
+                sprintf(subbuffer, "%d %s %d %.2f %.2f", get_int(0),
+                    player1.c_str(),
+                    get_int(1),
+                    get_float(2),
+                    get_float(3));
+            }
+
+            sprintf(buffer, "%s %03d %s %s %s %s", time_buffer, type,
+                map_name.c_str(),
+                map_description.c_str(),
+                text.c_str(),
+                subbuffer);
+            break;
+
+        case ServerLogger::LogTypeStatsCTC:
+            /* TIME LOG MAP MAP_DESC TEXT RANK PLAYER MIN:SEC */
+            sprintf(subbuffer, "%d %s %d:%02d", get_int(0),
+                player1.c_str(),
+                get_int(1),
+                get_int(2));
+
+            sprintf(buffer, "%s %03d %s %s %s %s", time_buffer, type,
+                map_name.c_str(),
+                map_description.c_str(),
+                text.c_str(),
+                subbuffer);
+            break;
+
+        case ServerLogger::LogTypePlayerNameChange:
+            /* TIME LOG TEXT OLD_NAME NEW_NAME */
+            sprintf(buffer, "%s %03d %s %s %s", time_buffer, type,
+                text.c_str(),
+                make_quote(strings[StringData1]).c_str(),
+                make_quote(strings[StringData2]).c_str());
+            break;
+
+        case ServerLogger::LogTypeRecordsDropped:
+            /* TIME LOG COUNT */
+            sprintf(buffer, "%s %03d %d", time_buffer, type, get_int(0));
+            break;
+
+        default:
+            /* map context or unknown */
+            return false;
+    }
+    line = buffer;
+
+    return true;
+}
+
+size_t ServerLogRecord::get_length(const unsigned char *header) {
+    return get_u16(header);
+}
+
+std::string ServerLogRecord::make_quote(const std::string& s) {
+    std::string quote = "\"";
+
+    size_t sz = s.length();
+    for (size_t i = 0; i < sz; i++) {
+        quote += s[i];
+        if (s[i] == '"') {
+            quote += "\"";
+        }
+    }
+
+    quote += "\"";
+    return quote;
+}
@@ -1,258 +1,221 @@
 #include "ServerLogger.hpp"
+#include "Timing.hpp"
 
-#include <cstdio>
 #include <ctime>
 
+static const size_t RingSize = 256 * 1024;
+static const ms_t WriterIdleMS = 10;
+
 ServerLogger::ServerLogger(std::ostream& stream, bool verbose)
-    : stream(stream), verbose(verbose), map(0)
-{
-    prepare();
-}
+    : stream(stream), verbose(verbose), binary(false), profiler(0), profiler_phase(0),
+      ring(0), quit(false), dropped(0), reported_dropped(0),
+      map_name(ServerLogRecord::make_quote("")),
+      map_description(ServerLogRecord::make_quote("")) { }
 
-ServerLogger::~ServerLogger() { }
+ServerLogger::~ServerLogger() {
+    stop_writer();
+}
 
 void ServerLogger::set_map(Map *map) {
-    this->map = map;
-    prepare();
+    record.clear(ServerLogRecord::TypeMapContext, static_cast<uint32_t>(time(0)));
+    if (map) {
+        record.set_string(ServerLogRecord::StringText, map->get_name());
+        record.set_string(ServerLogRecord::StringData1, map->get_description());
+    }
+    submit();
 }
 
-void ServerLogger::log(LogType type, const std::string& text, Player *p1, Player *p2,
-    const void *data1, const void *data2, const void *data3, const void *data4)
-{
-    if (verbose) {
-        time_t t = time(0);
-        strftime (time_buffer, sizeof(time_buffer), "%Y-%m-%d %H:%M:%S", localtime(&t));
-
-        switch (type) {
-            case LogTypePlayerConnect:
-            case LogTypePlayerDisconnect:
-                /* TIME LOG TEXT PLAYER_NAME */
-                sprintf(buffer, "%s %03d %s %s", time_buffer, type,
-                    make_quote(text).c_str(),
-                    make_quote(p1->get_player_name()).c_str());
-                break;
-
-            case LogTypeNewMap:
-                /* TIME LOG MAP MAP_DESC */
-                sprintf(buffer, "%s %03d %s %s", time_buffer, type,
-                    map_name.c_str(),
-                    map_description.c_str());
-                break;
-
-            case LogTypeChatMessage:
-            case LogTypeWarmUp:
-            case LogTypeGameBegins:
-            case LogTypeGameOver:
-                /* TIME LOG MAP MAP_DESC TEXT */
-                sprintf(buffer, "%s %03d %s %s %s", time_buffer, type,
-                    map_name.c_str(),
-                    map_description.c_str(),
-                    make_quote(text).c_str());
-                break;
-
-            case LogTypeFrag:
-                /* TIME LOG MAP MAP_DESC TEXT FRAG_PLAYER KILL_PLAYER REASON */
-                sprintf(buffer, "%s %03d %s %s %s %s %s %s", time_buffer, type,
-                    map_name.c_str(),
-                    map_description.c_str(),
-                    make_quote(text).c_str(),
-                    make_quote(p1->get_player_name()).c_str(),
-                    make_quote(p2->get_player_name()).c_str(),
-                    make_quote(static_cast<const char *>(data1)).c_str());
-                break;
-
-            case LogTypeKill:
-                /* TIME LOG MAP MAP_DESC TEXT PLAYER_NAME REASON */
-                sprintf(buffer, "%s %03d %s %s %s %s %s", time_buffer, type,
-                    map_name.c_str(),
-                    map_description.c_str(),
-                    make_quote(text).c_str(),
-                    make_quote(p1->get_player_name()).c_str(),
-                    make_quote(static_cast<const char *>(data1)).c_str());
-                break;
-
-            case LogTypeRedTeamJoin:
-            case LogTypeBlueTeamJoin:
-            case LogTypeRedFlagPicked:
-            case LogTypeRedFlagDropped:
-            case LogTypeRedFlagSaved:
-            case LogTypeBlueFlagPicked:
-            case LogTypeBlueFlagDropped:
-            case LogTypeBlueFlagSaved:
-            case LogTypeCoinPicked:
-            case LogTypeCoinDropped:
-            case LogTypeJoin:
-                /* TIME LOG MAP MAP_DESC TEXT PLAYER_NAME */
-                sprintf(buffer, "%s %03d %s %s %s %s", time_buffer, type,
-                    map_name.c_str(),
-                    map_description.c_str(),
-                    make_quote(text).c_str(),
-                    make_quote(p1->get_player_name()).c_str());
-                break;
-
-            case LogTypeRedFlagReturned:
-            case LogTypeBlueFlagReturned:
-                /* TIME LOG MAP MAP_DESC TEXT */
-                sprintf(buffer, "%s %03d %s %s %s", time_buffer, type,
-                    map_name.c_str(),
-                    map_description.c_str(),
-                    make_quote(text).c_str());
-                break;
-
-            case LogTypeTeamRedScored:
-            case LogTypeTeamBlueScored:
-                /* TIME LOG MAP MAP_DESC TEXT PLAYER_NAME */
-                sprintf(buffer, "%s %03d %s %s %s %s", time_buffer, type,
-                    map_name.c_str(),
-                    map_description.c_str(),
-                    make_quote(text).c_str(),
-                    make_quote(p1->get_player_name()).c_str());
-                break;
+void ServerLogger::set_profiler(Profiler *profiler, size_t phase) {
+    this->profiler = profiler;
+    profiler_phase = phase;
+}
 
-            case LogTypeRoundFinished:
-                /* TIME LOG MAP MAP_DESC TEXT PLAYER TIME_IN_S */
-                sprintf(buffer, "%s %03d %s %s %s %s %.2f", time_buffer, type,
-                    map_name.c_str(),
-                    map_description.c_str(),
-                    make_quote(text).c_str(),
-                    make_quote(p1->get_player_name()).c_str(),
-                    *static_cast<const float *>(data1));
-                break;
+bool ServerLogger::start_writer(bool binary) {
+    if (ring) {
+        return true;
+    }
 
-            case LogTypeEndOfStats:
-                /* TIME LOG MAP MAP_DESC TEXT */
-                sprintf(buffer, "%s %03d %s %s %s", time_buffer, type,
-                    map_name.c_str(),
-                    map_description.c_str(),
-                    make_quote(text).c_str());
-                break;
+    this->binary = binary;
+    try {
+        ring = new RingBuffer(RingSize);
+    } catch (const RingBufferException&) {
+        return false;
+    }
 
-            case LogTypeStatsTDMTeamScore:
-            case LogTypeStatsCTFTeamScore:
-            case LogTypeStatsGOHTeamScore:
-                /* TIME LOG MAP MAP_DESC TEXT TEAM_RED SCORE TEAM_BLUE SCORE */
-                sprintf(subbuffer, "%s %d %s %d",
-                    make_quote(static_cast<const char *>(data1)).c_str(),
-                    *static_cast<const score_t *>(data2),
-                    make_quote(static_cast<const char *>(data3)).c_str(),
-                    *static_cast<const score_t *>(data4));
+    quit = false;
+    if (!thread_start()) {
+        delete ring;
+        ring = 0;
+        return false;
+    }
 
-                sprintf(buffer, "%s %03d %s %s %s %s", time_buffer, type,
-                    map_name.c_str(),
-                    map_description.c_str(),
-                    make_quote(text).c_str(),
-                    subbuffer);
-                break;
+    return true;
+}
 
-            case LogTypeStatsDM:
-            case LogTypeStatsTDMTeamRed:
-            case LogTypeStatsTDMTeamBlue:
-            case LogTypeStatsCTFTeamRed:
-            case LogTypeStatsCTFTeamBlue:
-            case LogTypeStatsGOHTeamRed:
-            case LogTypeStatsGOHTeamBlue:
-                /* TIME LOG MAP MAP_DESC TEXT RANK PLAYER SCORE FRAGS KILLS */
-                sprintf(subbuffer, "%d %s %d %d %d", *static_cast<const int *>(data1),
-                    make_quote(p1->get_player_name()).c_str(),
-                    *static_cast<const sscore_t *>(data2),
-                    *static_cast<const score_t *>(data3),
-                    *static_cast<const score_t *>(data4));
+void ServerLogger::stop_writer() {
+    if (ring) {
+        quit = true;
+        thread_join();
+        delete ring;
+        ring = 0;
+    }
+}
 
-                sprintf(buffer, "%s %03d %s %s %s %s", time_buffer, type,
-                    map_name.c_str(),
-                    map_description.c_str(),
-                    make_quote(text).c_str(),
-                    subbuffer);
-                break;
+size_t ServerLogger::get_dropped_records() const {
+    return dropped;
+}
 
-            case LogTypeStatsSR:
-                /* TIME LOG MAP MAP_DESC TEXT RANK PLAYER LAPS BEST LAST */
-                if (!data3) {
-                    sprintf(subbuffer, "%d %s %d N/A N/A", *static_cast<const int *>(data1),
-                        make_quote(p1->get_player_name()).c_str(),
-                        *static_cast<const int *>(data2));
-                } else {
-                    sprintf(subbuffer, "%d %s %d %.2f %.2f", *static_cast<const int *>(data1),
-                        make_quote(p1->get_player_name()).c_str(),
-                        *static_cast<const int *>(data2),
-                        *static_cast<const float *>(data3),
-                        *static_cast<const float *>(data4));
-                }
+void ServerLogger::log(LogType type, const std::string& text, Player *p1, Player *p2,
+    const void *data1, const void *data2, const void *data3, const void *data4)
+{
+    ProfilerScope scope(profiler, profiler_phase);
 
-                sprintf(buffer, "%s %03d %s %s %s %s", time_buffer, type,
-                    map_name.c_str(),
-                    map_description.c_str(),
-                    make_quote(text).c_str(),
-                    subbuffer);
-                break;
+    if (type == _LogTypeMAX) {
+        return;
+    }
 
-            case LogTypeStatsCTC:
-                /* TIME LOG MAP MAP_DESC TEXT RANK PLAYER MIN:SEC */
-                sprintf(subbuffer, "%d %s %d:%02d", *static_cast<const int *>(data1),
-                    make_quote(p1->get_player_name()).c_str(),
-                    *static_cast<const int *>(data2),
-                    *static_cast<const int *>(data3));
+    record.clear(static_cast<unsigned char>(type), static_cast<uint32_t>(time(0)));
+    record.set_string(ServerLogRecord::StringText, text);
+    if (p1) {
+        record.set_string(ServerLogRecord::StringPlayer1, p1->get_player_name());
+    }
+    if (p2) {
+        record.set_string(ServerLogRecord::StringPlayer2, p2->get_player_name());
+    }
 
-                sprintf(buffer, "%s %03d %s %s %s %s", time_buffer, type,
-                    map_name.c_str(),
-                    map_description.c_str(),
-                    make_quote(text).c_str(),
-                    subbuffer);
-                break;
+    /* keep what the type needs, see ServerLogRecord::format */
+    switch (type) {
+        case LogTypeFrag:
+        case LogTypeKill:
+            record.set_string(ServerLogRecord::StringData1, static_cast<const char *>(data1));
+            break;
+
+        case LogTypeRoundFinished:
+            record.add_float(*static_cast<const float *>(data1));
+            break;
+
+        case LogTypeStatsTDMTeamScore:
+        case LogTypeStatsCTFTeamScore:
+        case LogTypeStatsGOHTeamScore:
+            record.set_string(ServerLogRecord::StringData1, static_cast<const char *>(data1));
+            record.add_int(*static_cast<const score_t *>(data2));
+            record.set_string(ServerLogRecord::StringData2, static_cast<const char *>(data3));
+            record.add_int(*static_cast<const score_t *>(data4));
+            break;
+
+        case LogTypeStatsDM:
+        case LogTypeStatsTDMTeamRed:
+        case LogTypeStatsTDMTeamBlue:
+        case LogTypeStatsCTFTeamRed:
+        case LogTypeStatsCTFTeamBlue:
+        case LogTypeStatsGOHTeamRed:
+        case LogTypeStatsGOHTeamBlue:
+            record.add_int(*static_cast<const int *>(data1));
+            record.add_int(*static_cast<const sscore_t *>(data2));
+            record.add_int(*static_cast<const score_t *>(data3));
+            record.add_int(*static_cast<const score_t *>(data4));
+            break;
+
+        case LogTypeStatsSR:
+            record.add_int(*static_cast<const int *>(data1));
+            record.add_int(*static_cast<const int *>(data2));
+            if (data3) {
+                record.add_float(*static_cast<const float *>(data3));
+                record.add_float(*static_cast<const float *>(data4));
+            }
+            break;
+
+        case LogTypeStatsCTC:
+            record.add_int(*static_cast<const int *>(data1));
+            record.add_int(*static_cast<const int *>(data2));
+            record.add_int(*static_cast<const int *>(data3));
+            break;
+
+        case LogTypePlayerNameChange:
+            record.set_string(ServerLogRecord::StringData1, static_cast<const char *>(data1));
+            record.set_string(ServerLogRecord::StringData2, static_cast<const char *>(data2));
+            break;
+
+        default:
+            break;
+    }
+    submit();
+}
 
-            case LogTypePlayerNameChange:
-                /* TIME LOG TEXT OLD_NAME NEW_NAME */
-                sprintf(buffer, "%s %03d %s %s %s", time_buffer, type,
-                    make_quote(text).c_str(),
-                    make_quote(static_cast<const char *>(data1)).c_str(),
-                    make_quote(static_cast<const char *>(data2)).c_str());
-                break;
+void ServerLogger::submit() {
+    size_t len = record.encode(record_data);
+    if (!ring) {
+        write(record_data, len);
+    } else if (!ring->write(record_data, len)) {
+        dropped++;
+    }
+}
 
-            case _LogTypeMAX:
-                /* do nothing */
-                return;
-                break;
-        }
-        stream << buffer << std::endl;
-    } else {
-        if (text.length()) {
-            stream << text << std::endl;
+bool ServerLogger::drain() {
+    bool any = false;
+    unsigned char header[ServerLogRecord::HeaderLength];
+    while (ring->peek(header, sizeof(header))) {
+        size_t len = ServerLogRecord::get_length(header);
+        if (!ring->read(write_data, len)) {
+            break;
         }
+        write(write_data, len);
+        any = true;
+    }
+    report_dropped();
+    if (any) {
+        stream.flush();
     }
-}
 
-void ServerLogger::prepare() {
-    map_name = make_quote(get_map_name()).c_str();
-    map_description = make_quote(get_map_description()).c_str();
+    return any;
 }
 
-std::string ServerLogger::make_quote(const std::string& s) {
-    std::string quote = "\"";
+void ServerLogger::write(const unsigned char *data, size_t len) {
+    if (binary) {
+        stream.write(reinterpret_cast<const char *>(data), len);
+    } else if (write_record.decode(data, len)) {
+        if (write_record.type == ServerLogRecord::TypeMapContext) {
+            map_name = ServerLogRecord::make_quote(write_record.strings[ServerLogRecord::StringText]);
+            map_description = ServerLogRecord::make_quote(write_record.strings[ServerLogRecord::StringData1]);
+            return;
+        }
 
-    size_t sz = s.length();
-    for (size_t i = 0; i < sz; i++) {
-        quote += s[i];
-        if (s[i] == '"') {
-            quote += "\"";
+        if (verbose) {
+            std::string line;
+            if (!write_record.format(line, map_name, map_description)) {
+                return;
+            }
+            stream << line << '\n';
+        } else {
+            if (!write_record.string_length[ServerLogRecord::StringText]) {
+                return;
+            }
+            stream << write_record.strings[ServerLogRecord::StringText] << '\n';
         }
     }
 
-    quote += "\"";
-    return quote;
+    /* the writer flushes once per batch */
+    if (!ring) {
+        stream.flush();
+    }
 }
 
-const char *ServerLogger::get_map_name() {
-    if (map) {
-        return map->get_name().c_str();
-    } else {
-        return "";
+void ServerLogger::report_dropped() {
+    size_t now = dropped;
+    if (now != reported_dropped) {
+        write_record.clear(LogTypeRecordsDropped, static_cast<uint32_t>(time(0)));
+        write_record.add_int(static_cast<int>(now - reported_dropped));
+        reported_dropped = now;
+        size_t len = write_record.encode(write_data);
+        write(write_data, len);
     }
 }
 
-const char *ServerLogger::get_map_description() {
-    if (map) {
-        return map->get_description().c_str();
-    } else {
-        return "";
+void ServerLogger::thread() {
+    while (!quit) {
+        if (!drain()) {
+            wait_ms(WriterIdleMS);
+        }
     }
-}
\ No newline at end of file
+    drain();
+}
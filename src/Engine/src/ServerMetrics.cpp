@@ -0,0 +1,263 @@
+#include "ServerMetrics.hpp"
+#include "Scope.hpp"
+
+#include <sstream>
+#include <cstdio>
+#ifdef __unix__
+#include <unistd.h>
+#endif
+
+/* upper bounds of the tick histogram, a tick is due every 16.6ms */
+static const ns_t TickBucketBounds[ServerMetrics::TickBuckets] = {
+    250000, 500000, 1000000, 2000000, 4000000,
+    8000000, 16000000, 33000000, 66000000, 133000000
+};
+
+static const char *NetCommandNames[] = {
+    "stat_req",
+    "stat_rsp",
+    "wrong_password",
+    "server_full",
+    "ack",
+    "ping",
+    "pong",
+    "login",
+    "logout",
+    "data",
+    0
+};
+
+static const time_t ScrapeTimeoutS = 2;
+
+static std::string escape_label(const std::string& value) {
+    std::string escaped;
+    for (size_t i = 0; i < value.length(); i++) {
+        char c = value[i];
+        if (c == '\\' || c == '"') {
+            escaped += '\\';
+            escaped += c;
+        } else if (c == '\n') {
+            escaped += "\\n";
+        } else {
+            escaped += c;
+        }
+    }
+
+    return escaped;
+}
+
+static std::string connection_labels(const ServerMetrics::ConnectionSample& cs) {
+    char address[32];
+    const Connection& c = cs.connection;
+    sprintf(address, "%u.%u.%u.%u:%u", (c.host >> 24) & 0xff, (c.host >> 16) & 0xff,
+        (c.host >> 8) & 0xff, c.host & 0xff, c.port);
+
+    return "{player=\"" + escape_label(cs.player_name) + "\",address=\"" + address + "\"}";
+}
+
+static void header(std::ostream& out, const char *name, const char *type, const char *help) {
+    out << "# HELP " << name << " " << help << "\n";
+    out << "# TYPE " << name << " " << type << "\n";
+}
+
+ServerMetrics::Sample::Sample()
+    : players(0), bots(0), max_players(0), tick_count(0), tick_sum(0),
+      response_heap_allocations(0), log_records_dropped(0)
+{
+    memset(tick_buckets, 0, sizeof(tick_buckets));
+}
+
+void ServerMetrics::Sample::observe_tick(ns_t ns) {
+    for (size_t i = 0; i < TickBuckets; i++) {
+        if (ns <= TickBucketBounds[i]) {
+            tick_buckets[i]++;
+        }
+    }
+    tick_count++;
+    tick_sum += ns;
+}
+
+ServerMetrics::ServerMetrics(const std::string& address, hostport_t port)
+    throw (ServerMetricsException) : quit(false)
+{
+    try {
+        listener.listen(address.c_str(), port);
+    } catch (const TCPSocketException& e) {
+        throw ServerMetricsException(std::string("Can't open metrics port: ") + e.what());
+    }
+
+    if (!thread_start()) {
+        listener.close();
+        throw ServerMetricsException("Starting metrics thread failed.");
+    }
+}
+
+ServerMetrics::~ServerMetrics() {
+    quit = true;
+    thread_join();
+    listener.close();
+}
+
+ServerMetrics::Sample& ServerMetrics::get_sample() {
+    return sample;
+}
+
+void ServerMetrics::publish() {
+    Scope<Mutex> lock(mtx);
+    published = sample;
+}
+
+void ServerMetrics::thread() {
+    while (!quit) {
+        try {
+            if (listener.activity(0, 100000)) {
+                TCPSocket client;
+                client.accept(listener);
+                serve(client);
+                client.close();
+            }
+        } catch (const TCPSocketException&) {
+            /* the scraper went away, the next one is served anyway */
+        }
+    }
+}
+
+void ServerMetrics::serve(TCPSocket& client) throw (TCPSocketException) {
+    /* whatever the request is, it gets the page */
+    char request[1024];
+    if (client.activity(ScrapeTimeoutS, 0)) {
+        client.receive(request, sizeof(request));
+    }
+
+    {
+        Scope<Mutex> lock(mtx);
+        scraped = published;
+    }
+    render(scraped);
+
+    char response_header[128];
+    sprintf(response_header, "HTTP/1.0 200 OK\r\nContent-Type: text/plain; version=0.0.4\r\n"
+        "Content-Length: %lu\r\n\r\n", static_cast<unsigned long>(page.length()));
+    client.send(response_header, strlen(response_header));
+
+    size_t sent = 0;
+    while (sent < page.length()) {
+        size_t sz = client.send(page.c_str() + sent, page.length() - sent);
+        if (!sz) {
+            break;
+        }
+        sent += sz;
+    }
+}
+
+void ServerMetrics::render(const Sample& s) {
+    std::ostringstream out;
+
+    header(out, "goatattack_info", "gauge", "Server name.");
+    out << "goatattack_info{server_name=\"" << escape_label(s.server_name) << "\"} 1\n";
+
+    header(out, "goatattack_tick_duration_seconds", "histogram", "Time spent in a server tick.");
+    for (size_t i = 0; i < TickBuckets; i++) {
+        out << "goatattack_tick_duration_seconds_bucket{le=\""
+            << (TickBucketBounds[i] / 1000000000.0) << "\"} " << s.tick_buckets[i] << "\n";
+    }
+    out << "goatattack_tick_duration_seconds_bucket{le=\"+Inf\"} " << s.tick_count << "\n";
+    out << "goatattack_tick_duration_seconds_sum " << (s.tick_sum / 1000000000.0) << "\n";
+    out << "goatattack_tick_duration_seconds_count " << s.tick_count << "\n";
+
+    header(out, "goatattack_players", "gauge", "Connected players.");
+    out << "goatattack_players " << s.players << "\n";
+    header(out, "goatattack_bots", "gauge", "Bots in the game.");
+    out << "goatattack_bots " << s.bots << "\n";
+    header(out, "goatattack_max_players", "gauge", "Player slots.");
+    out << "goatattack_max_players " << s.max_players << "\n";
+
+    header(out, "goatattack_connection_rtt_seconds", "gauge", "Round trip time of a connection.");
+    for (ConnectionSamples::const_iterator it = s.connections.begin(); it != s.connections.end(); it++) {
+        out << "goatattack_connection_rtt_seconds" << connection_labels(*it) << " "
+            << (it->connection.ping_time / 1000.0) << "\n";
+    }
+
+    header(out, "goatattack_connection_resends_total", "counter", "Resent reliable messages of a connection.");
+    for (ConnectionSamples::const_iterator it = s.connections.begin(); it != s.connections.end(); it++) {
+        out << "goatattack_connection_resends_total" << connection_labels(*it) << " "
+            << it->connection.resends << "\n";
+    }
+
+    header(out, "goatattack_connection_lost_datagrams_total", "counter", "Gaps in the unreliable sequence of a connection.");
+    for (ConnectionSamples::const_iterator it = s.connections.begin(); it != s.connections.end(); it++) {
+        out << "goatattack_connection_lost_datagrams_total" << connection_labels(*it) << " "
+            << it->connection.lost << "\n";
+    }
+
+    header(out, "goatattack_connection_sent_bytes_total", "counter", "Bytes sent to a connection.");
+    for (ConnectionSamples::const_iterator it = s.connections.begin(); it != s.connections.end(); it++) {
+        out << "goatattack_connection_sent_bytes_total" << connection_labels(*it) << " "
+            << it->connection.bytes_sent << "\n";
+    }
+
+    header(out, "goatattack_connection_received_bytes_total", "counter", "Bytes received from a connection.");
+    for (ConnectionSamples::const_iterator it = s.connections.begin(); it != s.connections.end(); it++) {
+        out << "goatattack_connection_received_bytes_total" << connection_labels(*it) << " "
+            << it->connection.bytes_received << "\n";
+    }
+
+    header(out, "goatattack_sent_bytes_total", "counter", "Bytes sent by net command.");
+    for (int i = 0; i < _NetCommandMAX; i++) {
+        out << "goatattack_sent_bytes_total{type=\"" << NetCommandNames[i] << "\"} "
+            << s.traffic.bytes_sent[i] << "\n";
+    }
+
+    header(out, "goatattack_received_bytes_total", "counter", "Bytes received by net command.");
+    for (int i = 0; i < _NetCommandMAX; i++) {
+        out << "goatattack_received_bytes_total{type=\"" << NetCommandNames[i] << "\"} "
+            << s.traffic.bytes_received[i] << "\n";
+    }
+
+    header(out, "goatattack_sent_datagrams_total", "counter", "Datagrams sent by net command.");
+    for (int i = 0; i < _NetCommandMAX; i++) {
+        out << "goatattack_sent_datagrams_total{type=\"" << NetCommandNames[i] << "\"} "
+            << s.traffic.datagrams_sent[i] << "\n";
+    }
+
+    header(out, "goatattack_received_datagrams_total", "counter", "Datagrams received by net command.");
+    for (int i = 0; i < _NetCommandMAX; i++) {
+        out << "goatattack_received_datagrams_total{type=\"" << NetCommandNames[i] << "\"} "
+            << s.traffic.datagrams_received[i] << "\n";
+    }
+
+    header(out, "goatattack_pak_transfer_bytes", "gauge", "Size of a pak sent to a player.");
+    for (PakTransferSamples::const_iterator it = s.pak_transfers.begin(); it != s.pak_transfers.end(); it++) {
+        out << "goatattack_pak_transfer_bytes{player=\"" << escape_label(it->player_name)
+            << "\",pak=\"" << escape_label(it->pak_name) << "\"} " << it->size << "\n";
+    }
+
+    header(out, "goatattack_pak_transfer_remaining_bytes", "gauge", "Bytes of a pak still to send.");
+    for (PakTransferSamples::const_iterator it = s.pak_transfers.begin(); it != s.pak_transfers.end(); it++) {
+        out << "goatattack_pak_transfer_remaining_bytes{player=\"" << escape_label(it->player_name)
+            << "\",pak=\"" << escape_label(it->pak_name) << "\"} " << it->remaining << "\n";
+    }
+
+    header(out, "goatattack_response_heap_allocations_total", "counter", "State responses that did not fit the arena.");
+    out << "goatattack_response_heap_allocations_total " << s.response_heap_allocations << "\n";
+
+    header(out, "goatattack_log_records_dropped_total", "counter", "Log records dropped by a full ring.");
+    out << "goatattack_log_records_dropped_total " << s.log_records_dropped << "\n";
+
+#ifdef __unix__
+    /* resident pages, read here to keep it off the tick */
+    FILE *f = fopen("/proc/self/statm", "r");
+    if (f) {
+        unsigned long size = 0;
+        unsigned long resident = 0;
+        if (fscanf(f, "%lu %lu", &size, &resident) == 2) {
+            header(out, "goatattack_resident_memory_bytes", "gauge", "Resident memory of the process.");
+            out << "goatattack_resident_memory_bytes "
+                << static_cast<uint64_t>(resident) * static_cast<uint64_t>(sysconf(_SC_PAGESIZE)) << "\n";
+        }
+        fclose(f);
+    }
+#endif
+
+    page = out.str();
+}
@@ -1,4 +1,5 @@
 #include "Tournament.hpp"
+#include "MapPreloader.hpp"
 
 #include <algorithm>
 #include <cmath>
@@ -39,8 +40,12 @@ Tournament::Tournament(Resources& resources, Subsystem& subsystem, Gui *gui, Ser
       hud_bombs(resources.get_icon("bomb")),
       hud_frogs(resources.get_icon("frog")),
       enemy_indicator(resources.get_icon("enemy_indicator_neutral")),
-      game_over(false), logger(logger), gui_is_destroyed(false),
-      do_friendly_fire_alarm(true)
+      game_over(false), logger(logger), resource_ids(0), jobs(0), random(&own_random),
+      gui_is_destroyed(false),
+      do_friendly_fire_alarm(true), die_sound(0), shot_start_sound(0),
+      grenade_start_sound(0), bomb_start_sound(0), frog_start_sound(0),
+      response_vector_growths(0),
+      response_heap_allocations(0)
 {
     /* init */
     char kvb[128];
@@ -59,7 +64,7 @@ Tournament::Tournament(Resources& resources, Subsystem& subsystem, Gui *gui, Ser
         const std::string& objname = map.get_value(kvb);
         if (objname.length()) {
             Object *obj = resources.get_object(objname);
-            GameObject *gobj = new GameObject;
+            GameObject *gobj = game_objects.create();
             gobj->picked = !server;
             gobj->object = obj;
             gobj->state.id = static_cast<identifier_t>(i);
@@ -71,20 +76,13 @@ Tournament::Tournament(Resources& resources, Subsystem& subsystem, Gui *gui, Ser
             gobj->state.accel_y = 0.0f;
             gobj->origin_x = static_cast<int>(gobj->state.x);
             gobj->origin_y = static_cast<int>(gobj->state.y);
-            game_objects.push_back(gobj);
             if (gobj->object->get_type() == Object::ObjectTypeSpawnPointFrog) {
                 has_frogs = true;
-                frog_spawn_points.push_back(gobj);
+                frog_spawn_points.push_back(game_objects.get_handle(gobj));
             }
         }
     }
 
-    /* create lightmap */
-    if (!server) {
-        map.create_lightmap();
-        lightmap = map.get_lightmap();
-    }
-
     /* check if frog's spawn points are placed in map */
     if (has_frogs) {
         frog_spawn_init = map.get_frog_spawn_init();
@@ -97,6 +95,13 @@ Tournament::Tournament(Resources& resources, Subsystem& subsystem, Gui *gui, Ser
         reset_frog_spawn_counter();
     }
 
+    /* sounds sent with events */
+    die_sound = lookup_sound(properties.get_value("die_sound"));
+    shot_start_sound = lookup_sound(properties.get_value("shot_start_sound"));
+    grenade_start_sound = lookup_sound(properties.get_value("grenade_start_sound"));
+    bomb_start_sound = lookup_sound(properties.get_value("bomb_start_sound"));
+    frog_start_sound = lookup_sound(properties.get_value("frog_start_sound"));
+
     /* setup logger */
     if (logger) {
         logger->set_map(&map);
@@ -106,30 +111,12 @@ Tournament::Tournament(Resources& resources, Subsystem& subsystem, Gui *gui, Ser
 Tournament::~Tournament() {
     delete_responses();
 
-    for (GameAnimations::iterator it = game_animations.begin();
-        it != game_animations.end(); it++)
-    {
-        delete *it;
-    }
-
     for (GameTextAnimations::iterator it = game_text_animations.begin();
         it != game_text_animations.end(); it++)
     {
         delete *it;
     }
 
-    for (GameObjects::iterator it = game_objects.begin();
-        it != game_objects.end(); it++)
-    {
-        delete *it;
-    }
-
-    for (SpawnableNPCs::iterator it = spawnable_npcs.begin();
-        it != spawnable_npcs.end(); it++)
-    {
-        delete *it;
-    }
-
     if (logger) {
         logger->set_map(0);
     }
@@ -145,6 +132,15 @@ identifier_t Tournament::create_animation_id() {
     return ++animation_id;
 }
 
+void Tournament::create_lightmap(MapPreloader *preloaded) {
+    if (preloaded && preloaded->has_lightmap_image()) {
+        map.create_lightmap(preloaded->get_lightmap_image());
+    } else {
+        map.create_lightmap();
+    }
+    lightmap = map.get_lightmap();
+}
+
 Map& Tournament::get_map() {
     return map;
 }
@@ -200,7 +196,7 @@ void Tournament::show_stats(bool state) {
 void Tournament::add_animation(GAnimation *animation) {
     GameAnimation *gani = 0;
     try {
-        Animation *ani = resources.get_animation(animation->animation_name);
+        Animation *ani = resource_ids->get_animation(animation->animation_id);
 
         int shaker = ani->get_screen_shaker();
         if (shaker) {
@@ -213,10 +209,10 @@ void Tournament::add_animation(GAnimation *animation) {
         int by = 0;
         for (int i = 0; i < spread_count; i++) {
             if (i) {
-                bx = rand() % spread - spread / 2;
-                by = rand() % spread - spread / 2;
+                bx = random->next() % spread - spread / 2;
+                by = random->next() % spread - spread / 2;
             }
-            gani = new GameAnimation;
+            gani = game_animations.create();
             gani->animation = ani;
             gani->state.id = animation->id;
             gani->state.duration = animation->duration;
@@ -225,16 +221,14 @@ void Tournament::add_animation(GAnimation *animation) {
             gani->state.y = animation->y + by;
             gani->state.accel_x = animation->accel_x;
             gani->state.accel_y = animation->accel_y;
-            gani->index = ani->get_randomized_index();
-            game_animations.push_back(gani);
+            gani->index = ani->get_randomized_index(*random);
         }
         if (!server) {
-            if (strlen(animation->sound_name)) {
-                subsystem.play_sound(resources.get_sound(animation->sound_name), 0);
+            if (animation->sound_id != ResourceIdNone) {
+                subsystem.play_sound(resource_ids->get_sound(animation->sound_id), 0);
             }
         }
     } catch (const ResourcesException& e) {
-        if (gani) delete gani;
         subsystem << "creating animation failed: " << e.what() << std::endl;
     }
 }
@@ -247,7 +241,7 @@ void Tournament::add_animation(const std::string& name, identifier_t id,
     try {
         Animation *ani = resources.get_animation(name);
         TileGraphic *tg = ani->get_tile()->get_tilegraphic();
-        gani = new GameAnimation;
+        gani = game_animations.create();
         gani->animation = ani;
         gani->state.id = id; /* client side generated are 0 */
         gani->state.duration = duration;
@@ -256,12 +250,10 @@ void Tournament::add_animation(const std::string& name, identifier_t id,
         gani->state.y = y  + height / 2 - tg->get_height() / 2;
         gani->state.accel_x = accel_x;
         gani->state.accel_y = accel_y;
-        game_animations.push_back(gani);
         if (!server) {
             subsystem.play_sound(ani->get_sound(), ani->get_sound_loops());
         }
     } catch (const ResourcesException& e) {
-        if (gani) delete gani;
         subsystem << "creating animation failed: " << e.what() << std::endl;
     }
 }
@@ -286,7 +278,7 @@ void Tournament::add_pick_object(GPickObject *po) {
     for (GameObjects::iterator it = game_objects.begin();
         it != game_objects.end(); it++)
     {
-        GameObject *obj = *it;
+        GameObject *obj = &*it;
         if (obj->state.id == po->id) {
             obj->picked = true;
             obj->delete_me = obj->object->is_spawnable();
@@ -308,16 +300,14 @@ void Tournament::add_pick_object(GPickObject *po) {
     }
 
     /* delete marked objects */
-    game_objects.erase(std::remove_if(game_objects.begin(),
-        game_objects.end(), erase_element<GameObject>),
-        game_objects.end());
+    game_objects.remove_marked();
 }
 
 void Tournament::add_place_object(GPlaceObject *po) {
     for (GameObjects::iterator it = game_objects.begin();
         it != game_objects.end(); it++)
     {
-        GameObject *obj = *it;
+        GameObject *obj = &*it;
         if (obj->state.id == po->id) {
             obj->picked = false;
             obj->state.x = po->x;
@@ -367,7 +357,7 @@ void Tournament::add_place_object(GPlaceObject *po) {
 
 void Tournament::spawn_object(GSpawnObject *so) {
     try {
-        Object *obj = resources.get_object(so->object_name);
+        Object *obj = resource_ids->get_object(so->object_id);
         spawn_object(obj, so->id, static_cast<int>(so->x), static_cast<int>(so->y), so->flags);
     } catch (const Exception& e) {
         subsystem << e.what() << std::endl;
@@ -375,7 +365,7 @@ void Tournament::spawn_object(GSpawnObject *so) {
 }
 
 void Tournament::spawn_object(Object *obj, identifier_t id, int x, int y, flags_t flags) {
-    GameObject *nobj = new GameObject;
+    GameObject *nobj = game_objects.create();
     nobj->object = obj;
     nobj->origin_x = x;
     nobj->origin_y = y;
@@ -385,7 +375,6 @@ void Tournament::spawn_object(Object *obj, identifier_t id, int x, int y, flags_
     nobj->state.x = static_cast<double>(x);
     nobj->state.y = static_cast<double>(y);
     nobj->spawned_object = true;
-    game_objects.push_back(nobj);
 
     if (!server) {
         if (flags & PlaceObjectWithAnimation) {
@@ -420,21 +409,39 @@ void Tournament::add_player_spawn_animation(Player *p) {
 }
 
 void Tournament::add_state_response(int action, data_len_t len, const void *data) {
-    state_responses.push_back(new StateResponse(action, len, reinterpret_cast<const data_t *>(data)));
+    if (state_responses.size() == state_responses.capacity()) {
+        response_vector_growths++;
+    }
+    StateResponse *resp = new (response_arena.alloc(sizeof(StateResponse)))
+        StateResponse(action, len, reinterpret_cast<const data_t *>(data));
+    state_responses.push_back(resp);
 }
 
 void Tournament::add_msg_response(const char *msg) {
     size_t sz = strlen(msg);
-    char *msgb = new char[sz];
+    char *msgb = static_cast<char *>(response_arena.alloc(sz));
     memcpy(msgb, msg, sz);
     add_state_response(GPCTextMessage, static_cast<data_len_t>(sz), msgb);
 }
 
-void Tournament::add_sound_response(const char *name) {
-    GGenericName *gnam = new GGenericName;
-    memset(gnam, 0, GGenericNameLen);
-    strncpy(gnam->name, name, NameLength - 1);
-    add_state_response(GPCPlaySound, GGenericNameLen, gnam);
+void Tournament::add_sound_response(Sound *sound) {
+    GPlaySound *gsnd = create_response<GPlaySound>();
+    gsnd->sound_id = resource_ids->get_id(sound);
+    gsnd->to_net();
+    add_state_response(GPCPlaySound, GPlaySoundLen, gsnd);
+}
+
+Sound *Tournament::lookup_sound(const std::string& name) {
+    /* an unknown sound is sent without id */
+    if (name.length()) {
+        try {
+            return resources.get_sound(name);
+        } catch (const ResourcesException&) {
+            /* chomp */
+        }
+    }
+
+    return 0;
 }
 
 Player *Tournament::get_following_player() {
@@ -464,27 +471,23 @@ Player *Tournament::get_me() {
 }
 
 void Tournament::delete_responses() {
-    size_t sz = state_responses.size();
-    for (size_t i = 0; i < sz; i++) {
-        StateResponse *resp = state_responses[i];
-        if (resp->data) {
-            if (resp->action == GPCTextMessage) {
-                delete[] resp->data;
-            } else {
-                delete resp->data;
-            }
-        }
-        delete resp;
-    }
+    /* all payloads are in the arena, the vector keeps its capacity */
     state_responses.clear();
+    response_heap_allocations = response_vector_growths + response_arena.get_heap_allocations();
+    response_vector_growths = 0;
+    response_arena.reset();
+}
+
+size_t Tournament::get_response_heap_allocations() const {
+    return response_heap_allocations;
 }
 
 void Tournament::create_spawn_points() throw (TournamentException) {
     for (GameObjects::iterator it = game_objects.begin(); it != game_objects.end(); it++) {
-        GameObject *obj = *it;
+        GameObject *obj = &*it;
         Object::ObjectType type = obj->object->get_type();
         if (type == Object::ObjectTypeSpawnPointRed || type == Object::ObjectTypeSpawnPointBlue) {
-            spawn_points.push_back(obj);
+            spawn_points.push_back(game_objects.get_handle(obj));
         }
     }
     if (!spawn_points.size()) {
@@ -498,7 +501,7 @@ void Tournament::player_removed(Player *p) {
     for (GameAnimations::iterator it = game_animations.begin();
         it != game_animations.end(); it++)
     {
-        GameAnimation *gani = *it;
+        GameAnimation *gani = &*it;
         if (gani->state.owner == p->state.id) {
             gani->state.owner = 0;
         }
@@ -511,7 +514,7 @@ void Tournament::spawn_player(Player *p) {
 
 void Tournament::spawn_player_base(Player *p, SpawnPoints& spawn_points) {
     // TODO: better selection of spawn points, maybe order by last spawn point usage
-    GameObject *obj = spawn_points[rand() % spawn_points.size()];
+    GameObject *obj = game_objects.get(spawn_points[random->next() % spawn_points.size()]);
     const CollisionBox& colbox = p->get_characterset()->get_colbox();
     TileGraphic *tg = obj->object->get_tile()->get_tilegraphic();
     int w = tg->get_width();
@@ -525,6 +528,27 @@ void Tournament::spawn_player_base(Player *p, SpawnPoints& spawn_points) {
     p->spawn(x, y);
 }
 
+void Tournament::get_object_center(GameObject *obj, double& x, double& y) {
+    TileGraphic *tg = obj->object->get_tile()->get_tilegraphic();
+    x = obj->state.x + tg->get_width() / 2;
+    y = obj->state.y + tg->get_height() / 2;
+}
+
+bool Tournament::find_tile_center(Tile::TileType type, double& x, double& y) {
+    for (int ty = 0; ty < map_height; ty++) {
+        for (int tx = 0; tx < map_width; tx++) {
+            short index = map_array[ty][tx];
+            if (index > -1 && tileset->get_tile(index)->get_tile_type() == type) {
+                x = tx * tile_width + tile_width / 2;
+                y = ty * tile_height + tile_height / 2;
+                return true;
+            }
+        }
+    }
+
+    return false;
+}
+
 void Tournament::add_team_score(GTeamScore *ts) { }
 
 void Tournament::retrieve_states() { }
@@ -553,6 +577,15 @@ bool Tournament::play_frog_error(Player *p) {
 
 void Tournament::reopen_join_window(Player *p) { }
 
+bool Tournament::is_team_game() const {
+    return false;
+}
+
+/* no objective, bots hunt the nearest enemy */
+bool Tournament::get_bot_goal(Player *p, double& x, double& y) {
+    return false;
+}
+
 bool Tournament::pick_item(Player *p, GameObject *obj) {
     switch (obj->object->get_type()) {
         case Object::ObjectTypeBomb:
@@ -656,10 +689,12 @@ bool Tournament::fire_enabled(Player *p) {
     return true;
 }
 
-void Tournament::play_ground_bump_sound() {
-    if (!server) {
+void Tournament::play_ground_bump_sound(int bumps) {
+    if (!server && bumps) {
         Sound *sound = resources.get_sound(properties.get_value("ground_bump_sound"));
-        subsystem.play_sound(sound, 0);
+        for (int i = 0; i < bumps; i++) {
+            subsystem.play_sound(sound, 0);
+        }
     }
 }
 
@@ -735,10 +770,10 @@ void Tournament::player_dies(Player *p, const std::string& die_message) {
     try {
         Animation *tempani = resources.get_animation(properties.get_value("die_animation"));
 
-        GAnimation *ani = new GAnimation;
+        GAnimation *ani = create_response<GAnimation>();
         memset(ani, 0, sizeof(GAnimation));
-        strncpy(ani->animation_name, tempani->get_name().c_str(), NameLength - 1);
-        strncpy(ani->sound_name, properties.get_value("die_sound").c_str(), NameLength - 1);
+        ani->animation_id = resource_ids->get_id(tempani);
+        ani->sound_id = resource_ids->get_id(die_sound);
 
         TileGraphic *tg = p->get_characterset()->get_tile(DirectionLeft, CharacterAnimationStanding)->get_tilegraphic();
         TileGraphic *tga = tempani->get_tile()->get_tilegraphic();
@@ -762,7 +797,7 @@ void Tournament::player_join_request(Player *p) {
         Player *me = get_me();
         if (me) {
             this->spawn_player(me);
-            playerflags_t *flags = new playerflags_t;
+            playerflags_t *flags = create_response<playerflags_t>();
             *flags = 0;
             add_state_response(GPSJoinRequest, sizeof(playerflags_t), flags);
         }
@@ -808,6 +843,27 @@ void Tournament::set_team_names(const std::string& team_red, const std::string&
     team_blue_name = team_blue;
 }
 
+void Tournament::set_resource_ids(ResourceIds *ids) {
+    resource_ids = ids;
+}
+
+void Tournament::set_job_system(JobSystem *jobs) {
+    this->jobs = jobs;
+}
+
+void Tournament::set_random(Random *random) {
+    this->random = (random ? random : &own_random);
+
+    /* the first frog is drawn again, a replay draws it from the same seed */
+    if (has_frogs) {
+        reset_frog_spawn_counter();
+    }
+}
+
+Random& Tournament::get_random() {
+    return *random;
+}
+
 void Tournament::destroy_generic_data_list(GenericData *data) {
     GenericData *s = data;
     GenericData *next = 0;
@@ -829,4 +885,8 @@ void Tournament::generic_data_delivery(void *data) { }
 
 void Tournament::set_friendly_fire_alarm(bool state) {
     do_friendly_fire_alarm = state;
+}
+
+bool Tournament::is_fire_enabled(Player *p) {
+    return fire_enabled(p);
 }
\ No newline at end of file
@@ -0,0 +1,357 @@
+#include "TournamentBenchmark.hpp"
+#include "TournamentFactory.hpp"
+#include "Tournament.hpp"
+#include "JobSystem.hpp"
+#include "Navigation.hpp"
+#include "Bot.hpp"
+#include "Utils.hpp"
+#include "AllocationTracker.hpp"
+
+#include <cstdlib>
+#include <cstdio>
+
+/* same rate as the server */
+static const ns_t BenchmarkTickNS = 1000000000 / 60;
+
+static const char *DefaultModes = "dm,ctf,sr,ctc,goh";
+
+/* the first tenth of the ticks fills the pools, allocations count after */
+static const int BenchmarkWarmupDivisor = 10;
+static const size_t BenchmarkAllocationSites = 12;
+
+TournamentBenchmark::TournamentBenchmark(Subsystem& subsystem, const Parameters& parms)
+    throw (BenchmarkException)
+    : Benchmark(subsystem, parms), player_count(0), npc_count(0), projectile_count(0),
+      tick_count(0), use_bots(false), next_shooter(0)
+{
+    set_default("modes", DefaultModes);
+    set_default("players", "16");
+    set_default("npcs", "8");
+    set_default("projectiles", "32");
+    set_default("ticks", "6000");
+    set_default("seed", "1");
+    set_default("bots", "0");
+
+    player_count = atoi(get_value("players").c_str());
+    npc_count = atoi(get_value("npcs").c_str());
+    projectile_count = atoi(get_value("projectiles").c_str());
+    tick_count = atoi(get_value("ticks").c_str());
+    use_bots = (atoi(get_value("bots").c_str()) != 0);
+    if (player_count < 1 || tick_count < 1) {
+        throw BenchmarkException("At least one player and one tick are needed");
+    }
+}
+
+TournamentBenchmark::~TournamentBenchmark() { }
+
+int TournamentBenchmark::run() throw (Exception) {
+    Resources resources(subsystem, get_value("data_directory"), Resources::LoadProfileServer);
+
+    size_t workers = JobSystem::get_default_worker_count();
+    const std::string& jobs_value = get_value("jobs");
+    if (jobs_value.length()) {
+        workers = static_cast<size_t>(atoi(jobs_value.c_str()));
+    }
+    JobSystem jobs(workers);
+
+    TournamentFactory factory(resources, subsystem, 0);
+    factory.set_job_system(&jobs);
+    factory.set_random(&random);
+
+    subsystem << "benchmarking " << player_count << (use_bots ? " bot(s), " : " player(s), ")
+        << npc_count << " npc(s), " << projectile_count << " projectile(s), " << tick_count
+        << " tick(s), " << jobs.get_worker_count() << " worker(s)" << std::endl;
+
+    /* only this thread is tracked, its jobs run inline while it is */
+    if (!AllocationTracker::attach()) {
+        throw BenchmarkException("Allocations are tracked in another thread");
+    }
+
+    int failed = 0;
+    StringTokens modes = tokenize(get_value("modes"), ',');
+    for (StringTokens::iterator it = modes.begin(); it != modes.end(); it++) {
+        try {
+            run_mode(resources, factory, *it);
+        } catch (const Exception& e) {
+            subsystem << *it << ": failed: " << e.what() << std::endl;
+            failed++;
+        }
+    }
+
+    Profiler::Report report;
+    profiler.report(report);
+    for (Profiler::Report::iterator it = report.begin(); it != report.end(); it++) {
+        subsystem << *it << std::endl;
+    }
+
+    AllocationTracker::detach();
+    save_results();
+
+    return failed;
+}
+
+void TournamentBenchmark::run_mode(Resources& resources, TournamentFactory& factory,
+    const std::string& mode) throw (Exception)
+{
+    GamePlayType type = get_game_play_type(mode);
+    std::string map_name = get_value("map");
+    if (!map_name.length()) {
+        map_name = find_map(resources, type);
+    }
+    std::string characterset_name = find_characterset(resources);
+
+    /* same outcome on every run */
+    random.seed(static_cast<uint32_t>(atoi(get_value("seed").c_str())));
+    next_shooter = 0;
+
+    Players players;
+    Bots bots;
+    Tournament *tournament = 0;
+    Navigation *navigation = 0;
+    size_t phase = profiler.add_phase(mode.c_str());
+    size_t bots_phase = (use_bots ? profiler.add_phase((mode + " bots").c_str()) : 0);
+    gametime_t start;
+    gametime_t end;
+
+    try {
+        for (int i = 0; i < player_count; i++) {
+            char name[32];
+            sprintf(name, "bot%d", i + 1);
+            players.push_back(new Player(resources, 0, static_cast<player_id_t>(i + 1),
+                name, characterset_name));
+        }
+
+        int duration = tick_count / 3600 + 1;
+        MapConfiguration config(type, map_name, duration, 0);
+        tournament = factory.create_tournament(config, true, false, players, 0);
+        tournament->set_team_names("team red", "team blue");
+        join_players(tournament, players);
+
+        if (use_bots) {
+            ProfilerScope scope(&profiler, bots_phase);
+            navigation = new Navigation(tournament->get_map(), tournament->get_tileset(),
+                players[0]->get_characterset()->get_colbox().height);
+            for (Players::iterator it = players.begin(); it != players.end(); it++) {
+                (*it)->bot = true;
+                bots.push_back(new Bot(*it));
+            }
+        }
+
+        get_now(start);
+        AllocationTracker::reset();
+        for (int tick = 0; tick < tick_count; tick++) {
+            if (tick == tick_count / BenchmarkWarmupDivisor) {
+                AllocationTracker::reset();
+            }
+            if (use_bots) {
+                ProfilerScope scope(&profiler, bots_phase);
+                think_bots(tournament, navigation, bots, players);
+            } else {
+                script_players(tournament, players, tick);
+            }
+            top_up(tournament, players);
+            {
+                ProfilerScope scope(&profiler, phase);
+                tournament->update_states(BenchmarkTickNS);
+            }
+            tournament->delete_responses();
+            AllocationTracker::tick();
+        }
+        get_now(end);
+    } catch (...) {
+        cleanup(tournament, navigation, bots, players);
+        throw;
+    }
+
+    cleanup(tournament, navigation, bots, players);
+
+    ns_t ns_per_tick = diff_ns(start, end) / tick_count;
+    subsystem << mode << ": map=" << map_name << " ticks=" << tick_count
+        << " ns/tick=" << ns_per_tick << std::endl;
+
+    set_result(mode + "_map", map_name);
+    set_result(mode + "_ns_per_tick", ns_per_tick);
+
+    if (AllocationTracker::is_available()) {
+        report_allocations(mode);
+    }
+}
+
+void TournamentBenchmark::report_allocations(const std::string& mode) throw (BenchmarkException) {
+    uint64_t ticks = AllocationTracker::get_ticks();
+    double per_tick = static_cast<double>(AllocationTracker::get_allocations()) / (ticks ? ticks : 1);
+
+    AllocationTracker::Report report;
+    AllocationTracker::report(report, BenchmarkAllocationSites);
+    for (AllocationTracker::Report::iterator it = report.begin(); it != report.end(); it++) {
+        subsystem << mode << ": " << *it << std::endl;
+    }
+
+    char value[32];
+    sprintf(value, "%.1f", per_tick);
+    set_result(mode + "_allocations_per_tick", std::string(value));
+}
+
+GamePlayType TournamentBenchmark::get_game_play_type(const std::string& mode) throw (BenchmarkException) {
+    std::string m = lowercase(mode);
+    if (m == "dm") {
+        return GamePlayTypeDM;
+    } else if (m == "tdm") {
+        return GamePlayTypeTDM;
+    } else if (m == "ctf") {
+        return GamePlayTypeCTF;
+    } else if (m == "sr") {
+        return GamePlayTypeSR;
+    } else if (m == "ctc") {
+        return GamePlayTypeCTC;
+    } else if (m == "goh") {
+        return GamePlayTypeGOH;
+    }
+
+    throw BenchmarkException("Unknown game mode: " + mode);
+}
+
+std::string TournamentBenchmark::find_map(Resources& resources, GamePlayType type) throw (BenchmarkException) {
+    /* team death match is played on death match maps */
+    GamePlayType map_type = (type == GamePlayTypeTDM ? GamePlayTypeDM : type);
+
+    Resources::ResourceObjects& maps = resources.get_maps();
+    for (Resources::ResourceObjects::iterator it = maps.begin(); it != maps.end(); it++) {
+        Map *map = static_cast<Map *>(it->object);
+        if (map->get_game_play_type() == map_type) {
+            return map->get_name();
+        }
+    }
+
+    throw BenchmarkException("No map found for this game mode");
+}
+
+std::string TournamentBenchmark::find_characterset(Resources& resources) throw (BenchmarkException) {
+    const std::string& name = get_value("characterset");
+    if (name.length()) {
+        return name;
+    }
+
+    Resources::ResourceObjects& sets = resources.get_charactersets();
+    if (!sets.size()) {
+        throw BenchmarkException("No characterset found");
+    }
+
+    return static_cast<Characterset *>(sets[0].object)->get_name();
+}
+
+void TournamentBenchmark::join_players(Tournament *tournament, Players& players) {
+    size_t sz = players.size();
+    for (size_t i = 0; i < sz; i++) {
+        Player *p = players[i];
+        tournament->player_added(p);
+        p->client_synced = true;
+        tournament->player_joins(p, (i % 2 ? 0 : PlayerServerFlagTeamRed));
+        respawn_player(tournament, p);
+    }
+}
+
+void TournamentBenchmark::respawn_player(Tournament *tournament, Player *p) {
+    p->state.server_state.flags &= PlayerServerFlagTeamRed;
+    p->zero();
+    tournament->spawn_player(p);
+}
+
+void TournamentBenchmark::script_players(Tournament *tournament, Players& players, int tick) {
+    size_t sz = players.size();
+    for (size_t i = 0; i < sz; i++) {
+        Player *p = players[i];
+        if (!p->is_alive_and_playing()) {
+            respawn_player(tournament, p);
+        }
+
+        /* run back and forth, jump once a second, duck from time to time */
+        int t = tick + static_cast<int>(i) * 37;
+        keystates_t keys = ((t % 240) < 120 ? PlayerKeyStateRight : PlayerKeyStateLeft);
+        if (t % 60 < 8) {
+            keys |= PlayerKeyStateJump;
+        }
+        if (t % 180 > 170) {
+            keys |= PlayerKeyStateDown;
+        }
+        p->state.client_server_state.key_states = keys;
+    }
+}
+
+void TournamentBenchmark::think_bots(Tournament *tournament, Navigation *navigation, Bots& bots,
+    Players& players)
+{
+    for (Bots::iterator it = bots.begin(); it != bots.end(); it++) {
+        Bot *bot = *it;
+        Player *p = bot->get_player();
+        bot->think(*tournament, *navigation, players, BenchmarkTickNS);
+        if (p->respawning) {
+            p->respawning = false;
+            respawn_player(tournament, p);
+        }
+    }
+}
+
+void TournamentBenchmark::cleanup(Tournament *tournament, Navigation *navigation, Bots& bots,
+    Players& players)
+{
+    delete tournament;
+    delete navigation;
+    for (Bots::iterator it = bots.begin(); it != bots.end(); it++) {
+        delete *it;
+    }
+    for (Players::iterator it = players.begin(); it != players.end(); it++) {
+        delete *it;
+    }
+}
+
+void TournamentBenchmark::top_up(Tournament *tournament, Players& players) {
+    size_t sz = players.size();
+
+    /* frogs are the npcs players can spawn */
+    Tournament::SpawnableNPCs& npcs = tournament->get_spawnable_npcs();
+    for (size_t i = 0; i < sz && static_cast<int>(npcs.size()) < npc_count; i++) {
+        Player *p = next_alive_player(players);
+        if (p) {
+            p->state.server_state.frogs = 1;
+            tournament->fire_frog(p, p->state.client_server_state.direction);
+        }
+    }
+
+    /* cycle through shots, grenades and bombs */
+    Tournament::GameAnimations& animations = tournament->get_game_animations();
+    for (size_t i = 0; i < sz && static_cast<int>(animations.size()) < projectile_count; i++) {
+        Player *p = next_alive_player(players);
+        if (p) {
+            unsigned char direction = p->state.client_server_state.direction;
+            switch (next_shooter % 3) {
+                case 0:
+                    p->state.server_state.ammo = 1;
+                    tournament->fire_shot(p, direction);
+                    break;
+
+                case 1:
+                    p->state.server_state.grenades = 1;
+                    tournament->fire_grenade(p, direction);
+                    break;
+
+                case 2:
+                    p->state.server_state.bombs = 1;
+                    tournament->fire_bomb(p, direction);
+                    break;
+            }
+        }
+    }
+}
+
+Player *TournamentBenchmark::next_alive_player(Players& players) {
+    size_t sz = players.size();
+    for (size_t i = 0; i < sz; i++) {
+        Player *p = players[next_shooter++ % sz];
+        if (p->is_alive_and_playing()) {
+            return p;
+        }
+    }
+
+    return 0;
+}
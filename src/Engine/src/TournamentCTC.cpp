@@ -12,7 +12,7 @@ TournamentCTC::TournamentCTC(Resources& resources, Subsystem& subsystem, Gui *gu
     const std::string& map_name, Players& players, int duration, bool warmup)
     throw (TournamentException, ResourcesException)
     : Tournament(resources, subsystem, gui, logger, game_file, server, map_name, players,
-      duration, warmup), coin(0),
+      duration, warmup),
       enemy_indicator_coin(resources.get_icon("enemy_indicator_coin"))
 {
     /* create spawn points */
@@ -22,23 +22,26 @@ TournamentCTC::TournamentCTC(Resources& resources, Subsystem& subsystem, Gui *gu
     }
 
     /* find coin in this map */
+    GameObject *found = 0;
     for (GameObjects::iterator it = game_objects.begin();
         it != game_objects.end(); it++)
     {
-        GameObject *obj = *it;
+        GameObject *obj = &*it;
         Object::ObjectType type = obj->object->get_type();
         if (type == Object::ObjectTypeCoin) {
-            if (coin) {
+            if (found) {
                 throw TournamentException("Multiple coins not allowed");
             }
-            coin = obj;
+            found = obj;
         }
     }
 
-    if (!coin) {
+    if (!found) {
         throw TournamentException("Coin is missing in this map");
     }
 
+    coin_handle = game_objects.get_handle(found);
+
     /* add all players into list */
     for (Players::iterator it = players.begin(); it != players.end(); it++) {
         Player *p = *it;
@@ -80,7 +83,7 @@ void TournamentCTC::write_stats_in_server_log() {
 }
 
 void TournamentCTC::update_wearable_remaining(GTimeRemaining *remain) {
-    coin->spawn_counter = remain->remaining;
+    get_coin()->spawn_counter = remain->remaining;
 }
 
 void TournamentCTC::frag_point(Player *pfrag, Player *pkill) { }
@@ -117,6 +120,7 @@ void TournamentCTC::subintegrate(ns_t ns) {
 }
 
 void TournamentCTC::check_coin_validity(double period_f) {
+    GameObject *coin = get_coin();
     if (coin->state.y - 100 > map_height * tile_height) {
         /* check if coin is in valid map range */
         if (!coin->picked) {
@@ -141,10 +145,11 @@ void TournamentCTC::check_coin_validity(double period_f) {
 }
 
 void TournamentCTC::return_coin(int flags) {
+    GameObject *coin = get_coin();
     coin->picked = false;
     coin->state.accel_x = 0.0f;
     coin->state.accel_y = 0.0f;
-    GPlaceObject *gpo = new GPlaceObject;
+    GPlaceObject *gpo = create_response<GPlaceObject>();
     memset(gpo, 0, sizeof(GPlaceObject));
     gpo->id = coin->state.id;
     gpo->flags = PlaceObjectWithAnimation | PlaceObjectResetVelocity | flags;
@@ -156,15 +161,16 @@ void TournamentCTC::return_coin(int flags) {
 }
 
 bool TournamentCTC::coin_not_at_origin() {
+    GameObject *coin = get_coin();
     int dx = static_cast<int>(round(coin->state.x)) - coin->origin_x;
     int dy = static_cast<int>(round(coin->state.y)) - coin->origin_y;
     return dx || dy;
 }
 
 void TournamentCTC::send_coin_remaining() {
-    GTimeRemaining *remain = new GTimeRemaining;
+    GTimeRemaining *remain = create_response<GTimeRemaining>();
     remain->flags = 0;
-    remain->remaining = static_cast<pos_t>(coin->spawn_counter);
+    remain->remaining = static_cast<pos_t>(get_coin()->spawn_counter);
     remain->to_net();
     add_state_response(GPCTimeRemaining, GTimeRemainingLen, remain);
 }
@@ -175,7 +181,7 @@ void TournamentCTC::send_coin_timer(Player *p) {
 
 void TournamentCTC::send_coin_timer(TimesOfPlayer *top) {
     if (top) {
-        GTransportTotalAndTime *tm = new GTransportTotalAndTime;
+        GTransportTotalAndTime *tm = create_response<GTransportTotalAndTime>();
         tm->id = top->player->state.id;
         tm->total = static_cast<sr_milliseconds_t>(round(top->total * 1000.0f));
         tm->current = top->send_current;
@@ -184,8 +190,33 @@ void TournamentCTC::send_coin_timer(TimesOfPlayer *top) {
     }
 }
 
+bool TournamentCTC::get_bot_goal(Player *p, double& x, double& y) {
+    /* the holder keeps running, the others chase the coin */
+    if (p->state.server_state.flags & PlayerServerFlagHasCoin) {
+        return false;
+    }
+
+    GameObject *coin = get_coin();
+    if (!coin->picked) {
+        get_object_center(coin, x, y);
+        return true;
+    }
+
+    for (Players::iterator it = players.begin(); it != players.end(); it++) {
+        Player *holder = *it;
+        if (holder->is_alive_and_playing() && holder->state.server_state.flags & PlayerServerFlagHasCoin) {
+            x = holder->state.client_server_state.x;
+            y = holder->state.client_server_state.y;
+            return true;
+        }
+    }
+
+    return false;
+}
+
 void TournamentCTC::player_added(Player *p) {
     times_of_players.push_back(TimesOfPlayer(p));
+    reattach_times(times_of_players.back());
 }
 
 void TournamentCTC::player_removed(Player *p) {
@@ -236,6 +267,7 @@ bool TournamentCTC::pick_item(Player *p, GameObject *obj) {
 
 void TournamentCTC::draw_object_addons() {
     /* draw coin return counter */
+    GameObject *coin = get_coin();
     if (coin_not_at_origin()) {
         if (!coin->picked) {
             int x = static_cast<int>(coin->state.x) + 2;
@@ -261,7 +293,7 @@ void TournamentCTC::draw_player_addons() {
             if (p->state.server_state.flags & PlayerServerFlagHasCoin) {
                 int fx = p->get_characterset()->get_coin_offset_x();
                 int fy = p->get_characterset()->get_coin_offset_y();
-                subsystem.draw_tile(coin->object->get_tile(),
+                subsystem.draw_tile(get_coin()->object->get_tile(),
                     static_cast<int>(p->state.client_server_state.x) + left + fx,
                     static_cast<int>(p->state.client_server_state.y) + top + fy);
             }
@@ -503,6 +535,7 @@ void TournamentCTC::generic_data_delivery(void *data) {
 
 bool TournamentCTC::test_and_drop_coin(Player *p) {
     /* test if player has coin -> drop it */
+    GameObject *coin = get_coin();
     bool dropped = false;
     if (server) {
         if (p->state.server_state.flags & PlayerServerFlagHasCoin) {
@@ -518,7 +551,7 @@ bool TournamentCTC::test_and_drop_coin(Player *p) {
             coin->state.accel_x = p->state.client_server_state.accel_x;
             coin->state.accel_y = p->state.client_server_state.accel_y;
 
-            GPlaceObject *gpo = new GPlaceObject;
+            GPlaceObject *gpo = create_response<GPlaceObject>();
             memset(gpo, 0, sizeof(GPlaceObject));
             gpo->id = coin->state.id;
             gpo->flags = PlaceObjectWithDropSound;
@@ -616,3 +649,74 @@ int TournamentCTC::draw_stats(Font *f, int x, int y) {
 
     return y;
 }
+
+void TournamentCTC::get_checkpoint_object(GameObject *obj, GameObject& state) {
+    state = *obj;
+    if (obj != get_coin() || !obj->picked) {
+        return;
+    }
+
+    /* the holder does not survive a restart, the coin drops as if they left */
+    state.picked = false;
+    state.spawn_counter = static_cast<double>(CoinDropInitialValue);
+    state.state.x = obj->origin_x;
+    state.state.y = obj->origin_y;
+    state.state.accel_x = 0.0f;
+    state.state.accel_y = 0.0f;
+    for (Players::iterator it = players.begin(); it != players.end(); it++) {
+        Player *p = *it;
+        if (p->state.server_state.flags & PlayerServerFlagHasCoin) {
+            int fx = p->get_characterset()->get_coin_drop_offset_x();
+            int fy = p->get_characterset()->get_coin_drop_offset_y();
+            state.state.x = static_cast<pos_t>(p->state.client_server_state.x) + fx;
+            state.state.y = static_cast<pos_t>(p->state.client_server_state.y) + fy;
+            state.state.accel_x = p->state.client_server_state.accel_x;
+            state.state.accel_y = p->state.client_server_state.accel_y;
+            break;
+        }
+    }
+}
+
+void TournamentCTC::write_mode_checkpoint(Checkpoint& cp) {
+    cp.write_u16(static_cast<uint16_t>(times_of_players.size() + held_times.size()));
+    for (TimesOfPlayers::iterator it = times_of_players.begin(); it != times_of_players.end(); it++) {
+        cp.write_string(it->player->get_player_name());
+        cp.write_float(it->total + it->current);
+    }
+    for (HeldTimesOfPlayers::iterator it = held_times.begin(); it != held_times.end(); it++) {
+        cp.write_string(it->player_name);
+        cp.write_float(it->total);
+    }
+}
+
+void TournamentCTC::read_mode_checkpoint(Checkpoint& cp) throw (CheckpointException) {
+    held_times.clear();
+    uint16_t count = cp.read_u16();
+    for (uint16_t i = 0; i < count; i++) {
+        HeldTimes held;
+        held.player_name = cp.read_string();
+        held.total = cp.read_float();
+        held_times.push_back(held);
+    }
+
+    for (TimesOfPlayers::iterator it = times_of_players.begin(); it != times_of_players.end(); it++) {
+        reattach_times(*it);
+    }
+}
+
+bool TournamentCTC::reattach_times(TimesOfPlayer& top) {
+    for (HeldTimesOfPlayers::iterator it = held_times.begin(); it != held_times.end(); it++) {
+        if (it->player_name == top.player->get_player_name()) {
+            top.total = it->total;
+            top.current = 0;
+            held_times.erase(it);
+            return true;
+        }
+    }
+
+    return false;
+}
+
+GameObject *TournamentCTC::get_coin() {
+    return game_objects.get(coin_handle);
+}
@@ -11,35 +11,40 @@ TournamentCTF::TournamentCTF(Resources& resources, Subsystem& subsystem, Gui *gu
     const std::string& map_name, Players& players, int duration, bool warmup)
     throw (TournamentException, ResourcesException)
     : TournamentTeam(resources, subsystem, gui, logger, game_file, server, map_name, players,
-      duration, warmup), red_flag(0), blue_flag(0)
+      duration, warmup)
 {
     /* find red and blue flags in this map */
+    GameObject *red = 0;
+    GameObject *blue = 0;
     for (GameObjects::iterator it = game_objects.begin();
         it != game_objects.end(); it++)
     {
-        GameObject *obj = *it;
+        GameObject *obj = &*it;
         Object::ObjectType type = obj->object->get_type();
         if (type == Object::ObjectTypeRedFlag) {
-            if (red_flag) {
+            if (red) {
                 throw TournamentException("Multiple red flags not allowed");
             }
-            red_flag = obj;
+            red = obj;
         } else if (type == Object::ObjectTypeBlueFlag) {
-            if (blue_flag) {
+            if (blue) {
                 throw TournamentException("Multiple blue flags not allowed");
             }
-            blue_flag = obj;
+            blue = obj;
         }
     }
 
-    if (!red_flag) {
+    if (!red) {
         throw TournamentException("Red flag is missing in this map");
     }
 
-    if (!blue_flag) {
+    if (!blue) {
         throw TournamentException("Blue flag is missing in this map");
     }
 
+    red_flag = game_objects.get_handle(red);
+    blue_flag = game_objects.get_handle(blue);
+
     /* setup tournament icon */
     tournament_icon = resources.get_icon("hud_ctf");
 }
@@ -57,8 +62,8 @@ void TournamentCTF::write_stats_in_server_log() {
 void TournamentCTF::subintegrate(ns_t ns) {
     double period_f = ns / static_cast<double>(ns_fc);
     if (server) {
-        check_flag_validity(period_f, "red flag", red_flag);
-        check_flag_validity(period_f, "blue flag", blue_flag);
+        check_flag_validity(period_f, "red flag", get_red_flag());
+        check_flag_validity(period_f, "blue flag", get_blue_flag());
 
         for (Players::iterator it = players.begin(); it != players.end(); it++) {
             Player *p = *it;
@@ -126,7 +131,7 @@ void TournamentCTF::draw_object_addons() {
     /* draw flag return counter */
     GameObject *flag;
     for (int i = 0; i < 2; i++) {
-        flag = (!i ? red_flag : blue_flag);
+        flag = (!i ? get_red_flag() : get_blue_flag());
         if (flag_not_at_origin(flag)) {
             if (!flag->picked) {
                 int x = static_cast<int>(flag->state.x);
@@ -152,9 +157,9 @@ void TournamentCTF::draw_player_addons() {
             if (p->state.server_state.flags & PlayerServerFlagHasOppositeFlag) {
                 GameObject *flag = 0;
                 if (p->state.server_state.flags & PlayerServerFlagTeamRed) {
-                    flag = blue_flag;
+                    flag = get_blue_flag();
                 } else {
-                    flag = red_flag;
+                    flag = get_red_flag();
                 }
                 int fx = p->get_characterset()->get_flag_offset_x();
                 int fy = p->get_characterset()->get_flag_offset_y();
@@ -182,6 +187,47 @@ bool TournamentCTF::play_gun_error(Player *p) {
     return true;
 }
 
+bool TournamentCTF::get_bot_goal(Player *p, double& x, double& y) {
+    bool red = ((p->state.server_state.flags & PlayerServerFlagTeamRed) != 0);
+    GameObject *own_flag = (red ? get_red_flag() : get_blue_flag());
+    GameObject *opposite_flag = (red ? get_blue_flag() : get_red_flag());
+
+    /* bring the flag home to the own base */
+    if (p->state.server_state.flags & PlayerServerFlagHasOppositeFlag) {
+        TileGraphic *tg = own_flag->object->get_tile()->get_tilegraphic();
+        x = own_flag->origin_x + tg->get_width() / 2;
+        y = own_flag->origin_y + tg->get_height() / 2;
+        return true;
+    }
+
+    /* catch the opposite flag */
+    if (!opposite_flag->picked) {
+        get_object_center(opposite_flag, x, y);
+        return true;
+    }
+
+    /* chase the thief of the own flag */
+    if (own_flag->picked) {
+        for (Players::iterator it = players.begin(); it != players.end(); it++) {
+            Player *thief = *it;
+            if (thief->is_alive_and_playing() &&
+                thief->state.server_state.flags & PlayerServerFlagHasOppositeFlag &&
+                ((thief->state.server_state.flags & PlayerServerFlagTeamRed) != 0) != red)
+            {
+                x = thief->state.client_server_state.x;
+                y = thief->state.client_server_state.y;
+                return true;
+            }
+        }
+    } else if (flag_not_at_origin(own_flag)) {
+        /* return the dropped own flag */
+        get_object_center(own_flag, x, y);
+        return true;
+    }
+
+    return false;
+}
+
 bool TournamentCTF::pick_item(Player *p, GameObject *obj) {
     switch (obj->object->get_type()) {
         case Object::ObjectTypeRedFlag:
@@ -243,65 +289,56 @@ bool TournamentCTF::pick_item(Player *p, GameObject *obj) {
     return false;
 }
 
-bool TournamentCTF::tile_collision(TestType type, Player *p, int last_falling_y_pos,
-    Tile *t, bool *killing)
-{
-    if (killing) *killing = false;
-
-    if (p) {
-        switch (t->get_tile_type()) {
-            case Tile::TileTypeBaseRed:
-                if (server && p) {
-                    if (p->state.server_state.flags & PlayerServerFlagHasOppositeFlag &&
-                        p->state.server_state.flags & PlayerServerFlagTeamRed)
-                    {
-                        /* red team scores */
-                        p->state.server_state.flags &= ~PlayerServerFlagHasOppositeFlag;
-                        p->state.server_state.score += 3;
-                        return_flag(blue_flag, PlaceObjectWithScoredSound);
-                        std::string msg(team_red_name + " team scores");
-                        add_msg_response(msg.c_str());
-                        if (logger) {
-                            logger->log(ServerLogger::LogTypeTeamRedScored, msg, p);
-                        }
-                        std::string team_name = uppercase(team_red_name);
-                        add_team_score_animation(p, team_name + " SCORES");
-                        score.score_red++;
-                        send_team_score();
+void TournamentCTF::touch_tile(Player *p, Tile *t) {
+    switch (t->get_tile_type()) {
+        case Tile::TileTypeBaseRed:
+            if (server) {
+                if (p->state.server_state.flags & PlayerServerFlagHasOppositeFlag &&
+                    p->state.server_state.flags & PlayerServerFlagTeamRed)
+                {
+                    /* red team scores */
+                    p->state.server_state.flags &= ~PlayerServerFlagHasOppositeFlag;
+                    p->state.server_state.score += 3;
+                    return_flag(get_blue_flag(), PlaceObjectWithScoredSound);
+                    std::string msg(team_red_name + " team scores");
+                    add_msg_response(msg.c_str());
+                    if (logger) {
+                        logger->log(ServerLogger::LogTypeTeamRedScored, msg, p);
                     }
+                    std::string team_name = uppercase(team_red_name);
+                    add_team_score_animation(p, team_name + " SCORES");
+                    score.score_red++;
+                    send_team_score();
                 }
-                return true;
-                break;
-
-            case Tile::TileTypeBaseBlue:
-                if (server && p) {
-                    if (p->state.server_state.flags & PlayerServerFlagHasOppositeFlag &&
-                        !(p->state.server_state.flags & PlayerServerFlagTeamRed))
-                    {
-                        /* blue team scores */
-                        p->state.server_state.flags &= ~PlayerServerFlagHasOppositeFlag;
-                        p->state.server_state.score += 3;
-                        return_flag(red_flag, PlaceObjectWithScoredSound);
-                        std::string msg(team_blue_name + " team scores");
-                        add_msg_response(msg.c_str());
-                        if (logger) {
-                            logger->log(ServerLogger::LogTypeTeamBlueScored, msg, p);
-                        }
-                        std::string team_name = uppercase(team_blue_name);
-                        add_team_score_animation(p, team_name + " SCORES");
-                        score.score_blue++;
-                        send_team_score();
+            }
+            break;
+
+        case Tile::TileTypeBaseBlue:
+            if (server) {
+                if (p->state.server_state.flags & PlayerServerFlagHasOppositeFlag &&
+                    !(p->state.server_state.flags & PlayerServerFlagTeamRed))
+                {
+                    /* blue team scores */
+                    p->state.server_state.flags &= ~PlayerServerFlagHasOppositeFlag;
+                    p->state.server_state.score += 3;
+                    return_flag(get_red_flag(), PlaceObjectWithScoredSound);
+                    std::string msg(team_blue_name + " team scores");
+                    add_msg_response(msg.c_str());
+                    if (logger) {
+                        logger->log(ServerLogger::LogTypeTeamBlueScored, msg, p);
                     }
+                    std::string team_name = uppercase(team_blue_name);
+                    add_team_score_animation(p, team_name + " SCORES");
+                    score.score_blue++;
+                    send_team_score();
                 }
-                return true;
-                break;
+            }
+            break;
 
-            default:
-                break;
-        }
+        default:
+            Tournament::touch_tile(p, t);
+            break;
     }
-
-    return Tournament::tile_collision(type, p, last_falling_y_pos, t, killing);
 }
 
 bool TournamentCTF::test_and_drop_flag(Player *p) {
@@ -311,9 +348,9 @@ bool TournamentCTF::test_and_drop_flag(Player *p) {
         if (p->state.server_state.flags & PlayerServerFlagHasOppositeFlag) {
             GameObject *flag = 0;
             if (p->state.server_state.flags & PlayerServerFlagTeamRed) {
-                flag = blue_flag;
+                flag = get_blue_flag();
             } else {
-                flag = red_flag;
+                flag = get_red_flag();
             }
 
             /* drop object */
@@ -328,7 +365,7 @@ bool TournamentCTF::test_and_drop_flag(Player *p) {
             flag->state.accel_x = p->state.client_server_state.accel_x;
             flag->state.accel_y = p->state.client_server_state.accel_y;
 
-            GPlaceObject *gpo = new GPlaceObject;
+            GPlaceObject *gpo = create_response<GPlaceObject>();
             memset(gpo, 0, sizeof(GPlaceObject));
             gpo->id = flag->state.id;
             gpo->flags = PlaceObjectWithDropSound;
@@ -339,7 +376,7 @@ bool TournamentCTF::test_and_drop_flag(Player *p) {
             add_state_response(GPCPlaceObject, sizeof(GPlaceObject), gpo);
 
             /* add message */
-            if (flag == red_flag) {
+            if (flag == get_red_flag()) {
                 std::string msg("the red flag dropped");
                 add_msg_response(msg.c_str());
                 if (logger) {
@@ -363,7 +400,7 @@ void TournamentCTF::return_flag(GameObject *flag, int flags) {
     flag->picked = false;
     flag->state.accel_x = 0.0f;
     flag->state.accel_y = 0.0f;
-    GPlaceObject *gpo = new GPlaceObject;
+    GPlaceObject *gpo = create_response<GPlaceObject>();
     memset(gpo, 0, sizeof(GPlaceObject));
     gpo->id = flag->state.id;
     gpo->flags = PlaceObjectWithAnimation | PlaceObjectResetVelocity | flags;
@@ -385,7 +422,7 @@ bool TournamentCTF::flag_not_at_origin(GameObject *flag) {
 }
 
 void TournamentCTF::send_flag_remaining(GameObject *flag) {
-    GTimeRemaining *remain = new GTimeRemaining;
+    GTimeRemaining *remain = create_response<GTimeRemaining>();
     remain->flags = (flag->object->get_type() == Object::ObjectTypeRedFlag ? 1 : 0);
     remain->remaining = static_cast<pos_t>(flag->spawn_counter);
     remain->to_net();
@@ -393,8 +430,46 @@ void TournamentCTF::send_flag_remaining(GameObject *flag) {
 }
 
 void TournamentCTF::update_wearable_remaining(GTimeRemaining *remain) {
-    GameObject *flag = (remain->flags ? red_flag : blue_flag);
+    GameObject *flag = (remain->flags ? get_red_flag() : get_blue_flag());
     flag->spawn_counter = remain->remaining;
 }
 
 void TournamentCTF::team_fire_point(Player *penem, Team team, int points) { }
+
+void TournamentCTF::get_checkpoint_object(GameObject *obj, GameObject& state) {
+    state = *obj;
+    if ((obj != get_red_flag() && obj != get_blue_flag()) || !obj->picked) {
+        return;
+    }
+
+    /* carriers do not survive a restart, the flag drops as if they left */
+    state.picked = false;
+    state.spawn_counter = static_cast<double>(FlagDropInitialValue);
+    state.state.x = obj->origin_x;
+    state.state.y = obj->origin_y;
+    state.state.accel_x = 0.0f;
+    state.state.accel_y = 0.0f;
+    bool red_carrier = (obj == get_blue_flag());
+    for (Players::iterator it = players.begin(); it != players.end(); it++) {
+        Player *p = *it;
+        if (p->state.server_state.flags & PlayerServerFlagHasOppositeFlag &&
+            ((p->state.server_state.flags & PlayerServerFlagTeamRed) != 0) == red_carrier)
+        {
+            int fx = p->get_characterset()->get_flag_drop_offset_x();
+            int fy = p->get_characterset()->get_flag_drop_offset_y();
+            state.state.x = static_cast<pos_t>(p->state.client_server_state.x) + fx;
+            state.state.y = static_cast<pos_t>(p->state.client_server_state.y) + fy;
+            state.state.accel_x = p->state.client_server_state.accel_x;
+            state.state.accel_y = p->state.client_server_state.accel_y;
+            break;
+        }
+    }
+}
+
+GameObject *TournamentCTF::get_red_flag() {
+    return game_objects.get(red_flag);
+}
+
+GameObject *TournamentCTF::get_blue_flag() {
+    return game_objects.get(blue_flag);
+}
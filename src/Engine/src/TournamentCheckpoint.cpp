@@ -0,0 +1,294 @@
+#include "Tournament.hpp"
+#include "CRC64.hpp"
+
+template <class T> static void hash_value(CRC64& crc, const T& value) {
+    crc.process(reinterpret_cast<const unsigned char *>(&value), sizeof(T));
+}
+
+static void hash_value(CRC64& crc, const std::string& value) {
+    hash_value(crc, value.length());
+    crc.process(reinterpret_cast<const unsigned char *>(value.data()), value.length());
+}
+
+/* what a restarted server needs to continue the match: timers, the map
+   objects, npcs, animations and the data of the game mode. player states
+   are kept by the server. players get new ids when they come back, so
+   owners are cleared as if they had left and carried items are written
+   where they would drop */
+void Tournament::write_checkpoint(Checkpoint& cp) {
+    cp.write_string(tournament_type());
+    cp.write_string(map.get_name());
+    cp.write_u16(static_cast<uint16_t>(game_state.seconds_remaining));
+    cp.write_u64(static_cast<uint64_t>(second_counter));
+    cp.write_bool(game_over);
+    if (has_frogs) {
+        cp.write_double(frog_respawn_counter);
+    }
+    cp.write_u16(static_cast<uint16_t>(animation_id));
+
+    /* objects of the map, spawned ones belonged to players */
+    uint16_t count = 0;
+    for (GameObjects::iterator it = game_objects.begin(); it != game_objects.end(); it++) {
+        if (!it->spawned_object) {
+            count++;
+        }
+    }
+    cp.write_u16(count);
+    for (GameObjects::iterator it = game_objects.begin(); it != game_objects.end(); it++) {
+        if (!it->spawned_object) {
+            GameObject obj;
+            get_checkpoint_object(&*it, obj);
+            cp.write_u16(static_cast<uint16_t>(obj.state.id));
+            cp.write_bool(obj.picked);
+            cp.write_double(obj.spawn_counter);
+            cp.write_double(obj.state.x);
+            cp.write_double(obj.state.y);
+            cp.write_double(obj.state.accel_x);
+            cp.write_double(obj.state.accel_y);
+            cp.write_bool(obj.falling);
+            cp.write_u32(static_cast<uint32_t>(obj.last_falling_y_pos));
+        }
+    }
+
+    /* frogs and other npcs */
+    count = 0;
+    for (SpawnableNPCs::iterator it = spawnable_npcs.begin(); it != spawnable_npcs.end(); it++) {
+        if (!it->delete_me) {
+            count++;
+        }
+    }
+    cp.write_u16(count);
+    for (SpawnableNPCs::iterator it = spawnable_npcs.begin(); it != spawnable_npcs.end(); it++) {
+        SpawnableNPC *npc = &*it;
+        if (!npc->delete_me) {
+            cp.write_string(npc->npc->get_name());
+            cp.write_u16(static_cast<uint16_t>(npc->state.id));
+            cp.write_u8(npc->state.direction);
+            cp.write_u16(npc->state.flags);
+            cp.write_double(npc->state.x);
+            cp.write_double(npc->state.y);
+            cp.write_double(npc->state.accel_x);
+            cp.write_double(npc->state.accel_y);
+            cp.write_u8(static_cast<unsigned char>(npc->icon));
+            cp.write_u32(static_cast<uint32_t>(npc->iconindex));
+            cp.write_double(npc->move_counter);
+            cp.write_bool(npc->in_idle);
+            cp.write_double(npc->idle_counter);
+            cp.write_double(npc->idle_counter_init);
+            cp.write_bool(npc->falling);
+            cp.write_u32(static_cast<uint32_t>(npc->last_falling_y_pos));
+        }
+    }
+
+    /* projectiles, explosions and effects */
+    count = 0;
+    for (GameAnimations::iterator it = game_animations.begin(); it != game_animations.end(); it++) {
+        if (!it->delete_me) {
+            count++;
+        }
+    }
+    cp.write_u16(count);
+    for (GameAnimations::iterator it = game_animations.begin(); it != game_animations.end(); it++) {
+        GameAnimation *gani = &*it;
+        if (!gani->delete_me) {
+            cp.write_string(gani->animation->get_name());
+            cp.write_u16(static_cast<uint16_t>(gani->state.id));
+            cp.write_u16(static_cast<uint16_t>(gani->state.duration));
+            cp.write_double(gani->state.x);
+            cp.write_double(gani->state.y);
+            cp.write_double(gani->state.accel_x);
+            cp.write_double(gani->state.accel_y);
+            cp.write_double(gani->animation_counter);
+            cp.write_u32(static_cast<uint32_t>(gani->index));
+            cp.write_bool(gani->falling);
+            cp.write_u32(static_cast<uint32_t>(gani->last_falling_y_pos));
+        }
+    }
+
+    write_mode_checkpoint(cp);
+}
+
+void Tournament::read_checkpoint(Checkpoint& cp) throw (CheckpointException) {
+    if (cp.read_string() != tournament_type()) {
+        throw CheckpointException("Checkpoint is of another game mode");
+    }
+    if (cp.read_string() != map.get_name()) {
+        throw CheckpointException("Checkpoint is of another map");
+    }
+    game_state.seconds_remaining = static_cast<scounter_t>(cp.read_u16());
+    second_counter = static_cast<ns_t>(cp.read_u64());
+    game_over = cp.read_bool();
+    if (has_frogs) {
+        frog_respawn_counter = cp.read_double();
+    }
+    animation_id = static_cast<identifier_t>(cp.read_u16());
+
+    uint16_t count = cp.read_u16();
+    for (uint16_t i = 0; i < count; i++) {
+        identifier_t id = static_cast<identifier_t>(cp.read_u16());
+        GameObject *obj = 0;
+        for (GameObjects::iterator it = game_objects.begin(); it != game_objects.end(); it++) {
+            if (!it->spawned_object && it->state.id == id) {
+                obj = &*it;
+                break;
+            }
+        }
+        if (!obj) {
+            throw CheckpointException("Checkpoint object not in map");
+        }
+        obj->picked = cp.read_bool();
+        obj->spawn_counter = cp.read_double();
+        obj->state.x = cp.read_double();
+        obj->state.y = cp.read_double();
+        obj->state.accel_x = cp.read_double();
+        obj->state.accel_y = cp.read_double();
+        obj->falling = cp.read_bool();
+        obj->last_falling_y_pos = static_cast<int>(cp.read_u32());
+    }
+
+    /* the checkpoint replaces whatever the fresh match started with */
+    for (SpawnableNPCs::iterator it = spawnable_npcs.begin(); it != spawnable_npcs.end(); it++) {
+        it->delete_me = true;
+    }
+    remove_marked_npcs();
+    for (GameAnimations::iterator it = game_animations.begin(); it != game_animations.end(); it++) {
+        it->delete_me = true;
+    }
+    game_animations.remove_marked();
+
+    try {
+        count = cp.read_u16();
+        for (uint16_t i = 0; i < count; i++) {
+            NPC *resource = resources.get_npc(cp.read_string());
+            SpawnableNPC *npc = spawnable_npcs.create();
+            npc->npc = resource;
+            npc->state.id = static_cast<identifier_t>(cp.read_u16());
+            npc->state.owner = 0;
+            npc->state.direction = cp.read_u8();
+            npc->state.flags = cp.read_u16();
+            npc->state.x = cp.read_double();
+            npc->state.y = cp.read_double();
+            npc->state.accel_x = cp.read_double();
+            npc->state.accel_y = cp.read_double();
+            npc->icon = static_cast<NPCAnimation>(cp.read_u8());
+            npc->iconindex = static_cast<int>(cp.read_u32());
+            npc->init_owner = 0;
+            npc->ignore_owner_counter = 0.0f;
+            npc->move_counter = cp.read_double();
+            npc->in_idle = cp.read_bool();
+            npc->idle_counter = cp.read_double();
+            npc->idle_counter_init = cp.read_double();
+            npc->falling = cp.read_bool();
+            npc->last_falling_y_pos = static_cast<int>(cp.read_u32());
+        }
+
+        count = cp.read_u16();
+        for (uint16_t i = 0; i < count; i++) {
+            Animation *resource = resources.get_animation(cp.read_string());
+            GameAnimation *gani = game_animations.create();
+            gani->animation = resource;
+            gani->state.id = static_cast<identifier_t>(cp.read_u16());
+            gani->state.duration = static_cast<scounter_t>(cp.read_u16());
+            gani->state.owner = 0;
+            gani->state.x = cp.read_double();
+            gani->state.y = cp.read_double();
+            gani->state.accel_x = cp.read_double();
+            gani->state.accel_y = cp.read_double();
+            gani->animation_counter = cp.read_double();
+            gani->index = static_cast<int>(cp.read_u32());
+            gani->falling = cp.read_bool();
+            gani->last_falling_y_pos = static_cast<int>(cp.read_u32());
+        }
+    } catch (const ResourcesException& e) {
+        throw CheckpointException(std::string("Checkpoint resource missing: ") + e.what());
+    }
+
+    read_mode_checkpoint(cp);
+}
+
+/* compares a match with its restored checkpoint. it walks the live
+   objects, npcs and animations instead of the checkpoint, so state the
+   checkpoint misses shows up as a difference. players and owners are
+   left out, their ids are not kept over a restart */
+uint64_t Tournament::get_state_hash() {
+    CRC64 crc;
+    hash_value(crc, game_state.seconds_remaining);
+    hash_value(crc, second_counter);
+    hash_value(crc, game_over);
+    if (has_frogs) {
+        hash_value(crc, frog_respawn_counter);
+    }
+    hash_value(crc, animation_id);
+
+    for (GameObjects::iterator it = game_objects.begin(); it != game_objects.end(); it++) {
+        if (!it->spawned_object) {
+            GameObject obj;
+            get_checkpoint_object(&*it, obj);
+            hash_value(crc, obj.state.id);
+            hash_value(crc, obj.picked);
+            hash_value(crc, obj.spawn_counter);
+            hash_value(crc, obj.state.x);
+            hash_value(crc, obj.state.y);
+            hash_value(crc, obj.state.accel_x);
+            hash_value(crc, obj.state.accel_y);
+            hash_value(crc, obj.falling);
+            hash_value(crc, obj.last_falling_y_pos);
+        }
+    }
+
+    for (SpawnableNPCs::iterator it = spawnable_npcs.begin(); it != spawnable_npcs.end(); it++) {
+        SpawnableNPC *npc = &*it;
+        if (!npc->delete_me) {
+            hash_value(crc, npc->npc->get_name());
+            hash_value(crc, npc->state.id);
+            hash_value(crc, npc->state.direction);
+            hash_value(crc, npc->state.flags);
+            hash_value(crc, npc->state.x);
+            hash_value(crc, npc->state.y);
+            hash_value(crc, npc->state.accel_x);
+            hash_value(crc, npc->state.accel_y);
+            hash_value(crc, npc->icon);
+            hash_value(crc, npc->iconindex);
+            hash_value(crc, npc->move_counter);
+            hash_value(crc, npc->in_idle);
+            hash_value(crc, npc->idle_counter);
+            hash_value(crc, npc->idle_counter_init);
+            hash_value(crc, npc->falling);
+            hash_value(crc, npc->last_falling_y_pos);
+        }
+    }
+
+    for (GameAnimations::iterator it = game_animations.begin(); it != game_animations.end(); it++) {
+        GameAnimation *gani = &*it;
+        if (!gani->delete_me) {
+            hash_value(crc, gani->animation->get_name());
+            hash_value(crc, gani->state.id);
+            hash_value(crc, gani->state.duration);
+            hash_value(crc, gani->state.x);
+            hash_value(crc, gani->state.y);
+            hash_value(crc, gani->state.accel_x);
+            hash_value(crc, gani->state.accel_y);
+            hash_value(crc, gani->animation_counter);
+            hash_value(crc, gani->index);
+            hash_value(crc, gani->falling);
+            hash_value(crc, gani->last_falling_y_pos);
+        }
+    }
+
+    /* scores and times are small tables of their own */
+    Checkpoint mode;
+    write_mode_checkpoint(mode);
+    if (mode.get_size()) {
+        crc.process(mode.get_data(), mode.get_size());
+    }
+
+    return crc.get_crc();
+}
+
+void Tournament::get_checkpoint_object(GameObject *obj, GameObject& state) {
+    state = *obj;
+}
+
+void Tournament::write_mode_checkpoint(Checkpoint& cp) { }
+
+void Tournament::read_mode_checkpoint(Checkpoint& cp) throw (CheckpointException) { }
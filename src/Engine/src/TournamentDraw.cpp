@@ -201,7 +201,7 @@ void Tournament::draw_animations(bool background) {
     for (GameAnimations::iterator it = game_animations.begin();
         it != game_animations.end(); it++)
     {
-        GameAnimation *gani = *it;
+        GameAnimation *gani = &*it;
         if (gani->animation->is_in_background() == background) {
             int x = static_cast<int>(round(gani->state.x));
             int y = static_cast<int>(round(gani->state.y));
@@ -227,7 +227,7 @@ void Tournament::draw_objects() {
     for (GameObjects::iterator it = game_objects.begin();
         it != game_objects.end(); it++)
     {
-        GameObject *obj = *it;
+        GameObject *obj = &*it;
         if (!obj->picked) {
             Object::ObjectType type = obj->object->get_type();
             if (type != Object::ObjectTypeSpawnPointRed &&
@@ -447,7 +447,7 @@ void Tournament::draw_npcs() {
     for (SpawnableNPCs::iterator it = spawnable_npcs.begin();
         it != spawnable_npcs.end(); it++)
     {
-        SpawnableNPC *npc = *it;
+        SpawnableNPC *npc = &*it;
 
         Tile *t = npc->npc->get_tile(static_cast<Direction>(npc->state.direction),
             npc->icon);
@@ -10,13 +10,20 @@
 
 TournamentFactory::TournamentFactory(Resources& resources, Subsystem& subsystem, Gui *gui)
     throw (TournamentFactoryException)
-    : resources(resources), subsystem(subsystem), gui(gui), tournament_id(0) { }
+    : resources(resources), subsystem(subsystem), gui(gui), tournament_id(0),
+      resource_ids(resources), jobs(0), random(0) { }
 
 TournamentFactory::~TournamentFactory() { }
 
 Tournament *TournamentFactory::create_tournament(const MapConfiguration& config,
-    bool server, bool warmup, Players& players, ServerLogger *logger) throw (Exception)
+    bool server, bool warmup, Players& players, ServerLogger *logger,
+    MapPreloader *preloaded) throw (Exception)
 {
+    /* a preloaded map only helps if the rotation was predicted right */
+    if (preloaded && preloaded->get_map_name() != config.map_name) {
+        preloaded = 0;
+    }
+
     int duration = (warmup ? config.warmup_in_seconds : config.duration * 60);
     Tournament *tournament = 0;
 
@@ -52,6 +59,22 @@ Tournament *TournamentFactory::create_tournament(const MapConfiguration& config,
             break;
     }
 
+    if (tournament) {
+        tournament->set_resource_ids(&resource_ids);
+        tournament->set_job_system(jobs);
+        if (random) {
+            tournament->set_random(random);
+        }
+        if (!server) {
+            try {
+                tournament->create_lightmap(preloaded);
+            } catch (...) {
+                delete tournament;
+                throw;
+            }
+        }
+    }
+
     if (tournament && server) {
         tournament_id++;
         if (logger) {
@@ -75,4 +98,15 @@ void TournamentFactory::set_tournament_server_flags(Properties& properties, Tour
         bool state = (atoi(properties.get_value("friendly_fire_alarm").c_str()) ? true : false);
         tournament->set_friendly_fire_alarm(state);
     }
-}
\ No newline at end of file
+}
+ResourceIds& TournamentFactory::get_resource_ids() {
+    return resource_ids;
+}
+
+void TournamentFactory::set_job_system(JobSystem *jobs) {
+    this->jobs = jobs;
+}
+
+void TournamentFactory::set_random(Random *random) {
+    this->random = random;
+}
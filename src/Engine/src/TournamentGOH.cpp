@@ -11,10 +11,13 @@ TournamentGOH::TournamentGOH(Resources& resources, Subsystem& subsystem, Gui *gu
     : TournamentTeam(resources, subsystem, gui, logger, game_file, server, map_name,
       players, duration, warmup),
       first_player_on_hill(0), addon_player(0), hill_counter(0),
-      crested_sound(properties.get_value("crested_sound")),
-      scored_sound(properties.get_value("scored_sound")),
-      leaved_sound(properties.get_value("leaved_sound"))
+      crested_sound(lookup_sound(properties.get_value("crested_sound"))),
+      scored_sound(lookup_sound(properties.get_value("scored_sound"))),
+      leaved_sound(lookup_sound(properties.get_value("leaved_sound"))),
+      has_hill(false), hill_x(0.0f), hill_y(0.0f)
 {
+    has_hill = find_tile_center(Tile::TileTypeHillZone, hill_x, hill_y);
+
     /* setup tournament icon */
     tournament_icon = resources.get_icon("hud_goh");
 }
@@ -29,6 +32,13 @@ const char *TournamentGOH::tournament_type() {
 
 void TournamentGOH::team_fire_point(Player *penem, Team team, int points) { }
 
+bool TournamentGOH::get_bot_goal(Player *p, double& x, double& y) {
+    x = hill_x;
+    y = hill_y;
+
+    return has_hill;
+}
+
 void TournamentGOH::score_transport_raw(void *data) {
     GHillCounter *hc = reinterpret_cast<GHillCounter *>(data);
     hc->from_net();
@@ -66,7 +76,7 @@ void TournamentGOH::subintegrate(ns_t ns) {
         if (!in_hill_zone) {
             if (first_player_on_hill) {
                 send_hill_counter(0);
-                add_sound_response(leaved_sound.c_str());
+                add_sound_response(leaved_sound);
             }
             first_player_on_hill = 0;
         } else {
@@ -74,7 +84,7 @@ void TournamentGOH::subintegrate(ns_t ns) {
                 first_player_on_hill = in_hill_zone;
                 hill_counter = HillCounterMax;
                 send_hill_counter(static_cast<pos_t>(hill_counter));
-                add_sound_response(crested_sound.c_str());
+                add_sound_response(crested_sound);
             } else {
                 hill_counter -= period_f;
                 if (!(static_cast<int>(hill_counter) % 25)) {
@@ -109,7 +119,7 @@ void TournamentGOH::subintegrate(ns_t ns) {
                             logger->log(ServerLogger::LogTypeTeamBlueScored, msg, first_player_on_hill);
                         }
                     }
-                    add_sound_response(scored_sound.c_str());
+                    add_sound_response(scored_sound);
                     send_team_score();
                     first_player_on_hill = 0;
                 }
@@ -147,7 +157,8 @@ GenericData *TournamentGOH::create_generic_data() {
     GenericData *gd = 0;
 
     if (first_player_on_hill) {
-        GHillCounter *hc = create_hill_counter(static_cast<pos_t>(hill_counter));
+        GHillCounter *hc = new GHillCounter;
+        setup_hill_counter(hc, static_cast<pos_t>(hill_counter));
         gd = new GenericData(hc, GHillCounterLen);
     }
 
@@ -164,8 +175,8 @@ void TournamentGOH::generic_data_delivery(void *data) {
 }
 
 bool TournamentGOH::player_is_in_hill_zone(Player *p) {
-    static int tilex;
-    static int tiley;
+    int tilex;
+    int tiley;
 
     CollisionBox colbox = p->get_characterset()->get_colbox();
     colbox.x += static_cast<int>(p->state.client_server_state.x);
@@ -235,16 +246,14 @@ void TournamentGOH::test_and_remove_player_from_hill(Player *p) {
 
 void TournamentGOH::send_hill_counter(pos_t value) {
     if (first_player_on_hill) {
-        GHillCounter *hc = create_hill_counter(value);
+        GHillCounter *hc = create_response<GHillCounter>();
+        setup_hill_counter(hc, value);
         add_state_response(GPCScoreTransportRaw, GHillCounterLen, hc);
     }
 }
 
-GHillCounter *TournamentGOH::create_hill_counter(pos_t value) {
-    GHillCounter *hc = new GHillCounter;
+void TournamentGOH::setup_hill_counter(GHillCounter *hc, pos_t value) {
     hc->id = first_player_on_hill->state.id;
     hc->counter = value;
     hc->to_net();
-
-    return hc;
 }
\ No newline at end of file
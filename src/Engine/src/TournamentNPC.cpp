@@ -3,14 +3,33 @@
 #include <cstdlib>
 #include <algorithm>
 
+class Tournament::NPCJob : public JobSystem::Job {
+private:
+    NPCJob(const NPCJob&);
+    NPCJob& operator=(const NPCJob&);
+
+public:
+    NPCJob(Tournament& tournament, double period_f)
+        : tournament(tournament), period_f(period_f) { }
+
+    virtual void execute(size_t index) {
+        tournament.integrate_npc(tournament.npc_steps[index], period_f,
+            &tournament.spawnable_npcs[index]);
+    }
+
+private:
+    Tournament& tournament;
+    double period_f;
+};
+
 void Tournament::reset_frog_spawn_counter() {
-    frog_respawn_counter = static_cast<double>(rand() % frog_spawn_init + frog_spawn_init);
+    frog_respawn_counter = static_cast<double>(random->next() % frog_spawn_init + frog_spawn_init);
 }
 
 void Tournament::add_spawnable_npc(GSpawnNPC *snpc) {
-    NPC *npc = resources.get_npc(snpc->npc_name);
+    NPC *npc = resource_ids->get_npc(snpc->npc_id);
 
-    SpawnableNPC *nnpc = new SpawnableNPC;
+    SpawnableNPC *nnpc = spawnable_npcs.create();
     nnpc->npc = npc;
     nnpc->state.id = snpc->id;
     nnpc->state.owner = snpc->owner;
@@ -24,13 +43,12 @@ void Tournament::add_spawnable_npc(GSpawnNPC *snpc) {
     nnpc->iconindex = 0;
     nnpc->init_owner = snpc->owner;
     nnpc->ignore_owner_counter = npc->get_ignore_owner_counter();
-    nnpc->move_counter = static_cast<double>(npc->get_move_init_randomized());
-    spawnable_npcs.push_back(nnpc);
+    nnpc->move_counter = static_cast<double>(npc->get_move_init_randomized(*random));
 
     if (!server) {
         try {
-            if (snpc->sound_name[0]) {
-                subsystem.play_sound(resources.get_sound(snpc->sound_name), 0);
+            if (snpc->sound_id != ResourceIdNone) {
+                subsystem.play_sound(resource_ids->get_sound(snpc->sound_id), 0);
             }
         } catch (const Exception& e) {
             subsystem << e.what();
@@ -42,23 +60,21 @@ void Tournament::remove_spawnable_npc(GRemoveNPC *rnpc) {
     for (SpawnableNPCs::iterator it = spawnable_npcs.begin();
         it != spawnable_npcs.end(); it++)
     {
-        SpawnableNPC *npc = *it;
+        SpawnableNPC *npc = &*it;
         if (npc->state.id == rnpc->id) {
-            spawnable_npcs.erase(it);
-            delete npc;
+            npc->delete_me = true;
+            remove_marked_npcs();
             break;
         }
     }
 }
 
 void Tournament::remove_marked_npcs() {
-    spawnable_npcs.erase(std::remove_if(spawnable_npcs.begin(),
-        spawnable_npcs.end(), erase_element<SpawnableNPC>),
-        spawnable_npcs.end());
+    spawnable_npcs.remove_marked();
 }
 
 void Tournament::send_remove_npc(SpawnableNPC *npc) {
-    GRemoveNPC *rnpc = new GRemoveNPC;
+    GRemoveNPC *rnpc = create_response<GRemoveNPC>();
     rnpc->id = npc->state.id;
     rnpc->to_net();
     add_state_response(GPCRemoveNPC, GRemoveNPCLen, rnpc);
@@ -67,17 +83,16 @@ void Tournament::send_remove_npc(SpawnableNPC *npc) {
 
 void Tournament::add_npc_remove_animation(SpawnableNPC *npc) {
     const std::string& animation_name = npc->npc->get_value("kill_animation");
-    const std::string& sound_name = npc->npc->get_value("kill_sound");
     if (animation_name.length()) {
         try {
             Animation *ani = resources.get_animation(animation_name);
             TileGraphic *tg = npc->npc->get_tile(DirectionLeft, NPCAnimationStanding)->get_tilegraphic();
             int width = tg->get_width();
             int height = tg->get_height();
-            GAnimation *sgani = new GAnimation;
+            GAnimation *sgani = create_response<GAnimation>();
             memset(sgani, 0, GAnimationLen);
-            strncpy(sgani->animation_name, ani->get_name().c_str(), NameLength - 1);
-            strncpy(sgani->sound_name, sound_name.c_str(), NameLength - 1);
+            sgani->animation_id = resource_ids->get_id(ani);
+            sgani->sound_id = resource_ids->get_id(npc->npc->get_kill_sound());
             sgani->id = npc->state.id;
             sgani->duration = ani->get_duration();
             TileGraphic *anitg = ani->get_tile()->get_tilegraphic();
@@ -101,7 +116,7 @@ void Tournament::spawn_frog() {
         for (GameObjects::iterator it = game_objects.begin();
             it != game_objects.end(); it++)
         {
-            GameObject *gobj = *it;
+            GameObject *gobj = &*it;
             if (gobj->object->get_type() == Object::ObjectTypeFrog) {
                 return;
             }
@@ -110,17 +125,17 @@ void Tournament::spawn_frog() {
         /* spawn object */
         try {
             Object *obj = resources.get_object("frog");
-            int index = rand() % sz;
-            GameObject *gobj = frog_spawn_points[index];
+            int index = random->next() % sz;
+            GameObject *gobj = game_objects.get(frog_spawn_points[index]);
 
             identifier_t id = get_free_object_id();
             spawn_object(obj, id, gobj->origin_x, gobj->origin_y, 0);
 
-            GSpawnObject *spwn = new GSpawnObject;
+            GSpawnObject *spwn = create_response<GSpawnObject>();
             memset(spwn, 0, sizeof(GSpawnObject));
             spwn->flags = PlaceObjectWithAnimation | PlaceObjectWithSpawnSound;
             spwn->id = id;
-            strncpy(spwn->object_name, obj->get_name().c_str(), NameLength - 1);
+            spwn->object_id = resource_ids->get_id(obj);
             spwn->x = static_cast<pos_t>(gobj->origin_x);
             spwn->y = static_cast<pos_t>(gobj->origin_y);
             spwn->to_net();
@@ -138,7 +153,7 @@ identifier_t Tournament::get_free_object_id() {
         found = false;
         size_t sz = game_objects.size();
         for (size_t i = 0; i < sz; i++) {
-            GameObject *obj = game_objects[i];
+            GameObject *obj = &game_objects[i];
             if (obj->state.id == id) {
                 found = true;
                 break;
@@ -159,7 +174,7 @@ identifier_t Tournament::get_free_npc_id() {
         found = false;
         size_t sz = spawnable_npcs.size();
         for (size_t i = 0; i < sz; i++) {
-            SpawnableNPC *npc = spawnable_npcs[i];
+            SpawnableNPC *npc = &spawnable_npcs[i];
             if (npc->state.id == id) {
                 found = true;
                 break;
@@ -173,27 +188,36 @@ identifier_t Tournament::get_free_npc_id() {
     return id;
 }
 
-void Tournament::update_npc_states(double period_f) {
-    for (SpawnableNPCs::iterator it = spawnable_npcs.begin();
-        it != spawnable_npcs.end(); it++)
-    {
-        SpawnableNPC *npc = *it;
-
-        /* update physics */
-        TileGraphic *tg = npc->npc->get_tile(DirectionLeft, NPCAnimationStanding)->get_tilegraphic();
-        int width = tg->get_width();
-        int height = tg->get_height();
+void Tournament::integrate_npc(BodyStep& step, double period_f, SpawnableNPC *npc) {
+    TileGraphic *tg = npc->npc->get_tile(DirectionLeft, NPCAnimationStanding)->get_tilegraphic();
+    int width = tg->get_width();
+    int height = tg->get_height();
+
+    const CollisionBox& colbox = npc->npc->get_colbox();
+
+    step.killing = false;
+    double y = npc->state.y - height;
+    step.collision = render_physics(period_f, false, 0, 0.0f, 0,
+        npc->npc->get_springiness_x(), 0.0f, colbox,
+        npc->state.x, y, npc->state.accel_x, npc->state.accel_y,
+        width, height, npc->npc->get_friction_factor(), 0, npc->falling,
+        npc->last_falling_y_pos, &step.killing, npc->npc->get_name());
+    npc->state.y = y + height;
+}
 
-        const CollisionBox& colbox = npc->npc->get_colbox();
+void Tournament::update_npc_states(double period_f) {
+    /* update physics, only the npc itself is touched */
+    size_t nnpcs = spawnable_npcs.size();
+    if (npc_steps.size() < nnpcs) {
+        npc_steps.resize(nnpcs);
+    }
+    NPCJob job(*this, period_f);
+    run_jobs(job, nnpcs);
 
-        bool killing = false;
-        double y = npc->state.y - height;
-        bool col = render_physics(period_f, false, 0, 0.0f, 0,
-            npc->npc->get_springiness_x(), 0.0f, colbox,
-            npc->state.x, y, npc->state.accel_x, npc->state.accel_y,
-            width, height, npc->npc->get_friction_factor(), false, npc->falling,
-            npc->last_falling_y_pos, &killing, npc->npc->get_name());
-        npc->state.y = y + height;
+    for (size_t i = 0; i < nnpcs; i++) {
+        SpawnableNPC *npc = &spawnable_npcs[i];
+        bool col = npc_steps[i].collision;
+        bool killing = npc_steps[i].killing;
 
         /* update ownership */
         if (server && npc->init_owner) {
@@ -208,9 +232,9 @@ void Tournament::update_npc_states(double period_f) {
         if (!npc->in_idle) {
             npc->move_counter -= period_f;
             if (npc->move_counter <= 0.0f) {
-                npc->move_counter = static_cast<double>(npc->npc->get_move_init_randomized());
+                npc->move_counter = static_cast<double>(npc->npc->get_move_init_randomized(*random));
 
-                int action = rand() % 5;
+                int action = random->next() % 5;
 
                 switch (action) {
                     case 0:
@@ -219,8 +243,8 @@ void Tournament::update_npc_states(double period_f) {
                         /* jump */
                         if (server) {
                             if (!npc->falling) {
-                                npc->state.accel_y = -npc->npc->get_jump_y_impulse_randomized();
-                                npc->state.accel_x = npc->npc->get_jump_x_impulse_randomized() *
+                                npc->state.accel_y = -npc->npc->get_jump_y_impulse_randomized(*random);
+                                npc->state.accel_x = npc->npc->get_jump_x_impulse_randomized(*random) *
                                     (static_cast<Direction>(npc->state.direction) == DirectionLeft ? -1 : 1);
                             }
                         }
@@ -231,7 +255,7 @@ void Tournament::update_npc_states(double period_f) {
                     {
                         /* change direction */
                         if (server && !col && !npc->falling) {
-                            npc->state.direction = static_cast<unsigned char>(rand() % 2 ? DirectionLeft : DirectionRight);
+                            npc->state.direction = static_cast<unsigned char>(random->next() % 2 ? DirectionLeft : DirectionRight);
                         }
                         break;
                     }
@@ -349,10 +373,10 @@ void Tournament::player_npc_collision(Player *p, SpawnableNPC *npc) {
         const std::string& explosion_animation = npc->npc->get_value("explosion_animation");
         if (explosion_animation.length()) {
             Animation *ani = resources.get_animation(explosion_animation);
-            GAnimation *sgani = new GAnimation;
+            GAnimation *sgani = create_response<GAnimation>();
             memset(sgani, 0, GAnimationLen);
-            strncpy(sgani->animation_name, ani->get_name().c_str(), NameLength - 1);
-            strncpy(sgani->sound_name, ani->get_value("sound_name").c_str(), NameLength - 1);
+            sgani->animation_id = resource_ids->get_id(ani);
+            sgani->sound_id = resource_ids->get_id(ani->get_sound());
             sgani->id = npc->state.id;
             sgani->duration = ani->get_duration();
             sgani->x = npc->state.x + ani->get_x_offset();
@@ -4,15 +4,140 @@
 #include <algorithm>
 
 static double bump_sound_velocity = 0.35f;
+static const double SweepNever = 1.0e30;
+
+/* the interval of the sweep in which the moving span [lo, hi) overlaps
+   the cell span [cell_lo, cell_hi), false if they never overlap */
+static bool sweep_interval(double lo, double hi, double cell_lo, double cell_hi,
+    double d, double& t0, double& t1)
+{
+    if (d > 0.0f) {
+        t0 = (cell_lo - hi) / d;
+        t1 = (cell_hi - lo) / d;
+    } else if (d < 0.0f) {
+        t0 = (cell_hi - lo) / d;
+        t1 = (cell_lo - hi) / d;
+    } else {
+        if (hi <= cell_lo || lo >= cell_hi) {
+            return false;
+        }
+        t0 = -SweepNever;
+        t1 = SweepNever;
+    }
+
+    return true;
+}
+
+bool Tournament::sweep_box(TileProbe& probe, TestType falling_type,
+    int last_falling_y_pos, double left, double top, double right, double bottom,
+    double& dx, double& dy, bool *killing)
+{
+    /* moves the box [left, right) x [top, bottom) along dx, dy to the time
+       of impact with the first blocking tile, the axis entered last is the
+       blocked one, the rest of the movement slides along the other axis.
+       tiles overlapped before the move and the contact itself are left to
+       the regular corner tests */
+    bool clipped = false;
+    double restx = dx;
+    double resty = dy;
+    dx = 0.0f;
+    dy = 0.0f;
+
+    for (int pass = 0; pass < 2 && (restx != 0.0f || resty != 0.0f); pass++) {
+        double l = left + dx;
+        double t = top + dy;
+        double r = right + dx;
+        double b = bottom + dy;
+
+        int cx0 = static_cast<int>(floor(std::min(l, l + restx) / tile_width));
+        int cx1 = static_cast<int>(ceil(std::max(r, r + restx) / tile_width)) - 1;
+        int cy0 = static_cast<int>(floor(std::min(t, t + resty) / tile_height));
+        int cy1 = static_cast<int>(ceil(std::max(b, b + resty) / tile_height)) - 1;
+        cx0 = std::max(cx0, 0);
+        cy0 = std::max(cy0, 0);
+        cx1 = std::min(cx1, map_width - 1);
+        cy1 = std::min(cy1, map_height - 1);
+
+        double impact = 1.0f;
+        bool horizontal = false;
+        bool hit_killing = false;
+        double cell_x = 0.0f;
+        double cell_y = 0.0f;
+        for (int cy = cy0; cy <= cy1; cy++) {
+            for (int cx = cx0; cx <= cx1; cx++) {
+                int index = map_array[cy][cx];
+                if (index < 0) {
+                    continue;
+                }
+
+                double tx0, tx1, ty0, ty1;
+                if (!sweep_interval(l, r, cx * tile_width, (cx + 1) * tile_width, restx, tx0, tx1) ||
+                    !sweep_interval(t, b, cy * tile_height, (cy + 1) * tile_height, resty, ty0, ty1))
+                {
+                    continue;
+                }
+                double t0 = std::max(tx0, ty0);
+                double t1 = std::min(tx1, ty1);
+                if (t0 < 0.0f || t0 >= t1 || t0 >= impact) {
+                    continue;
+                }
+
+                /* falling only tiles are entered from above only */
+                bool entered_horizontally = (tx0 > ty0);
+                TestType type = ((!entered_horizontally && resty > 0.0f) ? falling_type : TestTypeNormal);
+                probe.tilex = cx;
+                probe.tiley = cy;
+                bool kills = false;
+                bool blocks = tile_collision(type, probe, last_falling_y_pos,
+                    tileset->get_tile(index), (killing ? &kills : 0));
+                if (blocks || kills) {
+                    impact = t0;
+                    horizontal = entered_horizontally;
+                    hit_killing = kills;
+                    cell_x = (restx > 0.0f ? cx * tile_width : (cx + 1) * tile_width);
+                    cell_y = (resty > 0.0f ? cy * tile_height : (cy + 1) * tile_height);
+                }
+            }
+        }
+
+        if (impact >= 1.0f) {
+            dx += restx;
+            dy += resty;
+            break;
+        }
+
+        /* exactly at the contact on the blocked axis */
+        clipped = true;
+        if (horizontal) {
+            dx += (restx > 0.0f ? cell_x - r : cell_x - l);
+            dy += resty * impact;
+            restx = 0.0f;
+            resty *= (1.0f - impact);
+        } else {
+            dx += restx * impact;
+            dy += (resty > 0.0f ? cell_y - b : cell_y - t);
+            restx *= (1.0f - impact);
+            resty = 0.0f;
+        }
+
+        if (hit_killing) {
+            *killing = true;
+            break;
+        }
+    }
+
+    return clipped;
+}
 
 bool Tournament::render_physics(double period_f, bool projectile, int damage,
     double recoil, identifier_t owner, double springiness_x, double springiness_y,
     const CollisionBox& colbox, double& x, double& y, double& accel_x,
     double& accel_y, int width, int height, double friction_factor,
-    bool play_bump, bool& falling, int& last_falling_y_pos,
+    int *bumps, bool& falling, int& last_falling_y_pos,
     bool *killing, const std::string& weapon)
 {
     bool is_collision = false;
+    TileProbe probe;
 
     /* gravity */
     if (!projectile) {
@@ -38,6 +163,18 @@ bool Tournament::render_physics(double period_f, bool projectile, int damage,
         is_collision = true;
     }
 
+    /* swept tile collision detection along the movement vector */
+    bool swept_killing = false;
+    double dx = newx - x;
+    double dy = newy - y;
+    if (sweep_box(probe, TestTypeFalling, last_falling_y_pos, x + colbox.x,
+        y + height - colbox.y - colbox.height, x + colbox.x + colbox.width,
+        y + height - colbox.y, dx, dy, (killing ? &swept_killing : 0)))
+    {
+        newx = x + dx;
+        newy = y + dy;
+    }
+
     /* tile collision detection */
     bool bailout;
     int colmax;
@@ -50,13 +187,13 @@ bool Tournament::render_physics(double period_f, bool projectile, int damage,
             bailout = false;
             colmax = ((colbox.height - 1) / tile_height) + 1;
             for (int i = 0; i < colmax; i++) {
-                if (collide_with_tile(TestTypeNormal, 0, last_falling_y_pos,
+                if (collide_with_tile(probe, TestTypeNormal, 0, last_falling_y_pos,
                     newx + colbox.x, y + height - colbox.y - colbox.height +
                     (i * tile_height), 0, killing))
                 {
-                    newx = (tilex + 1) * tile_width - colbox.x;
-                    if (accel_x < -bump_sound_velocity && play_bump) {
-                        play_ground_bump_sound();
+                    newx = (probe.tilex + 1) * tile_width - colbox.x;
+                    if (accel_x < -bump_sound_velocity && bumps) {
+                        (*bumps)++;
                     }
                     accel_x = -accel_x * springiness_x;
                     is_collision = true;
@@ -69,12 +206,12 @@ bool Tournament::render_physics(double period_f, bool projectile, int damage,
             }
 
             /* left lower */
-            if (collide_with_tile(TestTypeNormal, 0, last_falling_y_pos,
+            if (collide_with_tile(probe, TestTypeNormal, 0, last_falling_y_pos,
                 newx + colbox.x, y + height - colbox.y - 1.0f, 0, killing))
             {
-                newx = (tilex + 1) * tile_width - colbox.x;
-                if (accel_x < -bump_sound_velocity && play_bump) {
-                    play_ground_bump_sound();
+                newx = (probe.tilex + 1) * tile_width - colbox.x;
+                if (accel_x < -bump_sound_velocity && bumps) {
+                    (*bumps)++;
                 }
                 accel_x = -accel_x * springiness_x;
                 is_collision = true;
@@ -88,13 +225,13 @@ bool Tournament::render_physics(double period_f, bool projectile, int damage,
             bailout = false;
             colmax = ((colbox.height - 1) / tile_height) + 1;
             for (int i = 0; i < colmax; i++) {
-                if (collide_with_tile(TestTypeNormal, 0, last_falling_y_pos,
+                if (collide_with_tile(probe, TestTypeNormal, 0, last_falling_y_pos,
                     newx + colbox.width + colbox.x, y + height - colbox.height -
                     colbox.y + (i * tile_height), 0, killing))
                 {
-                    newx = tilex * tile_width - colbox.width - colbox.x;
-                    if (accel_x > bump_sound_velocity && play_bump) {
-                        play_ground_bump_sound();
+                    newx = probe.tilex * tile_width - colbox.width - colbox.x;
+                    if (accel_x > bump_sound_velocity && bumps) {
+                        (*bumps)++;
                     }
                     accel_x = -accel_x * springiness_x;
                     is_collision = true;
@@ -107,12 +244,12 @@ bool Tournament::render_physics(double period_f, bool projectile, int damage,
             }
 
             /* right lower */
-            if (collide_with_tile(TestTypeNormal, 0, last_falling_y_pos,
+            if (collide_with_tile(probe, TestTypeNormal, 0, last_falling_y_pos,
                 newx + colbox.width + colbox.x, y + width - colbox.y - 1.0f, 0, killing))
             {
-                newx = tilex * tile_width - colbox.width - colbox.x;
-                if (accel_x > bump_sound_velocity && play_bump) {
-                    play_ground_bump_sound();
+                newx = probe.tilex * tile_width - colbox.width - colbox.x;
+                if (accel_x > bump_sound_velocity && bumps) {
+                    (*bumps)++;
                 }
                 accel_x = -accel_x * springiness_x;
                 is_collision = true;
@@ -136,13 +273,13 @@ bool Tournament::render_physics(double period_f, bool projectile, int damage,
             bailout = false;
             colmax = ((colbox.width - 1) / tile_width) + 1;
             for (int i = 0; i < colmax; i++) {
-                if (collide_with_tile(TestTypeNormal, 0, last_falling_y_pos,
+                if (collide_with_tile(probe, TestTypeNormal, 0, last_falling_y_pos,
                     x + colbox.x + (i * tile_width), newy + height - colbox.y -
                     colbox.height, 0, killing))
                 {
-                    newy = (tiley + 1) * tile_height + colbox.y + colbox.height - height;
-                    if (accel_y < -bump_sound_velocity && play_bump) {
-                        play_ground_bump_sound();
+                    newy = (probe.tiley + 1) * tile_height + colbox.y + colbox.height - height;
+                    if (accel_y < -bump_sound_velocity && bumps) {
+                        (*bumps)++;
                     }
                     accel_y = 0.0f;
                     is_collision = true;
@@ -156,13 +293,13 @@ bool Tournament::render_physics(double period_f, bool projectile, int damage,
             }
 
             /* top edge right point */
-            if (collide_with_tile(TestTypeNormal, 0, last_falling_y_pos,
+            if (collide_with_tile(probe, TestTypeNormal, 0, last_falling_y_pos,
                 x + colbox.x + colbox.width - 1.0f, newy + height - colbox.y -
                 colbox.height, 0, killing))
             {
-                newy = (tiley + 1) * tile_height + colbox.y + colbox.height - height;
-                if (accel_y < -bump_sound_velocity && play_bump) {
-                    play_ground_bump_sound();
+                newy = (probe.tiley + 1) * tile_height + colbox.y + colbox.height - height;
+                if (accel_y < -bump_sound_velocity && bumps) {
+                    (*bumps)++;
                 }
                 accel_y = 0.0f;
                 is_collision = true;
@@ -178,14 +315,14 @@ bool Tournament::render_physics(double period_f, bool projectile, int damage,
             colmax = ((colbox.width - 1) / tile_width) + 1;
             for (int i = 0; i < colmax; i++) {
                 double tile_friction = 0.0f;
-                if (collide_with_tile(TestTypeFalling, 0, last_falling_y_pos,
+                if (collide_with_tile(probe, TestTypeFalling, 0, last_falling_y_pos,
                     x + colbox.x + (i * tile_width), newy + height - colbox.y,
                     &tile_friction, killing))
                 {
                     if (!found) {
-                        newy = tiley * tile_height + colbox.y - height;
-                        if (accel_y > bump_sound_velocity && play_bump) {
-                            play_ground_bump_sound();
+                        newy = probe.tiley * tile_height + colbox.y - height;
+                        if (accel_y > bump_sound_velocity && bumps) {
+                            (*bumps)++;
                         }
                         accel_y = -accel_y * springiness_y;
                         is_collision = true;
@@ -200,14 +337,14 @@ bool Tournament::render_physics(double period_f, bool projectile, int damage,
 
             /* bottom edge right point */
             double tile_friction = 0.0f;
-            if (collide_with_tile(TestTypeFalling, 0, last_falling_y_pos,
+            if (collide_with_tile(probe, TestTypeFalling, 0, last_falling_y_pos,
                 x + colbox.x + colbox.width - 1.0f, newy + height - colbox.y,
                 &tile_friction, killing))
             {
                 if (!found) {
-                    newy = tiley * tile_height + colbox.y - height;
-                    if (accel_y > bump_sound_velocity && play_bump) {
-                        play_ground_bump_sound();
+                    newy = probe.tiley * tile_height + colbox.y - height;
+                    if (accel_y > bump_sound_velocity && bumps) {
+                        (*bumps)++;
                     }
                     accel_y = -accel_y * springiness_y;
                     is_collision = true;
@@ -220,6 +357,11 @@ bool Tournament::render_physics(double period_f, bool projectile, int damage,
         }
     } while (false);
 
+    /* the sweep stopped at a killing tile the corner tests may have missed */
+    if (swept_killing) {
+        *killing = true;
+    }
+
     /* save last falling y after y correction for falling tile collision tests */
     if (static_cast<int>(newy + height) > last_falling_y_pos) {
         last_falling_y_pos = static_cast<int>(newy + height);
@@ -266,7 +408,7 @@ bool Tournament::render_physics(double period_f, bool projectile, int damage,
                     p_colbox.y = static_cast<int>(p->state.client_server_state.y) - p_colbox.height - p_colbox.y;
                     if (obj_colbox.intersects(p_colbox)) {
                         if (server) {
-                            GPlayerRecoil *prec = new GPlayerRecoil;
+                            GPlayerRecoil *prec = create_response<GPlayerRecoil>();
                             prec->id = p->state.id;
                             prec->x_recoil = (accel_x < 0.0f ? recoil : -recoil);
                             prec->to_net();
@@ -283,7 +425,7 @@ bool Tournament::render_physics(double period_f, bool projectile, int damage,
         for (SpawnableNPCs::iterator it = spawnable_npcs.begin();
             it != spawnable_npcs.end(); it++)
         {
-            SpawnableNPC *npc = *it;
+            SpawnableNPC *npc = &*it;
             CollisionBox n_colbox = npc->npc->get_damage_colbox();
             n_colbox.x += static_cast<int>(npc->state.x);
             n_colbox.y = static_cast<int>(npc->state.y) - n_colbox.height - n_colbox.y;
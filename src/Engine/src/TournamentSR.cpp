@@ -12,7 +12,9 @@ TournamentSR::TournamentSR(Resources& resources, Subsystem& subsystem, Gui *gui,
     const std::string& map_name, Players& players, int duration, bool warmup)
     throw (TournamentException, ResourcesException)
     : Tournament(resources, subsystem, gui, logger, game_file, server, map_name,
-      players, duration, warmup)
+      players, duration, warmup), has_finish(false), finish_x(0.0f), finish_y(0.0f),
+      round_complete_sound(lookup_sound("round_complete")),
+      round_complete_best_sound(lookup_sound("round_complete_best"))
 {
     /* create spawn points */
     create_spawn_points();
@@ -20,6 +22,8 @@ TournamentSR::TournamentSR(Resources& resources, Subsystem& subsystem, Gui *gui,
         throw TournamentException("Why more than one spawn point in this game mode?");
     }
 
+    has_finish = find_tile_center(Tile::TileTypeSpeedraceFinish, finish_x, finish_y);
+
     /* setup tournament icon */
     tournament_icon = resources.get_icon("hud_sr");
 
@@ -32,6 +36,13 @@ TournamentSR::TournamentSR(Resources& resources, Subsystem& subsystem, Gui *gui,
 
 TournamentSR::~TournamentSR() { }
 
+bool TournamentSR::get_bot_goal(Player *p, double& x, double& y) {
+    x = finish_x;
+    y = finish_y;
+
+    return has_finish;
+}
+
 const char *TournamentSR::tournament_type() {
     return "SR";
 }
@@ -75,48 +86,40 @@ void TournamentSR::write_stats_in_server_log() {
 
 void TournamentSR::frag_point(Player *pfrag, Player *pkill) { }
 
-bool TournamentSR::tile_collision(TestType type, Player *p, int last_falling_y_pos,
-    Tile *t, bool *killing)
-{
-    if (killing) {
-        *killing = false;
-    }
-
-    if (p) {
-        Player *me = get_me();
-        switch (t->get_tile_type()) {
-            case Tile::TileTypeSpeedraceFinish:
-                if (!server && p == me) {
-                    bool found = false;
-                    for (PlayersToReturn::iterator it = players_to_return.begin();
-                        it != players_to_return.end(); it++)
-                    {
-                        if (*it == p) {
-                            found = true;
-                            break;
-                        }
+void TournamentSR::touch_tile(Player *p, Tile *t) {
+    switch (t->get_tile_type()) {
+        case Tile::TileTypeSpeedraceFinish:
+            if (!server && p == get_me()) {
+                bool found = false;
+                for (PlayersToReturn::iterator it = players_to_return.begin();
+                    it != players_to_return.end(); it++)
+                {
+                    if (*it == p) {
+                        found = true;
+                        break;
                     }
-                    if (!found) {
-                        players_to_return.push_back(p);
-                        TimesOfPlayer *top = get_times_of_player(p);
-                        if (top) {
-                            top->finished = true;
-                        }
+                }
+                if (!found) {
+                    players_to_return.push_back(p);
+                    TimesOfPlayer *top = get_times_of_player(p);
+                    if (top) {
+                        top->finished = true;
                     }
                 }
-                return false;
-                break;
+            }
+            break;
 
-            default:
-                break;
-        }
+        default:
+            Tournament::touch_tile(p, t);
+            break;
     }
-
-    return Tournament::tile_collision(type, p, last_falling_y_pos, t, killing);
 }
 
 void TournamentSR::player_added(Player *p) {
     times_of_players.push_back(TimesOfPlayer(p));
+    if (reattach_times(times_of_players.back())) {
+        std::sort(times_of_players.begin(), times_of_players.end());
+    }
 }
 
 void TournamentSR::player_removed(Player *p) {
@@ -163,7 +166,7 @@ void TournamentSR::spawn_player(Player *p) {
                     gametime_t now;
                     get_now(now);
                     ms_t d_ms = diff_ms(top->start_time, now);
-                    GTransportTime *race = new GTransportTime;
+                    GTransportTime *race = create_response<GTransportTime>();
                     race->id = p->state.id;
                     race->ms = static_cast<sr_milliseconds_t>(d_ms);
                     race->to_net();
@@ -180,7 +183,7 @@ void TournamentSR::round_finished_set_time(Player *p, GTransportTime *race) {
     /* server side */
     TimesOfPlayer *top = get_times_of_player(p);
     if (top) {
-        GTransportTime *tm = new GTransportTime;
+        GTransportTime *tm = create_response<GTransportTime>();
         *tm = *race;
         tm->to_net();
         add_state_response(GPCScoreTransportRaw, GTransportTimeLen, tm);
@@ -195,12 +198,12 @@ void TournamentSR::round_finished_set_time(Player *p, GTransportTime *race) {
         if ((has_entries && diff < best_time) || !has_entries) {
             sprintf(buffer, "new record of %s: %.2f", p->get_player_name().c_str(), diff);
             add_msg_response(buffer);
-            add_sound_response("round_complete_best");
+            add_sound_response(round_complete_best_sound);
             if (logger) {
                 logger->log(ServerLogger::LogTypeRoundFinished, buffer, p, 0, &diff);
             }
         } else {
-            add_sound_response("round_complete");
+            add_sound_response(round_complete_sound);
             if (logger) {
                 logger->log(ServerLogger::LogTypeRoundFinished, "round completed", p, 0, &diff);
             }
@@ -516,4 +519,65 @@ void TournamentSR::update_stats(TimesOfPlayer *top, float t) {
     }
 
     std::sort(times_of_players.begin(), times_of_players.end());
-}
\ No newline at end of file
+}
+
+void TournamentSR::write_mode_checkpoint(Checkpoint& cp) {
+    cp.write_u16(static_cast<uint16_t>(times_of_players.size() + held_times.size()));
+    for (TimesOfPlayers::iterator it = times_of_players.begin(); it != times_of_players.end(); it++) {
+        write_times(cp, it->player->get_player_name(), it->best, it->last, it->finished, it->times);
+    }
+    for (HeldTimesOfPlayers::iterator it = held_times.begin(); it != held_times.end(); it++) {
+        write_times(cp, it->player_name, it->best, it->last, it->finished, it->times);
+    }
+}
+
+void TournamentSR::read_mode_checkpoint(Checkpoint& cp) throw (CheckpointException) {
+    held_times.clear();
+    uint16_t count = cp.read_u16();
+    for (uint16_t i = 0; i < count; i++) {
+        HeldTimes held;
+        held.player_name = cp.read_string();
+        held.best = cp.read_float();
+        held.last = cp.read_float();
+        held.finished = cp.read_bool();
+        uint16_t laps = cp.read_u16();
+        for (uint16_t j = 0; j < laps; j++) {
+            held.times.push_back(cp.read_float());
+        }
+        held_times.push_back(held);
+    }
+
+    for (TimesOfPlayers::iterator it = times_of_players.begin(); it != times_of_players.end(); it++) {
+        reattach_times(*it);
+    }
+    std::sort(times_of_players.begin(), times_of_players.end());
+}
+
+bool TournamentSR::reattach_times(TimesOfPlayer& top) {
+    for (HeldTimesOfPlayers::iterator it = held_times.begin(); it != held_times.end(); it++) {
+        if (it->player_name == top.player->get_player_name()) {
+            top.best = it->best;
+            top.last = it->last;
+            top.finished = it->finished;
+            top.running = false;
+            top.times = it->times;
+            held_times.erase(it);
+            return true;
+        }
+    }
+
+    return false;
+}
+
+void TournamentSR::write_times(Checkpoint& cp, const std::string& player_name, float best,
+    float last, bool finished, const Times& times)
+{
+    cp.write_string(player_name);
+    cp.write_float(best);
+    cp.write_float(last);
+    cp.write_bool(finished);
+    cp.write_u16(static_cast<uint16_t>(times.size()));
+    for (Times::const_iterator it = times.begin(); it != times.end(); it++) {
+        cp.write_float(*it);
+    }
+}
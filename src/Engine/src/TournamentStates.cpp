@@ -2,27 +2,74 @@
 
 #include <algorithm>
 
-static double YInitialJumpImpulse = 3.8f;
 static double YVeloJumpToLanding = 2.0f;
-static ns_t IntegrateMaxTimeStep = 10000000;
+/* tile collisions are swept, the step size only bounds the integration
+   error, goatattack-check-physics compares the jump arcs to 10 ms steps */
+static ns_t IntegrateMaxTimeStep = 20000000;
+
+class Tournament::PlayerJob : public JobSystem::Job {
+private:
+    PlayerJob(const PlayerJob&);
+    PlayerJob& operator=(const PlayerJob&);
+
+public:
+    PlayerJob(Tournament& tournament, double period_f, Player *me)
+        : tournament(tournament), period_f(period_f), me(me) { }
+
+    virtual void execute(size_t index) {
+        tournament.integrate_player(tournament.player_steps[index], period_f, me);
+    }
+
+private:
+    Tournament& tournament;
+    double period_f;
+    Player *me;
+};
+
+class Tournament::ObjectJob : public JobSystem::Job {
+private:
+    ObjectJob(const ObjectJob&);
+    ObjectJob& operator=(const ObjectJob&);
+
+public:
+    ObjectJob(Tournament& tournament, double period_f)
+        : tournament(tournament), period_f(period_f) { }
+
+    virtual void execute(size_t index) {
+        tournament.integrate_object(tournament.object_steps[index], period_f,
+            &tournament.game_objects[index]);
+    }
+
+private:
+    Tournament& tournament;
+    double period_f;
+};
 
 void Tournament::update_states(ns_t ns) {
     if (!ready) {
         return;
     }
 
-    ns_t shot = IntegrateMaxTimeStep;
-    while (ns) {
-        if (ns <= IntegrateMaxTimeStep) {
-            shot = ns;
-            ns = 0;
-        } else {
-            ns -= IntegrateMaxTimeStep;
-        }
+    /* split into equal sized steps */
+    ns_t steps = (ns + IntegrateMaxTimeStep - 1) / IntegrateMaxTimeStep;
+    while (steps) {
+        ns_t shot = ns / steps;
+        ns -= shot;
+        steps--;
         integrate(shot);
     }
 }
 
+void Tournament::run_jobs(JobSystem::Job& job, size_t count) {
+    if (jobs) {
+        jobs->run(job, count);
+    } else {
+        for (size_t i = 0; i < count; i++) {
+            job.execute(i);
+        }
+    }
+}
+
 void Tournament::integrate(ns_t ns) {
     double period_f = ns / static_cast<double>(ns_fc);
 
@@ -61,14 +108,14 @@ void Tournament::integrate(ns_t ns) {
         for (GameObjects::iterator it = game_objects.begin();
             it != game_objects.end(); it++)
         {
-            GameObject *obj = *it;
+            GameObject *obj = &*it;
             int spawn_time = obj->object->get_spawning_time();
             if (obj->picked && spawn_time) {
                 obj->spawn_counter += period_f;
                 if (obj->spawn_counter >= spawn_time) {
                     obj->picked = false;
                     obj->spawn_counter = 0.0f;
-                    GPlaceObject *gpo = new GPlaceObject;
+                    GPlaceObject *gpo = create_response<GPlaceObject>();
                     gpo->id = obj->state.id;
                     gpo->flags = PlaceObjectWithAnimation | PlaceObjectWithSpawnSound;
                     gpo->x = static_cast<pos_t>(obj->state.x);
@@ -94,7 +141,7 @@ void Tournament::integrate(ns_t ns) {
     for (GameAnimations::iterator it = game_animations.begin();
         it != game_animations.end(); it++)
     {
-        GameAnimation *gani = *it;
+        GameAnimation *gani = &*it;
 
         gani->animation_counter += period_f * AnimationMultiplier;
         double speed = static_cast<double>(gani->animation->get_animation_speed());
@@ -126,11 +173,13 @@ void Tournament::integrate(ns_t ns) {
             int damage = gani->animation->get_damage();
 
             const CollisionBox& colbox = gani->animation->get_physics_colbox();
+            int bumps = 0;
             bool col = render_physics(period_f, projectile, damage, recoil,
                 gani->state.owner, springiness, springiness, colbox,
                 gani->state.x, gani->state.y, gani->state.accel_x,
-                gani->state.accel_y, width, height, 1.0f, true, gani->falling,
+                gani->state.accel_y, width, height, 1.0f, &bumps, gani->falling,
                 gani->last_falling_y_pos, 0, gani->animation->get_name());
+            play_ground_bump_sound(bumps);
 
             if (col && projectile) {
                 finished = true;
@@ -143,10 +192,10 @@ void Tournament::integrate(ns_t ns) {
                 const std::string& finished_animation = gani->animation->get_value("finished_animation");
                 if (finished_animation.length()) {
                     Animation *ani = resources.get_animation(finished_animation);
-                    GAnimation *sgani = new GAnimation;
+                    GAnimation *sgani = create_response<GAnimation>();
                     memset(sgani, 0, GAnimationLen);
-                    strncpy(sgani->animation_name, ani->get_name().c_str(), NameLength - 1);
-                    strncpy(sgani->sound_name, ani->get_value("sound_name").c_str(), NameLength - 1);
+                    sgani->animation_id = resource_ids->get_id(ani);
+                    sgani->sound_id = resource_ids->get_id(ani->get_sound());
                     sgani->id = gani->state.id;
                     sgani->duration = ani->get_duration();
                     sgani->x = gani->state.x + ani->get_x_offset();
@@ -163,9 +212,7 @@ void Tournament::integrate(ns_t ns) {
         }
     }
 
-    game_animations.erase(std::remove_if(game_animations.begin(),
-        game_animations.end(), erase_element<GameAnimation>),
-        game_animations.end());
+    game_animations.remove_marked();
 
     /* update text animations */
     for (GameTextAnimations::iterator it = game_text_animations.begin();
@@ -204,27 +251,15 @@ void Tournament::integrate(ns_t ns) {
         resources.update_tile_index(period_f * AnimationMultiplier, tileset);
     }
 
-    /* update object physics */
-    for (GameObjects::iterator it = game_objects.begin();
-        it != game_objects.end(); it++)
-    {
-        GameObject *obj = *it;
-        if (!obj->picked) {
-            if (obj->object->get_physics()) {
-                TileGraphic *tg = obj->object->get_tile()->get_tilegraphic();
-                int width = tg->get_width();
-                int height = tg->get_height();
-                double springiness = obj->object->get_springiness();
-
-                const CollisionBox& colbox = (obj->object->has_physics_colbox() ?
-                    obj->object->get_physics_colbox() : obj->object->get_colbox());
-
-                render_physics(period_f, false, 0, 0.0f, 0, springiness,
-                    springiness, colbox, obj->state.x, obj->state.y, obj->state.accel_x,
-                    obj->state.accel_y, width, height, 1.0f, true, obj->falling,
-                    obj->last_falling_y_pos, 0, obj->object->get_name());
-            }
-        }
+    /* update object physics, only the object itself is touched */
+    size_t nobjects = game_objects.size();
+    if (object_steps.size() < nobjects) {
+        object_steps.resize(nobjects);
+    }
+    ObjectJob object_job(*this, period_f);
+    run_jobs(object_job, nobjects);
+    for (size_t i = 0; i < nobjects; i++) {
+        play_ground_bump_sound(object_steps[i].bumps);
     }
 
     /* subclassed integration */
@@ -257,9 +292,28 @@ void Tournament::integrate(ns_t ns) {
     /* control spectator */
     control_spectator(me, period_f);
 
-    /* update all player states */
+    /* update all player states, the movement and tile collisions of
+       each player only touch that player and run as jobs, all other
+       effects are applied afterwards in player order */
+    size_t nsteps = 0;
     for (Players::iterator it = players.begin(); it != players.end(); it++) {
         Player *p = *it;
+        if (p->is_alive_and_playing()) {
+            if (nsteps == player_steps.size()) {
+                player_steps.push_back(PlayerStep());
+            }
+            PlayerStep& step = player_steps[nsteps++];
+            step.p = p;
+            step.hits.clear();
+        }
+    }
+
+    PlayerJob job(*this, period_f, me);
+    run_jobs(job, nsteps);
+
+    for (size_t i = 0; i < nsteps; i++) {
+        PlayerStep& step = player_steps[i];
+        Player *p = step.p;
 
         if (p->is_alive_and_playing()) {
             const CollisionBox& colbox = p->get_characterset()->get_colbox();
@@ -275,271 +329,18 @@ void Tournament::integrate(ns_t ns) {
                 following_player = p;
             }
 
-            /* action key triggers */
-            bool move_left = ((p->state.client_server_state.key_states & PlayerKeyStateLeft) != 0) |
-                ((p->state.client_server_state.jaxis & PlayerKeyStateLeft) != 0);
-
-            bool move_right = ((p->state.client_server_state.key_states & PlayerKeyStateRight) != 0) |
-                ((p->state.client_server_state.jaxis & PlayerKeyStateRight) != 0);
-
-            bool move_up = ((p->state.client_server_state.key_states & PlayerKeyStateUp) != 0) |
-                ((p->state.client_server_state.jaxis & PlayerKeyStateUp) != 0);
-
-            bool move_down = ((p->state.client_server_state.key_states & PlayerKeyStateDown) != 0) |
-                ((p->state.client_server_state.jaxis & PlayerKeyStateDown) != 0);
-
-            bool move_jump = ((p->state.client_server_state.key_states & PlayerKeyStateJump) != 0);
-
-            /* prevent locking slidings */
-            if (move_left && move_right) {
-                move_left = move_right = false;
-            }
-
-            if (move_up && move_down) {
-                move_up = move_down = false;
+            /* apply touched tiles in probe order */
+            for (TileHits::iterator hit = step.hits.begin(); hit != step.hits.end(); hit++) {
+                touch_tile(p, *hit);
             }
 
-            /* horizontal acceleration */
-            if (move_left) {
-                p->state.client_server_state.accel_x -= (XAccel * period_f);
-            }
-
-            if (move_right) {
-                p->state.client_server_state.accel_x += (XAccel * period_f);
-            }
-
-            if (p->state.client_server_state.accel_x < -XMaxAccel) {
-                p->state.client_server_state.accel_x = -XMaxAccel;
-            }
-
-            if (p->state.client_server_state.accel_x > XMaxAccel) {
-                p->state.client_server_state.accel_x = XMaxAccel;
-            }
-
-            /* horizontal deceleration */
-            if (!move_left && !move_right) {
-                if (p->state.client_server_state.accel_x > -Epsilon && p->state.client_server_state.accel_x < Epsilon) {
-                    p->state.client_server_state.accel_x = 0.0f;
-                } else if (p->state.client_server_state.accel_x < -Epsilon) {
-                    p->state.client_server_state.accel_x += (XDecel * period_f);
-                    if (p->state.client_server_state.accel_x > -Epsilon) {
-                        p->state.client_server_state.accel_x = 0.0f;
-                    }
-                } else if (p->state.client_server_state.accel_x > Epsilon) {
-                    p->state.client_server_state.accel_x -= (XDecel * period_f);
-                    if (p->state.client_server_state.accel_x < Epsilon) {
-                        p->state.client_server_state.accel_x = 0.0f;
-                    }
-                }
-            }
-
-            /* jump */
-            if (move_jump && p->state.client_state.flags & PlayerClientFlagJumpReleased) {
-                p->state.client_state.flags &= ~PlayerClientFlagJumpReleased;
-                if (!(p->state.client_state.flags & PlayerClientFlagFalling) &&
-                    p->state.client_server_state.jump_accel_y > -Epsilon &&
-                    p->state.client_server_state.jump_accel_y < Epsilon)
-                {
-                    if (p == me) {
-                        p->state.client_server_state.jump_accel_y = -YInitialJumpImpulse;
-                        if (!server) {
-                            p->force_broadcast = true;
-                            const std::string& jump_sound = p->get_characterset()->get_value("jump_sound");
-                            if (jump_sound.length()) {
-                                subsystem.play_sound(resources.get_sound(jump_sound), 0);
-                            }
-                        }
-                    }
-                }
-            } else if (!move_jump) {
-                p->state.client_state.flags |= PlayerClientFlagJumpReleased;
-            }
-
-            /* gravity */
-            p->state.client_server_state.accel_y += YAccelGravity * period_f;
-            if (p->state.client_server_state.accel_y > YMaxAccel) {
-                p->state.client_server_state.accel_y = YMaxAccel;
-            }
-
-            if (p->state.client_server_state.accel_y + p->state.client_server_state.jump_accel_y < -Epsilon) {
-                p->state.client_server_state.jump_accel_y += (move_jump ? YDecelJump : YDecelJumpNormal) * period_f;
-            } else {
-                p->state.client_server_state.jump_accel_y += YDecelJumpNormal * period_f;
-            }
-
-            if (p->state.client_server_state.jump_accel_y > -Epsilon) {
-                p->state.client_server_state.jump_accel_y = 0.0f;
-            }
-
-            /* new movement vector */
-            double movy = p->state.client_server_state.accel_y + p->state.client_server_state.jump_accel_y;
-
-            /* new position */
-            double newx = p->state.client_server_state.x + (p->state.client_server_state.accel_x * period_f);
-            double newy = p->state.client_server_state.y + (movy * period_f);
-
-            /* map boundary checks */
-            if (newx < -colbox.x) {
-                newx = -colbox.x;
-                p->state.client_server_state.accel_x = 0.0f;
-            }
-            if (newx + colbox.x + colbox.width > map_width * tile_width) {
-                newx = map_width * tile_width - (colbox.x + colbox.width);
-                p->state.client_server_state.accel_x = 0.0f;
-            }
-
-            /* tile collision detection */
-            bool bailout;
-            int colmax;
-
-            /* AABB tile collision detection in x direction */
-            do {
-                /* left side */
-                if (p->state.client_server_state.accel_x < 0.0f) {
-                    /* left upper stepped down */
-                    bailout = false;
-                    colmax = ((colbox.height - 1) / tile_height) + 1;
-                    for (int i = 0; i < colmax; i++) {
-                        if (collide_with_tile(TestTypeNormal, p, p->last_falling_y_pos, newx + colbox.x, p->state.client_server_state.y - colbox.y - colbox.height + (i * tile_height), 0, 0)) {
-                            newx = (tilex + 1) * tile_width - colbox.x;
-                            p->state.client_server_state.accel_x = 0.0f;
-                            bailout = true;
-                            break;
-                        }
-                    }
-                    if (bailout) {
-                        break;
-                    }
-
-                    /* left lower */
-                    if (collide_with_tile(TestTypeNormal, p, p->last_falling_y_pos, newx + colbox.x, p->state.client_server_state.y - colbox.y - 1.0f, 0, 0)) {
-                        newx = (tilex + 1) * tile_width - colbox.x;
-                        p->state.client_server_state.accel_x = 0.0f;
-                        break;
-                    }
-                }
-
-                if (p->state.client_server_state.accel_x > 0.0f) {
-                    /* right upper stepped down */
-                    bailout = false;
-                    colmax = ((colbox.height - 1) / tile_height) + 1;
-                    for (int i = 0; i < colmax; i++) {
-                        if (collide_with_tile(TestTypeNormal, p, p->last_falling_y_pos, newx + colbox.width + colbox.x, p->state.client_server_state.y - colbox.height - colbox.y + (i * tile_height), 0, 0)) {
-                            newx = tilex * tile_width - colbox.width - colbox.x;
-                            p->state.client_server_state.accel_x = 0.0f;
-                            bailout = true;
-                            break;
-                        }
-                    }
-                    if (bailout) {
-                        break;
-                    }
-
-                    /* right lower */
-                    if (collide_with_tile(TestTypeNormal, p, p->last_falling_y_pos, newx + colbox.width + colbox.x, p->state.client_server_state.y - colbox.y - 1.0f, 0, 0)) {
-                        newx = tilex * tile_width - colbox.width - colbox.x;
-                        p->state.client_server_state.accel_x = 0.0f;
-                    }
-                }
-            } while (false);
-
-            /* set player's falling flag */
-            p->state.client_state.flags |= PlayerClientFlagFalling;
-
-            /* save last falling y before y correction for falling tile collision tests */
-            if (static_cast<int>(newy) < p->last_falling_y_pos) {
-                p->last_falling_y_pos = static_cast<int>(newy);
-            }
-
-            /* AABB tile collision detection in y direction */
-            double ground_friction = 0.0f;
-
-            do {
-                /* test if jumping only */
-                if (movy < 0.0f) {
-                    /* reset after jump */
-                    p->last_falling_y_pos = Player::PlayerFallingTestMaxY;
-                    /* top edge */
-                    bailout = false;
-                    colmax = ((colbox.width - 1) / tile_width) + 1;
-                    for (int i = 0; i < colmax; i++) {
-                        if (collide_with_tile(TestTypeNormal, p, p->last_falling_y_pos, p->state.client_server_state.x + colbox.x + (i * tile_width), newy - colbox.y - colbox.height, 0, 0)) {
-                            newy = (tiley + 1) * tile_height + colbox.y + colbox.height;
-                            p->state.client_server_state.jump_accel_y = 0.0f;
-                            p->state.client_server_state.accel_y = 0.0f;
-                            p->state.client_state.flags &= ~PlayerClientFlagFalling;
-                            bailout = true;
-                            break;
-                        }
-                    }
-                    if (bailout) {
-                        break;
-                    }
-
-                    /* top edge right point */
-                    if (collide_with_tile(TestTypeNormal, p, p->last_falling_y_pos, p->state.client_server_state.x + colbox.x + colbox.width - 1.0f, newy - colbox.y - colbox.height, 0, 0)) {
-                        newy = (tiley + 1) * tile_height + colbox.y + colbox.height;
-                        p->state.client_server_state.jump_accel_y = 0.0f;
-                        p->state.client_server_state.accel_y = 0.0f;
-                        p->state.client_state.flags &= ~PlayerClientFlagFalling;
-                        break;
-                    }
-                }
-
-                /* test if falling only */
-                TestType test_type;
-                if (move_down) {
-                    p->last_falling_y_pos = Player::PlayerFallingTestMaxY;
-                    test_type = TestTypeFallingThrough;
-                } else {
-                    test_type = TestTypeFalling;
-                }
-                if (movy > 0.0f) {
-                    /* bottom edge */
-                    bool found = false;
-                    colmax = ((colbox.width - 1) / tile_width) + 1;
-                    for (int i = 0; i < colmax; i++) {
-                        double tile_friction = 0.0f;
-                        if (collide_with_tile(test_type, p, p->last_falling_y_pos, p->state.client_server_state.x + colbox.x + (i * tile_width), newy - colbox.y, &tile_friction, 0)) {
-                            if (!found) {
-                                if (p->state.client_server_state.accel_y > YVeloLanding) {
-                                    p->state.client_state.flags |= PlayerClientFlagLanded;
-                                }
-                                newy = tiley * tile_height + colbox.y;
-                                p->state.client_server_state.jump_accel_y = 0.0f;
-                                p->state.client_server_state.accel_y = 0.0f;
-                                p->state.client_state.flags &= ~PlayerClientFlagFalling;
-                                found = true;
-                            }
-                        }
-                        if (tile_friction > ground_friction) {
-                            ground_friction = tile_friction;
-                        }
-                    }
-
-                    /* bottom edge right point */
-                    double tile_friction = 0.0f;
-                    if (collide_with_tile(test_type, p, p->last_falling_y_pos, p->state.client_server_state.x + colbox.x + colbox.width - 1.0f, newy - colbox.y, &tile_friction, 0)) {
-                        if (!found) {
-                            if (p->state.client_server_state.accel_y > YVeloLanding) {
-                                p->state.client_state.flags |= PlayerClientFlagLanded;
-                            }
-                            newy = tiley * tile_height + colbox.y;
-                            p->state.client_server_state.jump_accel_y = 0.0f;
-                            p->state.client_server_state.accel_y = 0.0f;
-                            p->state.client_state.flags &= ~PlayerClientFlagFalling;
-                        }
-                    }
-                    if (tile_friction > ground_friction) {
-                        ground_friction = tile_friction;
-                    }
-                }
-            } while (false);
-
-            /* save last falling y after y correction for falling tile collision tests */
-            if (static_cast<int>(newy) > p->last_falling_y_pos) {
-                p->last_falling_y_pos = static_cast<int>(newy);
-            }
+            bool move_left = step.move_left;
+            bool move_right = step.move_right;
+            bool move_up = step.move_up;
+            bool move_down = step.move_down;
+            double newx = step.newx;
+            double newy = step.newy;
+            double ground_friction = step.ground_friction;
 
             /* if player was killed by tile, continue to next player here */
             if (p->state.server_state.flags & PlayerServerFlagDead) {
@@ -556,7 +357,7 @@ void Tournament::integrate(ns_t ns) {
                 for (GameObjects::iterator oit = game_objects.begin();
                     oit != game_objects.end(); oit++)
                 {
-                    GameObject *obj = *oit;
+                    GameObject *obj = &*oit;
                     if (!obj->picked) {
                         TileGraphic *tg = obj->object->get_tile()->get_tilegraphic();
 
@@ -573,7 +374,7 @@ void Tournament::integrate(ns_t ns) {
                                 proceed = true;
                             }
                             if (proceed) {
-                                GPickObject *po = new GPickObject;
+                                GPickObject *po = create_response<GPickObject>();
                                 po->id = obj->state.id;
                                 po->to_net();
                                 add_state_response(GPCPickObject, sizeof(GPickObject), po);
@@ -585,15 +386,13 @@ void Tournament::integrate(ns_t ns) {
                 }
 
                 /* delete marked objects */
-                game_objects.erase(std::remove_if(game_objects.begin(),
-                    game_objects.end(), erase_element<GameObject>),
-                    game_objects.end());
+                game_objects.remove_marked();
 
                 /* NPC collision */
                 for (SpawnableNPCs::iterator nit = spawnable_npcs.begin();
                     nit != spawnable_npcs.end(); nit++)
                 {
-                    SpawnableNPC *npc = *nit;
+                    SpawnableNPC *npc = &*nit;
 
                     CollisionBox npc_colbox = npc->npc->get_colbox();
                     npc_colbox.x += static_cast<int>(npc->state.x);
@@ -809,39 +608,364 @@ void Tournament::integrate(ns_t ns) {
     }
 }
 
+void Tournament::integrate_player(PlayerStep& step, double period_f, Player *me) {
+    Player *p = step.p;
+    const CollisionBox& colbox = p->get_characterset()->get_colbox();
+    TileProbe probe;
+    probe.hits = &step.hits;
+
+    /* action key triggers */
+    bool move_left = ((p->state.client_server_state.key_states & PlayerKeyStateLeft) != 0) |
+        ((p->state.client_server_state.jaxis & PlayerKeyStateLeft) != 0);
+
+    bool move_right = ((p->state.client_server_state.key_states & PlayerKeyStateRight) != 0) |
+        ((p->state.client_server_state.jaxis & PlayerKeyStateRight) != 0);
+
+    bool move_up = ((p->state.client_server_state.key_states & PlayerKeyStateUp) != 0) |
+        ((p->state.client_server_state.jaxis & PlayerKeyStateUp) != 0);
+
+    bool move_down = ((p->state.client_server_state.key_states & PlayerKeyStateDown) != 0) |
+        ((p->state.client_server_state.jaxis & PlayerKeyStateDown) != 0);
+
+    bool move_jump = ((p->state.client_server_state.key_states & PlayerKeyStateJump) != 0);
+
+    /* prevent locking slidings */
+    if (move_left && move_right) {
+        move_left = move_right = false;
+    }
+
+    if (move_up && move_down) {
+        move_up = move_down = false;
+    }
+
+    /* horizontal acceleration */
+    if (move_left) {
+        p->state.client_server_state.accel_x -= (XAccel * period_f);
+    }
+
+    if (move_right) {
+        p->state.client_server_state.accel_x += (XAccel * period_f);
+    }
+
+    if (p->state.client_server_state.accel_x < -XMaxAccel) {
+        p->state.client_server_state.accel_x = -XMaxAccel;
+    }
+
+    if (p->state.client_server_state.accel_x > XMaxAccel) {
+        p->state.client_server_state.accel_x = XMaxAccel;
+    }
+
+    /* horizontal deceleration */
+    if (!move_left && !move_right) {
+        if (p->state.client_server_state.accel_x > -Epsilon && p->state.client_server_state.accel_x < Epsilon) {
+            p->state.client_server_state.accel_x = 0.0f;
+        } else if (p->state.client_server_state.accel_x < -Epsilon) {
+            p->state.client_server_state.accel_x += (XDecel * period_f);
+            if (p->state.client_server_state.accel_x > -Epsilon) {
+                p->state.client_server_state.accel_x = 0.0f;
+            }
+        } else if (p->state.client_server_state.accel_x > Epsilon) {
+            p->state.client_server_state.accel_x -= (XDecel * period_f);
+            if (p->state.client_server_state.accel_x < Epsilon) {
+                p->state.client_server_state.accel_x = 0.0f;
+            }
+        }
+    }
+
+    /* jump */
+    if (move_jump && p->state.client_state.flags & PlayerClientFlagJumpReleased) {
+        p->state.client_state.flags &= ~PlayerClientFlagJumpReleased;
+        if (!(p->state.client_state.flags & PlayerClientFlagFalling) &&
+            p->state.client_server_state.jump_accel_y > -Epsilon &&
+            p->state.client_server_state.jump_accel_y < Epsilon)
+        {
+            if (p == me || p->bot) {
+                p->state.client_server_state.jump_accel_y = -YInitialJumpImpulse;
+                if (!server) {
+                    p->force_broadcast = true;
+                    const std::string& jump_sound = p->get_characterset()->get_value("jump_sound");
+                    if (jump_sound.length()) {
+                        subsystem.play_sound(resources.get_sound(jump_sound), 0);
+                    }
+                }
+            }
+        }
+    } else if (!move_jump) {
+        p->state.client_state.flags |= PlayerClientFlagJumpReleased;
+    }
+
+    /* gravity */
+    p->state.client_server_state.accel_y += YAccelGravity * period_f;
+    if (p->state.client_server_state.accel_y > YMaxAccel) {
+        p->state.client_server_state.accel_y = YMaxAccel;
+    }
+
+    if (p->state.client_server_state.accel_y + p->state.client_server_state.jump_accel_y < -Epsilon) {
+        p->state.client_server_state.jump_accel_y += (move_jump ? YDecelJump : YDecelJumpNormal) * period_f;
+    } else {
+        p->state.client_server_state.jump_accel_y += YDecelJumpNormal * period_f;
+    }
+
+    if (p->state.client_server_state.jump_accel_y > -Epsilon) {
+        p->state.client_server_state.jump_accel_y = 0.0f;
+    }
+
+    /* new movement vector */
+    double movy = p->state.client_server_state.accel_y + p->state.client_server_state.jump_accel_y;
+
+    /* new position */
+    double newx = p->state.client_server_state.x + (p->state.client_server_state.accel_x * period_f);
+    double newy = p->state.client_server_state.y + (movy * period_f);
+
+    /* map boundary checks */
+    if (newx < -colbox.x) {
+        newx = -colbox.x;
+        p->state.client_server_state.accel_x = 0.0f;
+    }
+    if (newx + colbox.x + colbox.width > map_width * tile_width) {
+        newx = map_width * tile_width - (colbox.x + colbox.width);
+        p->state.client_server_state.accel_x = 0.0f;
+    }
+
+    /* swept tile collision detection along the movement vector */
+    double curx = p->state.client_server_state.x;
+    double cury = p->state.client_server_state.y;
+    double dx = newx - curx;
+    double dy = newy - cury;
+    if (sweep_box(probe, (move_down ? TestTypeFallingThrough : TestTypeFalling),
+        p->last_falling_y_pos, curx + colbox.x, cury - colbox.y - colbox.height,
+        curx + colbox.x + colbox.width, cury - colbox.y, dx, dy, 0))
+    {
+        newx = curx + dx;
+        newy = cury + dy;
+    }
+
+    /* tile collision detection */
+    bool bailout;
+    int colmax;
+
+    /* AABB tile collision detection in x direction */
+    do {
+        /* left side */
+        if (p->state.client_server_state.accel_x < 0.0f) {
+            /* left upper stepped down */
+            bailout = false;
+            colmax = ((colbox.height - 1) / tile_height) + 1;
+            for (int i = 0; i < colmax; i++) {
+                if (collide_with_tile(probe, TestTypeNormal, p, p->last_falling_y_pos, newx + colbox.x, p->state.client_server_state.y - colbox.y - colbox.height + (i * tile_height), 0, 0)) {
+                    newx = (probe.tilex + 1) * tile_width - colbox.x;
+                    p->state.client_server_state.accel_x = 0.0f;
+                    bailout = true;
+                    break;
+                }
+            }
+            if (bailout) {
+                break;
+            }
+
+            /* left lower */
+            if (collide_with_tile(probe, TestTypeNormal, p, p->last_falling_y_pos, newx + colbox.x, p->state.client_server_state.y - colbox.y - 1.0f, 0, 0)) {
+                newx = (probe.tilex + 1) * tile_width - colbox.x;
+                p->state.client_server_state.accel_x = 0.0f;
+                break;
+            }
+        }
+
+        if (p->state.client_server_state.accel_x > 0.0f) {
+            /* right upper stepped down */
+            bailout = false;
+            colmax = ((colbox.height - 1) / tile_height) + 1;
+            for (int i = 0; i < colmax; i++) {
+                if (collide_with_tile(probe, TestTypeNormal, p, p->last_falling_y_pos, newx + colbox.width + colbox.x, p->state.client_server_state.y - colbox.height - colbox.y + (i * tile_height), 0, 0)) {
+                    newx = probe.tilex * tile_width - colbox.width - colbox.x;
+                    p->state.client_server_state.accel_x = 0.0f;
+                    bailout = true;
+                    break;
+                }
+            }
+            if (bailout) {
+                break;
+            }
+
+            /* right lower */
+            if (collide_with_tile(probe, TestTypeNormal, p, p->last_falling_y_pos, newx + colbox.width + colbox.x, p->state.client_server_state.y - colbox.y - 1.0f, 0, 0)) {
+                newx = probe.tilex * tile_width - colbox.width - colbox.x;
+                p->state.client_server_state.accel_x = 0.0f;
+            }
+        }
+    } while (false);
+
+    /* set player's falling flag */
+    p->state.client_state.flags |= PlayerClientFlagFalling;
+
+    /* save last falling y before y correction for falling tile collision tests */
+    if (static_cast<int>(newy) < p->last_falling_y_pos) {
+        p->last_falling_y_pos = static_cast<int>(newy);
+    }
+
+    /* AABB tile collision detection in y direction */
+    double ground_friction = 0.0f;
+
+    do {
+        /* test if jumping only */
+        if (movy < 0.0f) {
+            /* reset after jump */
+            p->last_falling_y_pos = Player::PlayerFallingTestMaxY;
+            /* top edge */
+            bailout = false;
+            colmax = ((colbox.width - 1) / tile_width) + 1;
+            for (int i = 0; i < colmax; i++) {
+                if (collide_with_tile(probe, TestTypeNormal, p, p->last_falling_y_pos, p->state.client_server_state.x + colbox.x + (i * tile_width), newy - colbox.y - colbox.height, 0, 0)) {
+                    newy = (probe.tiley + 1) * tile_height + colbox.y + colbox.height;
+                    p->state.client_server_state.jump_accel_y = 0.0f;
+                    p->state.client_server_state.accel_y = 0.0f;
+                    p->state.client_state.flags &= ~PlayerClientFlagFalling;
+                    bailout = true;
+                    break;
+                }
+            }
+            if (bailout) {
+                break;
+            }
+
+            /* top edge right point */
+            if (collide_with_tile(probe, TestTypeNormal, p, p->last_falling_y_pos, p->state.client_server_state.x + colbox.x + colbox.width - 1.0f, newy - colbox.y - colbox.height, 0, 0)) {
+                newy = (probe.tiley + 1) * tile_height + colbox.y + colbox.height;
+                p->state.client_server_state.jump_accel_y = 0.0f;
+                p->state.client_server_state.accel_y = 0.0f;
+                p->state.client_state.flags &= ~PlayerClientFlagFalling;
+                break;
+            }
+        }
+
+        /* test if falling only */
+        TestType test_type;
+        if (move_down) {
+            p->last_falling_y_pos = Player::PlayerFallingTestMaxY;
+            test_type = TestTypeFallingThrough;
+        } else {
+            test_type = TestTypeFalling;
+        }
+        if (movy > 0.0f) {
+            /* bottom edge */
+            bool found = false;
+            colmax = ((colbox.width - 1) / tile_width) + 1;
+            for (int i = 0; i < colmax; i++) {
+                double tile_friction = 0.0f;
+                if (collide_with_tile(probe, test_type, p, p->last_falling_y_pos, p->state.client_server_state.x + colbox.x + (i * tile_width), newy - colbox.y, &tile_friction, 0)) {
+                    if (!found) {
+                        if (p->state.client_server_state.accel_y > YVeloLanding) {
+                            p->state.client_state.flags |= PlayerClientFlagLanded;
+                        }
+                        newy = probe.tiley * tile_height + colbox.y;
+                        p->state.client_server_state.jump_accel_y = 0.0f;
+                        p->state.client_server_state.accel_y = 0.0f;
+                        p->state.client_state.flags &= ~PlayerClientFlagFalling;
+                        found = true;
+                    }
+                }
+                if (tile_friction > ground_friction) {
+                    ground_friction = tile_friction;
+                }
+            }
+
+            /* bottom edge right point */
+            double tile_friction = 0.0f;
+            if (collide_with_tile(probe, test_type, p, p->last_falling_y_pos, p->state.client_server_state.x + colbox.x + colbox.width - 1.0f, newy - colbox.y, &tile_friction, 0)) {
+                if (!found) {
+                    if (p->state.client_server_state.accel_y > YVeloLanding) {
+                        p->state.client_state.flags |= PlayerClientFlagLanded;
+                    }
+                    newy = probe.tiley * tile_height + colbox.y;
+                    p->state.client_server_state.jump_accel_y = 0.0f;
+                    p->state.client_server_state.accel_y = 0.0f;
+                    p->state.client_state.flags &= ~PlayerClientFlagFalling;
+                }
+            }
+            if (tile_friction > ground_friction) {
+                ground_friction = tile_friction;
+            }
+        }
+    } while (false);
+
+    /* save last falling y after y correction for falling tile collision tests */
+    if (static_cast<int>(newy) > p->last_falling_y_pos) {
+        p->last_falling_y_pos = static_cast<int>(newy);
+    }
+
+    step.move_left = move_left;
+    step.move_right = move_right;
+    step.move_up = move_up;
+    step.move_down = move_down;
+    step.newx = newx;
+    step.newy = newy;
+    step.ground_friction = ground_friction;
+}
+
+void Tournament::integrate_object(BodyStep& step, double period_f, GameObject *obj) {
+    step.collision = false;
+    step.bumps = 0;
+    if (!obj->picked) {
+        if (obj->object->get_physics()) {
+            TileGraphic *tg = obj->object->get_tile()->get_tilegraphic();
+            int width = tg->get_width();
+            int height = tg->get_height();
+            double springiness = obj->object->get_springiness();
+
+            const CollisionBox& colbox = (obj->object->has_physics_colbox() ?
+                obj->object->get_physics_colbox() : obj->object->get_colbox());
+
+            step.collision = render_physics(period_f, false, 0, 0.0f, 0, springiness,
+                springiness, colbox, obj->state.x, obj->state.y, obj->state.accel_x,
+                obj->state.accel_y, width, height, 1.0f, &step.bumps, obj->falling,
+                obj->last_falling_y_pos, 0, obj->object->get_name());
+        }
+    }
+}
+
 void Tournament::subintegrate(ns_t ns) { }
 
 void Tournament::players_post_actions() { }
 
 void Tournament::round_finished_set_time(Player *p, GTransportTime *race) { }
 
-bool Tournament::collide_with_tile(TestType type, Player *p,
+bool Tournament::collide_with_tile(TileProbe& probe, TestType type, Player *p,
     int last_falling_y_pos, double x, double y, double *friction, bool *killing)
 {
-    tilex = static_cast<int>(x) / tile_width;
-    tiley = static_cast<int>(y) / tile_height;
+    probe.tilex = static_cast<int>(x) / tile_width;
+    probe.tiley = static_cast<int>(y) / tile_height;
 
-    if (tilex < 0 || tiley < 0) {
+    if (probe.tilex < 0 || probe.tiley < 0) {
         return false;
     }
 
-    if (tilex > map_width - 1 || tiley > map_height - 1) {
+    if (probe.tilex > map_width - 1 || probe.tiley > map_height - 1) {
         return false;
     }
 
-    int index = map_array[tiley][tilex];
+    int index = map_array[probe.tiley][probe.tilex];
     if (index > -1) {
         Tile *t = tileset->get_tile(index);
         if (friction) {
             *friction = t->get_friction();
         }
-        return tile_collision(type, p, last_falling_y_pos, t, killing);
+        bool rv = tile_collision(type, probe, last_falling_y_pos, t, killing);
+        if (p) {
+            if (probe.hits) {
+                if (probe.hits->empty() || probe.hits->back() != t) {
+                    probe.hits->push_back(t);
+                }
+            } else {
+                touch_tile(p, t);
+            }
+        }
+        return rv;
     }
 
     return false;
 }
 
-bool Tournament::tile_collision(TestType type, Player *p,
+bool Tournament::tile_collision(TestType type, const TileProbe& probe,
     int last_falling_y_pos, Tile *t, bool *killing)
 {
     if (killing) *killing = false;
@@ -854,18 +978,8 @@ bool Tournament::tile_collision(TestType type, Player *p,
             return true;
 
         case Tile::TileTypeKilling:
-        {
             if (killing) *killing = true;
-            if (server && p && p->is_alive_and_playing()) {
-                p->state.server_state.score--;
-                std::string msg(p->get_player_name() + " committed suicide");
-                player_dies(p, msg);
-                if (logger) {
-                    logger->log(ServerLogger::LogTypeKill, msg, p, p, "tile");
-                }
-            }
             break;
-        }
 
         case Tile::TileTypeFallingOnlyBlocking:
         case Tile::TileTypeFallingOnlyBlockingNoDescending:
@@ -878,9 +992,9 @@ bool Tournament::tile_collision(TestType type, Player *p,
 
                 case TestTypeFalling:
                 {
-                    bool test = (last_falling_y_pos <= tiley * tile_height);
-                    if (tiley > 0) {
-                        int index = map_array[tiley - 1][tilex];
+                    bool test = (last_falling_y_pos <= probe.tiley * tile_height);
+                    if (probe.tiley > 0) {
+                        int index = map_array[probe.tiley - 1][probe.tilex];
                         if (index == -1 || tileset->get_tile(index)->get_tile_type() == Tile::TileTypeNonblocking) {
                             return test;
                         } else {
@@ -899,3 +1013,16 @@ bool Tournament::tile_collision(TestType type, Player *p,
 
     return false;
 }
+
+void Tournament::touch_tile(Player *p, Tile *t) {
+    if (t->get_tile_type() == Tile::TileTypeKilling) {
+        if (server && p->is_alive_and_playing()) {
+            p->state.server_state.score--;
+            std::string msg(p->get_player_name() + " committed suicide");
+            player_dies(p, msg);
+            if (logger) {
+                logger->log(ServerLogger::LogTypeKill, msg, p, p, "tile");
+            }
+        }
+    }
+}
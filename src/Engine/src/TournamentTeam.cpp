@@ -35,14 +35,18 @@ TournamentTeam::~TournamentTeam() {
     }
 }
 
+bool TournamentTeam::is_team_game() const {
+    return true;
+}
+
 void TournamentTeam::create_spawn_points() throw (TournamentException) {
     for (GameObjects::iterator it = game_objects.begin(); it != game_objects.end(); it++) {
-        GameObject *obj = *it;
+        GameObject *obj = &*it;
         Object::ObjectType type = obj->object->get_type();
         if (type == Object::ObjectTypeSpawnPointRed) {
-            spawn_points_red.push_back(obj);
+            spawn_points_red.push_back(game_objects.get_handle(obj));
         } else  if (type == Object::ObjectTypeSpawnPointBlue) {
-            spawn_points_blue.push_back(obj);
+            spawn_points_blue.push_back(game_objects.get_handle(obj));
         }
     }
 
@@ -262,7 +266,7 @@ void TournamentTeam::add_team_score(GTeamScore *ts) {
 }
 
 void TournamentTeam::send_team_score() {
-    GTeamScore *ts = new GTeamScore;
+    GTeamScore *ts = create_response<GTeamScore>();
     *ts = score;
     ts->to_net();
     add_state_response(GPCTeamScore, sizeof(GTeamScore), ts);
@@ -335,7 +339,7 @@ void TournamentTeam::team_click(playerflags_t flags) {
     if (me) {
         me->state.server_state.flags |= flags;
         this->spawn_player(me);
-        playerflags_t *pflags = new playerflags_t;
+        playerflags_t *pflags = create_response<playerflags_t>();
         *pflags = flags;
         add_state_response(GPSJoinRequest, sizeof(playerflags_t), pflags);
     }
@@ -378,7 +382,7 @@ void TournamentTeam::check_friendly_fire(identifier_t owner, Player *p) {
                     if ((fp->state.server_state.flags & PlayerServerFlagTeamRed) ==
                         (p->state.server_state.flags & PlayerServerFlagTeamRed))
                     {
-                        GFriendyFireAlarm *alarm = new GFriendyFireAlarm;
+                        GFriendyFireAlarm *alarm = create_response<GFriendyFireAlarm>();
                         alarm->owner = owner;
                         alarm->to_net();
                         add_state_response(GPCFriendlyFire, GFriendyFireAlarmLen, alarm);
@@ -488,7 +492,7 @@ void TournamentTeam::add_team_score_animation(Player *p, const std::string& text
     Font *font = resources.get_font("big");
     int tw = font->get_text_width(text);
 
-    GTextAnimation *tani = new GTextAnimation;
+    GTextAnimation *tani = create_response<GTextAnimation>();
     memset(tani, 0, sizeof(GTextAnimation));
     strncpy(tani->font_name, font->get_name().c_str(), NameLength - 1);
     strncpy(tani->display_text, text.c_str(), TextLength - 1);
@@ -567,4 +571,14 @@ void TournamentTeam::write_stats_in_server_log() {
                 &p->state.server_state.frags, &p->state.server_state.kills);
         }
     }
-}
\ No newline at end of file
+}
+
+void TournamentTeam::write_mode_checkpoint(Checkpoint& cp) {
+    cp.write_u16(score.score_red);
+    cp.write_u16(score.score_blue);
+}
+
+void TournamentTeam::read_mode_checkpoint(Checkpoint& cp) throw (CheckpointException) {
+    score.score_red = cp.read_u16();
+    score.score_blue = cp.read_u16();
+}
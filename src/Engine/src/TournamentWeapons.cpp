@@ -84,7 +84,7 @@ void Tournament::check_attack(Player *p, const CollisionBox& colbox,
                 if (p->state.client_state.flags & flag) {
                     p->state.client_state.flags &= ~flag;
                     if (is_fire_enabled && (*mun) > 0) {
-                        unsigned char *dir = new unsigned char;
+                        unsigned char *dir = create_response<unsigned char>();
                         *dir = p->state.client_server_state.direction;
                         add_state_response(action, sizeof(dir), dir);
                         p->state.client_state.flags |= flag2;
@@ -117,30 +117,30 @@ void Tournament::check_attack(Player *p, const CollisionBox& colbox,
 
 void Tournament::fire_shot(Player *p, unsigned char direction) {
     firing_animation(p, PlayerClientFlagFireReleased, properties.get_value("shot"),
-        "shot_start_sound", atoi(properties.get_value("shot_y_offset").c_str()), direction,
+        shot_start_sound, atoi(properties.get_value("shot_y_offset").c_str()), direction,
         &p->state.server_state.ammo);
 }
 
 void Tournament::fire_grenade(Player *p, unsigned char direction) {
     firing_animation(p, PlayerClientFlagGrenadeReleased, properties.get_value("grenade"),
-        "grenade_start_sound", atoi(properties.get_value("grenade_y_offset").c_str()), direction,
+        grenade_start_sound, atoi(properties.get_value("grenade_y_offset").c_str()), direction,
         &p->state.server_state.grenades);
 }
 
 void Tournament::fire_bomb(Player *p, unsigned char direction) {
     firing_animation(p, PlayerClientFlagBombReleased, properties.get_value("bomb"),
-        "bomb_start_sound", atoi(properties.get_value("bomb_y_offset").c_str()), direction,
+        bomb_start_sound, atoi(properties.get_value("bomb_y_offset").c_str()), direction,
         &p->state.server_state.bombs);
 }
 
 void Tournament::fire_frog(Player *p, unsigned char direction) {
     firing_npc(p, PlayerClientFlagFrogReleased, properties.get_value("frog"),
-        "frog_start_sound", atoi(properties.get_value("frog_y_offset").c_str()), direction,
+        frog_start_sound, atoi(properties.get_value("frog_y_offset").c_str()), direction,
         &p->state.server_state.frogs);
 }
 
 void Tournament::firing_animation(Player *p, int flag, const std::string& animation_name,
-    const std::string& start_sound, int yoffset, unsigned char direction, unsigned char *mun)
+    Sound *start_sound, int yoffset, unsigned char direction, unsigned char *mun)
 {
     (*mun)--;
     const CollisionBox& colbox = p->get_characterset()->get_colbox();
@@ -148,10 +148,10 @@ void Tournament::firing_animation(Player *p, int flag, const std::string& animat
     const CollisionBox& a_colbox = animation->get_physics_colbox();
     int ah = animation->get_tile()->get_tilegraphic()->get_height();
 
-    GAnimation *ani = new GAnimation;
+    GAnimation *ani = create_response<GAnimation>();
     memset(ani, 0, sizeof(GAnimation));
-    strncpy(ani->animation_name, animation->get_name().c_str(), NameLength - 1);
-    strncpy(ani->sound_name, properties.get_value(start_sound).c_str(), NameLength - 1);
+    ani->animation_id = resource_ids->get_id(animation);
+    ani->sound_id = resource_ids->get_id(start_sound);
     ani->id = ++animation_id;
     ani->duration = animation->get_duration();
     ani->owner = p->state.id;
@@ -180,14 +180,14 @@ void Tournament::firing_animation(Player *p, int flag, const std::string& animat
 }
 
 void Tournament::firing_npc(Player *p, int flag, const std::string& npc_name,
-    const std::string& start_sound, int yoffset, unsigned char direction, unsigned char *mun)
+    Sound *start_sound, int yoffset, unsigned char direction, unsigned char *mun)
 {
     (*mun)--;
     NPC *npc = resources.get_npc(npc_name);
-    GSpawnNPC *snpc = new GSpawnNPC;
+    GSpawnNPC *snpc = create_response<GSpawnNPC>();
     memset(snpc, 0, sizeof(GSpawnNPC));
-    strncpy(snpc->npc_name, npc_name.c_str(), NameLength - 1);
-    strncpy(snpc->sound_name, properties.get_value(start_sound).c_str(), NameLength - 1);
+    snpc->npc_id = resource_ids->get_id(npc);
+    snpc->sound_id = resource_ids->get_id(start_sound);
     snpc->id = get_free_npc_id();
     snpc->owner = p->state.id;
     snpc->direction = direction;
@@ -236,7 +236,7 @@ void Tournament::check_killing_animation(int x, int y, Animation *ani,
             for (SpawnableNPCs::iterator it = spawnable_npcs.begin();
                 it != spawnable_npcs.end(); it++)
             {
-                SpawnableNPC *npc = *it;
+                SpawnableNPC *npc = &*it;
                 CollisionBox n_colbox = npc->npc->get_damage_colbox();
                 n_colbox.x += static_cast<int>(npc->state.x);
                 n_colbox.y = static_cast<int>(npc->state.y) - n_colbox.height - n_colbox.y;
@@ -19,6 +19,8 @@ public:
 
     Tileset *get_tileset_ptr() const;
     Background *get_background_ptr() const;
+    short **get_writable_map();
+    short **get_writable_decoration();
 
     Objects& get_objects();
     Lights& get_light_sources();
@@ -47,7 +49,6 @@ private:
     Objects objects;
     Lights lights;
 
-    short **create_new_array(short **from, int new_width, int new_height);
     void save_array(const char *prefix, short **from, int width, int height);
 };
 
@@ -77,6 +77,16 @@ Background *EditableMap::get_background_ptr() const {
     return pbackground;
 }
 
+short **EditableMap::get_writable_map() {
+    detach_arrays();
+    return map;
+}
+
+short **EditableMap::get_writable_decoration() {
+    detach_arrays();
+    return decoration;
+}
+
 EditableMap::Objects& EditableMap::get_objects() {
     return objects;
 }
@@ -128,37 +138,13 @@ void EditableMap::resize_map(int new_width, int new_height) {
     touch();
 
     /* create new map/decoration */
-    short **new_map = create_new_array(map, new_width, new_height);
-    short **new_decoration = create_new_array(decoration, new_width, new_height);
-    cleanup();
-    map = new_map;
-    decoration = new_decoration;
-
-    width = new_width;
-    height = new_height;
-}
-
-short **EditableMap::create_new_array(short **from, int new_width, int new_height) {
-    short index;
-    short **new_map = new short *[new_height];
-    for (int y = 0; y < new_height; y++) {
-        new_map[y] = new short[new_width];
-        for (int x = 0; x < new_width; x++) {
-            if (x < width && y < height) {
-                index = from[y][x];
-            } else {
-                index = -1;
-            }
-            new_map[y][x] = index;
-        }
-    }
-
-    return new_map;
+    resize_arrays(new_width, new_height);
 }
 
 void EditableMap::set_tile(int x, int y, short index) {
     if (x >= 0 && x < width && y >= 0 && y < height) {
         touch();
+        detach_arrays();
         map[y][x] = index;
     }
 }
@@ -166,6 +152,7 @@ void EditableMap::set_tile(int x, int y, short index) {
 void EditableMap::set_decoration(int x, int y, short index) {
     if (x >= 0 && x < width && y >= 0 && y < height) {
         touch();
+        detach_arrays();
         decoration[y][x] = index;
     }
 }
@@ -1699,7 +1699,7 @@ void MapEditor::hcopy_click() {
     }
 
     int map_center = map_width / 2;
-    short **map_array = wmap->get_map();
+    short **map_array = wmap->get_writable_map();
     for (int y = 0; y < map_height; y++) {
         for (int x = map_center - 1; x >= 0; x--) {
             int newx = map_center + (map_center - x) - 1;
@@ -1707,7 +1707,7 @@ void MapEditor::hcopy_click() {
         }
     }
 
-    short **deco_array = wmap->get_decoration();
+    short **deco_array = wmap->get_writable_decoration();
     for (int y = 0; y < map_height; y++) {
         for (int x = map_center - 1; x >= 0; x--) {
             int newx = map_center + (map_center - x) - 1;
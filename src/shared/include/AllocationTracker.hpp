@@ -0,0 +1,52 @@
+#ifndef ALLOCATIONTRACKER_HPP
+#define ALLOCATIONTRACKER_HPP
+
+#include <string>
+#include <vector>
+#include <cstddef>
+#include <stdint.h>
+
+/* counts the heap allocations of one attached thread by profiler phase
+   and call site. only builds configured with --enable-allocation-tracking
+   replace the global operator new and delete, everywhere else each call
+   is a no-op and is_available() says so. the tables are fixed and only
+   touched by the attached thread, so the hook neither allocates nor locks.
+   one thread of the process can be attached at a time, attach() of a
+   second one fails until the first one detaches. reset() and report()
+   belong to the attached thread too, the job system runs the jobs of an
+   attached thread on that thread */
+class AllocationTracker {
+private:
+    AllocationTracker();
+    AllocationTracker(const AllocationTracker&);
+    AllocationTracker& operator=(const AllocationTracker&);
+
+public:
+    /* phase 0 collects everything outside a profiler scope */
+    static const size_t MaxPhases = 32;
+    static const size_t MaxSites = 1024;
+
+    typedef std::vector<std::string> Report;
+
+    static bool is_available();
+    static bool attach();
+    static void detach();
+    static bool is_attached();
+
+    static void set_phase_name(size_t phase, const char *name);
+    static size_t enter_phase(size_t phase);
+    static void leave_phase(size_t previous);
+
+    static void tick();
+    static void reset();
+    static uint64_t get_allocations();
+    static uint64_t get_bytes();
+    static uint64_t get_ticks();
+    static uint64_t get_max_tick_allocations();
+    static void report(Report& lines, size_t max_sites);
+
+    /* called by the hook */
+    static void record(size_t bytes, void *site);
+};
+
+#endif
@@ -7,6 +7,7 @@
 #include "Tile.hpp"
 #include "Sound.hpp"
 #include "AABB.hpp"
+#include "Random.hpp"
 #include "ZipReader.hpp"
 
 class AnimationException : public Exception {
@@ -40,7 +41,7 @@ public:
     int get_damage() const;
     int get_spread() const;
     int get_spread_count() const;
-    int get_randomized_index() const;
+    int get_randomized_index(Random& random) const;
     double get_recoil() const;
     int get_x_offset() const;
     int get_y_offset() const;
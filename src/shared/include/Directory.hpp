@@ -33,7 +33,8 @@ private:
     std::string suffix;
     bool finished;
     ZipReader *zip;
-    Zip::Files::const_iterator zf_it;
+    const ZipReader::Entries *zip_entries;
+    ZipReader::Entries::const_iterator zip_it;
     char zip_ret[256];
 #ifdef __unix__
     DIR *dir;
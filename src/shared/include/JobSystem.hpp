@@ -0,0 +1,83 @@
+#ifndef JOBSYSTEM_HPP
+#define JOBSYSTEM_HPP
+
+#include "Exception.hpp"
+#include "Thread.hpp"
+
+#include <vector>
+#include <cstddef>
+
+class JobSystemException : public Exception {
+public:
+    JobSystemException(const char *msg) : Exception(msg) { }
+    JobSystemException(const std::string& msg) : Exception(msg) { }
+};
+
+/* a fixed set of worker threads, run() hands out the indices 0..count-1
+   of a job and returns when every index has been executed, the calling
+   thread takes part in the work, jobs must not throw. if the pool is
+   already busy with another caller or the caller is attached to the
+   allocation tracker, the job runs on the caller alone */
+class JobSystem {
+private:
+    JobSystem(const JobSystem&);
+    JobSystem& operator=(const JobSystem&);
+
+public:
+    class Job {
+    public:
+        virtual ~Job() { }
+        virtual void execute(size_t index) = 0;
+    };
+
+    JobSystem(size_t workers) throw (JobSystemException);
+    virtual ~JobSystem();
+
+    size_t get_worker_count() const;
+    void run(Job& job, size_t count);
+
+    static size_t get_default_worker_count();
+
+private:
+    class Worker : public Thread {
+    private:
+        Worker(const Worker&);
+        Worker& operator=(const Worker&);
+
+    public:
+        Worker(JobSystem& owner);
+        virtual ~Worker();
+
+        bool start();
+        void join();
+
+    protected:
+        virtual void thread();
+
+    private:
+        JobSystem& owner;
+    };
+
+    typedef std::vector<Worker *> Workers;
+
+    struct sync_t;
+
+    Workers workers;
+    sync_t *sync;
+    Job *current_job;
+    size_t next_index;
+    size_t job_count;
+    size_t pending;
+    bool quit;
+
+    void lock();
+    void unlock();
+    void wait_for_work();
+    void wait_for_completion();
+    void wake_workers();
+    void wake_caller();
+    void run_inline(Job& job, size_t count);
+    void work();
+};
+
+#endif
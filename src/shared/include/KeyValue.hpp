@@ -43,6 +43,9 @@ public:
     const std::string& get_zip_filename() const;
     const std::string& get_zip_file_hash() const;
 
+protected:
+    void discard_value(const std::string& key);
+
 private:
     bool modified;
     int depth_counter;
@@ -5,6 +5,7 @@
 #include "Subsystem.hpp"
 #include "Tile.hpp"
 #include "ZipReader.hpp"
+#include "PNG.hpp"
 
 const int LightMapSize = 128;
 
@@ -22,8 +23,14 @@ private:
 public:
     Lightmap(Subsystem& subsystem, const std::string& filename, ZipReader *zip = 0)
         throw (LightmapException);
+    Lightmap(Subsystem& subsystem, PNG *image) throw (LightmapException);
     virtual ~Lightmap();
 
+    /* decoding touches no graphics, it may run on any thread,
+       returns 0 if the map has no lightmap */
+    static PNG *load_image(const std::string& filename, ZipReader *zip = 0)
+        throw (LightmapException);
+
     Tile *get_tile(int x, int y);
     void set_alpha(float alpha);
     float get_alpha() const;
@@ -35,7 +42,7 @@ private:
     int height;
     float alpha;
 
-    void create_tile(const std::string& filename, ZipReader *zip) throw (Exception);
+    void create_tiles(PNG& png) throw (Exception);
     void cleanup();
 };
 
@@ -9,6 +9,8 @@
 #include "Object.hpp"
 #include "Lightmap.hpp"
 #include "ZipReader.hpp"
+#include "Mutex.hpp"
+#include "MapCache.hpp"
 
 class MapException : public Exception {
 public:
@@ -16,6 +18,40 @@ public:
     MapException(const std::string& msg) : Exception(msg) { }
 };
 
+/* tile and decoration arrays of a map. they never change once loaded, so
+   all copies of a map (one per running tournament) share them by reference
+   count instead of duplicating them. writers detach first */
+class MapArrays {
+private:
+    MapArrays(const MapArrays& rhs);
+    MapArrays& operator=(const MapArrays& rhs);
+
+public:
+    MapArrays(int width, int height) throw (MutexException);
+    MapArrays(const MapArrays& rhs, int width, int height) throw (MutexException);
+    virtual ~MapArrays();
+
+    MapArrays *acquire();
+    bool release();
+    bool is_shared();
+
+    int get_width() const;
+    int get_height() const;
+    short **get_map();
+    short **get_decoration();
+
+private:
+    Mutex mtx;
+    int refs;
+    int width;
+    int height;
+    short **map;
+    short **decoration;
+
+    short **create_array(short **from, int from_width, int from_height);
+    void destroy_array(short **array);
+};
+
 class Map : public Properties {
 private:
     Map& operator=(const Map& rhs);
@@ -24,6 +60,10 @@ public:
     Map(Subsystem& subsystem);
     Map(Subsystem& subsystem, const std::string& filename, ZipReader *zip = 0)
         throw (KeyValueException, MapException);
+    /* a packaged map from its cached header, the tiles are read by load()
+       from the pak with the hash the header was cached from */
+    Map(Subsystem& subsystem, const std::string& filename, const std::string& zip_filename,
+        const std::string& pak_hash, const std::string& cache_filename) throw (KeyValueException, MapException);
     Map(const Map& rhs);
     virtual ~Map();
 
@@ -39,9 +79,12 @@ public:
     double get_decoration_brightness() const;
     double get_lightmap_alpha() const;
     void create_lightmap();
+    void create_lightmap(PNG *image);
+    PNG *load_lightmap_image() const throw (LightmapException);
     Tile *get_preview();
     GamePlayType get_game_play_type() const;
     int get_frog_spawn_init() const;
+    void load() throw (MapException);
 
 protected:
     Subsystem& subsystem;
@@ -60,10 +103,20 @@ protected:
     GamePlayType game_play_type;
     int frog_spawn_init;
     std::string zip_filename;
+    std::string pak_hash;
+    std::string cache_filename;
+    bool preview_tried;
+    MapArrays *arrays;
+    mutable Mutex mtx;
 
-    short **create_map(int width, int height);
-    void fill_map() throw (Exception);
-    void fill_map_array(const char *prefix, short **into);
+    void read_header();
+    void check_pak(ZipReader *zip) const throw (MapException);
+    void load_preview();
+    void bind_arrays();
+    void detach_arrays();
+    void resize_arrays(int new_width, int new_height);
+    void fill_map(const KeyValue& from) throw (Exception);
+    void fill_map_array(const KeyValue& from, const char *prefix, short **into);
     void cleanup();
 };
 
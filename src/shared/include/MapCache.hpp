@@ -0,0 +1,43 @@
+#ifndef MAPCACHE_HPP
+#define MAPCACHE_HPP
+
+#include "KeyValue.hpp"
+#include "PNG.hpp"
+
+#include <string>
+#include <vector>
+
+/* headers and preview thumbnails of packaged maps, cached on disk in a
+   directory per pak hash. a map with a cached header is created from it
+   alone and reads its tiles on first use. the cache is only a shortcut,
+   whatever can't be read or written is silently taken from the pak */
+class MapCache {
+private:
+    MapCache();
+    MapCache(const MapCache&);
+    MapCache& operator=(const MapCache&);
+
+public:
+    static const int ThumbnailSize = 64;
+
+    struct Thumbnail {
+        Thumbnail() : width(0), height(0), bytes_per_pixel(0) { }
+
+        int width;
+        int height;
+        int bytes_per_pixel;
+        std::vector<unsigned char> pixels;
+    };
+
+    /* empty if the cache directory can't be created */
+    static std::string get_cache_filename(const std::string& pak_hash, const std::string& map_filename);
+
+    static bool has_header(const std::string& cache_filename);
+    static void write_header(const std::string& cache_filename, const KeyValue& header);
+
+    static void create_thumbnail(const PNG& png, Thumbnail& thumbnail);
+    static bool read_thumbnail(const std::string& cache_filename, Thumbnail& thumbnail);
+    static void write_thumbnail(const std::string& cache_filename, const Thumbnail& thumbnail);
+};
+
+#endif
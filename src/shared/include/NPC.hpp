@@ -5,6 +5,8 @@
 #include "Movable.hpp"
 #include "Subsystem.hpp"
 #include "Tile.hpp"
+#include "Sound.hpp"
+#include "Random.hpp"
 #include "ZipReader.hpp"
 
 /* NPC icon enum */
@@ -28,11 +30,11 @@ public:
 
     Tile *get_tile(Direction direction, NPCAnimation animation);
     int get_move_init() const;
-    int get_move_init_randomized() const;
+    int get_move_init_randomized(Random& random) const;
     double get_jump_x_impulse() const;
     double get_jump_y_impulse() const;
-    double get_jump_x_impulse_randomized() const;
-    double get_jump_y_impulse_randomized() const;
+    double get_jump_x_impulse_randomized(Random& random) const;
+    double get_jump_y_impulse_randomized(Random& random) const;
     double get_max_accel_x() const;
     double get_springiness_x() const;
     double get_springiness_y() const;
@@ -41,6 +43,8 @@ public:
     double get_idle2_counter() const;
     double get_impact() const;
     double get_ignore_owner_counter() const;
+    Sound *get_kill_sound() const;
+    void set_kill_sound(Sound *sound);
 
 private:
     Tile *tiles[_DirectionMAX][_NPCAnimationMAX];
@@ -55,6 +59,7 @@ private:
     double idle2_counter;
     double impact;
     double ignore_owner_counter;
+    Sound *kill_sound;
 
     void create_npc(NPCAnimation type, const std::string& filename,
         int animation_speed, bool one_shot, ZipReader *zip) throw (Exception);
@@ -32,6 +32,9 @@ public:
     };
 
     PNG(const std::string& filename, ZipReader *zip = 0) throw (PNGException);
+
+    /* with header_only only the image header is read, get_pic() is 0 */
+    PNG(const std::string& filename, ZipReader *zip, bool header_only) throw (PNGException);
     virtual ~PNG();
 
     void flip_h();
@@ -61,6 +64,11 @@ private:
 
     void read_png_from_file(const std::string& filename) throw (PNGException);
     void read_png_from_zip(const std::string& filename, ZipReader *zip) throw (PNGException);
+    void read_png_header(const std::string& filename, ZipReader *zip) throw (PNGException);
+
+    static size_t read_png_head(const std::string& filename, ZipReader *zip, png_byte *head,
+        size_t len) throw (PNGException);
+    static bool find_trns_chunk(const png_byte *head, size_t sz, bool& found);
 
     static void user_data_read(png_structp png_ptr, png_bytep data, png_size_t len);
 };
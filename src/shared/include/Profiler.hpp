@@ -0,0 +1,110 @@
+#ifndef PROFILER_HPP
+#define PROFILER_HPP
+
+#include "Exception.hpp"
+#include "Timing.hpp"
+#include "AllocationTracker.hpp"
+
+#include <string>
+#include <vector>
+
+class ProfilerException : public Exception {
+public:
+    ProfilerException(const char *msg) : Exception(msg) { }
+    ProfilerException(const std::string& msg) : Exception(msg) { }
+};
+
+/* per phase latency histograms, buckets grow by a quarter octave so the
+   percentiles are exact within 25%, the optional trace ring keeps the
+   last events for a chrome trace-event json file */
+class Profiler {
+private:
+    Profiler(const Profiler&);
+    Profiler& operator=(const Profiler&);
+
+public:
+    typedef std::vector<std::string> Report;
+
+    Profiler();
+    virtual ~Profiler();
+
+    size_t add_phase(const char *name);
+    void record(size_t phase, const gametime_t& start, const gametime_t& end);
+    void reset();
+    void report(Report& lines) const;
+
+    void enable_trace(size_t events);
+    bool is_tracing() const;
+    void write_trace(const std::string& filename) const throw (ProfilerException);
+
+private:
+    enum {
+        SubBuckets = 4,
+        Buckets = 32 * SubBuckets
+    };
+
+    struct Phase {
+        Phase(const char *name) : name(name), count(0), total(0), max(0),
+            buckets(Buckets, 0) { }
+
+        std::string name;
+        unsigned long count;
+        double total;
+        ns_t max;
+        std::vector<unsigned long> buckets;
+    };
+
+    struct TraceEvent {
+        size_t phase;
+        gametime_t start;
+        ns_t duration;
+    };
+
+    typedef std::vector<Phase> Phases;
+    typedef std::vector<TraceEvent> TraceEvents;
+
+    Phases phases;
+    TraceEvents trace;
+    size_t trace_pos;
+    bool trace_wrapped;
+    gametime_t epoch;
+
+    static size_t get_bucket(ns_t ns);
+    static ns_t get_bucket_limit(size_t bucket);
+    ns_t get_percentile(const Phase& phase, double percent) const;
+};
+
+/* measures the enclosing block, a null profiler costs nothing. heap
+   allocations in the block are tagged with its phase */
+class ProfilerScope {
+private:
+    ProfilerScope(const ProfilerScope&);
+    ProfilerScope& operator=(const ProfilerScope&);
+
+public:
+    ProfilerScope(Profiler *profiler, size_t phase)
+        : profiler(profiler), phase(phase),
+          previous_allocation_phase(AllocationTracker::enter_phase(phase + 1))
+    {
+        if (profiler) {
+            get_now(start);
+        }
+    }
+
+    ~ProfilerScope() {
+        if (profiler) {
+            gametime_t end;
+            get_now(end);
+            profiler->record(phase, start, end);
+        }
+        AllocationTracker::leave_phase(previous_allocation_phase);
+    }
+
+private:
+    Profiler *profiler;
+    size_t phase;
+    size_t previous_allocation_phase;
+    gametime_t start;
+};
+
+#endif
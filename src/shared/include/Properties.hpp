@@ -24,8 +24,13 @@ public:
     void reload_configuration() throw (KeyValueException);
     void save_configuration() throw (KeyValueException);
 
+    /* position in its list of the resources, numbered after each load */
+    size_t get_resource_index() const;
+    void set_resource_index(size_t index);
+
 private:
     std::string filename;
+    size_t resource_index;
 
     std::string name;
     std::string author;
@@ -0,0 +1,27 @@
+#ifndef RANDOM_HPP
+#define RANDOM_HPP
+
+#include <stdint.h>
+
+/* random numbers for the game state. rand() is one generator for the
+   whole process, servers on other threads would draw from it and an
+   input journal could not reseed it for its own tournament alone */
+class Random {
+private:
+    Random(const Random&);
+    Random& operator=(const Random&);
+
+public:
+    Random();
+    Random(uint32_t seed);
+
+    void seed(uint32_t seed);
+
+    /* 0 to 2^31 - 1 */
+    int next();
+
+private:
+    uint32_t state;
+};
+
+#endif
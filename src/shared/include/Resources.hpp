@@ -16,6 +16,7 @@
 #include "Icon.hpp"
 #include "Sound.hpp"
 #include "Music.hpp"
+#include "Timing.hpp"
 
 #include <string>
 #include <map>
@@ -57,7 +58,28 @@ public:
 
     typedef std::vector<ResourceObject> ResourceObjects;
 
-    Resources(Subsystem& subystem, const std::string& resource_directory) throw (ResourcesException);
+    /* a resource which is only known by name */
+    struct IndexEntry {
+        IndexEntry(const char *directory, const std::string& name, bool base_resource)
+            : directory(directory), name(name), base_resource(base_resource) { }
+
+        const char *directory;
+        std::string name;
+        bool base_resource;
+    };
+
+    typedef std::vector<IndexEntry> IndexEntries;
+
+    /* what a program needs of each resource category */
+    enum LoadProfile {
+        LoadProfileClient = 0,
+        LoadProfileServer,
+        LoadProfileEditor,
+        _LoadProfileMAX
+    };
+
+    Resources(Subsystem& subystem, const std::string& resource_directory,
+        LoadProfile profile = LoadProfileClient) throw (ResourcesException);
     virtual ~Resources();
 
     void reload_resources() throw (ResourcesException);
@@ -70,6 +92,7 @@ public:
     NPC *get_npc(const std::string& name) throw (ResourcesException);
     Animation *get_animation(const std::string& name) throw (ResourcesException);
     Map *get_map(const std::string& name) throw (ResourcesException);
+    Map *get_map_header(const std::string& name) throw (ResourcesException);
     Background *get_background(const std::string& name) throw (ResourcesException);
     Font *get_font(const std::string& name) throw (ResourcesException);
     Icon *get_icon(const std::string& name) throw (ResourcesException);
@@ -93,8 +116,15 @@ public:
     const LoadedPaks& get_loaded_paks() const;
 
 private:
+    struct ResourceFile;
+    class LoadJob;
+
+    typedef std::vector<ResourceFile *> ResourceFiles;
+    typedef std::vector<ZipReader *> ZipReaders;
+
     Subsystem& subsystem;
     std::string resource_directory;
+    LoadProfile profile;
 
     LoadedPaks loaded_paks;
     ResourceObjects tilesets;
@@ -109,24 +139,15 @@ private:
     ResourceObjects sounds;
     ResourceObjects musics;
     ResourceObjects game_settings;
-
-    void read_tilesets(const std::string& directory, ZipReader *zip, bool base_resource) throw (Exception);
-    void read_objects(const std::string& directory, ZipReader *zip, bool base_resource) throw (Exception);
-    void read_charactersets(const std::string& directory, ZipReader *zip, bool base_resource) throw (Exception);
-    void read_npcs(const std::string& directory, ZipReader *zip, bool base_resource) throw (Exception);
-    void read_animations(const std::string& directory, ZipReader *zip, bool base_resource) throw (Exception);
-    void read_maps(const std::string& directory, ZipReader *zip, bool base_resource) throw (Exception);
-    void read_backgrounds(const std::string& directory, ZipReader *zip, bool base_resource) throw (Exception);
-    void read_fonts(const std::string& directory, ZipReader *zip, bool base_resource) throw (Exception);
-    void read_icons(const std::string& directory, ZipReader *zip, bool base_resource) throw (Exception);
-    void read_sounds(const std::string& directory, ZipReader *zip, bool base_resource) throw (Exception);
-    void read_musics(const std::string& directory, ZipReader *zip, bool base_resource) throw (Exception);
-    void read_game_settings(const std::string& directory, ZipReader *zip, bool base_resource) throw (Exception);
+    IndexEntries index;
 
     void load_resources(bool home_paks_only) throw (ResourcesException);
-    void read_all(const std::string& fdir, ZipReader *fzip, bool base_resource) throw (Exception);
+    void scan_all(ResourceFiles& files, const std::string& fdir, ZipReader *fzip, bool base_resource) throw (Exception);
+    void load_files(ResourceFiles& files, const gametime_t& start) throw (Exception);
+    void destroy_files(ResourceFiles& files, ZipReaders& zips);
     void destroy_resources(bool home_paks_only);
     void prepare_resources() throw (ResourcesException);
+    bool is_indexed(const char *directory, const std::string& name) const;
 };
 
 #endif
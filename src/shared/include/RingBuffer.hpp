@@ -0,0 +1,46 @@
+#ifndef RINGBUFFER_HPP
+#define RINGBUFFER_HPP
+
+#include "Exception.hpp"
+
+#include <cstddef>
+
+class RingBufferException : public Exception {
+public:
+    RingBufferException(const char *msg) : Exception(msg) { }
+    RingBufferException(const std::string& msg) : Exception(msg) { }
+};
+
+/* byte ring for exactly one producer and one consumer thread. nothing
+   blocks: a write that does not fit is refused as a whole and a read
+   that is not complete yet returns false. both positions only grow,
+   each side owns one of them and publishes it behind a barrier */
+class RingBuffer {
+private:
+    RingBuffer(const RingBuffer&);
+    RingBuffer& operator=(const RingBuffer&);
+
+public:
+    RingBuffer(size_t size) throw (RingBufferException);
+    virtual ~RingBuffer();
+
+    size_t get_size() const;
+    size_t get_used() const;
+
+    /* producer */
+    bool write(const void *data, size_t len);
+
+    /* consumer */
+    bool peek(void *data, size_t len) const;
+    bool read(void *data, size_t len);
+
+private:
+    unsigned char *buffer;
+    size_t size;
+    volatile size_t head;
+    volatile size_t tail;
+
+    void copy_out(size_t pos, void *data, size_t len) const;
+};
+
+#endif
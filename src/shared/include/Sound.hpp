@@ -19,7 +19,8 @@ private:
     Sound& operator=(const Sound&);
 
 public:
-    Sound(Subsystem& subsystem, const std::string& filename, ZipReader *zip = 0)
+    /* without audio the sound is only a named entry for resource ids */
+    Sound(Subsystem& subsystem, const std::string& filename, ZipReader *zip = 0, bool with_audio = true)
         throw (KeyValueException, SoundException);
     virtual ~Sound();
 
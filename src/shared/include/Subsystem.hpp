@@ -115,6 +115,7 @@ public:
 
     virtual const char *get_subsystem_name() const = 0;
     virtual bool is_dedicated_server() const = 0;
+    virtual bool needs_pictures() const = 0;
 
     virtual int get_zoom_factor() const = 0;
     virtual void toggle_fullscreen() = 0;
@@ -131,6 +132,8 @@ public:
 
     virtual TileGraphic *create_tilegraphic(int width, int height) = 0;
     virtual Audio *create_audio() = 0;
+    virtual void defer_uploads() = 0;
+    virtual size_t upload_deferred() = 0;
 
     virtual void begin_drawings() = 0;
     virtual void end_drawings() = 0;
@@ -12,6 +12,7 @@ public:
 
     virtual const char *get_subsystem_name() const;
     virtual bool is_dedicated_server() const;
+    virtual bool needs_pictures() const;
 
     virtual int get_zoom_factor() const;
     virtual void toggle_fullscreen();
@@ -28,6 +29,8 @@ public:
 
     virtual TileGraphic *create_tilegraphic(int width, int height);
     virtual Audio *create_audio();
+    virtual void defer_uploads();
+    virtual size_t upload_deferred();
 
     virtual void begin_drawings();
     virtual void end_drawings();
@@ -2,8 +2,10 @@
 #define TILEGRAPHICGL_HPP
 
 #include "TileGraphic.hpp"
+#include "Mutex.hpp"
 
 #include <deque>
+#include <vector>
 #ifdef __unix__
 #include <SDL2/SDL_opengl.h>
 #elif _WIN32
@@ -25,6 +27,12 @@ public:
     unsigned char *get_picture_array(int index);
     int get_bytes_per_pixel(int index);
 
+    /* while uploads are deferred, tiles can be added from any thread and
+       only get queued, upload_deferred() creates their textures on the
+       thread owning the context and returns the number of textures */
+    static void defer_uploads() throw (MutexException);
+    static size_t upload_deferred();
+
 private:
     struct PictureData {
         PictureData(int bytes_per_pixel, unsigned char *pic)
@@ -34,12 +42,35 @@ private:
         unsigned char *pic;
     };
 
+    struct Upload {
+        Upload(int bytes_per_pixel, unsigned char *pic, bool linear)
+            : bytes_per_pixel(bytes_per_pixel), pic(pic), linear(linear) { }
+
+        int bytes_per_pixel;
+        unsigned char *pic;
+        bool linear;
+    };
+
     typedef std::deque<GLuint> Textures;
     typedef std::deque<PictureData> Pictures;
+    typedef std::deque<Upload> Uploads;
+    typedef std::vector<TileGraphicGL *> Graphics;
+
+    struct Deferred {
+        Mutex mtx;
+        Graphics graphics;
+    };
+
+    static Deferred *deferred;
 
     Textures textures;
     Pictures pictures;
+    Uploads uploads;
+    bool registered;
     size_t sz;
+
+    GLuint create_texture(int bytes_per_pixel, const void *pic, bool linear);
+    void upload();
 };
 
 #endif
\ No newline at end of file
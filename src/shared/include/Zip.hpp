@@ -34,7 +34,7 @@ public:
 
     const std::string& get_zip_filename() const;
     const std::string& get_zip_short_filename() const;
-    const std::string& get_hash() throw (ZipException);
+    virtual const std::string& get_hash() throw (ZipException);
     void rehash() throw (ZipException);
 
 protected:
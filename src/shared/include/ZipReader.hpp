@@ -2,10 +2,13 @@
 #define ZIPREADER_HPP
 
 #include "Zip.hpp"
+#include "Mutex.hpp"
 
 #include <string>
 #include <vector>
+#include <map>
 #include <cstdio>
+#include <ctime>
 
 class ZipReaderException : public ZipException {
 public:
@@ -19,19 +22,77 @@ private:
     ZipReader& operator=(const ZipReader&);
 
 public:
+    typedef std::vector<const File *> Entries;
+
     ZipReader(const std::string& filename) throw (ZipReaderException);
     virtual ~ZipReader();
 
+    /* one reader per pak path, size and modification time for the
+       whole process. a shared reader is given back with release(),
+       unused ones stay open until close_unused() */
+    static ZipReader *open(const std::string& filename) throw (ZipReaderException);
+    static void release(ZipReader *zip);
+    static void close_unused();
+
+    /* hashed on the first call from any thread. the hash of a pak is
+       kept with its path, size and modification time, a reader opened
+       again for an unchanged pak does not hash it again */
+    virtual const std::string& get_hash() throw (ZipException);
+
+    size_t get_size() const;
+    size_t read_at(void *data, size_t len, size_t ofs);
     const Files& get_files() const;
+    const Entries& get_directory_entries(const std::string& directory) const;
     bool file_exists(std::string filename);
     bool equals_directory(const File& file, const std::string& directory);
     const char *extract(std::string filename, size_t *out_sz = 0) throw (ZipReaderException);
+    size_t extract_head(std::string filename, char *buffer, size_t len) throw (ZipReaderException);
     static void destroy(const char *data);
 
 private:
+    typedef std::vector<size_t> FileTable;
+    typedef std::map<std::string, Entries> Directories;
+
+    /* reads may come from several threads, without pread they share
+       the file position */
+    Mutex mtx;
+    size_t size;
+
+    /* the process wide cache */
+    std::string shared_key;
+    time_t shared_mtime;
+    int references;
+
+    /* built once after the central directory is read, read only after */
+    FileTable file_table;
+    Directories directories;
+    Entries no_entries;
+
+    /* call with the shared lock held */
+    static ZipReader *get_shared(const std::string& key, time_t mtime, size_t size);
+
+    void build_index();
     void throw_corrupt_file(const std::string& filename) throw (ZipReaderException);
     void throw_inflate_failed(z_stream *z, const char *data, const std::string& msg) throw (ZipReaderException);
     const File& get_file(const std::string& filename) throw (ZipReaderException);
+    size_t read_local_header(const File& file, const std::string& filename,
+        int& cmpr_sz, int& ucmpr_sz) throw (ZipReaderException);
+};
+
+/* holds a shared reader for a scope */
+class SharedZipReader {
+private:
+    SharedZipReader(const SharedZipReader&);
+    SharedZipReader& operator=(const SharedZipReader&);
+
+public:
+    SharedZipReader(const std::string& filename) throw (ZipReaderException);
+    ~SharedZipReader();
+
+    ZipReader *get() const;
+
+private:
+    ZipReader *zip;
 };
 
 #endif
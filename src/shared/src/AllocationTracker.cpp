@@ -0,0 +1,320 @@
+#include "AllocationTracker.hpp"
+
+#ifdef ALLOCATION_TRACKING
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <dlfcn.h>
+#include <cxxabi.h>
+
+struct AllocationSite {
+    void *address;
+    size_t phase;
+    uint64_t count;
+    uint64_t bytes;
+};
+
+struct AllocationPhase {
+    char name[32];
+    uint64_t count;
+    uint64_t bytes;
+};
+
+static __thread bool tracked = false;
+static __thread size_t current_phase = 0;
+static int attached = 0;
+
+static AllocationSite sites[AllocationTracker::MaxSites];
+static AllocationPhase phases[AllocationTracker::MaxPhases];
+static uint64_t overflow_count = 0;
+static uint64_t overflow_bytes = 0;
+static uint64_t allocations = 0;
+static uint64_t allocated_bytes = 0;
+static uint64_t ticks = 0;
+static uint64_t tick_start_allocations = 0;
+static uint64_t max_tick_allocations = 0;
+
+static bool CompareAllocationSite(const AllocationSite *lhs, const AllocationSite *rhs) {
+    return (lhs->count > rhs->count);
+}
+
+static std::string get_site_name(void *address) {
+    char buffer[64];
+    Dl_info info;
+    if (dladdr(address, &info) && info.dli_sname) {
+        int status = 0;
+        char *demangled = abi::__cxa_demangle(info.dli_sname, 0, 0, &status);
+        std::string name(status == 0 && demangled ? demangled : info.dli_sname);
+        free(demangled);
+        sprintf(buffer, "+0x%lx", static_cast<unsigned long>(
+            static_cast<char *>(address) - static_cast<char *>(info.dli_saddr)));
+
+        return name + buffer;
+    }
+    sprintf(buffer, "%p", address);
+
+    return buffer;
+}
+
+bool AllocationTracker::is_available() {
+    return true;
+}
+
+bool AllocationTracker::attach() {
+    if (!tracked) {
+        if (!__sync_bool_compare_and_swap(&attached, 0, 1)) {
+            return false;
+        }
+        tracked = true;
+    }
+
+    return true;
+}
+
+void AllocationTracker::detach() {
+    if (tracked) {
+        tracked = false;
+        __sync_lock_release(&attached);
+    }
+}
+
+bool AllocationTracker::is_attached() {
+    return tracked;
+}
+
+void AllocationTracker::set_phase_name(size_t phase, const char *name) {
+    if (phase < MaxPhases) {
+        strncpy(phases[phase].name, name, sizeof(phases[phase].name) - 1);
+    }
+}
+
+size_t AllocationTracker::enter_phase(size_t phase) {
+    size_t previous = current_phase;
+    current_phase = (phase < MaxPhases ? phase : 0);
+
+    return previous;
+}
+
+void AllocationTracker::leave_phase(size_t previous) {
+    current_phase = previous;
+}
+
+void AllocationTracker::tick() {
+    if (tracked) {
+        uint64_t n = allocations - tick_start_allocations;
+        if (n > max_tick_allocations) {
+            max_tick_allocations = n;
+        }
+        tick_start_allocations = allocations;
+        ticks++;
+    }
+}
+
+void AllocationTracker::reset() {
+    memset(sites, 0, sizeof(sites));
+    for (size_t i = 0; i < MaxPhases; i++) {
+        phases[i].count = 0;
+        phases[i].bytes = 0;
+    }
+    overflow_count = 0;
+    overflow_bytes = 0;
+    allocations = 0;
+    allocated_bytes = 0;
+    ticks = 0;
+    tick_start_allocations = 0;
+    max_tick_allocations = 0;
+}
+
+uint64_t AllocationTracker::get_allocations() {
+    return allocations;
+}
+
+uint64_t AllocationTracker::get_bytes() {
+    return allocated_bytes;
+}
+
+uint64_t AllocationTracker::get_ticks() {
+    return ticks;
+}
+
+uint64_t AllocationTracker::get_max_tick_allocations() {
+    return max_tick_allocations;
+}
+
+void AllocationTracker::report(Report& lines, size_t max_sites) {
+    /* the report allocates itself, that is not counted */
+    bool was_tracked = tracked;
+    tracked = false;
+
+    char buffer[256];
+    double per_tick = 1.0 / (ticks ? ticks : 1);
+    sprintf(buffer, "allocations: %llu in %llu ticks, %.1f/tick, %.0f bytes/tick, max %llu in a tick",
+        static_cast<unsigned long long>(allocations), static_cast<unsigned long long>(ticks),
+        allocations * per_tick, allocated_bytes * per_tick,
+        static_cast<unsigned long long>(max_tick_allocations));
+    lines.push_back(buffer);
+
+    for (size_t i = 0; i < MaxPhases; i++) {
+        const AllocationPhase& ph = phases[i];
+        if (ph.count) {
+            sprintf(buffer, "  %-16.31s %10.1f/tick %12.0f bytes/tick", (i ? ph.name : "other"),
+                ph.count * per_tick, ph.bytes * per_tick);
+            lines.push_back(buffer);
+        }
+    }
+
+    std::vector<const AllocationSite *> used;
+    for (size_t i = 0; i < MaxSites; i++) {
+        if (sites[i].count) {
+            used.push_back(&sites[i]);
+        }
+    }
+    std::sort(used.begin(), used.end(), CompareAllocationSite);
+    for (size_t i = 0; i < used.size() && i < max_sites; i++) {
+        const AllocationSite *site = used[i];
+        sprintf(buffer, " (%.31s): %.1f/tick, %.0f bytes/tick",
+            (site->phase ? phases[site->phase].name : "other"),
+            site->count * per_tick, site->bytes * per_tick);
+        lines.push_back("  " + get_site_name(site->address) + buffer);
+    }
+    if (overflow_count) {
+        sprintf(buffer, "  other sites: %.1f/tick, %.0f bytes/tick",
+            overflow_count * per_tick, overflow_bytes * per_tick);
+        lines.push_back(buffer);
+    }
+
+    tracked = was_tracked;
+}
+
+void AllocationTracker::record(size_t bytes, void *site) {
+    if (!tracked) {
+        return;
+    }
+
+    allocations++;
+    allocated_bytes += bytes;
+    phases[current_phase].count++;
+    phases[current_phase].bytes += bytes;
+
+    /* open addressing on site and phase, a full table counts as other */
+    size_t index = ((reinterpret_cast<size_t>(site) >> 2) * 2654435761u + current_phase) % MaxSites;
+    for (size_t i = 0; i < MaxSites; i++) {
+        AllocationSite& s = sites[index];
+        if (!s.count) {
+            s.address = site;
+            s.phase = current_phase;
+        }
+        if (s.address == site && s.phase == current_phase) {
+            s.count++;
+            s.bytes += bytes;
+            return;
+        }
+        index = (index + 1) % MaxSites;
+    }
+    overflow_count++;
+    overflow_bytes += bytes;
+}
+
+/* the hook, the caller of operator new is the sampled call site */
+static void *tracked_alloc(size_t sz, void *site) {
+    AllocationTracker::record(sz, site);
+
+    return malloc(sz ? sz : 1);
+}
+
+void *operator new(size_t sz) throw (std::bad_alloc) {
+    void *p = tracked_alloc(sz, __builtin_return_address(0));
+    if (!p) {
+        throw std::bad_alloc();
+    }
+
+    return p;
+}
+
+void *operator new[](size_t sz) throw (std::bad_alloc) {
+    void *p = tracked_alloc(sz, __builtin_return_address(0));
+    if (!p) {
+        throw std::bad_alloc();
+    }
+
+    return p;
+}
+
+void *operator new(size_t sz, const std::nothrow_t&) throw () {
+    return tracked_alloc(sz, __builtin_return_address(0));
+}
+
+void *operator new[](size_t sz, const std::nothrow_t&) throw () {
+    return tracked_alloc(sz, __builtin_return_address(0));
+}
+
+void operator delete(void *p) throw () {
+    free(p);
+}
+
+void operator delete[](void *p) throw () {
+    free(p);
+}
+
+void operator delete(void *p, const std::nothrow_t&) throw () {
+    free(p);
+}
+
+void operator delete[](void *p, const std::nothrow_t&) throw () {
+    free(p);
+}
+
+#else
+
+bool AllocationTracker::is_available() {
+    return false;
+}
+
+bool AllocationTracker::attach() {
+    return true;
+}
+
+void AllocationTracker::detach() { }
+
+bool AllocationTracker::is_attached() {
+    return false;
+}
+
+void AllocationTracker::set_phase_name(size_t phase, const char *name) { }
+
+size_t AllocationTracker::enter_phase(size_t phase) {
+    return 0;
+}
+
+void AllocationTracker::leave_phase(size_t previous) { }
+
+void AllocationTracker::tick() { }
+
+void AllocationTracker::reset() { }
+
+uint64_t AllocationTracker::get_allocations() {
+    return 0;
+}
+
+uint64_t AllocationTracker::get_bytes() {
+    return 0;
+}
+
+uint64_t AllocationTracker::get_ticks() {
+    return 0;
+}
+
+uint64_t AllocationTracker::get_max_tick_allocations() {
+    return 0;
+}
+
+void AllocationTracker::report(Report& lines, size_t max_sites) {
+    lines.push_back("allocation tracking is not built in, configure with --enable-allocation-tracking");
+}
+
+void AllocationTracker::record(size_t bytes, void *site) { }
+
+#endif
@@ -116,9 +116,9 @@ int Animation::get_spread_count() const {
     return spread_count;
 }
 
-int Animation::get_randomized_index() const {
+int Animation::get_randomized_index(Random& random) const {
     if (randomized_index) {
-        return rand() % randomized_index;
+        return random.next() % randomized_index;
     } else {
         return 0;
     }
@@ -148,7 +148,7 @@ void Animation::create_tile(const std::string& filename, ZipReader *zip) throw (
         bool background = (atoi(get_value("background").c_str()) == 0 ? false : true);
         bool one_shot = (atoi(get_value("one_shot").c_str()) != 0 ? true : false);
 
-        PNG png(filename, zip);
+        PNG png(filename, zip, !subsystem.needs_pictures());
 
         const int& png_width = png.get_width();
         const int& png_height = png.get_height();
@@ -36,7 +36,7 @@ Background::Background(Subsystem& subsystem, const std::string& filename, ZipRea
                 sprintf(buffer, "%s%d.png", filename.c_str(), i);
                 pngfile = buffer;
             }
-            PNG png(pngfile, zip);
+            PNG png(pngfile, zip, !subsystem.needs_pictures());
             tilegraphics[i] = subsystem.create_tilegraphic(png.get_width(), png.get_height());
             tilegraphics[i]->punch_out_tile(png, 0, 0, false);
         }
@@ -110,7 +110,7 @@ int Characterset::get_coin_drop_offset_y() const {
 void Characterset::create_character(CharacterAnimation type,
     const std::string& filename, int animation_speed, bool one_shot, ZipReader *zip) throw (Exception)
 {
-    PNG png(filename, zip);
+    PNG png(filename, zip, !subsystem.needs_pictures());
     tiles[DirectionRight][type] = create_tile(png, animation_speed, one_shot, false);
     png.flip_h();
     tiles[DirectionLeft][type] = create_tile(png, animation_speed, one_shot, true);
@@ -119,7 +119,7 @@ void Characterset::create_character(CharacterAnimation type,
 void Characterset::create_armor_overlay(CharacterAnimation type,
     const std::string& filename, int animation_speed, bool one_shot, ZipReader *zip) throw (Exception)
 {
-    PNG png(filename, zip);
+    PNG png(filename, zip, !subsystem.needs_pictures());
     armor_overlays[DirectionRight][type] = create_tile(png, animation_speed, one_shot, false);
     png.flip_h();
     armor_overlays[DirectionLeft][type] = create_tile(png, animation_speed, one_shot, true);
@@ -128,7 +128,7 @@ void Characterset::create_armor_overlay(CharacterAnimation type,
 void Characterset::create_rifle_overlay(CharacterAnimation type,
     const std::string& filename, int animation_speed, bool one_shot, ZipReader *zip) throw (Exception)
 {
-    PNG png(filename, zip);
+    PNG png(filename, zip, !subsystem.needs_pictures());
     rifle_overlays[DirectionRight][type] = create_tile(png, animation_speed, one_shot, false);
     png.flip_h();
     rifle_overlays[DirectionLeft][type] = create_tile(png, animation_speed, one_shot, true);
@@ -30,6 +30,7 @@ Configuration::Configuration(const std::string& directory,
     cdef("music_volume", "128");
     cdef("map_volume", "75");
     cdef("sfx_volume", "128");
+    cdef("record_demos", "0");
     cdef("master_server", "master.goatattack.net");
     cdef("master_port", "25113");
 
@@ -5,11 +5,11 @@
 
 Directory::Directory(const std::string& directory, const std::string& suffix,
     ZipReader *zip) throw (DirectoryException)
-    : directory(directory), suffix(suffix), finished(false), zip(zip)
+    : directory(directory), suffix(suffix), finished(false), zip(zip), zip_entries(0)
 {
     if (zip) {
-        const Zip::Files& files = zip->get_files();
-        zf_it = files.begin();
+        zip_entries = &zip->get_directory_entries(directory);
+        zip_it = zip_entries->begin();
     } else {
 #ifdef __unix__
         dir = opendir(directory.c_str());
@@ -37,28 +37,26 @@ Directory::~Directory() {
 
 const char *Directory::get_entry() {
     if (zip) {
-        const Zip::Files& files = zip->get_files();
-        while (zf_it != files.end()) {
-            const Zip::File& file = *zf_it;
-            zf_it++;
+        /* only the entries below the directory are visited */
+        while (zip_it != zip_entries->end()) {
+            const Zip::File& file = **zip_it;
+            zip_it++;
             memset(zip_ret, 0, sizeof zip_ret);
-            if (zip->equals_directory(file, directory)) {
-                if (suffix.length()) {
-                    /* find suffix */
-                    size_t pos = file.filename.rfind('.');
-                    if (pos != std::string::npos) {
-                        if (!strcmp(&file.filename.c_str()[pos], suffix.c_str())) {
-                            if (pos >= sizeof zip_ret) {
-                                pos = sizeof zip_ret - 1;
-                            }
-                            strncpy(zip_ret, file.filename.c_str(), pos);
-                            return zip_ret;
+            if (suffix.length()) {
+                /* find suffix */
+                size_t pos = file.filename.rfind('.');
+                if (pos != std::string::npos) {
+                    if (!strcmp(&file.filename.c_str()[pos], suffix.c_str())) {
+                        if (pos >= sizeof zip_ret) {
+                            pos = sizeof zip_ret - 1;
                         }
+                        strncpy(zip_ret, file.filename.c_str(), pos);
+                        return zip_ret;
                     }
-                } else {
-                    strncpy(zip_ret, file.filename.c_str(), sizeof zip_ret - 1);
-                    return zip_ret;
                 }
+            } else {
+                strncpy(zip_ret, file.filename.c_str(), sizeof zip_ret - 1);
+                return zip_ret;
             }
         }
     } else {
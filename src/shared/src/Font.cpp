@@ -17,7 +17,7 @@ Font::Font(Subsystem& subsystem, const std::string& filename, ZipReader *zip)
     : Properties(filename + ".font", zip), subsystem(subsystem)
 {
     try {
-        PNG png(filename + ".png", zip);
+        PNG png(filename + ".png", zip, !subsystem.needs_pictures());
         /* setup font operations */
         FontOperations fo;
         if (zip) {
@@ -36,7 +36,7 @@ int Icon::get_hotspot_y() const {
 
 void Icon::create_tile(const std::string& filename, ZipReader *zip) throw (Exception) {
     try {
-        PNG png(filename, zip);
+        PNG png(filename, zip, !subsystem.needs_pictures());
         TileGraphic *tg = subsystem.create_tilegraphic(png.get_width(), png.get_height());
         bool linear = (atoi(get_value("linear").c_str()) != 0 ? true : false);
         tg->punch_out_tile(png, 0, 0, false, linear);
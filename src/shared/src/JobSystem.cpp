@@ -0,0 +1,222 @@
+#include "JobSystem.hpp"
+#include "AllocationTracker.hpp"
+
+#ifdef __unix__
+#include <unistd.h>
+#endif
+
+static const size_t MaxDefaultWorkers = 7;
+
+struct JobSystem::sync_t {
+#ifdef __unix__
+    pthread_mutex_t mutex;
+    pthread_cond_t work;
+    pthread_cond_t done;
+#elif _WIN32
+    CRITICAL_SECTION mutex;
+    CONDITION_VARIABLE work;
+    CONDITION_VARIABLE done;
+#endif
+};
+
+JobSystem::Worker::Worker(JobSystem& owner) : owner(owner) { }
+
+JobSystem::Worker::~Worker() { }
+
+bool JobSystem::Worker::start() {
+    return thread_start();
+}
+
+void JobSystem::Worker::join() {
+    thread_join();
+}
+
+void JobSystem::Worker::thread() {
+    owner.work();
+}
+
+JobSystem::JobSystem(size_t workers) throw (JobSystemException)
+    : sync(0), current_job(0), next_index(0), job_count(0), pending(0),
+      quit(false)
+{
+    try {
+        sync = new sync_t;
+    } catch (const std::exception& e) {
+        throw JobSystemException(e.what());
+    }
+#ifdef __unix__
+    pthread_mutex_init(&sync->mutex, 0);
+    pthread_cond_init(&sync->work, 0);
+    pthread_cond_init(&sync->done, 0);
+#elif _WIN32
+    InitializeCriticalSection(&sync->mutex);
+    InitializeConditionVariable(&sync->work);
+    InitializeConditionVariable(&sync->done);
+#endif
+
+    for (size_t i = 0; i < workers; i++) {
+        Worker *worker = new Worker(*this);
+        if (!worker->start()) {
+            delete worker;
+            break;
+        }
+        this->workers.push_back(worker);
+    }
+}
+
+JobSystem::~JobSystem() {
+    lock();
+    quit = true;
+    wake_workers();
+    unlock();
+
+    for (Workers::iterator it = workers.begin(); it != workers.end(); it++) {
+        (*it)->join();
+        delete *it;
+    }
+
+#ifdef __unix__
+    pthread_cond_destroy(&sync->done);
+    pthread_cond_destroy(&sync->work);
+    pthread_mutex_destroy(&sync->mutex);
+#elif _WIN32
+    DeleteCriticalSection(&sync->mutex);
+#endif
+    delete sync;
+}
+
+size_t JobSystem::get_worker_count() const {
+    return workers.size();
+}
+
+void JobSystem::run(Job& job, size_t count) {
+    /* nothing to share, or a tracked caller that has to see every allocation */
+    if (workers.empty() || count < 2 || AllocationTracker::is_attached()) {
+        run_inline(job, count);
+        return;
+    }
+
+    /* pool is busy with another caller */
+    lock();
+    if (current_job) {
+        unlock();
+        run_inline(job, count);
+        return;
+    }
+
+    current_job = &job;
+    next_index = 0;
+    job_count = count;
+    pending = count;
+    wake_workers();
+
+    /* help out */
+    while (next_index < job_count) {
+        size_t index = next_index++;
+        unlock();
+        job.execute(index);
+        lock();
+        pending--;
+    }
+
+    while (pending) {
+        wait_for_completion();
+    }
+    current_job = 0;
+    unlock();
+}
+
+void JobSystem::run_inline(Job& job, size_t count) {
+    for (size_t i = 0; i < count; i++) {
+        job.execute(i);
+    }
+}
+
+size_t JobSystem::get_default_worker_count() {
+    long cpus = 1;
+#ifdef __unix__
+    cpus = sysconf(_SC_NPROCESSORS_ONLN);
+#elif _WIN32
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    cpus = static_cast<long>(info.dwNumberOfProcessors);
+#endif
+    if (cpus < 2) {
+        return 0;
+    }
+
+    size_t workers = static_cast<size_t>(cpus - 1);
+
+    return (workers > MaxDefaultWorkers ? MaxDefaultWorkers : workers);
+}
+
+void JobSystem::lock() {
+#ifdef __unix__
+    pthread_mutex_lock(&sync->mutex);
+#elif _WIN32
+    EnterCriticalSection(&sync->mutex);
+#endif
+}
+
+void JobSystem::unlock() {
+#ifdef __unix__
+    pthread_mutex_unlock(&sync->mutex);
+#elif _WIN32
+    LeaveCriticalSection(&sync->mutex);
+#endif
+}
+
+void JobSystem::wait_for_work() {
+#ifdef __unix__
+    pthread_cond_wait(&sync->work, &sync->mutex);
+#elif _WIN32
+    SleepConditionVariableCS(&sync->work, &sync->mutex, INFINITE);
+#endif
+}
+
+void JobSystem::wait_for_completion() {
+#ifdef __unix__
+    pthread_cond_wait(&sync->done, &sync->mutex);
+#elif _WIN32
+    SleepConditionVariableCS(&sync->done, &sync->mutex, INFINITE);
+#endif
+}
+
+void JobSystem::wake_workers() {
+#ifdef __unix__
+    pthread_cond_broadcast(&sync->work);
+#elif _WIN32
+    WakeAllConditionVariable(&sync->work);
+#endif
+}
+
+void JobSystem::wake_caller() {
+#ifdef __unix__
+    pthread_cond_signal(&sync->done);
+#elif _WIN32
+    WakeConditionVariable(&sync->done);
+#endif
+}
+
+void JobSystem::work() {
+    lock();
+    while (true) {
+        while (!quit && (!current_job || next_index >= job_count)) {
+            wait_for_work();
+        }
+        if (quit) {
+            break;
+        }
+
+        Job *job = current_job;
+        size_t index = next_index++;
+        unlock();
+        job->execute(index);
+        lock();
+        pending--;
+        if (!pending) {
+            wake_caller();
+        }
+    }
+    unlock();
+}
@@ -154,6 +154,11 @@ void KeyValue::clear() {
     entries.clear();
 }
 
+void KeyValue::discard_value(const std::string& key) {
+    /* frees a parsed entry, the file itself stays untouched */
+    entries.erase(key);
+}
+
 uint32_t KeyValue::get_hash_value() const {
     return hash_value;
 }
@@ -7,12 +7,27 @@ Lightmap::Lightmap(Subsystem& subsystem, const std::string& filename, ZipReader
     throw (LightmapException)
     : subsystem(subsystem), tile(0), width(0), height(0), alpha(0.85f)
 {
-    try {
-        create_tile(filename + ".lmp", zip);
-    } catch (const LightmapException&) {
-        throw;
-    } catch (const Exception& e) {
-        throw LightmapException(e.what());
+    PNG *image = load_image(filename, zip);
+    if (image) {
+        try {
+            create_tiles(*image);
+        } catch (const Exception& e) {
+            delete image;
+            throw LightmapException(e.what());
+        }
+        delete image;
+    }
+}
+
+Lightmap::Lightmap(Subsystem& subsystem, PNG *image) throw (LightmapException)
+    : subsystem(subsystem), tile(0), width(0), height(0), alpha(0.85f)
+{
+    if (image) {
+        try {
+            create_tiles(*image);
+        } catch (const Exception& e) {
+            throw LightmapException(e.what());
+        }
     }
 }
 
@@ -36,41 +51,51 @@ float Lightmap::get_alpha() const {
     return alpha;
 }
 
-void Lightmap::create_tile(const std::string& filename, ZipReader *zip) throw (Exception) {
-    if ((zip ? zip->file_exists(filename) : file_exists(filename))) {
-        try {
-            PNG png(filename, zip);
-            width = static_cast<int>(png.get_width() / LightMapSize);
-            height = static_cast<int>(png.get_height() / LightMapSize);
-            tile = new Tile **[height];
-            for (int y = 0; y < height; y++) {
-                tile[y] = new Tile *[width];
-                for (int x = 0; x < width; x++) {
-                    tile[y][x] = 0;
-                }
+PNG *Lightmap::load_image(const std::string& filename, ZipReader *zip) throw (LightmapException) {
+    std::string lmp_filename(filename + ".lmp");
+    if (!(zip ? zip->file_exists(lmp_filename) : file_exists(lmp_filename))) {
+        return 0;
+    }
+
+    try {
+        return new PNG(lmp_filename, zip);
+    } catch (const Exception& e) {
+        throw LightmapException(e.what());
+    }
+}
+
+void Lightmap::create_tiles(PNG& png) throw (Exception) {
+    try {
+        width = static_cast<int>(png.get_width() / LightMapSize);
+        height = static_cast<int>(png.get_height() / LightMapSize);
+        tile = new Tile **[height];
+        for (int y = 0; y < height; y++) {
+            tile[y] = new Tile *[width];
+            for (int x = 0; x < width; x++) {
+                tile[y][x] = 0;
             }
+        }
 
-            int tx = 0;
-            int ty = 0;
-            int w = width * LightMapSize;
-            int h = height * LightMapSize;
-            for (int y = 0; y < h; y += LightMapSize) {
-                for (int x = 0; x < w; x += LightMapSize) {
-                    TileGraphic *tg = subsystem.create_tilegraphic(LightMapSize, LightMapSize);
-                    if (tg->punch_out_lightmap(png, x, y)) {
-                        delete tg;
-                    } else {
-                        tile[ty][tx] = new Tile(tg, false, Tile::TileTypeNonblocking, 0, true, 0.0f);
-                    }
-                    tx++;
+        int tx = 0;
+        int ty = 0;
+        int w = width * LightMapSize;
+        int h = height * LightMapSize;
+        for (int y = 0; y < h; y += LightMapSize) {
+            for (int x = 0; x < w; x += LightMapSize) {
+                TileGraphic *tg = subsystem.create_tilegraphic(LightMapSize, LightMapSize);
+                if (tg->punch_out_lightmap(png, x, y)) {
+                    delete tg;
+                } else {
+                    tile[ty][tx] = new Tile(tg, false, Tile::TileTypeNonblocking, 0, true, 0.0f);
                 }
-                tx = 0;
-                ty++;
+                tx++;
             }
-        } catch (const Exception&) {
-            cleanup();
-            throw;
+            tx = 0;
+            ty++;
         }
+    } catch (const Exception&) {
+        cleanup();
+        throw;
     }
 }
 
@@ -1,15 +1,87 @@
 #include "Map.hpp"
+#include "Scope.hpp"
 
 #include <cstdlib>
 
-Map::Map(Subsystem& subsystem) : subsystem(subsystem) {
+MapArrays::MapArrays(int width, int height) throw (MutexException)
+    : refs(1), width(width), height(height),
+      map(create_array(0, 0, 0)), decoration(create_array(0, 0, 0)) { }
+
+MapArrays::MapArrays(const MapArrays& rhs, int width, int height) throw (MutexException)
+    : refs(1), width(width), height(height),
+      map(create_array(rhs.map, rhs.width, rhs.height)),
+      decoration(create_array(rhs.decoration, rhs.width, rhs.height)) { }
+
+MapArrays::~MapArrays() {
+    destroy_array(map);
+    destroy_array(decoration);
+}
+
+MapArrays *MapArrays::acquire() {
+    Scope<Mutex> lock(mtx);
+    refs++;
+
+    return this;
+}
+
+bool MapArrays::release() {
+    Scope<Mutex> lock(mtx);
+    refs--;
+
+    return (refs == 0);
+}
+
+bool MapArrays::is_shared() {
+    Scope<Mutex> lock(mtx);
+
+    return (refs > 1);
+}
+
+int MapArrays::get_width() const {
+    return width;
+}
+
+int MapArrays::get_height() const {
+    return height;
+}
+
+short **MapArrays::get_map() {
+    return map;
+}
+
+short **MapArrays::get_decoration() {
+    return decoration;
+}
+
+short **MapArrays::create_array(short **from, int from_width, int from_height) {
+    short **array = new short *[height];
+    for (int y = 0; y < height; y++) {
+        array[y] = new short[width];
+        for (int x = 0; x < width; x++) {
+            if (x < from_width && y < from_height) {
+                array[y][x] = from[y][x];
+            } else {
+                array[y][x] = -1;
+            }
+        }
+    }
+
+    return array;
+}
+
+void MapArrays::destroy_array(short **array) {
+    for (int y = 0; y < height; y++) {
+        delete[] array[y];
+    }
+    delete[] array;
+}
+
+Map::Map(Subsystem& subsystem) : subsystem(subsystem), preview_tried(false) {
     parallax = 0;
     decoration_brightness = 0.0f;
     lightmap_alpha = 0.0f;
-    width = 100;
-    height = 100;
-    map = create_map(width, height);
-    decoration = create_map(width, height);
+    arrays = new MapArrays(100, 100);
+    bind_arrays();
     lightmap = 0;
     preview = 0;
     game_play_type = GamePlayTypeDM;
@@ -20,31 +92,23 @@ Map::Map(Subsystem& subsystem, const std::string& filename, ZipReader *zip)
     throw (KeyValueException, MapException)
     : Properties(filename + ".map", zip), subsystem(subsystem), filename(filename),
       tileset(get_value("tileset")),
-      background(get_value("background"))
+      background(get_value("background")), preview_tried(false), arrays(0)
 {
     try {
-        parallax = atoi(get_value("parallax_shift").c_str());
-        decoration_brightness = atof(get_value("decoration_brightness").c_str());
-        lightmap_alpha = atof(get_value("lightmap_alpha").c_str());
-        if (lightmap_alpha < 0.05f) {
-            lightmap_alpha = 0.85f;
-        }
-
-        game_play_type = static_cast<GamePlayType>(atoi(get_value("game_play_type").c_str()));
-        frog_spawn_init = atoi(get_value("frog_spawn_init").c_str());
+        read_header();
 
         /* create map array */
-        width = atoi(get_value("width").c_str());
-        height = atoi(get_value("height").c_str());
-        map = create_map(width, height);
-        decoration = create_map(width, height);
+        arrays = new MapArrays(width, height);
+        bind_arrays();
         if (zip) {
             zip_filename = zip->get_zip_filename();
         }
-        fill_map();
+        fill_map(*this);
     } catch (const MapException&) {
+        cleanup();
         throw;
     } catch (const Exception& e) {
+        cleanup();
         throw MapException(e.what());
     }
     lightmap = 0;
@@ -62,6 +126,16 @@ Map::Map(Subsystem& subsystem, const std::string& filename, ZipReader *zip)
     }
 }
 
+Map::Map(Subsystem& subsystem, const std::string& filename, const std::string& zip_filename,
+    const std::string& pak_hash, const std::string& cache_filename) throw (KeyValueException, MapException)
+    : Properties(cache_filename + ".map"), subsystem(subsystem), filename(filename),
+      tileset(get_value("tileset")), background(get_value("background")),
+      lightmap(0), map(0), decoration(0), preview(0), zip_filename(zip_filename),
+      pak_hash(pak_hash), cache_filename(cache_filename), preview_tried(false), arrays(0)
+{
+    read_header();
+}
+
 Map::Map(const Map& rhs)
     : Properties(rhs),
       subsystem(rhs.subsystem),
@@ -77,24 +151,24 @@ Map::Map(const Map& rhs)
       preview(0),
       game_play_type(rhs.game_play_type),
       frog_spawn_init(rhs.frog_spawn_init),
-      zip_filename(rhs.zip_filename)
+      zip_filename(rhs.zip_filename),
+      pak_hash(rhs.pak_hash),
+      cache_filename(rhs.cache_filename),
+      preview_tried(false),
+      arrays(0)
 {
-    /* copy map */
-    map = new short *[height];
-    for (int y = 0; y < height; y++) {
-        map[y] = new short[width];
-        for (int x = 0; x < width; x++) {
-            map[y][x] = rhs.map[y][x];
+    /* no copy, the arrays are shared until someone writes */
+    {
+        Scope<Mutex> lock(rhs.mtx);
+        if (rhs.arrays) {
+            arrays = rhs.arrays->acquire();
         }
     }
-
-    /* copy decoration */
-    decoration = new short *[height];
-    for (int y = 0; y < height; y++) {
-        decoration[y] = new short[width];
-        for (int x = 0; x < width; x++) {
-            decoration[y][x] = rhs.decoration[y][x];
-        }
+    if (arrays) {
+        bind_arrays();
+    } else {
+        map = 0;
+        decoration = 0;
     }
 }
 
@@ -159,20 +233,49 @@ double Map::get_lightmap_alpha() const {
 }
 
 void Map::create_lightmap() {
+    PNG *image = load_lightmap_image();
+    try {
+        create_lightmap(image);
+    } catch (...) {
+        delete image;
+        throw;
+    }
+    delete image;
+}
+
+void Map::create_lightmap(PNG *image) {
     if (lightmap) {
         delete lightmap;
     }
 
+    lightmap = new Lightmap(subsystem, image);
+    lightmap->set_alpha(static_cast<float>(lightmap_alpha));
+}
+
+PNG *Map::load_lightmap_image() const throw (LightmapException) {
+    /* the shared reader of the pak, reads from several threads are safe */
     if (zip_filename.length()) {
-        ZipReader zip(zip_filename);
-        lightmap = new Lightmap(subsystem, filename, &zip);
-    } else {
-        lightmap = new Lightmap(subsystem, filename);
+        try {
+            SharedZipReader zip(zip_filename);
+            check_pak(zip.get());
+            return Lightmap::load_image(filename, zip.get());
+        } catch (const ZipReaderException& e) {
+            throw LightmapException(e.what());
+        } catch (const MapException& e) {
+            throw LightmapException(e.what());
+        }
     }
-    lightmap->set_alpha(static_cast<float>(lightmap_alpha));
+
+    return Lightmap::load_image(filename);
 }
 
 Tile *Map::get_preview() {
+    /* maps from the cache make it when the picker first shows them */
+    if (!preview && !preview_tried && cache_filename.length()) {
+        preview_tried = true;
+        load_preview();
+    }
+
     return preview;
 }
 
@@ -184,28 +287,104 @@ int Map::get_frog_spawn_init() const {
     return frog_spawn_init;
 }
 
-short **Map::create_map(int width, int height) {
-    short **map = new short *[height];
-    for (int y = 0; y < height; y++) {
-        map[y] = new short[width];
-        for (int x = 0; x < width; x++) {
-            map[y][x] = -1;
+void Map::load() throw (MapException) {
+    /* servers sharing the resources may ask at the same time */
+    Scope<Mutex> lock(mtx);
+    if (arrays) {
+        return;
+    }
+
+    try {
+        KeyValue body;
+        if (zip_filename.length()) {
+            /* an unchanged pak is not hashed again, read() only reads */
+            SharedZipReader zip(zip_filename);
+            check_pak(zip.get());
+            body.read(filename + ".map", zip.get());
+        } else {
+            body.read(filename + ".map");
         }
+        arrays = new MapArrays(width, height);
+        bind_arrays();
+        fill_map(body);
+    } catch (const Exception& e) {
+        cleanup();
+        map = 0;
+        decoration = 0;
+        throw MapException(e.what());
     }
+}
 
-    return map;
+void Map::read_header() {
+    width = atoi(get_value("width").c_str());
+    height = atoi(get_value("height").c_str());
+    parallax = atoi(get_value("parallax_shift").c_str());
+    decoration_brightness = atof(get_value("decoration_brightness").c_str());
+    lightmap_alpha = atof(get_value("lightmap_alpha").c_str());
+    if (lightmap_alpha < 0.05f) {
+        lightmap_alpha = 0.85f;
+    }
+
+    game_play_type = static_cast<GamePlayType>(atoi(get_value("game_play_type").c_str()));
+    frog_spawn_init = atoi(get_value("frog_spawn_init").c_str());
+}
+
+/* the pak may have been replaced since the header was cached, the
+   tiles of the new one would not fit the header */
+void Map::check_pak(ZipReader *zip) const throw (MapException) {
+    if (pak_hash.length() && zip->get_hash() != pak_hash) {
+        throw MapException("Package " + zip_filename + " has changed since " + filename + " was cached");
+    }
+}
+
+void Map::load_preview() {
+    try {
+        MapCache::Thumbnail thumbnail;
+        if (!MapCache::read_thumbnail(cache_filename, thumbnail)) {
+            SharedZipReader zip(zip_filename);
+            check_pak(zip.get());
+            PNG png(filename + ".png", zip.get());
+            MapCache::create_thumbnail(png, thumbnail);
+            MapCache::write_thumbnail(cache_filename, thumbnail);
+        }
+        TileGraphic *tg = subsystem.create_tilegraphic(thumbnail.width, thumbnail.height);
+        tg->add_tile(thumbnail.bytes_per_pixel, &thumbnail.pixels[0], false, false);
+        preview = new Tile(tg, false, Tile::TileTypeNonblocking, 0, true, 0.0f);
+    } catch (const Exception&) {
+        /* chomp */
+    }
+}
+
+void Map::bind_arrays() {
+    width = arrays->get_width();
+    height = arrays->get_height();
+    map = arrays->get_map();
+    decoration = arrays->get_decoration();
+}
+
+void Map::detach_arrays() {
+    if (arrays->is_shared()) {
+        resize_arrays(width, height);
+    }
 }
 
-void Map::fill_map() throw (Exception) {
-    fill_map_array("decoration", decoration);
-    fill_map_array("tiles", map);
+void Map::resize_arrays(int new_width, int new_height) {
+    MapArrays *new_arrays = new MapArrays(*arrays, new_width, new_height);
+    cleanup();
+    arrays = new_arrays;
+    bind_arrays();
+}
+
+void Map::fill_map(const KeyValue& from) throw (Exception) {
+    fill_map_array(from, "decoration", decoration);
+    fill_map_array(from, "tiles", map);
 }
 
-void Map::fill_map_array(const char *prefix, short **into) {
+void Map::fill_map_array(const KeyValue& from, const char *prefix, short **into) {
     char kvb[128];
     for (int y = 0; y < height; y++) {
         sprintf(kvb, "%s%d", prefix, y);
-        std::string line = get_value(kvb);
+        std::string line = from.get_value(kvb);
         std::string tileno;
         int x = 0;
         while (x < width && line.length()) {
@@ -220,14 +399,17 @@ void Map::fill_map_array(const char *prefix, short **into) {
             into[y][x] = atoi(tileno.c_str());
             x++;
         }
+
+        /* the array holds it now, no need to keep the text in every copy */
+        if (&from == this) {
+            discard_value(kvb);
+        }
     }
 }
 
 void Map::cleanup() {
-    for (int y = 0; y < height; y++) {
-        delete[] map[y];
-        delete[] decoration[y];
+    if (arrays && arrays->release()) {
+        delete arrays;
     }
-    delete[] map;
-    delete[] decoration;
+    arrays = 0;
 }
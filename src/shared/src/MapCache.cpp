@@ -0,0 +1,187 @@
+#include "MapCache.hpp"
+#include "Utils.hpp"
+#include "Globals.hpp"
+#include "Mutex.hpp"
+#include "Scope.hpp"
+
+#include <fstream>
+#include <sstream>
+#include <cstdio>
+#include <cstring>
+
+#ifdef __unix__
+#include <arpa/inet.h>
+#include <unistd.h>
+#elif _WIN32
+#include "Win.hpp"
+#endif
+
+static const char *CacheDirectory = "cache";
+static const char *HeaderSuffix = ".map";
+static const char *ThumbnailSuffix = ".thumb";
+static const char ThumbnailMagic[] = "GTN1";
+static const size_t ThumbnailMagicLength = 4;
+
+static Mutex tmp_mtx;
+static unsigned int tmp_counter = 0;
+
+/* unique among the servers of this process and other processes, two
+   writers of the same entry never share a temporary file */
+static std::string get_tmp_filename(const std::string& filename) {
+    unsigned int counter;
+    {
+        Scope<Mutex> lock(tmp_mtx);
+        counter = tmp_counter++;
+    }
+
+    std::ostringstream tmp_filename;
+#ifdef __unix__
+    tmp_filename << filename << "." << getpid() << "." << counter << ".tmp";
+#elif _WIN32
+    tmp_filename << filename << "." << GetCurrentProcessId() << "." << counter << ".tmp";
+#endif
+
+    return tmp_filename.str();
+}
+
+/* the old file stays in place until the new one replaces it */
+static bool replace_file(const std::string& tmp_filename, const std::string& filename) {
+#ifdef __unix__
+    bool replaced = !rename(tmp_filename.c_str(), filename.c_str());
+#elif _WIN32
+    bool replaced = (MoveFileExA(tmp_filename.c_str(), filename.c_str(), MOVEFILE_REPLACE_EXISTING) != 0);
+#endif
+    if (!replaced) {
+        remove(tmp_filename.c_str());
+    }
+
+    return replaced;
+}
+
+std::string MapCache::get_cache_filename(const std::string& pak_hash, const std::string& map_filename) {
+    try {
+        std::string directory = get_home_directory() + dir_separator + UserDirectory;
+        create_directory(CacheDirectory, directory);
+        directory += dir_separator + std::string(CacheDirectory);
+        create_directory(pak_hash, directory);
+        directory += dir_separator + pak_hash;
+
+        /* entries in paks are always separated by slashes */
+        size_t pos = map_filename.rfind('/');
+        std::string name = (pos == std::string::npos ? map_filename : map_filename.substr(pos + 1));
+
+        return directory + dir_separator + name;
+    } catch (const UtilsException&) {
+        /* chomp */
+    }
+
+    return "";
+}
+
+bool MapCache::has_header(const std::string& cache_filename) {
+    return (cache_filename.length() && file_exists(cache_filename + HeaderSuffix));
+}
+
+void MapCache::write_header(const std::string& cache_filename, const KeyValue& header) {
+    if (!cache_filename.length()) {
+        return;
+    }
+
+    /* write aside and rename, a crash never leaves half a header */
+    std::string filename(cache_filename + HeaderSuffix);
+    std::string tmp_filename(get_tmp_filename(filename));
+    {
+        std::ofstream f(tmp_filename.c_str());
+        if (!f.is_open()) {
+            return;
+        }
+        const KeyValue::Entries& entries = header.get_entries();
+        for (KeyValue::Entries::const_iterator it = entries.begin(); it != entries.end(); it++) {
+            f << it->first << "=" << it->second << std::endl;
+        }
+        f.close();
+        if (!f) {
+            remove(tmp_filename.c_str());
+            return;
+        }
+    }
+    replace_file(tmp_filename, filename);
+}
+
+void MapCache::create_thumbnail(const PNG& png, Thumbnail& thumbnail) {
+    /* the upper left corner, like the previews of fully loaded maps */
+    int png_width = static_cast<int>(png.get_width());
+    int png_height = static_cast<int>(png.get_height());
+    thumbnail.width = (png_width < ThumbnailSize ? png_width : ThumbnailSize);
+    thumbnail.height = (png_height < ThumbnailSize ? png_height : ThumbnailSize);
+    thumbnail.bytes_per_pixel = (png.get_color_format() == PNG::ColorFormatRGBA ? 4 : 3);
+
+    size_t row_len = thumbnail.width * thumbnail.bytes_per_pixel;
+    thumbnail.pixels.resize(row_len * thumbnail.height);
+    for (int y = 0; y < thumbnail.height; y++) {
+        memcpy(&thumbnail.pixels[y * row_len], png.get_pic() + y * png_width * thumbnail.bytes_per_pixel, row_len);
+    }
+}
+
+bool MapCache::read_thumbnail(const std::string& cache_filename, Thumbnail& thumbnail) {
+    if (!cache_filename.length()) {
+        return false;
+    }
+
+    std::string filename(cache_filename + ThumbnailSuffix);
+    std::ifstream f(filename.c_str(), std::ifstream::in | std::ifstream::binary);
+    if (!f.is_open()) {
+        return false;
+    }
+
+    char magic[ThumbnailMagicLength];
+    uint32_t header[3];
+    f.read(magic, ThumbnailMagicLength);
+    f.read(reinterpret_cast<char *>(header), sizeof(header));
+    if (!f || memcmp(magic, ThumbnailMagic, ThumbnailMagicLength)) {
+        return false;
+    }
+
+    thumbnail.width = static_cast<int>(ntohl(header[0]));
+    thumbnail.height = static_cast<int>(ntohl(header[1]));
+    thumbnail.bytes_per_pixel = static_cast<int>(ntohl(header[2]));
+    if (thumbnail.width < 1 || thumbnail.width > ThumbnailSize ||
+        thumbnail.height < 1 || thumbnail.height > ThumbnailSize ||
+        (thumbnail.bytes_per_pixel != 3 && thumbnail.bytes_per_pixel != 4))
+    {
+        return false;
+    }
+
+    thumbnail.pixels.resize(thumbnail.width * thumbnail.height * thumbnail.bytes_per_pixel);
+    f.read(reinterpret_cast<char *>(&thumbnail.pixels[0]), thumbnail.pixels.size());
+
+    return (f.good());
+}
+
+void MapCache::write_thumbnail(const std::string& cache_filename, const Thumbnail& thumbnail) {
+    if (!cache_filename.length() || !thumbnail.pixels.size()) {
+        return;
+    }
+
+    std::string filename(cache_filename + ThumbnailSuffix);
+    std::string tmp_filename(get_tmp_filename(filename));
+    {
+        std::ofstream f(tmp_filename.c_str(), std::ofstream::out | std::ofstream::binary | std::ofstream::trunc);
+        if (!f.is_open()) {
+            return;
+        }
+        uint32_t header[3];
+        header[0] = htonl(static_cast<uint32_t>(thumbnail.width));
+        header[1] = htonl(static_cast<uint32_t>(thumbnail.height));
+        header[2] = htonl(static_cast<uint32_t>(thumbnail.bytes_per_pixel));
+        f.write(ThumbnailMagic, ThumbnailMagicLength);
+        f.write(reinterpret_cast<const char *>(header), sizeof(header));
+        f.write(reinterpret_cast<const char *>(&thumbnail.pixels[0]), thumbnail.pixels.size());
+        f.close();
+        if (!f) {
+            remove(tmp_filename.c_str());
+            return;
+        }
+    }
+    replace_file(tmp_filename, filename);
+}
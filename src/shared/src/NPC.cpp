@@ -5,7 +5,7 @@
 
 NPC::NPC(Subsystem& subsystem, const std::string& filename, ZipReader *zip)
     throw (KeyValueException, MovableException)
-    : Properties(filename + ".npc", zip), Movable(subsystem)
+    : Properties(filename + ".npc", zip), Movable(subsystem), kill_sound(0)
 {
     try {
         read_base_informations(*this);
@@ -69,8 +69,8 @@ int NPC::get_move_init() const {
     return move_init;
 }
 
-int NPC::get_move_init_randomized() const {
-    return (rand() % move_init + move_init);
+int NPC::get_move_init_randomized(Random& random) const {
+    return (random.next() % move_init + move_init);
 }
 
 double NPC::get_jump_x_impulse() const {
@@ -81,12 +81,12 @@ double NPC::get_jump_y_impulse() const {
     return jump_y_impulse;
 }
 
-double NPC::get_jump_x_impulse_randomized() const {
-    return (rand() % static_cast<int>(jump_x_impulse * 100)) / 100.0f + jump_x_impulse;
+double NPC::get_jump_x_impulse_randomized(Random& random) const {
+    return (random.next() % static_cast<int>(jump_x_impulse * 100)) / 100.0f + jump_x_impulse;
 }
 
-double NPC::get_jump_y_impulse_randomized() const {
-    return (rand() % static_cast<int>(jump_y_impulse * 100)) / 100.0f + jump_y_impulse;
+double NPC::get_jump_y_impulse_randomized(Random& random) const {
+    return (random.next() % static_cast<int>(jump_y_impulse * 100)) / 100.0f + jump_y_impulse;
 }
 
 double NPC::get_max_accel_x() const {
@@ -121,10 +121,18 @@ double NPC::get_ignore_owner_counter() const {
     return ignore_owner_counter;
 }
 
+Sound *NPC::get_kill_sound() const {
+    return kill_sound;
+}
+
+void NPC::set_kill_sound(Sound *sound) {
+    kill_sound = sound;
+}
+
 void NPC::create_npc(NPCAnimation type, const std::string& filename,
     int animation_speed, bool one_shot, ZipReader *zip) throw (Exception)
 {
-    PNG png(filename, zip);
+    PNG png(filename, zip, !subsystem.needs_pictures());
     tiles[DirectionRight][type] = create_tile(png, animation_speed, one_shot, false);
     png.flip_h();
     tiles[DirectionLeft][type] = create_tile(png, animation_speed, one_shot, true);
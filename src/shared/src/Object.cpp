@@ -88,7 +88,7 @@ void Object::create_tile(const std::string& filename, ZipReader *zip) throw (Exc
         bool background = (atoi(get_value("background").c_str()) == 0 ? false : true);
         bool one_shot = (atoi(get_value("one_shot").c_str()) != 0 ? true : false);
 
-        PNG png(filename, zip);
+        PNG png(filename, zip, !subsystem.needs_pictures());
 
         const int& png_width = png.get_width();
         const int& png_height = png.get_height();
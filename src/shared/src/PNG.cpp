@@ -4,6 +4,12 @@
 #include <cstring>
 #include <cerrno>
 
+/* signature and IHDR chunk */
+static const size_t PNGIHDREnd = 33;
+
+/* enough for the largest palette and tRNS chunks behind IHDR */
+static const size_t PNGHeadLength = 2048;
+
 PNG::PNG(const std::string& filename, ZipReader *zip) throw (PNGException) {
     if (zip) {
         read_png_from_zip(filename, zip);
@@ -12,6 +18,16 @@ PNG::PNG(const std::string& filename, ZipReader *zip) throw (PNGException) {
     }
 }
 
+PNG::PNG(const std::string& filename, ZipReader *zip, bool header_only) throw (PNGException) {
+    if (header_only) {
+        read_png_header(filename, zip);
+    } else if (zip) {
+        read_png_from_zip(filename, zip);
+    } else {
+        read_png_from_file(filename);
+    }
+}
+
 PNG::~PNG() {
     delete[] pic;
 }
@@ -28,7 +44,7 @@ void PNG::flip_h() {
             break;
     }
 
-    if (bytes_per_pixel) {
+    if (bytes_per_pixel && pic) {
         unsigned int row_bytes = width * bytes_per_pixel;
         unsigned char *new_pic = new unsigned char[row_bytes * height];
 
@@ -61,7 +77,7 @@ void PNG::flip_v() {
             break;
     }
 
-    if (bytes_per_pixel) {
+    if (bytes_per_pixel && pic) {
         unsigned int row_bytes = width * bytes_per_pixel;
         unsigned char *new_pic = new unsigned char[row_bytes * height];
 
@@ -290,6 +306,109 @@ void PNG::read_png_from_zip(const std::string& filename, ZipReader *zip) throw (
     }
 }
 
+void PNG::read_png_header(const std::string& filename, ZipReader *zip) throw (PNGException) {
+    /* signature, then the IHDR chunk: length, type and 13 bytes of data,
+       palette images need the chunks up to the image data as well */
+    png_byte header[PNGHeadLength];
+    size_t sz = read_png_head(filename, zip, header, PNGIHDREnd);
+
+    /* check header */
+    if (sz < 8 || png_sig_cmp(header, 0, 8)) {
+        throw PNGException("File is not recognized as PNG file: " + filename);
+    }
+    if (sz != PNGIHDREnd || memcmp(header + 12, "IHDR", 4)) {
+        throw PNGException("Corrupt PNG header: " + filename);
+    }
+
+    width = static_cast<unsigned int>(png_get_uint_32(header + 16));
+    height = static_cast<unsigned int>(png_get_uint_32(header + 20));
+    bit_depth = header[24];
+    pic = 0;
+
+    /* the same formats the full decode accepts after expanding */
+    switch (header[25]) {
+        case PNG_COLOR_TYPE_RGB:
+            color_format = ColorFormatRGB;
+            break;
+
+        case PNG_COLOR_TYPE_RGBA:
+            color_format = ColorFormatRGBA;
+            break;
+
+        case PNG_COLOR_TYPE_PALETTE:
+        {
+            /* expanding makes it RGBA if there is a tRNS chunk */
+            bit_depth = 8;
+            bool transparent = false;
+            sz = read_png_head(filename, zip, header, PNGHeadLength);
+            if (!find_trns_chunk(header, sz, transparent)) {
+                /* the palette chunks do not fit in the head, decode it */
+                if (zip) {
+                    read_png_from_zip(filename, zip);
+                } else {
+                    read_png_from_file(filename);
+                }
+                delete[] pic;
+                pic = 0;
+                return;
+            }
+            color_format = (transparent ? ColorFormatRGBA : ColorFormatRGB);
+            break;
+        }
+
+        default:
+            throw PNGException("Unrecognized PNG color type: " + filename);
+            break;
+    }
+
+    if (bit_depth != 8) {
+        throw PNGException("Invalid PNG bit depth, must be 8: " + filename);
+    }
+}
+
+size_t PNG::read_png_head(const std::string& filename, ZipReader *zip, png_byte *head, size_t len) throw (PNGException) {
+    if (zip) {
+        try {
+            return zip->extract_head(filename, reinterpret_cast<char *>(head), len);
+        } catch (const ZipReaderException& e) {
+            throw PNGException(e.what());
+        }
+    }
+
+    FILE *f = fopen(filename.c_str(), "rb");
+    if (!f) {
+        throw PNGException("Cannot open PNG file " + filename + ": " +
+            std::string(strerror(errno)));
+    }
+    size_t sz = fread(head, 1, len, f);
+    fclose(f);
+
+    return sz;
+}
+
+bool PNG::find_trns_chunk(const png_byte *head, size_t sz, bool& found) {
+    /* walks the chunks after IHDR, a tRNS chunk has to come before IDAT */
+    size_t pos = PNGIHDREnd;
+    while (pos + 8 <= sz) {
+        png_uint_32 chunk_len = png_get_uint_32(head + pos);
+        const png_byte *type = head + pos + 4;
+        if (!memcmp(type, "tRNS", 4)) {
+            found = true;
+            return true;
+        }
+        if (!memcmp(type, "IDAT", 4) || !memcmp(type, "IEND", 4)) {
+            found = false;
+            return true;
+        }
+        if (chunk_len > sz) {
+            break;
+        }
+        pos += chunk_len + 12;
+    }
+
+    return false;
+}
+
 void PNG::user_data_read(png_structp png_ptr, png_bytep data, png_size_t len) {
     PNGZipStream *zs = static_cast<PNGZipStream *>(png_get_io_ptr(png_ptr));
     size_t remain = static_cast<size_t>(zs->size) - (zs->ptr - zs->data);
@@ -0,0 +1,156 @@
+#include "Profiler.hpp"
+
+#include <cstdio>
+#include <cerrno>
+#include <cstring>
+
+Profiler::Profiler() : trace_pos(0), trace_wrapped(false) {
+    get_now(epoch);
+}
+
+Profiler::~Profiler() { }
+
+size_t Profiler::add_phase(const char *name) {
+    phases.push_back(Phase(name));
+    AllocationTracker::set_phase_name(phases.size(), name);
+
+    return phases.size() - 1;
+}
+
+void Profiler::record(size_t phase, const gametime_t& start, const gametime_t& end) {
+    ns_t ns = diff_ns(start, end);
+    if (ns < 0) {
+        ns = 0;
+    }
+
+    Phase& ph = phases[phase];
+    ph.count++;
+    ph.total += ns;
+    if (ns > ph.max) {
+        ph.max = ns;
+    }
+    ph.buckets[get_bucket(ns)]++;
+
+    if (trace.size()) {
+        TraceEvent& evt = trace[trace_pos];
+        evt.phase = phase;
+        evt.start = start;
+        evt.duration = ns;
+        trace_pos++;
+        if (trace_pos >= trace.size()) {
+            trace_pos = 0;
+            trace_wrapped = true;
+        }
+    }
+}
+
+void Profiler::reset() {
+    for (Phases::iterator it = phases.begin(); it != phases.end(); it++) {
+        Phase& ph = *it;
+        ph.count = 0;
+        ph.total = 0;
+        ph.max = 0;
+        ph.buckets.assign(Buckets, 0);
+    }
+    trace_pos = 0;
+    trace_wrapped = false;
+}
+
+void Profiler::report(Report& lines) const {
+    char buffer[256];
+
+    for (Phases::const_iterator it = phases.begin(); it != phases.end(); it++) {
+        const Phase& ph = *it;
+        if (ph.count) {
+            sprintf(buffer, "%s: n=%lu avg=%.3fms p50=%.3fms p99=%.3fms max=%.3fms",
+                ph.name.c_str(), ph.count, ph.total / ph.count / 1000000.0,
+                get_percentile(ph, 50.0) / 1000000.0,
+                get_percentile(ph, 99.0) / 1000000.0,
+                ph.max / 1000000.0);
+        } else {
+            sprintf(buffer, "%s: n=0", ph.name.c_str());
+        }
+        lines.push_back(buffer);
+    }
+}
+
+void Profiler::enable_trace(size_t events) {
+    trace.resize(events);
+    trace_pos = 0;
+    trace_wrapped = false;
+}
+
+bool Profiler::is_tracing() const {
+    return (trace.size() != 0);
+}
+
+void Profiler::write_trace(const std::string& filename) const throw (ProfilerException) {
+    FILE *f = fopen(filename.c_str(), "wb");
+    if (!f) {
+        throw ProfilerException("Cannot open trace file " + filename + ": " + strerror(errno));
+    }
+
+    fprintf(f, "{\"traceEvents\":[\n");
+    size_t sz = (trace_wrapped ? trace.size() : trace_pos);
+    size_t pos = (trace_wrapped ? trace_pos : 0);
+    for (size_t i = 0; i < sz; i++) {
+        const TraceEvent& evt = trace[pos];
+        double ts = (evt.start.tv_sec - epoch.tv_sec) * 1000000.0 +
+            (evt.start.tv_nsec - epoch.tv_nsec) / 1000.0;
+        fprintf(f, "%s{\"name\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":1,\"ts\":%.3f,\"dur\":%.3f}\n",
+            (i ? "," : ""), phases[evt.phase].name.c_str(), ts, evt.duration / 1000.0);
+        pos++;
+        if (pos >= trace.size()) {
+            pos = 0;
+        }
+    }
+    fprintf(f, "],\"displayTimeUnit\":\"ms\"}\n");
+
+    if (fclose(f)) {
+        throw ProfilerException("Writing trace file " + filename + " failed");
+    }
+}
+
+size_t Profiler::get_bucket(ns_t ns) {
+    if (ns < SubBuckets) {
+        return static_cast<size_t>(ns > 0 ? ns : 0);
+    }
+
+    int msb = 0;
+    for (ns_t v = ns; v > 1; v >>= 1) {
+        msb++;
+    }
+    size_t sub = static_cast<size_t>((ns >> (msb - 2)) & (SubBuckets - 1));
+    size_t bucket = static_cast<size_t>(msb - 1) * SubBuckets + sub;
+
+    return (bucket < Buckets ? bucket : Buckets - 1);
+}
+
+ns_t Profiler::get_bucket_limit(size_t bucket) {
+    if (bucket < SubBuckets) {
+        return static_cast<ns_t>(bucket);
+    }
+
+    int shift = static_cast<int>(bucket / SubBuckets) - 1;
+    ns_t base = static_cast<ns_t>(SubBuckets + bucket % SubBuckets + 1);
+
+    return (base << shift) - 1;
+}
+
+ns_t Profiler::get_percentile(const Phase& phase, double percent) const {
+    unsigned long wanted = static_cast<unsigned long>(phase.count * percent / 100.0 + 0.5);
+    if (!wanted) {
+        wanted = 1;
+    }
+
+    unsigned long sum = 0;
+    for (size_t i = 0; i < Buckets; i++) {
+        sum += phase.buckets[i];
+        if (sum >= wanted) {
+            ns_t limit = get_bucket_limit(i);
+            return (limit < phase.max ? limit : phase.max);
+        }
+    }
+
+    return phase.max;
+}
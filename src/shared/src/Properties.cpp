@@ -1,15 +1,23 @@
 #include "Properties.hpp"
 
-Properties::Properties() { }
+Properties::Properties() : resource_index(0) { }
 
 Properties::Properties(const std::string& filename, ZipReader *zip) throw (KeyValueException)
-    : KeyValue(filename, zip), filename(filename)
+    : KeyValue(filename, zip), filename(filename), resource_index(0)
 {
     fetch();
 }
 
 Properties::~Properties() { }
 
+size_t Properties::get_resource_index() const {
+    return resource_index;
+}
+
+void Properties::set_resource_index(size_t index) {
+    resource_index = index;
+}
+
 const std::string& Properties::get_name() const {
     return name;
 }
@@ -0,0 +1,24 @@
+#include "Random.hpp"
+
+#include <ctime>
+
+Random::Random() : state(0) {
+    seed(static_cast<uint32_t>(time(0)) ^ static_cast<uint32_t>(reinterpret_cast<size_t>(this)));
+}
+
+Random::Random(uint32_t seed) : state(0) {
+    this->seed(seed);
+}
+
+void Random::seed(uint32_t seed) {
+    /* xorshift never leaves zero */
+    state = (seed ? seed : 1);
+}
+
+int Random::next() {
+    state ^= state << 13;
+    state ^= state >> 17;
+    state ^= state << 5;
+
+    return static_cast<int>(state >> 1);
+}
@@ -1,8 +1,11 @@
 #include "Resources.hpp"
+#include "JobSystem.hpp"
+#include "MapCache.hpp"
 #include "Utils.hpp"
 #include "Globals.hpp"
 
 #include <cstdlib>
+#include <cstring>
 #include <ctime>
 #include <algorithm>
 
@@ -41,6 +44,18 @@ static void erase_loaded_pak(Resources::LoadedPaks& paks, bool home_paks_only) {
     }
 }
 
+static bool erase_index_entry_home_only(Resources::IndexEntry& entry) {
+    return !entry.base_resource;
+}
+
+static void erase_index(Resources::IndexEntries& index, bool home_paks_only) {
+    if (home_paks_only) {
+        index.erase(std::remove_if(index.begin(), index.end(), erase_index_entry_home_only), index.end());
+    } else {
+        index.clear();
+    }
+}
+
 template<class T> static T *find_object(Resources::ResourceObjects& objects, const std::string& name) {
     for (Resources::ResourceObjects::iterator it = objects.begin(); it != objects.end(); it++) {
         Resources::ResourceObject& ro = *it;
@@ -52,9 +67,156 @@ template<class T> static T *find_object(Resources::ResourceObjects& objects, con
     return 0;
 }
 
+template<class T> static void number_resource_objects(Resources::ResourceObjects& objects) {
+    size_t index = 0;
+    for (Resources::ResourceObjects::iterator it = objects.begin(); it != objects.end(); it++) {
+        static_cast<T *>(it->object)->set_resource_index(index++);
+    }
+}
+
+template<class T> static void *create_resource(Subsystem& subsystem, const std::string& filename, ZipReader *zip) {
+    return new T(subsystem, filename, zip);
+}
+
+static void *create_map(Subsystem& subsystem, const std::string& filename, ZipReader *zip) {
+    if (!zip) {
+        return new Map(subsystem, filename, zip);
+    }
+
+    /* maps of a known pak are made from their cached headers */
+    const std::string& pak_hash = zip->get_hash();
+    std::string cache_filename = MapCache::get_cache_filename(pak_hash, filename);
+    if (MapCache::has_header(cache_filename)) {
+        return new Map(subsystem, filename, zip->get_zip_filename(), pak_hash, cache_filename);
+    }
+
+    Map *map = new Map(subsystem, filename, zip);
+    MapCache::write_header(cache_filename, *map);
+
+    return map;
+}
+
+static void *create_sound_stub(Subsystem& subsystem, const std::string& filename, ZipReader *zip) {
+    return new Sound(subsystem, filename, zip, false);
+}
+
+static void *create_game_settings(Subsystem& subsystem, const std::string& filename, ZipReader *zip) {
+    return new Properties(filename + ".game", zip);
+}
+
+/* load creates the object, stub creates it without its media and
+   index only keeps the name from its properties for validations.
+   fonts and icons are needed everywhere for their metrics, without
+   pictures the subsystem only reads the headers of their images */
+enum LoadPolicy {
+    LoadPolicyLoad = 0,
+    LoadPolicyStub,
+    LoadPolicyIndex
+};
+
+static const char *LoadPolicyNames[] = { "", " (stubs)", " (indexed)" };
+
+/* the scan order of each directory and pak, policies per profile */
+struct ResourceType {
+    const char *directory;
+    const char *suffix;
+    void *(*create)(Subsystem& subsystem, const std::string& filename, ZipReader *zip);
+    void *(*create_stub)(Subsystem& subsystem, const std::string& filename, ZipReader *zip);
+    Resources::ResourceObjects& (Resources::*objects)();
+    LoadPolicy policies[Resources::_LoadProfileMAX];
+};
+
+static const ResourceType ResourceTypes[] = {
+    /* policies for client, server and editor */
+    { "tilesets", ".tileset", create_resource<Tileset>, 0, &Resources::get_tilesets,
+        { LoadPolicyLoad, LoadPolicyLoad, LoadPolicyLoad } },
+    { "objects", ".object", create_resource<Object>, 0, &Resources::get_objects,
+        { LoadPolicyLoad, LoadPolicyLoad, LoadPolicyLoad } },
+    { "charactersets", ".characterset", create_resource<Characterset>, 0, &Resources::get_charactersets,
+        { LoadPolicyLoad, LoadPolicyLoad, LoadPolicyLoad } },
+    { "npcs", ".npc", create_resource<NPC>, 0, &Resources::get_npcs,
+        { LoadPolicyLoad, LoadPolicyLoad, LoadPolicyLoad } },
+    { "animations", ".animation", create_resource<Animation>, 0, &Resources::get_animations,
+        { LoadPolicyLoad, LoadPolicyLoad, LoadPolicyLoad } },
+    { "maps", ".map", create_map, 0, &Resources::get_maps,
+        { LoadPolicyLoad, LoadPolicyLoad, LoadPolicyLoad } },
+    { "backgrounds", ".background", create_resource<Background>, 0, &Resources::get_backgrounds,
+        { LoadPolicyLoad, LoadPolicyLoad, LoadPolicyLoad } },
+    { "fonts", ".font", create_resource<Font>, 0, &Resources::get_fonts,
+        { LoadPolicyLoad, LoadPolicyLoad, LoadPolicyLoad } },
+    { "icons", ".icon", create_resource<Icon>, 0, &Resources::get_icons,
+        { LoadPolicyLoad, LoadPolicyLoad, LoadPolicyLoad } },
+    { "sounds", ".sound", create_resource<Sound>, create_sound_stub, &Resources::get_sounds,
+        { LoadPolicyLoad, LoadPolicyStub, LoadPolicyIndex } },
+    { "music", ".music", create_resource<Music>, 0, &Resources::get_musics,
+        { LoadPolicyLoad, LoadPolicyIndex, LoadPolicyIndex } },
+    { "game", ".game", create_game_settings, 0, &Resources::get_game_settings,
+        { LoadPolicyLoad, LoadPolicyLoad, LoadPolicyLoad } }
+};
+
+static const size_t ResourceTypeCount = sizeof(ResourceTypes) / sizeof(ResourceType);
+
+struct Resources::ResourceFile {
+    ResourceFile(size_t type, LoadPolicy policy, const std::string& filename, ZipReader *zip, bool base_resource)
+        : type(type), policy(policy), filename(filename), zip(zip), base_resource(base_resource),
+          object(0), load_time(0) { }
+
+    size_t type;
+    LoadPolicy policy;
+    std::string filename;
+    ZipReader *zip;
+    bool base_resource;
+    void *object;
+    std::string error;
+    ns_t load_time;
+};
+
+/* constructs one scanned file per index, errors are kept for the report */
+class Resources::LoadJob : public JobSystem::Job {
+private:
+    LoadJob(const LoadJob&);
+    LoadJob& operator=(const LoadJob&);
+
+public:
+    LoadJob(Subsystem& subsystem, ResourceFiles& files) : subsystem(subsystem), files(files) { }
+
+    virtual void execute(size_t index) {
+        ResourceFile *file = files[index];
+        gametime_t start;
+        gametime_t now;
+
+        get_now(start);
+        try {
+            const ResourceType& type = ResourceTypes[file->type];
+            switch (file->policy) {
+                case LoadPolicyLoad:
+                    file->object = type.create(subsystem, file->filename, file->zip);
+                    break;
+
+                case LoadPolicyStub:
+                    file->object = type.create_stub(subsystem, file->filename, file->zip);
+                    break;
+
+                case LoadPolicyIndex:
+                    file->object = new Properties(file->filename + type.suffix, file->zip);
+                    break;
+            }
+        } catch (const std::exception& e) {
+            file->error = e.what();
+        }
+        get_now(now);
+        file->load_time = diff_ns(start, now);
+    }
+
+private:
+    Subsystem& subsystem;
+    ResourceFiles& files;
+};
+
 /* class implementation begins here */
-Resources::Resources(Subsystem& subsystem, const std::string& resource_directory) throw (ResourcesException)
-    : subsystem(subsystem), resource_directory(resource_directory)
+Resources::Resources(Subsystem& subsystem, const std::string& resource_directory,
+    LoadProfile profile) throw (ResourcesException)
+    : subsystem(subsystem), resource_directory(resource_directory), profile(profile)
 {
     subsystem << "initializing resources" << std::endl;
     srand(static_cast<unsigned int>(time(0)));
@@ -132,6 +294,17 @@ Animation *Resources::get_animation(const std::string& name) throw (ResourcesExc
 }
 
 Map *Resources::get_map(const std::string& name) throw (ResourcesException) {
+    Map *o = get_map_header(name);
+    try {
+        o->load();
+    } catch (const MapException& e) {
+        throw ResourcesException(e.what());
+    }
+
+    return o;
+}
+
+Map *Resources::get_map_header(const std::string& name) throw (ResourcesException) {
     Map *o = find_object<Map>(maps, name);
     if (o) return o;
     throw ResourcesException("map " + name + " not found");
@@ -225,214 +398,30 @@ Resources::ResourceObjects& Resources::get_game_settings() {
     return game_settings;
 }
 
-void Resources::read_tilesets(const std::string& directory, ZipReader *zip, bool base_resource) throw (Exception) {
-    const char *entry = 0;
-    try {
-        Directory dir(directory, ".tileset", zip);
-        while ((entry = dir.get_entry())) {
-            try {
-                tilesets.push_back(ResourceObject(new Tileset(subsystem, (zip ? "" : directory + dir_separator) + entry, zip), base_resource));
-            } catch (const Exception& e) {
-                subsystem << e.what() << std::endl;
-            }
-        }
-    } catch (const DirectoryException&) {
-        /* chomp */
-    }
-}
-
-void Resources::read_objects(const std::string& directory, ZipReader *zip, bool base_resource) throw (Exception) {
-    const char *entry = 0;
-    try {
-        Directory dir(directory, ".object", zip);
-        while ((entry = dir.get_entry())) {
-            try {
-                objects.push_back(ResourceObject(new Object(subsystem, (zip ? "" : directory + dir_separator) + entry, zip), base_resource));
-            } catch (const Exception& e) {
-                subsystem << e.what() << std::endl;
-            }
-        }
-    } catch (const DirectoryException&) {
-        /* chomp */
-    }
-}
-
-void Resources::read_charactersets(const std::string& directory, ZipReader *zip, bool base_resource) throw (Exception) {
-    const char *entry = 0;
-    try {
-        Directory dir(directory, ".characterset", zip);
-        while ((entry = dir.get_entry())) {
-            try {
-                charactersets.push_back(ResourceObject(new Characterset(subsystem, (zip ? "" : directory + dir_separator) + entry, zip), base_resource));
-            } catch (const Exception& e) {
-                subsystem << e.what() << std::endl;
-            }
-        }
-    } catch (const DirectoryException&) {
-        /* chomp */
-    }
-}
-
-void Resources::read_npcs(const std::string& directory, ZipReader *zip, bool base_resource) throw (Exception) {
-    const char *entry = 0;
-    try {
-        Directory dir(directory, ".npc", zip);
-        while ((entry = dir.get_entry())) {
-            try {
-                npcs.push_back(ResourceObject(new NPC(subsystem, (zip ? "" : directory + dir_separator) + entry, zip), base_resource));
-            } catch (const Exception& e) {
-                subsystem << e.what() << std::endl;
-            }
-        }
-    } catch (const DirectoryException&) {
-        /* chomp */
-    }
-}
-
-void Resources::read_animations(const std::string& directory, ZipReader *zip, bool base_resource) throw (Exception) {
-    const char *entry = 0;
-    try {
-        Directory dir(directory, ".animation", zip);
-        while ((entry = dir.get_entry())) {
-            try {
-                animations.push_back(ResourceObject(new Animation(subsystem, (zip ? "" : directory + dir_separator) + entry, zip), base_resource));
-            } catch (const Exception& e) {
-                subsystem << e.what() << std::endl;
-            }
-        }
-    } catch (const DirectoryException&) {
-        /* chomp */
-    }
-}
-
-void Resources::read_maps(const std::string& directory, ZipReader *zip, bool base_resource) throw (Exception) {
-    const char *entry = 0;
-    try {
-        Directory dir(directory, ".map", zip);
-        while ((entry = dir.get_entry())) {
-            try {
-                maps.push_back(ResourceObject(new Map(subsystem, (zip ? "" : directory + dir_separator) + entry, zip), base_resource));
-            } catch (const Exception& e) {
-                subsystem << e.what() << std::endl;
-            }
-        }
-    } catch (const DirectoryException&) {
-        /* chomp */
-    }
-}
-
-void Resources::read_backgrounds(const std::string& directory, ZipReader *zip, bool base_resource) throw (Exception) {
-    const char *entry = 0;
-    try {
-        Directory dir(directory, ".background", zip);
-        while ((entry = dir.get_entry())) {
-            try {
-                backgrounds.push_back(ResourceObject(new Background(subsystem, (zip ? "" : directory + dir_separator) + entry, zip), base_resource));
-            } catch (const Exception& e) {
-                subsystem << e.what() << std::endl;
-            }
-        }
-    } catch (const DirectoryException&) {
-        /* chomp */
-    }
-}
-
-void Resources::read_fonts(const std::string& directory, ZipReader *zip, bool base_resource) throw (Exception) {
-    const char *entry = 0;
-    try {
-        Directory dir(directory, ".font", zip);
-        while ((entry = dir.get_entry())) {
-            try {
-                fonts.push_back(ResourceObject(new Font(subsystem, (zip ? "" : directory + dir_separator) + entry, zip), base_resource));
-            } catch (const Exception& e) {
-                subsystem << e.what() << std::endl;
-            }
-        }
-    } catch (const DirectoryException&) {
-        /* chomp */
-    }
-}
-
-void Resources::read_icons(const std::string& directory, ZipReader *zip, bool base_resource) throw (Exception) {
-    const char *entry = 0;
-    try {
-        Directory dir(directory, ".icon", zip);
-        while ((entry = dir.get_entry())) {
-            try {
-                icons.push_back(ResourceObject(new Icon(subsystem, (zip ? "" : directory + dir_separator) + entry, zip), base_resource));
-            } catch (const Exception& e) {
-                subsystem << e.what() << std::endl;
-            }
-        }
-    } catch (const DirectoryException&) {
-        /* chomp */
-    }
-}
-
-void Resources::read_sounds(const std::string& directory, ZipReader *zip, bool base_resource) throw (Exception) {
-    const char *entry = 0;
-    try {
-        Directory dir(directory, ".sound", zip);
-        while ((entry = dir.get_entry())) {
-            try {
-                sounds.push_back(ResourceObject(new Sound(subsystem, (zip ? "" : directory + dir_separator) + entry, zip), base_resource));
-            } catch (const Exception& e) {
-                subsystem << e.what() << std::endl;
-            }
-        }
-    } catch (const DirectoryException&) {
-        /* chomp */
-    }
-}
-
-void Resources::read_musics(const std::string& directory, ZipReader *zip, bool base_resource) throw (Exception) {
-    const char *entry = 0;
-    try {
-        Directory dir(directory, ".music", zip);
-        while ((entry = dir.get_entry())) {
-            try {
-                musics.push_back(ResourceObject(new Music(subsystem, (zip ? "" : directory + dir_separator) + entry, zip), base_resource));
-            } catch (const Exception& e) {
-                subsystem << e.what() << std::endl;
-            }
-        }
-    } catch (const DirectoryException&) {
-        /* chomp */
-    }
-}
-
-void Resources::read_game_settings(const std::string& directory, ZipReader *zip, bool base_resource) throw (Exception) {
-    const char *entry = 0;
-    try {
-        Directory dir(directory, ".game", zip);
-        while ((entry = dir.get_entry())) {
-            try {
-                game_settings.push_back(ResourceObject(new Properties((zip ? "" : directory + dir_separator) + entry + ".game", zip), base_resource));
-            } catch (const Exception& e) {
-                subsystem << e.what() << std::endl;
-            }
-        }
-    } catch (const DirectoryException&) {
-        /* chomp */
-    }
-}
-
 void Resources::load_resources(bool home_paks_only) throw (ResourcesException) {
+    ResourceFiles files;
+    ZipReaders zips;
+    gametime_t start;
+
+    get_now(start);
     try {
         if (!home_paks_only) {
             /* scan main directories */
             subsystem << "scanning main directories" << std::endl;
-            read_all(resource_directory + dir_separator, 0, true);
+            scan_all(files, resource_directory + dir_separator, 0, true);
 
-            /* read main paks */
+            /* scan main paks */
             Directory dir(resource_directory, ".pak");
             const char *entry = 0;
             while ((entry = dir.get_entry())) {
                 subsystem << "scanning " << entry << ".pak" << std::endl;
                 try {
-                    ZipReader zip(resource_directory + dir_separator + entry + ".pak");
-                    read_all("", &zip, true);
-                    loaded_paks.push_back(LoadedPak(zip.get_zip_filename(), zip.get_zip_short_filename(), zip.get_hash(), false));
+                    ZipReader *zip = ZipReader::open(resource_directory + dir_separator + entry + ".pak");
+                    zips.push_back(zip);
+
+                    /* hashed before the scan, the loaders only read it */
+                    loaded_paks.push_back(LoadedPak(zip->get_zip_filename(), zip->get_zip_short_filename(), zip->get_hash(), false));
+                    scan_all(files, "", zip, true);
                 } catch (const ZipException& e) {
                     subsystem << e.what() << std::endl;
                 }
@@ -441,45 +430,120 @@ void Resources::load_resources(bool home_paks_only) throw (ResourcesException) {
 
         /* scan user directories */
         subsystem << "scanning user directories" << std::endl;
-        read_all(get_home_directory() + dir_separator + UserDirectory + dir_separator, 0, false);
+        scan_all(files, get_home_directory() + dir_separator + UserDirectory + dir_separator, 0, false);
 
-        /* read home directory */
+        /* scan home directory */
         std::string hdir = get_home_directory() + dir_separator + UserDirectory;
         Directory dir(hdir, ".pak");
         const char *entry = 0;
         while ((entry = dir.get_entry())) {
             subsystem << "scanning " << entry << ".pak" << std::endl;
             try {
-                ZipReader zip(hdir + dir_separator + entry + ".pak");
-                read_all("", &zip, false);
-                loaded_paks.push_back(LoadedPak(zip.get_zip_filename(), zip.get_zip_short_filename(), zip.get_hash(), true));
+                ZipReader *zip = ZipReader::open(hdir + dir_separator + entry + ".pak");
+                zips.push_back(zip);
+                loaded_paks.push_back(LoadedPak(zip->get_zip_filename(), zip->get_zip_short_filename(), zip->get_hash(), true));
+                scan_all(files, "", zip, false);
             } catch (const ZipException& e) {
                 subsystem << e.what() << std::endl;
             }
         }
 
+        /* load everything found */
+        load_files(files, start);
+        destroy_files(files, zips);
+
         /* prepare all resources for quick accesses */
         subsystem.set_scanlines_icon(get_icon("scanlines"));
         prepare_resources();
     } catch (const Exception& e) {
+        destroy_files(files, zips);
         destroy_resources(false);
         throw ResourcesException(e.what());
     }
 }
 
-void Resources::read_all(const std::string& fdir, ZipReader *fzip, bool base_resource) throw (Exception) {
-    read_tilesets(fdir + "tilesets", fzip, base_resource);
-    read_objects(fdir + "objects", fzip, base_resource);
-    read_charactersets(fdir + "charactersets", fzip, base_resource);
-    read_npcs(fdir + "npcs", fzip, base_resource);
-    read_animations(fdir + "animations", fzip, base_resource);
-    read_maps(fdir + "maps", fzip, base_resource);
-    read_backgrounds(fdir + "backgrounds", fzip, base_resource);
-    read_fonts(fdir + "fonts", fzip, base_resource);
-    read_icons(fdir + "icons", fzip, base_resource);
-    read_sounds(fdir + "sounds", fzip, base_resource);
-    read_musics(fdir + "music", fzip, base_resource);
-    read_game_settings(fdir + "game", fzip, base_resource);
+void Resources::scan_all(ResourceFiles& files, const std::string& fdir, ZipReader *fzip, bool base_resource) throw (Exception) {
+    for (size_t i = 0; i < ResourceTypeCount; i++) {
+        const ResourceType& type = ResourceTypes[i];
+        LoadPolicy policy = type.policies[profile];
+        if (policy == LoadPolicyStub && !type.create_stub) {
+            policy = LoadPolicyLoad;
+        }
+        std::string directory = fdir + type.directory;
+        try {
+            Directory dir(directory, type.suffix, fzip);
+            const char *entry = 0;
+            while ((entry = dir.get_entry())) {
+                files.push_back(new ResourceFile(i, policy, (fzip ? "" : directory + dir_separator) + entry, fzip, base_resource));
+            }
+        } catch (const DirectoryException&) {
+            /* chomp */
+        }
+    }
+}
+
+void Resources::load_files(ResourceFiles& files, const gametime_t& start) throw (Exception) {
+    /* decode on all cores, the textures are created afterwards on this thread */
+    JobSystem jobs(JobSystem::get_default_worker_count());
+    LoadJob job(subsystem, files);
+    gametime_t decode_start;
+    gametime_t upload_start;
+    gametime_t end;
+
+    get_now(decode_start);
+    subsystem.defer_uploads();
+    jobs.run(job, files.size());
+    get_now(upload_start);
+    size_t textures = subsystem.upload_deferred();
+
+    /* hand the objects out in scan order, failures are reported the same way */
+    size_t counts[ResourceTypeCount] = { 0 };
+    ns_t times[ResourceTypeCount] = { 0 };
+    size_t loaded = 0;
+    for (ResourceFiles::iterator it = files.begin(); it != files.end(); it++) {
+        ResourceFile *file = *it;
+        times[file->type] += file->load_time;
+        if (file->object && file->policy == LoadPolicyIndex) {
+            Properties *props = static_cast<Properties *>(file->object);
+            index.push_back(IndexEntry(ResourceTypes[file->type].directory, props->get_name(), file->base_resource));
+            delete props;
+            file->object = 0;
+            counts[file->type]++;
+        } else if (file->object) {
+            (this->*ResourceTypes[file->type].objects)().push_back(ResourceObject(file->object, file->base_resource));
+            file->object = 0;
+            counts[file->type]++;
+            loaded++;
+        } else {
+            subsystem << file->error << std::endl;
+        }
+    }
+    get_now(end);
+
+    /* timing report, the times per type add up over all threads */
+    subsystem << "loaded " << loaded << " resources on " << (jobs.get_worker_count() + 1)
+        << " threads in " << diff_ms(start, end) << " ms (scan " << diff_ms(start, decode_start)
+        << " ms, decode " << diff_ms(decode_start, upload_start) << " ms, upload "
+        << diff_ms(upload_start, end) << " ms, " << textures << " textures)" << std::endl;
+    for (size_t i = 0; i < ResourceTypeCount; i++) {
+        if (counts[i]) {
+            subsystem << "  " << ResourceTypes[i].directory << ": " << counts[i]
+                << LoadPolicyNames[ResourceTypes[i].policies[profile]] << " in "
+                << (times[i] / 1000000) << " ms" << std::endl;
+        }
+    }
+}
+
+void Resources::destroy_files(ResourceFiles& files, ZipReaders& zips) {
+    for (ResourceFiles::iterator it = files.begin(); it != files.end(); it++) {
+        delete *it;
+    }
+    files.clear();
+
+    for (ZipReaders::iterator it = zips.begin(); it != zips.end(); it++) {
+        ZipReader::release(*it);
+    }
+    zips.clear();
 }
 
 void Resources::destroy_resources(bool home_paks_only) {
@@ -496,6 +560,7 @@ void Resources::destroy_resources(bool home_paks_only) {
     erase_resource_objects<Object>(objects, home_paks_only);
     erase_resource_objects<Tileset>(tilesets, home_paks_only);
 
+    erase_index(index, home_paks_only);
     erase_loaded_pak(loaded_paks, home_paks_only);
 }
 
@@ -506,7 +571,38 @@ void Resources::prepare_resources() throw (ResourcesException) {
         Animation *ani = static_cast<Animation *>(ro.object);
         const std::string& sound_name = ani->get_value("sound_name");
         if (sound_name.length()) {
+            /* indexed sounds are only checked for existence */
+            if (is_indexed("sounds", sound_name)) {
+                continue;
+            }
             ani->set_sound(get_sound(sound_name));
         }
     }
+
+    /* npc kill sounds, missing ones stay unset */
+    for (ResourceObjects::iterator it = npcs.begin(); it != npcs.end(); it++) {
+        ResourceObject& ro = *it;
+        NPC *npc = static_cast<NPC *>(ro.object);
+        const std::string& sound_name = npc->get_value("kill_sound");
+        if (sound_name.length() && !is_indexed("sounds", sound_name)) {
+            npc->set_kill_sound(find_object<Sound>(sounds, sound_name));
+        }
+    }
+
+    /* the resource ids on the wire are kept by these positions */
+    number_resource_objects<Animation>(animations);
+    number_resource_objects<Sound>(sounds);
+    number_resource_objects<Object>(objects);
+    number_resource_objects<NPC>(npcs);
+}
+
+bool Resources::is_indexed(const char *directory, const std::string& name) const {
+    for (IndexEntries::const_iterator it = index.begin(); it != index.end(); it++) {
+        const IndexEntry& entry = *it;
+        if (!strcmp(entry.directory, directory) && entry.name == name) {
+            return true;
+        }
+    }
+
+    return false;
 }
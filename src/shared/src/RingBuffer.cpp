@@ -0,0 +1,101 @@
+#include "RingBuffer.hpp"
+
+#include <cstring>
+
+#ifdef _WIN32
+#include "Win.hpp"
+#endif
+
+static inline void memory_barrier() {
+#ifdef _WIN32
+    MemoryBarrier();
+#else
+    __sync_synchronize();
+#endif
+}
+
+RingBuffer::RingBuffer(size_t size) throw (RingBufferException)
+    : buffer(0), size(1), head(0), tail(0)
+{
+    /* power of two, positions are masked */
+    while (this->size < size) {
+        this->size <<= 1;
+    }
+
+    try {
+        buffer = new unsigned char[this->size];
+    } catch (const std::exception& e) {
+        throw RingBufferException(e.what());
+    }
+}
+
+RingBuffer::~RingBuffer() {
+    delete[] buffer;
+}
+
+size_t RingBuffer::get_size() const {
+    return size;
+}
+
+size_t RingBuffer::get_used() const {
+    return tail - head;
+}
+
+bool RingBuffer::write(const void *data, size_t len) {
+    size_t t = tail;
+    size_t h = head;
+    memory_barrier();
+    if (size - (t - h) < len) {
+        return false;
+    }
+
+    size_t pos = t & (size - 1);
+    size_t first = size - pos;
+    if (first > len) {
+        first = len;
+    }
+    memcpy(buffer + pos, data, first);
+    memcpy(buffer, static_cast<const unsigned char *>(data) + first, len - first);
+
+    memory_barrier();
+    tail = t + len;
+
+    return true;
+}
+
+bool RingBuffer::peek(void *data, size_t len) const {
+    size_t h = head;
+    size_t t = tail;
+    memory_barrier();
+    if (t - h < len) {
+        return false;
+    }
+    copy_out(h, data, len);
+
+    return true;
+}
+
+bool RingBuffer::read(void *data, size_t len) {
+    size_t h = head;
+    size_t t = tail;
+    memory_barrier();
+    if (t - h < len) {
+        return false;
+    }
+    copy_out(h, data, len);
+
+    memory_barrier();
+    head = h + len;
+
+    return true;
+}
+
+void RingBuffer::copy_out(size_t pos, void *data, size_t len) const {
+    pos &= (size - 1);
+    size_t first = size - pos;
+    if (first > len) {
+        first = len;
+    }
+    memcpy(data, buffer + pos, first);
+    memcpy(static_cast<unsigned char *>(data) + first, buffer, len - first);
+}
@@ -1,10 +1,14 @@
 #include "Sound.hpp"
 
-Sound::Sound(Subsystem& subsystem, const std::string& filename, ZipReader *zip)
+Sound::Sound(Subsystem& subsystem, const std::string& filename, ZipReader *zip, bool with_audio)
     throw (KeyValueException, SoundException)
     : Properties(filename + ".sound", zip), subsystem(subsystem), audio(0),
     playing_channel(-1)
 {
+    if (!with_audio) {
+        return;
+    }
+
     try {
         audio = subsystem.create_audio();
         audio->generate_audio(filename + ".ogg", zip);
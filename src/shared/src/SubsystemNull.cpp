@@ -20,6 +20,11 @@ bool SubsystemNull::is_dedicated_server() const {
     return true;
 }
 
+bool SubsystemNull::needs_pictures() const {
+    /* tiles are only counted, images need not be decoded */
+    return keep_pictures;
+}
+
 int SubsystemNull::get_zoom_factor() const {
     return 1;
 }
@@ -60,6 +65,12 @@ Audio *SubsystemNull::create_audio() {
     return new AudioNull;
 }
 
+void SubsystemNull::defer_uploads() { }
+
+size_t SubsystemNull::upload_deferred() {
+    return 0;
+}
+
 void SubsystemNull::begin_drawings() { }
 
 void SubsystemNull::end_drawings() { }
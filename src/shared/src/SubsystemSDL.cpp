@@ -191,6 +191,10 @@ bool SubsystemSDL::is_dedicated_server() const {
     return false;
 }
 
+bool SubsystemSDL::needs_pictures() const {
+    return true;
+}
+
 int SubsystemSDL::get_zoom_factor() const {
     return current_zoom;
 }
@@ -295,6 +299,14 @@ Audio *SubsystemSDL::create_audio() {
     return new AudioSDL;
 }
 
+void SubsystemSDL::defer_uploads() {
+    TileGraphicGL::defer_uploads();
+}
+
+size_t SubsystemSDL::upload_deferred() {
+    return TileGraphicGL::upload_deferred();
+}
+
 void SubsystemSDL::begin_drawings() {
     glClearColor(0.0f, 0.0f, 0.0f, 0.0f);
     glClear(GL_COLOR_BUFFER_BIT);
@@ -2,11 +2,34 @@
 
 #include "TileGraphicGL.hpp"
 #include "ScopeAllocator.hpp"
+#include "Scope.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+TileGraphicGL::Deferred *TileGraphicGL::deferred = 0;
 
 TileGraphicGL::TileGraphicGL(int width, int height, bool keep_pictures)
-    : TileGraphic(width, height, keep_pictures), sz(0) { }
+    : TileGraphic(width, height, keep_pictures), registered(false), sz(0)
+{
+    if (deferred) {
+        Scope<Mutex> lock(deferred->mtx);
+        deferred->graphics.push_back(this);
+        registered = true;
+    }
+}
 
 TileGraphicGL::~TileGraphicGL() {
+    if (registered && deferred) {
+        Scope<Mutex> lock(deferred->mtx);
+        Graphics& graphics = deferred->graphics;
+        graphics.erase(std::remove(graphics.begin(), graphics.end(), this), graphics.end());
+    }
+
+    for (Uploads::iterator it = uploads.begin(); it != uploads.end(); it++) {
+        delete[] it->pic;
+    }
+
     for (Textures::iterator it = textures.begin(); it != textures.end(); it++) {
         GLuint tex = *it;
         glDeleteTextures(1, &tex);
@@ -39,20 +62,21 @@ int TileGraphicGL::get_bytes_per_pixel(int index) {
 }
 
 void TileGraphicGL::add_tile(int bytes_per_pixel, const void *pic, bool desc, bool linear) {
-    GLuint tex;
-
-    glGenTextures(1, &tex);
-    glBindTexture(GL_TEXTURE_2D, tex);
-    if (linear) {
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-    } else {
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    if (registered) {
+        /* keep a copy until the context owner uploads it */
+        size_t bytes = width * height * bytes_per_pixel;
+        unsigned char *copy = new unsigned char[bytes];
+        memcpy(copy, pic, bytes);
+        if (desc) {
+            uploads.push_front(Upload(bytes_per_pixel, copy, linear));
+        } else {
+            uploads.push_back(Upload(bytes_per_pixel, copy, linear));
+        }
+        sz = uploads.size();
+        return;
     }
-    glTexImage2D(GL_TEXTURE_2D, 0, bytes_per_pixel, width, height, 0,
-        (bytes_per_pixel == 4 ? GL_RGBA : GL_RGB), GL_UNSIGNED_BYTE, pic);
 
+    GLuint tex = create_texture(bytes_per_pixel, pic, linear);
     if (desc) {
         textures.push_front(tex);
     } else {
@@ -125,4 +149,55 @@ size_t TileGraphicGL::get_tile_count() {
     return sz;
 }
 
+void TileGraphicGL::defer_uploads() throw (MutexException) {
+    if (!deferred) {
+        deferred = new Deferred;
+    }
+}
+
+size_t TileGraphicGL::upload_deferred() {
+    size_t n = 0;
+    if (deferred) {
+        Graphics& graphics = deferred->graphics;
+        for (Graphics::iterator it = graphics.begin(); it != graphics.end(); it++) {
+            TileGraphicGL *tg = *it;
+            n += tg->uploads.size();
+            tg->upload();
+            tg->registered = false;
+        }
+        delete deferred;
+        deferred = 0;
+    }
+
+    return n;
+}
+
+GLuint TileGraphicGL::create_texture(int bytes_per_pixel, const void *pic, bool linear) {
+    GLuint tex;
+
+    glGenTextures(1, &tex);
+    glBindTexture(GL_TEXTURE_2D, tex);
+    if (linear) {
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    } else {
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    }
+    glTexImage2D(GL_TEXTURE_2D, 0, bytes_per_pixel, width, height, 0,
+        (bytes_per_pixel == 4 ? GL_RGBA : GL_RGB), GL_UNSIGNED_BYTE, pic);
+
+    return tex;
+}
+
+void TileGraphicGL::upload() {
+    /* the queue is already in texture order */
+    for (Uploads::iterator it = uploads.begin(); it != uploads.end(); it++) {
+        textures.push_back(create_texture(it->bytes_per_pixel, it->pic, it->linear));
+        delete[] it->pic;
+    }
+    uploads.clear();
+    sz = textures.size();
+}
+
 #endif
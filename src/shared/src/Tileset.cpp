@@ -51,7 +51,7 @@ size_t Tileset::get_tile_count() {
 
 void Tileset::create_tile(const std::string& filename, ZipReader *zip) throw (Exception) {
     try {
-        PNG png(filename, zip);
+        PNG png(filename, zip, !subsystem.needs_pictures());
 
         const int& png_width = png.get_width();
         const int& png_height = png.get_height();
@@ -1,11 +1,74 @@
 #include "ZipReader.hpp"
+#include "Scope.hpp"
 
 #include <algorithm>
 #include <cerrno>
 #include <cstring>
+#include <cstdlib>
+#include <climits>
+#include <sys/stat.h>
+#ifdef __unix__
+#include <unistd.h>
+#elif _WIN32
+#include "Win.hpp"
+#endif
+
+static const size_t NoFile = static_cast<size_t>(-1);
+
+/* shared readers by canonical path */
+typedef std::map<std::string, ZipReader *> SharedReaders;
+
+/* hashes of paks by canonical path, they outlive the readers */
+struct KnownHash {
+    KnownHash() : mtime(0), size(0) { }
+    KnownHash(time_t mtime, size_t size, const std::string& hash)
+        : mtime(mtime), size(size), hash(hash) { }
+
+    time_t mtime;
+    size_t size;
+    std::string hash;
+};
+
+typedef std::map<std::string, KnownHash> KnownHashes;
+
+static Mutex shared_mtx;
+static SharedReaders shared_readers;
+static KnownHashes known_hashes;
+
+static struct SharedReadersCleanup {
+    ~SharedReadersCleanup() {
+        ZipReader::close_unused();
+    }
+} shared_readers_cleanup;
+
+static std::string get_canonical_path(const std::string& filename) {
+#ifdef __unix__
+    char path[PATH_MAX];
+    if (realpath(filename.c_str(), path)) {
+        return path;
+    }
+#elif _WIN32
+    char path[MAX_PATH];
+    if (_fullpath(path, filename.c_str(), sizeof path)) {
+        return path;
+    }
+#endif
+
+    return filename;
+}
+
+static size_t hash_filename(const std::string& filename) {
+    /* fnv-1a */
+    size_t h = 2166136261u;
+    for (std::string::const_iterator it = filename.begin(); it != filename.end(); it++) {
+        h = (h ^ static_cast<unsigned char>(*it)) * 16777619u;
+    }
+
+    return h;
+}
 
 ZipReader::ZipReader(const std::string& filename) throw (ZipReaderException)
-    : Zip(filename)
+    : Zip(filename), size(0), shared_mtime(0), references(0)
 {
     size_t sz;
     unsigned char *ptr;
@@ -23,6 +86,8 @@ ZipReader::ZipReader(const std::string& filename) throw (ZipReaderException)
     }
 
     /* find end of central directory */
+    fseek(f, 0, SEEK_END);
+    size = static_cast<size_t>(ftell(f));
     fseek(f, -256, SEEK_END);
     sz = fread(buffer, 1, 256, f);
     if (sz < 22) {
@@ -67,14 +132,157 @@ ZipReader::ZipReader(const std::string& filename) throw (ZipReaderException)
         entry.filename.assign(reinterpret_cast<const char *>(buffer), len);
         files.push_back(entry);
     }
+
+    build_index();
 }
 
 ZipReader::~ZipReader() { }
 
+ZipReader *ZipReader::open(const std::string& filename) throw (ZipReaderException) {
+    std::string key = get_canonical_path(filename);
+    struct stat st;
+    if (stat(key.c_str(), &st)) {
+        throw ZipReaderException("Can't open package: " + filename + " (" + strerror(errno) + ")");
+    }
+    size_t st_size = static_cast<size_t>(st.st_size);
+
+    {
+        Scope<Mutex> lock(shared_mtx);
+        ZipReader *zip = get_shared(key, st.st_mtime, st_size);
+        if (zip) {
+            return zip;
+        }
+    }
+
+    /* read the central directory unlocked, other paks open meanwhile */
+    ZipReader *zip = new ZipReader(filename);
+
+    Scope<Mutex> lock(shared_mtx);
+    ZipReader *other = get_shared(key, st.st_mtime, st_size);
+    if (other) {
+        /* another thread was faster */
+        delete zip;
+        return other;
+    }
+
+    KnownHashes::iterator kit = known_hashes.find(key);
+    if (kit != known_hashes.end()) {
+        const KnownHash& known = kit->second;
+        if (known.mtime == st.st_mtime && known.size == zip->size) {
+            zip->hash = known.hash;
+        }
+    }
+    zip->shared_key = key;
+    zip->shared_mtime = st.st_mtime;
+    zip->references = 1;
+    shared_readers[key] = zip;
+
+    return zip;
+}
+
+ZipReader *ZipReader::get_shared(const std::string& key, time_t mtime, size_t size) {
+    SharedReaders::iterator it = shared_readers.find(key);
+    if (it == shared_readers.end()) {
+        return 0;
+    }
+
+    ZipReader *zip = it->second;
+    if (zip->shared_mtime == mtime && zip->size == size) {
+        zip->references++;
+        return zip;
+    }
+
+    /* the pak was replaced, the old reader goes with its last user */
+    shared_readers.erase(it);
+    zip->shared_key.clear();
+    if (!zip->references) {
+        delete zip;
+    }
+
+    return 0;
+}
+
+void ZipReader::release(ZipReader *zip) {
+    if (!zip) {
+        return;
+    }
+
+    Scope<Mutex> lock(shared_mtx);
+    zip->references--;
+    if (!zip->references && !zip->shared_key.length()) {
+        delete zip;
+    }
+}
+
+void ZipReader::close_unused() {
+    Scope<Mutex> lock(shared_mtx);
+    for (SharedReaders::iterator it = shared_readers.begin(); it != shared_readers.end();) {
+        ZipReader *zip = it->second;
+        if (!zip->references) {
+            delete zip;
+            shared_readers.erase(it++);
+        } else {
+            it++;
+        }
+    }
+}
+
+const std::string& ZipReader::get_hash() throw (ZipException) {
+    /* rehash() moves the file position, like reads without pread */
+    Scope<Mutex> lock(mtx);
+    if (!hash.length()) {
+        rehash();
+        Scope<Mutex> shared_lock(shared_mtx);
+        if (shared_key.length()) {
+            known_hashes[shared_key] = KnownHash(shared_mtime, size, hash);
+        }
+    }
+
+    return hash;
+}
+
+size_t ZipReader::get_size() const {
+    return size;
+}
+
+size_t ZipReader::read_at(void *data, size_t len, size_t ofs) {
+#ifdef __unix__
+    /* pread leaves the file position alone, no lock needed */
+    char *ptr = static_cast<char *>(data);
+    size_t total = 0;
+    while (total < len) {
+        ssize_t sz = pread(fileno(f), ptr + total, len - total, static_cast<off_t>(ofs + total));
+        if (sz < 0 && errno == EINTR) {
+            continue;
+        }
+        if (sz <= 0) {
+            break;
+        }
+        total += static_cast<size_t>(sz);
+    }
+
+    return total;
+#else
+    Scope<Mutex> lock(mtx);
+    fseek(f, static_cast<long>(ofs), SEEK_SET);
+
+    return fread(data, 1, len, f);
+#endif
+}
+
 const ZipReader::Files& ZipReader::get_files() const {
     return files;
 }
 
+const ZipReader::Entries& ZipReader::get_directory_entries(const std::string& directory) const {
+    Directories::const_iterator it = directories.find(directory);
+    if (it == directories.end()) {
+        return no_entries;
+    }
+
+    return it->second;
+}
+
 bool ZipReader::file_exists(std::string filename) {
     try {
         std::replace(filename.begin(), filename.end(), '\\', '/');
@@ -103,62 +311,39 @@ const char *ZipReader::extract(std::string filename, size_t *out_sz) throw (ZipR
     std::replace(filename.begin(), filename.end(), '\\', '/');
     const File& file = get_file(filename);
 
-    /* get file header */
-    fseek(f, file.ofs, SEEK_SET);
-    size_t sz = fread(buffer, 1, 30, f);
-    if (sz != 30) {
-        throw_inflate_failed(0, 0, filename);
-    }
-    if (memcmp(buffer, "PK\003\004", 4)) {
-        throw_inflate_failed(0, 0, filename);
-    }
-    int cmpr_sz = buffer[21] << 24 | buffer[20] << 16 | buffer[19] << 8 | buffer[18];
-    int ucmpr_sz = buffer[25] << 24 | buffer[24] << 16 | buffer[23] << 8 | buffer[22];
-    int len = buffer[27] << 8 | buffer[26];
-    int xln = buffer[29] << 8 | buffer[28];
+    /* read the compressed data */
+    int cmpr_sz = 0;
+    int ucmpr_sz = 0;
+    size_t ofs = read_local_header(file, filename, cmpr_sz, ucmpr_sz);
 
-    /* extract */
     char *data = new char[ucmpr_sz];
-    fseek(f, file.ofs + 30 + len + xln, SEEK_SET);
-    if (cmpr_sz == ucmpr_sz) {
-        /* plain copy */
-        sz = fread(data, 1, cmpr_sz, f);
-        if (sz != static_cast<size_t>(cmpr_sz)) {
-            throw_inflate_failed(0, data, filename);
+    char *cmpr_data = (cmpr_sz == ucmpr_sz ? data : new char[cmpr_sz]);
+    size_t sz = read_at(cmpr_data, cmpr_sz, ofs);
+    if (sz != static_cast<size_t>(cmpr_sz)) {
+        if (cmpr_data != data) {
+            destroy(cmpr_data);
         }
-    } else {
-        /* uncompress */
+        throw_inflate_failed(0, data, filename);
+    }
+
+    /* uncompress, a plain copy is already in place */
+    if (cmpr_data != data) {
         z_stream z;
         memset(&z, 0, sizeof(z_stream));
-        char *dst = data;
         int status = inflateInit2(&z, -MAX_WBITS);
         if (status != Z_OK) {
+            destroy(cmpr_data);
             throw_inflate_failed(&z, data, filename);
         }
 
-        const int bsz = sizeof buffer;
-        do {
-            z.next_in = buffer;
-            if (cmpr_sz > bsz) {
-                z.avail_in = bsz;
-            } else {
-                z.avail_in = cmpr_sz;
-            }
-            z.avail_in = fread(z.next_in, 1, z.avail_in, f);
-            while (z.avail_in && status == Z_OK) {
-                z.next_out = outbuf;
-                z.avail_out = bsz;
-                status = inflate(&z, Z_NO_FLUSH);
-                int c = bsz - z.avail_out;
-                if (c) {
-                    memcpy(dst, outbuf, c);
-                    dst += c;
-                }
-            }
-            cmpr_sz -= bsz;
-        } while (cmpr_sz > 0 && status == Z_OK);
+        z.next_in = reinterpret_cast<Bytef *>(cmpr_data);
+        z.avail_in = cmpr_sz;
+        z.next_out = reinterpret_cast<Bytef *>(data);
+        z.avail_out = ucmpr_sz;
+        status = inflate(&z, Z_FINISH);
+        destroy(cmpr_data);
         if (status != Z_STREAM_END) {
-            throw_inflate_failed(&z, data, filename + " (" + z.msg + ")");
+            throw_inflate_failed(&z, data, filename + " (" + (z.msg ? z.msg : "truncated") + ")");
         }
         inflateEnd(&z);
     }
@@ -170,6 +355,52 @@ const char *ZipReader::extract(std::string filename, size_t *out_sz) throw (ZipR
     return data;
 }
 
+size_t ZipReader::extract_head(std::string filename, char *buffer, size_t len) throw (ZipReaderException) {
+    std::replace(filename.begin(), filename.end(), '\\', '/');
+    const File& file = get_file(filename);
+
+    /* a few compressed bytes are enough for the first bytes of a file,
+       more are only read while the output is not filled */
+    const size_t ChunkSize = 256;
+    unsigned char cmpr_data[ChunkSize];
+    z_stream z;
+    memset(&z, 0, sizeof(z_stream));
+    z.next_out = reinterpret_cast<Bytef *>(buffer);
+    z.avail_out = static_cast<uInt>(len);
+
+    int cmpr_sz = 0;
+    int ucmpr_sz = 0;
+    size_t ofs = read_local_header(file, filename, cmpr_sz, ucmpr_sz);
+    if (cmpr_sz == ucmpr_sz) {
+        return read_at(buffer, (len < static_cast<size_t>(ucmpr_sz) ? len : ucmpr_sz), ofs);
+    }
+
+    if (inflateInit2(&z, -MAX_WBITS) != Z_OK) {
+        throw_inflate_failed(&z, 0, filename);
+    }
+
+    size_t remaining = static_cast<size_t>(cmpr_sz);
+    int status = Z_OK;
+    while (z.avail_out && remaining && status == Z_OK) {
+        size_t chunk = (remaining < ChunkSize ? remaining : ChunkSize);
+        if (read_at(cmpr_data, chunk, ofs) != chunk) {
+            throw_inflate_failed(&z, 0, filename);
+        }
+        ofs += chunk;
+        remaining -= chunk;
+        z.next_in = cmpr_data;
+        z.avail_in = static_cast<uInt>(chunk);
+        status = inflate(&z, Z_SYNC_FLUSH);
+        if (status != Z_OK && status != Z_STREAM_END && status != Z_BUF_ERROR) {
+            throw_inflate_failed(&z, 0, filename);
+        }
+    }
+    size_t sz = len - z.avail_out;
+    inflateEnd(&z);
+
+    return sz;
+}
+
 void ZipReader::destroy(const char *data) {
     if (data) {
         delete[] data;
@@ -191,12 +422,71 @@ void ZipReader::throw_inflate_failed(z_stream *z, const char *data, const std::s
 }
 
 const ZipReader::File& ZipReader::get_file(const std::string& filename) throw (ZipReaderException) {
-    for (Files::iterator it = files.begin(); it != files.end(); it++) {
-        const File& file = *it;
+    size_t mask = file_table.size() - 1;
+    size_t slot = hash_filename(filename) & mask;
+    while (file_table[slot] != NoFile) {
+        const File& file = files[file_table[slot]];
         if (file.filename == filename) {
             return file;
         }
+        slot = (slot + 1) & mask;
     }
 
     throw ZipReaderException("File " + filename + " not found in package");
 }
+
+size_t ZipReader::read_local_header(const File& file, const std::string& filename,
+    int& cmpr_sz, int& ucmpr_sz) throw (ZipReaderException)
+{
+    unsigned char header[30];
+    size_t sz = read_at(header, 30, file.ofs);
+    if (sz != 30) {
+        throw_inflate_failed(0, 0, filename);
+    }
+    if (memcmp(header, "PK\003\004", 4)) {
+        throw_inflate_failed(0, 0, filename);
+    }
+    cmpr_sz = header[21] << 24 | header[20] << 16 | header[19] << 8 | header[18];
+    ucmpr_sz = header[25] << 24 | header[24] << 16 | header[23] << 8 | header[22];
+    int len = header[27] << 8 | header[26];
+    int xln = header[29] << 8 | header[28];
+
+    return file.ofs + 30 + len + xln;
+}
+
+void ZipReader::build_index() {
+    /* open addressing on the path hash, the table is at most half full
+       and duplicates are found in central directory order */
+    size_t table_size = 16;
+    while (table_size < files.size() * 2) {
+        table_size <<= 1;
+    }
+    file_table.assign(table_size, NoFile);
+
+    for (size_t i = 0; i < files.size(); i++) {
+        const File& file = files[i];
+        size_t slot = hash_filename(file.filename) & (table_size - 1);
+        while (file_table[slot] != NoFile) {
+            slot = (slot + 1) & (table_size - 1);
+        }
+        file_table[slot] = i;
+
+        /* like equals_directory(), entries belong to every parent directory */
+        size_t pos = file.filename.rfind('/');
+        while (pos != std::string::npos && pos) {
+            directories[file.filename.substr(0, pos)].push_back(&file);
+            pos = file.filename.rfind('/', pos - 1);
+        }
+    }
+}
+
+SharedZipReader::SharedZipReader(const std::string& filename) throw (ZipReaderException)
+    : zip(ZipReader::open(filename)) { }
+
+SharedZipReader::~SharedZipReader() {
+    ZipReader::release(zip);
+}
+
+ZipReader *SharedZipReader::get() const {
+    return zip;
+}